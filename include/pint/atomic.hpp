@@ -0,0 +1,174 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+
+#include "pint/pint.hpp"
+
+namespace pint {
+namespace detail {
+
+// Plain integer addition is the same as add_wrap if there is single pack,
+// which fills the whole integer: carry out of it is discarded
+template<class Integer, size_t Bits0, size_t ...Bits>
+using has_native_fetch_add = std::integral_constant<bool,
+    sizeof...(Bits) == 0 && Bits0 == sizeof(Integer) * 8>;
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// Packed integer updated atomically. Bitwise operations and additions
+// of the single full-width pack are native atomic instructions, other
+// lane-wise operations are compare-and-swap loops over the whole integer.
+// All fetch_* functions return the previous value
+
+template<class PackedInt> class atomic_packed_int;
+
+template<class Integer, size_t Bits0, size_t ...Bits>
+class atomic_packed_int<packed_int<Integer, Bits0, Bits...>> {
+    static_assert(std::is_integral<Integer>::value, "Only integers can be updated atomically");
+
+public:
+    using packed_type = packed_int<Integer, Bits0, Bits...>;
+
+    atomic_packed_int() noexcept : m_value(Integer(0)) {}
+    explicit atomic_packed_int(packed_type value) noexcept : m_value(value.value()) {}
+
+    atomic_packed_int(const atomic_packed_int &) = delete;
+    atomic_packed_int &operator=(const atomic_packed_int &) = delete;
+
+    bool is_lock_free() const noexcept { return m_value.is_lock_free(); }
+
+    packed_type load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+        return packed_type(m_value.load(order));
+    }
+
+    void store(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        m_value.store(value.value(), order);
+    }
+
+    packed_type exchange(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return packed_type(m_value.exchange(value.value(), order));
+    }
+
+    bool compare_exchange_weak(packed_type &expected, packed_type desired,
+        std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        Integer value = expected.value();
+        const bool result = m_value.compare_exchange_weak(value, desired.value(), order);
+        expected = packed_type(value);
+        return result;
+    }
+
+    bool compare_exchange_strong(packed_type &expected, packed_type desired,
+        std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        Integer value = expected.value();
+        const bool result = m_value.compare_exchange_strong(value, desired.value(), order);
+        expected = packed_type(value);
+        return result;
+    }
+
+    // Replace value by function(value) atomically, function may be called several times
+    template<class Function>
+    packed_type fetch_update(Function function, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        Integer value = m_value.load(std::memory_order_relaxed);
+        while (!m_value.compare_exchange_weak(value, function(packed_type(value)).value(),
+            order, std::memory_order_relaxed)) {}
+        return packed_type(value);
+    }
+
+    packed_type fetch_add_wrap(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return fetch_add_wrap(value, order, detail::has_native_fetch_add<Integer, Bits0, Bits...>());
+    }
+
+    packed_type fetch_sub_wrap(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return fetch_sub_wrap(value, order, detail::has_native_fetch_add<Integer, Bits0, Bits...>());
+    }
+
+    packed_type fetch_add_unsigned_saturate(packed_type value,
+        std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        return fetch_update([value](packed_type current) { return add_unsigned_saturate(current, value); }, order);
+    }
+
+    packed_type fetch_add_signed_saturate(packed_type value,
+        std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        return fetch_update([value](packed_type current) { return add_signed_saturate(current, value); }, order);
+    }
+
+    packed_type fetch_sub_unsigned_saturate(packed_type value,
+        std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        return fetch_update([value](packed_type current) { return sub_unsigned_saturate(current, value); }, order);
+    }
+
+    packed_type fetch_sub_signed_saturate(packed_type value,
+        std::memory_order order = std::memory_order_seq_cst) noexcept
+    {
+        return fetch_update([value](packed_type current) { return sub_signed_saturate(current, value); }, order);
+    }
+
+    packed_type fetch_min_unsigned(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return fetch_update([value](packed_type current) { return min_unsigned(current, value); }, order);
+    }
+
+    packed_type fetch_max_unsigned(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return fetch_update([value](packed_type current) { return max_unsigned(current, value); }, order);
+    }
+
+    packed_type fetch_min_signed(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return fetch_update([value](packed_type current) { return min_signed(current, value); }, order);
+    }
+
+    packed_type fetch_max_signed(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return fetch_update([value](packed_type current) { return max_signed(current, value); }, order);
+    }
+
+    packed_type fetch_and(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return packed_type(m_value.fetch_and(value.value(), order));
+    }
+
+    packed_type fetch_or(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return packed_type(m_value.fetch_or(value.value(), order));
+    }
+
+    packed_type fetch_xor(packed_type value, std::memory_order order = std::memory_order_seq_cst) noexcept {
+        return packed_type(m_value.fetch_xor(value.value(), order));
+    }
+
+private:
+    packed_type fetch_add_wrap(packed_type value, std::memory_order order, std::true_type /* native */) noexcept {
+        return packed_type(m_value.fetch_add(value.value(), order));
+    }
+
+    packed_type fetch_add_wrap(packed_type value, std::memory_order order, std::false_type) noexcept {
+        return fetch_update([value](packed_type current) { return add_wrap(current, value); }, order);
+    }
+
+    packed_type fetch_sub_wrap(packed_type value, std::memory_order order, std::true_type /* native */) noexcept {
+        return packed_type(m_value.fetch_sub(value.value(), order));
+    }
+
+    packed_type fetch_sub_wrap(packed_type value, std::memory_order order, std::false_type) noexcept {
+        return fetch_update([value](packed_type current) { return sub_wrap(current, value); }, order);
+    }
+
+    std::atomic<Integer> m_value;
+};
+
+} // namespace pint
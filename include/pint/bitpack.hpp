@@ -0,0 +1,323 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "pint/vector.hpp"
+
+namespace pint {
+namespace bitpack {
+
+// Values are encoded by blocks, all values of block take the same number
+// of bits, which is enough for the largest of them. Blocks are grouped
+// into frames
+const size_t block_size = 128;
+const size_t frame_blocks = 4;
+const size_t frame_size = block_size * frame_blocks;
+
+} // namespace bitpack
+
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////
+// Encoded stream is a sequence of 64-bit words. Frame starts with header word,
+// 16 bits per block: width of values in the low 8 bits and number of values
+// in the high 8 bits, zero count marks absent block. Payloads of blocks follow
+// the header, block of count values takes ceil(count * width / 64) words, which
+// are 2 * width words for full block. Values are stored as in packed_vector.
+//
+// Encoder emits only full frames until the stream is finished, so the stream
+// may be split into chunks at any frame boundary
+
+inline size_t bitpack_payload_words(size_t count, size_t width) noexcept {
+    return (count * width + 63) / 64;
+}
+
+inline size_t bitpack_width(const uint32_t *values, size_t count) noexcept {
+    uint32_t all = 0;
+    for (size_t i = 0; i < count; ++i)
+        all |= values[i];
+
+    size_t width = 0;
+    while (width < 32 && (all >> width) != 0)
+        ++width;
+    return width;
+}
+
+inline size_t bitpack_block_width(uint64_t header, size_t block) noexcept {
+    return (header >> (block * 16)) & 0xff;
+}
+
+inline size_t bitpack_block_count(uint64_t header, size_t block) noexcept {
+    return (header >> (block * 16 + 8)) & 0xff;
+}
+
+// Function is called with size_t_<width>, width is from 0 to 32
+template<class Function>
+void with_bitpack_width(size_t, const Function &, size_t_<33>) {}
+
+template<class Function, size_t Width>
+void with_bitpack_width(size_t width, const Function &function, size_t_<Width>) {
+    if (width == Width)
+        return function(size_t_<Width>());
+    with_bitpack_width(width, function, size_t_<Width + 1>());
+}
+
+// Padded words of one block, SIMD loads and reading of the next word by
+// get_bits may leave the block payload by up to 2 words
+const size_t bitpack_block_buffer = 2 * 32 + bit_array_padding;
+
+// Full blocks are packed by 64 values straight into the stream, partial
+// block is packed into zeroed buffer and copied. Blocks have the layout of
+// packed_vector rather than of packed_int lanes: pack_block already joins
+// values into pairs of Width-bit lanes in a 64-bit register, and the shared
+// layout lets the decoder reuse AVX2 unpacking of packed_vector
+struct bitpack_pack_block {
+    const uint32_t *values;
+    size_t count;
+    uint64_t *words;
+
+    void operator()(size_t_<0>) const {}
+
+    template<size_t Width>
+    void operator()(size_t_<Width>) const {
+        if (count == bitpack::block_size) {
+            pack_block<Width>(words, values);
+            pack_block<Width>(words + Width, values + 64);
+            return;
+        }
+
+        uint64_t buffer[bitpack_block_buffer] = {};
+        pack_values<Width>(buffer, 0, values, count);
+        std::copy(buffer, buffer + bitpack_payload_words(count, Width), words);
+    }
+};
+
+template<class Isa>
+struct bitpack_unpack_block {
+    const uint64_t *words;
+    size_t count;
+    uint32_t *out;
+
+    void operator()(size_t_<0>) const { std::fill(out, out + count, uint32_t(0)); }
+
+    template<size_t Width>
+    void operator()(size_t_<Width>) const { bulk_unpack<Width>{words, 0, out, count}(Isa()); }
+};
+
+// Appends frame of up to frame_size values to the stream
+inline void bitpack_encode_frame(const uint32_t *values, size_t count, std::vector<uint64_t> &stream) {
+    const size_t header = stream.size();
+    stream.push_back(0);
+
+    uint64_t header_word = 0;
+    for (size_t block = 0; block < bitpack::frame_blocks && count > 0; ++block) {
+        const size_t block_count = std::min(count, bitpack::block_size);
+        const size_t width = bitpack_width(values, block_count);
+        header_word |= uint64_t(width | (block_count << 8)) << (block * 16);
+
+        const size_t offset = stream.size();
+        stream.resize(offset + bitpack_payload_words(block_count, width));
+        with_bitpack_width(width, bitpack_pack_block{values, block_count, stream.data() + offset}, size_t_<0>());
+
+        values += block_count;
+        count -= block_count;
+    }
+
+    stream[header] = header_word;
+}
+
+// Number of words of frame starting at words[0], or 0 if the frame is
+// malformed or doesn't fit size words
+inline size_t bitpack_frame_words(const uint64_t *words, size_t size, size_t &values) noexcept {
+    if (size == 0)
+        return 0;
+
+    size_t length = 1;
+    values = 0;
+    for (size_t block = 0; block < bitpack::frame_blocks; ++block) {
+        const size_t width = bitpack_block_width(words[0], block);
+        const size_t count = bitpack_block_count(words[0], block);
+        if (width > 32 || count > bitpack::block_size)
+            return 0;
+
+        length += bitpack_payload_words(count, width);
+        values += count;
+    }
+    return length <= size ? length : 0;
+}
+
+// Decoding of frames called with the tag of instruction set selected at runtime.
+// Blocks at the end of the stream are copied to padded buffer
+struct bulk_bitpack_decode {
+    const uint64_t *words;
+    size_t size;
+    uint32_t *out;
+
+    template<class Isa>
+    void operator()(Isa) const {
+        const uint64_t header = words[0];
+        const uint64_t *payload = words + 1;
+        uint32_t *values = out;
+
+        for (size_t block = 0; block < bitpack::frame_blocks; ++block) {
+            const size_t width = bitpack_block_width(header, block);
+            const size_t count = bitpack_block_count(header, block);
+            const size_t length = bitpack_payload_words(count, width);
+
+            if (payload + length + 2 <= words + size) {
+                with_bitpack_width(width, bitpack_unpack_block<Isa>{payload, count, values}, size_t_<0>());
+            } else {
+                uint64_t buffer[bitpack_block_buffer] = {};
+                std::copy(payload, payload + length, buffer);
+                with_bitpack_width(width, bitpack_unpack_block<Isa>{buffer, count, values}, size_t_<0>());
+            }
+
+            payload += length;
+            values += count;
+        }
+    }
+};
+
+} // namespace detail
+
+namespace bitpack {
+
+///////////////////////////////////////////////////////////////////////////////
+// Codec of columns of unsigned integers which fit a few bits, e.g. deltas
+// of time series. Each block of 128 values is stored with its own width,
+// as packed_vector of that width. Values up to 25 bits long are decoded with
+// AVX2 shuffles if instruction set selected by simd::current_level() supports
+// them.
+//
+// Encoded stream is an array of 64-bit words in native byte order
+
+// Number of values in encoded stream, or 0 if it is malformed
+inline size_t decoded_size(const uint64_t *words, size_t size) noexcept {
+    size_t result = 0;
+    while (size > 0) {
+        size_t values = 0;
+        const size_t length = detail::bitpack_frame_words(words, size, values);
+        if (length == 0)
+            return 0;
+
+        result += values;
+        words += length;
+        size -= length;
+    }
+    return result;
+}
+
+// Streaming decoder of encoded words, which must outlive the decoder
+class decoder {
+public:
+    decoder(const uint64_t *words, size_t size) noexcept : m_words(words), m_size(size) {}
+
+    // Decode whole frames which fit capacity values, returns number of decoded
+    // values. Capacity of at least frame_size values is always enough for the
+    // next frame. Returns 0 if the stream is done or the next frame is malformed
+    size_t decode(uint32_t *out, size_t capacity) noexcept {
+        size_t result = 0;
+        while (m_size > 0) {
+            size_t values = 0;
+            const size_t length = detail::bitpack_frame_words(m_words, m_size, values);
+            if (length == 0 || result + values > capacity)
+                break;
+
+            simd::dispatch(detail::bulk_bitpack_decode{m_words, m_size, out + result});
+            result += values;
+            m_words += length;
+            m_size -= length;
+        }
+        return result;
+    }
+
+    // All words are decoded
+    bool done() const noexcept { return m_size == 0; }
+
+private:
+    const uint64_t *m_words;
+    size_t m_size;
+};
+
+// Decode the whole stream, out receives decoded_size(words, size) values.
+// Returns number of decoded values, which is less if the stream is malformed
+inline size_t decode(const uint64_t *words, size_t size, uint32_t *out) noexcept {
+    decoder stream(words, size);
+    return stream.decode(out, static_cast<size_t>(-1));
+}
+
+// Streaming encoder. Values are encoded by whole frames, the rest is kept
+// until the next call of encode or finish
+class encoder {
+public:
+    // Append values to the stream
+    void encode(const uint32_t *values, size_t count) {
+        if (!m_pending.empty()) {
+            const size_t taken = std::min(count, frame_size - m_pending.size());
+            m_pending.insert(m_pending.end(), values, values + taken);
+            values += taken;
+            count -= taken;
+
+            if (m_pending.size() < frame_size)
+                return;
+            detail::bitpack_encode_frame(m_pending.data(), frame_size, m_words);
+            m_pending.clear();
+        }
+
+        for (; count >= frame_size; values += frame_size, count -= frame_size)
+            detail::bitpack_encode_frame(values, frame_size, m_words);
+
+        m_pending.assign(values, values + count);
+    }
+
+    // Encode kept values as the last frame
+    void finish() {
+        if (!m_pending.empty())
+            detail::bitpack_encode_frame(m_pending.data(), m_pending.size(), m_words);
+        m_pending.clear();
+    }
+
+    // Encoded words. They end at frame boundary, so words taken after each
+    // call are a chunk decoded independently of others
+    const std::vector<uint64_t> &words() const noexcept { return m_words; }
+
+    std::vector<uint64_t> take() {
+        std::vector<uint64_t> result;
+        result.swap(m_words);
+        return result;
+    }
+
+    // Number of values kept until the next frame is full
+    size_t pending() const noexcept { return m_pending.size(); }
+
+private:
+    std::vector<uint64_t> m_words;
+    std::vector<uint32_t> m_pending;
+};
+
+// Encode values as a whole stream
+inline std::vector<uint64_t> encode(const uint32_t *values, size_t count) {
+    encoder stream;
+    stream.encode(values, count);
+    stream.finish();
+    return stream.take();
+}
+
+} // namespace bitpack
+} // namespace pint
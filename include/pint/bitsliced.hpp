@@ -0,0 +1,509 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "pint/pint.hpp"
+#include "pint/simd.hpp"
+#include "pint/unpack.hpp"
+
+namespace pint {
+namespace detail {
+
+#if defined(__GNUC__) || defined(__clang__)
+inline size_t popcount64(uint64_t value) noexcept { return static_cast<size_t>(__builtin_popcountll(value)); }
+#else
+inline size_t popcount64(uint64_t value) noexcept {
+    value -= (value >> 1) & 0x5555555555555555ull;
+    value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+    value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return static_cast<size_t>((value * 0x0101010101010101ull) >> 56);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Bit-sliced operations work on planes of a group of 64 elements: plane K
+// holds bit K of the elements, bit N of the plane is element N. Addition is
+// a ripple-carry adder of Bits full adders, each one handles 64 elements
+// with a few bitwise operations. Ops have apply<Bits>(a, b, out)
+// on arrays of Bits planes of one group
+
+// a + b + carry, returns carry out of the high order plane
+template<size_t Bits>
+inline uint64_t bitsliced_add(const uint64_t *a, const uint64_t *b, uint64_t carry, uint64_t *out) noexcept {
+    for (size_t k = 0; k < Bits; ++k) {
+        const uint64_t x = a[k] ^ b[k];
+        out[k] = x ^ carry;
+        carry = (a[k] & b[k]) | (x & carry);
+    }
+    return carry;
+}
+
+// a - b as a + ~b + 1, returns carry: bit is zero if subtraction borrows
+template<size_t Bits>
+inline uint64_t bitsliced_sub(const uint64_t *a, const uint64_t *b, uint64_t *out) noexcept {
+    uint64_t not_b[Bits];
+    for (size_t k = 0; k < Bits; ++k)
+        not_b[k] = ~b[k];
+    return bitsliced_add<Bits>(a, not_b, ~uint64_t(0), out);
+}
+
+// Overflowed elements are replaced with min (sign of a is set) or max value
+template<size_t Bits>
+inline void bitsliced_saturate_signed(const uint64_t *a, uint64_t overflow, uint64_t *out) noexcept {
+    const uint64_t sign = a[Bits - 1];
+    for (size_t k = 0; k + 1 < Bits; ++k)
+        out[k] = (out[k] & ~overflow) | (~sign & overflow);
+    out[Bits - 1] = (out[Bits - 1] & ~overflow) | (sign & overflow);
+}
+
+template<size_t Bits>
+inline void bitsliced_fill(uint64_t mask, uint64_t *out) noexcept {
+    for (size_t k = 0; k < Bits; ++k)
+        out[k] = mask;
+}
+
+struct bitsliced_add_wrap_op {
+    template<size_t Bits>
+    static void apply(const uint64_t *a, const uint64_t *b, uint64_t *out) noexcept {
+        bitsliced_add<Bits>(a, b, 0, out);
+    }
+};
+
+struct bitsliced_sub_wrap_op {
+    template<size_t Bits>
+    static void apply(const uint64_t *a, const uint64_t *b, uint64_t *out) noexcept {
+        bitsliced_sub<Bits>(a, b, out);
+    }
+};
+
+struct bitsliced_add_unsigned_saturate_op {
+    template<size_t Bits>
+    static void apply(const uint64_t *a, const uint64_t *b, uint64_t *out) noexcept {
+        const uint64_t carry = bitsliced_add<Bits>(a, b, 0, out);
+        for (size_t k = 0; k < Bits; ++k)
+            out[k] |= carry;
+    }
+};
+
+struct bitsliced_sub_unsigned_saturate_op {
+    template<size_t Bits>
+    static void apply(const uint64_t *a, const uint64_t *b, uint64_t *out) noexcept {
+        const uint64_t no_borrow = bitsliced_sub<Bits>(a, b, out);
+        for (size_t k = 0; k < Bits; ++k)
+            out[k] &= no_borrow;
+    }
+};
+
+// Signed overflow: operands of the same sign give result of another sign
+struct bitsliced_add_signed_saturate_op {
+    template<size_t Bits>
+    static void apply(const uint64_t *a, const uint64_t *b, uint64_t *out) noexcept {
+        bitsliced_add<Bits>(a, b, 0, out);
+        const uint64_t overflow = ~(a[Bits - 1] ^ b[Bits - 1]) & (a[Bits - 1] ^ out[Bits - 1]);
+        bitsliced_saturate_signed<Bits>(a, overflow, out);
+    }
+};
+
+struct bitsliced_sub_signed_saturate_op {
+    template<size_t Bits>
+    static void apply(const uint64_t *a, const uint64_t *b, uint64_t *out) noexcept {
+        bitsliced_sub<Bits>(a, b, out);
+        const uint64_t overflow = (a[Bits - 1] ^ b[Bits - 1]) & (a[Bits - 1] ^ out[Bits - 1]);
+        bitsliced_saturate_signed<Bits>(a, overflow, out);
+    }
+};
+
+struct bitsliced_cmp_eq_op {
+    template<size_t Bits>
+    static void apply(const uint64_t *a, const uint64_t *b, uint64_t *out) noexcept {
+        uint64_t equal = ~uint64_t(0);
+        for (size_t k = 0; k < Bits; ++k)
+            equal &= ~(a[k] ^ b[k]);
+        bitsliced_fill<Bits>(equal, out);
+    }
+};
+
+struct bitsliced_cmp_lt_unsigned_op {
+    template<size_t Bits>
+    static void apply(const uint64_t *a, const uint64_t *b, uint64_t *out) noexcept {
+        uint64_t diff[Bits];
+        bitsliced_fill<Bits>(~bitsliced_sub<Bits>(a, b, diff), out);
+    }
+};
+
+// a < b if sign of a - b differs from signed overflow
+struct bitsliced_cmp_lt_signed_op {
+    template<size_t Bits>
+    static void apply(const uint64_t *a, const uint64_t *b, uint64_t *out) noexcept {
+        uint64_t diff[Bits];
+        bitsliced_sub<Bits>(a, b, diff);
+        const uint64_t overflow = (a[Bits - 1] ^ b[Bits - 1]) & (a[Bits - 1] ^ diff[Bits - 1]);
+        bitsliced_fill<Bits>(diff[Bits - 1] ^ overflow, out);
+    }
+};
+
+// Op applied to all groups, planes are stored one after another, so loop
+// over groups is vectorized. Pointers are copied, since stores may alias them
+template<class Op, size_t Bits, size_t Groups>
+struct bulk_bitsliced {
+    const uint64_t *a;
+    const uint64_t *b;
+    uint64_t *out;
+
+    template<class Isa>
+    void operator()(Isa) const {
+        const uint64_t *x = a, *y = b;
+        uint64_t *result = out;
+
+        for (size_t g = 0; g < Groups; ++g) {
+            uint64_t pa[Bits], pb[Bits], pr[Bits];
+            for (size_t k = 0; k < Bits; ++k) {
+                pa[k] = x[k * Groups + g];
+                pb[k] = y[k * Groups + g];
+            }
+            Op::template apply<Bits>(pa, pb, pr);
+            for (size_t k = 0; k < Bits; ++k)
+                result[k * Groups + g] = pr[k];
+        }
+    }
+};
+
+// Sum of plane K is popcount of the plane weighted by 2^K
+template<size_t Bits, size_t Groups>
+struct bulk_bitsliced_sum {
+    const uint64_t *planes;
+    uint64_t *sum;
+
+    template<class Isa>
+    void operator()(Isa) const {
+        uint64_t result = 0;
+        for (size_t k = 0; k < Bits; ++k) {
+            uint64_t count = 0;
+            for (size_t g = 0; g < Groups; ++g)
+                count += popcount64(planes[k * Groups + g]);
+            result += count << k;
+        }
+        *sum = result;
+    }
+};
+
+template<class Integer, size_t ...Lanes>
+struct bitsliced_packed_checks {
+    static const size_t lanes = sizeof...(Lanes);
+    static const size_t bits = find_max<Lanes...>::value;
+
+    static_assert(sum<Lanes...>::value == bits * lanes, "Packs must have the same length");
+    static_assert(sizeof(Integer) <= sizeof(uint64_t), "Packed integers must fit 64 bits");
+    static const bool value = true;
+};
+
+// Conversion of packed integers to planes and back, packed integer N holds
+// elements N * Lanes, ..., N * Lanes + Lanes - 1. Elements are moved bit by bit,
+// or with pdep / pext if Lanes divides 64, so packed integer doesn't cross groups:
+// bit K of all its packs is extracted from the packed integer at once
+template<size_t Bits, size_t N, class Integer, size_t ...Lanes>
+struct bitsliced_convert {
+    static const size_t lanes = sizeof...(Lanes);
+    static const size_t groups = N / 64;
+    static const uint64_t lane_mask = all_ones<uint64_t, Bits>::value;
+
+    // Low order bit of each pack
+    static constexpr uint64_t low_bits(size_t lane = 0) {
+        return lane == lanes ? 0 : (uint64_t(1) << (lane * Bits)) | low_bits(lane + 1);
+    }
+};
+
+template<size_t Bits, size_t N, class Integer, size_t ...Lanes>
+struct bitsliced_to_planes : bitsliced_convert<Bits, N, Integer, Lanes...> {
+    using base = bitsliced_convert<Bits, N, Integer, Lanes...>;
+    using base::lanes;
+    using base::groups;
+
+    const packed_int<Integer, Lanes...> *values;
+    uint64_t *planes;
+
+    bitsliced_to_planes(const packed_int<Integer, Lanes...> *values_, uint64_t *planes_) noexcept
+        : values(values_), planes(planes_) {}
+
+    void operator()(simd::none) const {
+        std::fill(planes, planes + Bits * groups, uint64_t(0));
+        for (size_t e = 0; e < N; ++e) {
+            const uint64_t element = (static_cast<uint64_t>(values[e / lanes].value()) >> (e % lanes * Bits)) & base::lane_mask;
+            for (size_t k = 0; k < Bits; ++k)
+                planes[k * groups + e / 64] |= ((element >> k) & 1) << (e % 64);
+        }
+    }
+
+#ifdef PINT_SIMD_BMI2
+    PINT_SIMD_TARGET("bmi2") PINT_SIMD_FLATTEN
+    void operator()(bmi2) const {
+        for (size_t g = 0; g < groups; ++g) {
+            for (size_t k = 0; k < Bits; ++k) {
+                uint64_t plane = 0;
+                for (size_t i = 0; i < 64 / lanes; ++i)
+                    plane |= _pext_u64(values[g * (64 / lanes) + i].value(), base::low_bits() << k) << (i * lanes);
+                planes[k * groups + g] = plane;
+            }
+        }
+    }
+#endif
+};
+
+template<size_t Bits, size_t N, class Integer, size_t ...Lanes>
+struct bitsliced_from_planes : bitsliced_convert<Bits, N, Integer, Lanes...> {
+    using base = bitsliced_convert<Bits, N, Integer, Lanes...>;
+    using base::lanes;
+    using base::groups;
+
+    const uint64_t *planes;
+    packed_int<Integer, Lanes...> *values;
+
+    bitsliced_from_planes(const uint64_t *planes_, packed_int<Integer, Lanes...> *values_) noexcept
+        : planes(planes_), values(values_) {}
+
+    void operator()(simd::none) const {
+        for (size_t i = 0; i < N / lanes; ++i) {
+            uint64_t value = 0;
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                const size_t e = i * lanes + lane;
+                for (size_t k = 0; k < Bits; ++k)
+                    value |= ((planes[k * groups + e / 64] >> (e % 64)) & 1) << (lane * Bits + k);
+            }
+            values[i] = packed_int<Integer, Lanes...>(static_cast<Integer>(value));
+        }
+    }
+
+#ifdef PINT_SIMD_BMI2
+    PINT_SIMD_TARGET("bmi2") PINT_SIMD_FLATTEN
+    void operator()(bmi2) const {
+        for (size_t g = 0; g < groups; ++g) {
+            for (size_t i = 0; i < 64 / lanes; ++i) {
+                uint64_t value = 0;
+                for (size_t k = 0; k < Bits; ++k)
+                    value |= _pdep_u64(planes[k * groups + g] >> (i * lanes), base::low_bits() << k);
+                values[g * (64 / lanes) + i] = packed_int<Integer, Lanes...>(static_cast<Integer>(value));
+            }
+        }
+    }
+#endif
+};
+
+// Tag of constructor which leaves planes uninitialized, for results
+// written by kernels
+struct bitsliced_uninitialized {};
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// N unsigned integers of Bits bits in bit-sliced form: bit K of 64 elements
+// is stored in one word (plane), so operation on 64 elements takes a few
+// bitwise operations per bit, whatever the length of elements. It is faster
+// than packed integers for short elements (1 to 4 bits) and operations
+// which need carries between bits, like saturation.
+//
+// N must be a multiple of 64. Objects hold N * Bits bits inline, so N is
+// chosen to fit cache, e.g. 4096, and arrays of objects store more elements
+
+template<size_t Bits, size_t N>
+class bitsliced {
+    static_assert(Bits > 0 && Bits <= 64, "Elements must be from 1 to 64 bits long");
+    static_assert(N > 0 && N % 64 == 0, "Number of elements must be a multiple of 64");
+
+public:
+    static const size_t size = N;
+    static const size_t groups = N / 64;
+    static const size_t bits = Bits;
+
+    bitsliced() noexcept : m_planes() {}
+    explicit bitsliced(detail::bitsliced_uninitialized) noexcept {}
+
+    // Element index, truncated to Bits bits on assignment
+    uint64_t get(size_t index) const noexcept {
+        uint64_t result = 0;
+        for (size_t k = 0; k < Bits; ++k)
+            result |= ((m_planes[k][index / 64] >> (index % 64)) & 1) << k;
+        return result;
+    }
+
+    void set(size_t index, uint64_t value) noexcept {
+        const uint64_t bit = uint64_t(1) << (index % 64);
+        for (size_t k = 0; k < Bits; ++k)
+            m_planes[k][index / 64] = (m_planes[k][index / 64] & ~bit) | (((value >> k) & 1) ? bit : 0);
+    }
+
+    // Plane K: bit K of elements, bit N of word G is element G * 64 + N
+    const uint64_t *plane(size_t k) const noexcept { return m_planes[k]; }
+    uint64_t *plane(size_t k) noexcept { return m_planes[k]; }
+
+    // Planes one after another
+    const uint64_t *data() const noexcept { return m_planes[0]; }
+    uint64_t *data() noexcept { return m_planes[0]; }
+
+    // Elements from packs of N / sizeof...(Lanes) packed integers, all packs
+    // must be Bits long. pdep / pext are used if simd::current_bmi2() is true
+    template<class Integer, size_t ...Lanes>
+    static bitsliced from_packed(const packed_int<Integer, Lanes...> *values) noexcept {
+        using checks = detail::bitsliced_packed_checks<Integer, Lanes...>;
+        static_assert(checks::value && checks::bits == Bits, "Packs must be Bits long");
+        static_assert(N % sizeof...(Lanes) == 0, "Elements must fill packed integers");
+
+        bitsliced result{detail::bitsliced_uninitialized()};
+        detail::bmi2_dispatch(detail::bitsliced_to_planes<Bits, N, Integer, Lanes...>(values, result.data()),
+            std::integral_constant<bool, 64 % sizeof...(Lanes) == 0>());
+        return result;
+    }
+
+    template<class Integer, size_t ...Lanes>
+    void to_packed(packed_int<Integer, Lanes...> *out) const noexcept {
+        using checks = detail::bitsliced_packed_checks<Integer, Lanes...>;
+        static_assert(checks::value && checks::bits == Bits, "Packs must be Bits long");
+        static_assert(N % sizeof...(Lanes) == 0, "Elements must fill packed integers");
+
+        detail::bmi2_dispatch(detail::bitsliced_from_planes<Bits, N, Integer, Lanes...>(data(), out),
+            std::integral_constant<bool, 64 % sizeof...(Lanes) == 0>());
+    }
+
+    friend bool operator==(const bitsliced &a, const bitsliced &b) noexcept {
+        return std::equal(a.data(), a.data() + Bits * groups, b.data());
+    }
+    friend bool operator!=(const bitsliced &a, const bitsliced &b) noexcept { return !(a == b); }
+
+private:
+    uint64_t m_planes[Bits][groups];
+};
+
+template<size_t Bits, size_t N> const size_t bitsliced<Bits, N>::size;
+template<size_t Bits, size_t N> const size_t bitsliced<Bits, N>::groups;
+template<size_t Bits, size_t N> const size_t bitsliced<Bits, N>::bits;
+
+namespace detail {
+
+template<class Op, size_t Bits, size_t N>
+bitsliced<Bits, N> apply_bitsliced(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    bitsliced<Bits, N> result{bitsliced_uninitialized()};
+    simd::dispatch(bulk_bitsliced<Op, Bits, N / 64>{a.data(), b.data(), result.data()});
+    return result;
+}
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// Element-wise functions of bit-sliced integers, the same as functions of
+// packed integers with the same names. Loops over groups are vectorized for
+// instruction set selected by simd::current_level()
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> add_wrap(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return detail::apply_bitsliced<detail::bitsliced_add_wrap_op>(a, b);
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> sub_wrap(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return detail::apply_bitsliced<detail::bitsliced_sub_wrap_op>(a, b);
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> add_unsigned_saturate(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return detail::apply_bitsliced<detail::bitsliced_add_unsigned_saturate_op>(a, b);
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> sub_unsigned_saturate(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return detail::apply_bitsliced<detail::bitsliced_sub_unsigned_saturate_op>(a, b);
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> add_signed_saturate(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return detail::apply_bitsliced<detail::bitsliced_add_signed_saturate_op>(a, b);
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> sub_signed_saturate(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return detail::apply_bitsliced<detail::bitsliced_sub_signed_saturate_op>(a, b);
+}
+
+// Element of the result has all bits set if condition is true, otherwise it's zero
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> cmp_eq(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return detail::apply_bitsliced<detail::bitsliced_cmp_eq_op>(a, b);
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> cmp_lt_unsigned(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return detail::apply_bitsliced<detail::bitsliced_cmp_lt_unsigned_op>(a, b);
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> cmp_gt_unsigned(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return cmp_lt_unsigned(b, a);
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> cmp_lt_signed(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return detail::apply_bitsliced<detail::bitsliced_cmp_lt_signed_op>(a, b);
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> cmp_gt_signed(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return cmp_lt_signed(b, a);
+}
+
+// Elements of a where mask is set, and elements of b elsewhere. Mask
+// is a result of comparison, only its first plane is used
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> select(const bitsliced<Bits, N> &mask, const bitsliced<Bits, N> &a,
+    const bitsliced<Bits, N> &b) noexcept
+{
+    bitsliced<Bits, N> result{detail::bitsliced_uninitialized()};
+    for (size_t k = 0; k < Bits; ++k) {
+        for (size_t g = 0; g < N / 64; ++g)
+            result.plane(k)[g] = (a.plane(k)[g] & mask.plane(0)[g]) | (b.plane(k)[g] & ~mask.plane(0)[g]);
+    }
+    return result;
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> min_unsigned(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return select(cmp_lt_unsigned(a, b), a, b);
+}
+
+template<size_t Bits, size_t N>
+bitsliced<Bits, N> max_unsigned(const bitsliced<Bits, N> &a, const bitsliced<Bits, N> &b) noexcept {
+    return select(cmp_lt_unsigned(a, b), b, a);
+}
+
+// Exact sum of all elements by popcount of planes. The sum is less than
+// N * 2^Bits, so it must fit 64 bits
+template<size_t Bits, size_t N>
+uint64_t reduce_add_wide(const bitsliced<Bits, N> &value) noexcept {
+    static_assert(Bits + detail::bit_width(N - 1) <= 64, "Sum of elements must fit 64 bits");
+    uint64_t result = 0;
+    simd::dispatch(detail::bulk_bitsliced_sum<Bits, N / 64>{value.data(), &result});
+    return result;
+}
+
+// Number of elements where mask is set
+template<size_t Bits, size_t N>
+size_t count(const bitsliced<Bits, N> &mask) noexcept {
+    size_t result = 0;
+    for (size_t g = 0; g < N / 64; ++g)
+        result += detail::popcount64(mask.plane(0)[g]);
+    return result;
+}
+
+} // namespace pint
@@ -0,0 +1,1135 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "pint/pint.hpp"
+#include "pint/simd.hpp"
+
+namespace pint {
+namespace detail {
+
+// Size of lanes if all packs have the same size, which is supported by
+// SIMD instructions, and packs fill the whole integer. Otherwise 0
+template<class Integer, size_t Bits0, size_t ...Bits>
+using native_lane = size_t_<
+    (all_same<integer_seq<Bits0, Bits...>>::value
+        && sum<Bits0, Bits...>::value == sizeof(Integer) * 8
+        && (Bits0 == 8 || Bits0 == 16 || Bits0 == 32 || Bits0 == 64)) ? Bits0 : 0
+>;
+
+// Size of native lanes of packed integer
+template<class PackedInt> struct native_lane_of_impl;
+template<class Integer, size_t Bits0, size_t ...Bits>
+struct native_lane_of_impl<packed_int<Integer, Bits0, Bits...>> { using type = native_lane<Integer, Bits0, Bits...>; };
+
+template<class PackedInt>
+using native_lane_of = typename native_lane_of_impl<PackedInt>::type;
+
+// Overload resolution priority, higher is preferred
+template<size_t N> struct priority : priority<N - 1> {};
+template<> struct priority<0> {};
+
+// Operations applied by bulk functions. `apply` works on any word,
+// `native` is defined only if SIMD instruction set has dedicated instruction
+// for the layout.
+
+struct add_wrap_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::add_wrap<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::add_wrap(a, b, lane)) {
+        return simd::add_wrap(a, b, lane);
+    }
+};
+
+struct add_unsigned_saturate_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::add_unsigned_saturate<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::add_unsigned_saturate(a, b, lane)) {
+        return simd::add_unsigned_saturate(a, b, lane);
+    }
+};
+
+struct add_signed_saturate_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::add_signed_saturate<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::add_signed_saturate(a, b, lane)) {
+        return simd::add_signed_saturate(a, b, lane);
+    }
+};
+
+struct sub_wrap_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::sub_wrap<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::sub_wrap(a, b, lane)) {
+        return simd::sub_wrap(a, b, lane);
+    }
+};
+
+struct sub_unsigned_saturate_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::sub_unsigned_saturate<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::sub_unsigned_saturate(a, b, lane)) {
+        return simd::sub_unsigned_saturate(a, b, lane);
+    }
+};
+
+struct sub_signed_saturate_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::sub_signed_saturate<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::sub_signed_saturate(a, b, lane)) {
+        return simd::sub_signed_saturate(a, b, lane);
+    }
+};
+
+struct min_unsigned_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::min_unsigned<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::min_unsigned(a, b, lane)) {
+        return simd::min_unsigned(a, b, lane);
+    }
+};
+
+struct max_unsigned_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::max_unsigned<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::max_unsigned(a, b, lane)) {
+        return simd::max_unsigned(a, b, lane);
+    }
+};
+
+struct min_signed_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::min_signed<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::min_signed(a, b, lane)) {
+        return simd::min_signed(a, b, lane);
+    }
+};
+
+struct max_signed_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::max_signed<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::max_signed(a, b, lane)) {
+        return simd::max_signed(a, b, lane);
+    }
+};
+
+struct avg_unsigned_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::avg_unsigned<Bits0, Bits...>(a, b); }
+
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::avg_unsigned(a, b, lane)) {
+        return simd::avg_unsigned(a, b, lane);
+    }
+};
+
+struct avg_signed_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::avg_signed<Bits0, Bits...>(a, b); }
+
+    // Unsigned average of lanes with inverted sign bit. Lanes may be
+    // shorter than Integer, sign bits are repeated for each of them
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane) -> decltype(simd::avg_unsigned(a, b, lane)) {
+        using integer = typename Word::value_type;
+        const Word sign(static_cast<integer>(
+            static_cast<integer>(integer(~integer(0)) / all_ones<integer, Lane::value>::value) << (Lane::value - 1)));
+        return simd::avg_unsigned(a ^ sign, b ^ sign, lane) ^ sign;
+    }
+};
+
+struct absdiff_unsigned_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b) { return detail::absdiff_unsigned<Bits0, Bits...>(a, b); }
+
+    // max(a, b) - min(a, b)
+    template<class Word, class Lane>
+    static auto native(Word a, Word b, Lane lane)
+        -> decltype(simd::sub_wrap(simd::max_unsigned(a, b, lane), simd::min_unsigned(a, b, lane), lane))
+    {
+        return simd::sub_wrap(simd::max_unsigned(a, b, lane), simd::min_unsigned(a, b, lane), lane);
+    }
+};
+
+// shift_left_op and shift_right_unsigned_op are defined in pint.hpp
+
+struct shift_right_signed_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value, size_t amount) { return detail::shift_right_signed<Bits0, Bits...>(value, amount); }
+};
+
+struct rotate_left_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value, size_t amount) {
+        return detail::rotate<shift_left_op, shift_right_unsigned_op, Bits0, Bits...>(
+            value, amount, all_same<integer_seq<Bits0, Bits...>>());
+    }
+};
+
+struct rotate_right_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value, size_t amount) {
+        return detail::rotate<shift_right_unsigned_op, shift_left_op, Bits0, Bits...>(
+            value, amount, all_same<integer_seq<Bits0, Bits...>>());
+    }
+};
+
+// Shifts by amounts given for each pack are binary operations
+struct shift_left_variable_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value, Word amounts) {
+        return detail::shift_variable<shift_left_op, Bits0, Bits...>(value, amounts);
+    }
+};
+
+struct shift_right_unsigned_variable_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value, Word amounts) {
+        return detail::shift_variable<shift_right_unsigned_op, Bits0, Bits...>(value, amounts);
+    }
+};
+
+struct shift_right_signed_variable_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value, Word amounts) {
+        return detail::shift_right_signed_variable<Bits0, Bits...>(value, amounts);
+    }
+};
+
+struct rotate_left_variable_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value, Word amounts) {
+        return detail::rotate_variable<shift_left_op, shift_right_unsigned_op, Bits0, Bits...>(value, amounts);
+    }
+};
+
+struct rotate_right_variable_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value, Word amounts) {
+        return detail::rotate_variable<shift_right_unsigned_op, shift_left_op, Bits0, Bits...>(value, amounts);
+    }
+};
+
+// Operations with lazy overflow detection return wrapped result and
+// accumulate overflow vector in `overflow`
+struct add_overflow_unsigned_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b, Word &overflow) {
+        const Word sum = detail::add_wrap<Bits0, Bits...>(a, b);
+        overflow = static_cast<Word>(overflow | detail::overflow_add_unsigned<Bits0, Bits...>(a, b, sum));
+        return sum;
+    }
+};
+
+struct add_overflow_signed_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b, Word &overflow) {
+        const Word sum = detail::add_wrap<Bits0, Bits...>(a, b);
+        overflow = static_cast<Word>(overflow | detail::overflow_add_signed<Bits0, Bits...>(a, b, sum));
+        return sum;
+    }
+};
+
+struct sub_overflow_unsigned_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b, Word &overflow) {
+        const Word diff = detail::sub_wrap<Bits0, Bits...>(a, b);
+        overflow = static_cast<Word>(overflow | detail::overflow_sub_unsigned<Bits0, Bits...>(a, b, diff));
+        return diff;
+    }
+};
+
+struct sub_overflow_signed_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word a, Word b, Word &overflow) {
+        const Word diff = detail::sub_wrap<Bits0, Bits...>(a, b);
+        overflow = static_cast<Word>(overflow | detail::overflow_sub_signed<Bits0, Bits...>(a, b, diff));
+        return diff;
+    }
+};
+
+// Bit counting operations. Native lanes are counted by pshufb or VPOPCNT,
+// leading and trailing zeros are masked by SWAR and counted the same way
+template<class Word, class ...Packs>
+Word leading_zeros_layout(Word value, seq<Packs...>) { return detail::leading_zeros<Packs::value...>(value); }
+
+template<class Word, class ...Packs>
+Word trailing_zeros_layout(Word value, seq<Packs...>) { return detail::trailing_zeros<Packs::value...>(value); }
+
+template<class Word, class Lane>
+using lanes_layout = repeat<Lane, sizeof(scalar_of<Word>) * 8 / Lane::value>;
+
+struct popcount_lanes_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value) { return detail::popcount_lanes<Bits0, Bits...>(value); }
+
+    template<class Word, class Lane, class ...Tag>
+    static auto native(Word value, Lane lane, Tag ...tag) -> decltype(simd::popcount_lanes(value, lane, tag...)) {
+        return simd::popcount_lanes(value, lane, tag...);
+    }
+};
+
+struct clz_lanes_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value) { return detail::clz_lanes<Bits0, Bits...>(value); }
+
+    template<class Word, class Lane, class ...Tag>
+    static auto native(Word value, Lane lane, Tag ...tag)
+        -> decltype(simd::popcount_lanes(value, lane, tag...))
+    {
+        return simd::popcount_lanes(leading_zeros_layout(value, lanes_layout<Word, Lane>()), lane, tag...);
+    }
+};
+
+struct ctz_lanes_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static Word apply(Word value) { return detail::ctz_lanes<Bits0, Bits...>(value); }
+
+    template<class Word, class Lane, class ...Tag>
+    static auto native(Word value, Lane lane, Tag ...tag)
+        -> decltype(simd::popcount_lanes(value, lane, tag...))
+    {
+        return simd::popcount_lanes(trailing_zeros_layout(value, lanes_layout<Word, Lane>()), lane, tag...);
+    }
+};
+
+// Conversions between layouts. `apply` converts packs within lanes of the
+// wider integer. If packs of both layouts are native lanes, `native` clamps
+// them and lanes are extended on load or truncated on store
+struct widen_unsigned_op {
+    using sign_extend = std::false_type;
+
+    template<class Conversion, class Word>
+    static Word apply(Word value) { return Conversion::repack(value); }
+
+    template<class Conversion, class Word, class Lane>
+    static Word native(Word value, Lane) { return value; }
+};
+
+struct widen_signed_op {
+    using sign_extend = std::true_type;
+
+    template<class Conversion, class Word>
+    static Word apply(Word value) { return Conversion::widen_signed(value); }
+
+    template<class Conversion, class Word, class Lane>
+    static Word native(Word value, Lane) { return value; }
+};
+
+struct narrow_unsigned_saturate_op {
+    using sign_extend = std::false_type;
+
+    template<class Conversion, class Word>
+    static Word apply(Word value) { return Conversion::narrow_unsigned_saturate(value); }
+
+    template<class Conversion, class Word, class Lane>
+    static auto native(Word value, Lane lane) -> decltype(simd::min_unsigned(value, value, lane)) {
+        using integer = typename Word::value_type;
+        using max = typename Conversion::template unsigned_max<integer>;
+        return simd::min_unsigned(value, Word(max::value), lane);
+    }
+};
+
+struct narrow_signed_saturate_op {
+    using sign_extend = std::false_type;
+
+    template<class Conversion, class Word>
+    static Word apply(Word value) { return Conversion::narrow_signed_saturate(value); }
+
+    template<class Conversion, class Word, class Lane>
+    static auto native(Word value, Lane lane)
+        -> decltype(simd::max_signed(simd::min_signed(value, value, lane), value, lane))
+    {
+        using integer = typename Word::value_type;
+        using max = typename Conversion::template signed_max<integer>;
+        using min = typename Conversion::template signed_min<integer>;
+        return simd::max_signed(simd::min_signed(value, Word(max::value), lane), Word(min::value), lane);
+    }
+};
+
+struct repack_op {
+    using sign_extend = std::false_type;
+
+    template<class Conversion, class Word>
+    static Word apply(Word value) { return Conversion::repack(value); }
+
+    template<class Conversion, class Word, class Lane>
+    static Word native(Word value, Lane) { return value; }
+};
+
+// Word of Lane bits loaded from lanes of Narrow bits, lanes of the same size
+// are loaded as is
+template<class Word, class Lane, class SignExtend>
+Word load_lanes(const void *data, Lane, Lane, SignExtend) { return Word::load(data); }
+
+template<class Word, class Narrow, class Lane>
+auto load_lanes(const void *data, Narrow narrow, Lane lane, std::false_type)
+    -> decltype(simd::load_zero_extend<Word>(data, narrow, lane))
+{
+    return simd::load_zero_extend<Word>(data, narrow, lane);
+}
+
+template<class Word, class Narrow, class Lane>
+auto load_lanes(const void *data, Narrow narrow, Lane lane, std::true_type)
+    -> decltype(simd::load_sign_extend<Word>(data, narrow, lane))
+{
+    return simd::load_sign_extend<Word>(data, narrow, lane);
+}
+
+template<class Word, class Lane>
+void store_lanes(void *data, Word value, Lane, Lane) { value.store(data); }
+
+template<class Word, class Narrow, class Lane>
+auto store_lanes(void *data, Word value, Narrow narrow, Lane lane)
+    -> decltype(simd::store_truncate(data, value, narrow, lane))
+{
+    simd::store_truncate(data, value, narrow, lane);
+}
+
+// Apply operation to SIMD word, prefer dedicated instruction if there is one
+template<class Op, size_t Bits0, size_t ...Bits, class Word>
+auto apply_word(Word a, Word b, priority<1>)
+    -> decltype(Op::native(a, b, native_lane<scalar_of<Word>, Bits0, Bits...>()))
+{
+    return Op::native(a, b, native_lane<scalar_of<Word>, Bits0, Bits...>());
+}
+
+template<class Op, size_t Bits0, size_t ...Bits, class Word>
+Word apply_word(Word a, Word b, priority<0>)
+{
+    return Op::template apply<Bits0, Bits...>(a, b);
+}
+
+// Unary operation, tag selects variant of native instruction
+template<class Op, size_t Bits0, size_t ...Bits, class Word, class ...Tag>
+auto apply_word(Word value, priority<1>, Tag ...tag)
+    -> decltype(Op::native(value, native_lane<scalar_of<Word>, Bits0, Bits...>(), tag...))
+{
+    return Op::native(value, native_lane<scalar_of<Word>, Bits0, Bits...>(), tag...);
+}
+
+template<class Op, size_t Bits0, size_t ...Bits, class Word, class ...Tag>
+Word apply_word(Word value, priority<0>, Tag ...)
+{
+    return Op::template apply<Bits0, Bits...>(value);
+}
+
+// Binary operation over arrays. Called with the tag of instruction set
+// selected at runtime, the tail which doesn't fill the whole SIMD register
+// is processed without SIMD
+template<class Op, class Integer, size_t Bits0, size_t ...Bits>
+struct bulk_binary {
+    using packed_type = packed_int<Integer, Bits0, Bits...>;
+
+    const packed_type *a;
+    const packed_type *b;
+    packed_type *out;
+    size_t count;
+
+    void operator()(simd::none) const {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = packed_type(Op::template apply<Bits0, Bits...>(a[i].value(), b[i].value()));
+    }
+
+    template<class Isa>
+    void operator()(Isa) const {
+        using word = simd::word<Integer, Isa>;
+
+        size_t i = 0;
+        for (; i + word::size <= count; i += word::size) {
+            apply_word<Op, Bits0, Bits...>(word::load(a + i), word::load(b + i), priority<1>())
+                .store(out + i);
+        }
+
+        bulk_binary{a + i, b + i, out + i, count - i}(simd::none());
+    }
+};
+
+// Shift over array
+template<class Op, class Integer, size_t Bits0, size_t ...Bits>
+struct bulk_shift {
+    using packed_type = packed_int<Integer, Bits0, Bits...>;
+
+    const packed_type *values;
+    size_t amount;
+    packed_type *out;
+    size_t count;
+
+    void operator()(simd::none) const {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = packed_type(Op::template apply<Bits0, Bits...>(values[i].value(), amount));
+    }
+
+    template<class Isa>
+    void operator()(Isa) const {
+        using word = simd::word<Integer, Isa>;
+
+        size_t i = 0;
+        for (; i + word::size <= count; i += word::size)
+            Op::template apply<Bits0, Bits...>(word::load(values + i), amount).store(out + i);
+
+        bulk_shift{values + i, amount, out + i, count - i}(simd::none());
+    }
+};
+
+// Bit counting over arrays. At avx512bw level VPOPCNT instructions are
+// used if they are enabled, the loop is compiled for them separately
+template<class Op, class Integer, size_t Bits0, size_t ...Bits>
+struct bulk_popcount {
+    using packed_type = packed_int<Integer, Bits0, Bits...>;
+
+    const packed_type *values;
+    packed_type *out;
+    size_t count;
+
+    void operator()(simd::none) const {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = packed_type(Op::template apply<Bits0, Bits...>(values[i].value()));
+    }
+
+    template<class Isa>
+    void operator()(Isa) const { run<Isa>(); }
+
+#ifdef PINT_SIMD_X86
+    void operator()(simd::avx512bw) const {
+        if (simd::current_avx512_popcnt())
+            return run_vpopcnt();
+        run<simd::avx512bw>();
+    }
+
+    PINT_SIMD_TARGET(PINT_SIMD_VPOPCNT_TARGET) PINT_SIMD_FLATTEN
+    void run_vpopcnt() const { run<simd::avx512bw>(simd::vpopcnt()); }
+#endif
+
+    template<class Isa, class ...Tag>
+    void run(Tag ...tag) const {
+        using word = simd::word<Integer, Isa>;
+
+        size_t i = 0;
+        for (; i + word::size <= count; i += word::size)
+            apply_word<Op, Bits0, Bits...>(word::load(values + i), priority<1>(), tag...).store(out + i);
+
+        bulk_popcount{values + i, out + i, count - i}(simd::none());
+    }
+};
+
+// Conversion between layouts over arrays. Lanes of SIMD register are
+// integers of the wider layout, the narrower integers are extended on load
+// or truncated on store. If packs of both layouts are native lanes, the
+// lanes of packs are converted instead
+template<class Op, class From, class To>
+struct bulk_convert {
+    using conversion = packed_conversion<From, To>;
+    using integer = typename conversion::word;
+    using from_bits = size_t_<sizeof(typename From::value_type) * 8>;
+    using to_bits = size_t_<sizeof(typename To::value_type) * 8>;
+    using wide_bits = size_t_<sizeof(integer) * 8>;
+
+    using from_lane = native_lane_of<From>;
+    using to_lane = native_lane_of<To>;
+    using wide_lane = size_t_<(from_lane::value < to_lane::value ? to_lane::value : from_lane::value)>;
+    using native = std::integral_constant<bool, from_lane::value != 0 && to_lane::value != 0
+        && from_lane::value != to_lane::value>;
+
+    const From *values;
+    To *out;
+    size_t count;
+
+    void operator()(simd::none) const {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = To(static_cast<typename To::value_type>(
+                Op::template apply<conversion>(static_cast<integer>(values[i].value()))));
+        }
+    }
+
+    template<class Isa>
+    void operator()(Isa) const { run<simd::word<integer, Isa>>(priority<1>()); }
+
+    template<class Word, class Native = native>
+    auto run(priority<1>) const -> typename std::enable_if<Native::value, decltype(
+        store_lanes(out, Op::template native<conversion>(
+            load_lanes<Word>(values, from_lane(), wide_lane(), typename Op::sign_extend()), from_lane()),
+            to_lane(), wide_lane()))>::type
+    {
+        size_t i = 0;
+        for (; i + Word::size <= count; i += Word::size) {
+            const Word value = load_lanes<Word>(values + i, from_lane(), wide_lane(), typename Op::sign_extend());
+            store_lanes(out + i, Op::template native<conversion>(value, from_lane()), to_lane(), wide_lane());
+        }
+
+        bulk_convert{values + i, out + i, count - i}(simd::none());
+    }
+
+    template<class Word>
+    void run(priority<0>) const {
+        size_t i = 0;
+        for (; i + Word::size <= count; i += Word::size) {
+            const Word value = load_lanes<Word>(values + i, from_bits(), wide_bits(), std::false_type());
+            store_lanes(out + i, Op::template apply<conversion>(value), to_bits(), wide_bits());
+        }
+
+        bulk_convert{values + i, out + i, count - i}(simd::none());
+    }
+};
+
+// Binary operation with lazy overflow detection over arrays. Overflow vector
+// is accumulated in register and merged into flags once per call
+template<class Op, class Integer, size_t Bits0, size_t ...Bits>
+struct bulk_overflow {
+    using packed_type = packed_int<Integer, Bits0, Bits...>;
+
+    const packed_type *a;
+    const packed_type *b;
+    packed_type *out;
+    size_t count;
+    overflow_flags<packed_type> *overflow;
+
+    void operator()(simd::none) const {
+        Integer bits = overflow->bits().value();
+        for (size_t i = 0; i < count; ++i)
+            out[i] = packed_type(Op::template apply<Bits0, Bits...>(a[i].value(), b[i].value(), bits));
+        overflow->record(packed_type(bits));
+    }
+
+    template<class Isa>
+    void operator()(Isa) const {
+        using word = simd::word<Integer, Isa>;
+
+        word bits(Integer(0));
+        size_t i = 0;
+        for (; i + word::size <= count; i += word::size)
+            Op::template apply<Bits0, Bits...>(word::load(a + i), word::load(b + i), bits).store(out + i);
+
+        Integer lanes[word::size];
+        bits.store(lanes);
+        for (size_t j = 0; j < word::size; ++j)
+            overflow->record(packed_type(lanes[j]));
+
+        bulk_overflow{a + i, b + i, out + i, count - i, overflow}(simd::none());
+    }
+};
+
+// Sum of absolute differences of all packs. Absolute differences are summed
+// within each lane (the sum fits the lane, like reduce_add_wide), then lanes
+// are summed into 64-bit lanes of accumulator. Layouts of 8-bit packs
+// use psadbw, which does both steps at once
+template<class Integer, size_t Bits0, size_t ...Bits>
+struct bulk_sad {
+    using packed_type = packed_int<Integer, Bits0, Bits...>;
+    using same_length = all_same<integer_seq<Bits0, Bits...>>;
+
+    const packed_type *a;
+    const packed_type *b;
+    size_t count;
+    uint64_t *result;
+
+    // Lanes of Word summed within 64-bit lanes
+    template<class Word64, class Word>
+    static Word64 widen_sum(Word sums, std::true_type /* 64-bit lanes */) { return sums.template as<Word64>(); }
+
+    template<class Word64, class Word>
+    static Word64 widen_sum(Word sums, std::false_type) {
+        return sum_packs<sizeof(Integer) * 8, 64>(sums.template as<Word64>(), std::true_type());
+    }
+
+    template<class Word64, class Word>
+    static auto sum_absdiff(Word a, Word b, priority<1>)
+        -> decltype(simd::sum_absdiff(a, b, native_lane<Integer, Bits0, Bits...>()), Word64(uint64_t(0)))
+    {
+        return simd::sum_absdiff(a, b, native_lane<Integer, Bits0, Bits...>()).template as<Word64>();
+    }
+
+    template<class Word64, class Word>
+    static Word64 sum_absdiff(Word a, Word b, priority<0>) {
+        return widen_sum<Word64>(
+            detail::reduce_add<Bits0, Bits...>(detail::absdiff_unsigned<Bits0, Bits...>(a, b), same_length()),
+            std::integral_constant<bool, sizeof(Integer) == sizeof(uint64_t)>());
+    }
+
+    void operator()(simd::none) const {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            sum += static_cast<uint64_t>(detail::reduce_add<Bits0, Bits...>(
+                static_cast<scalar_of<Integer>>(detail::absdiff_unsigned<Bits0, Bits...>(a[i].value(), b[i].value())),
+                same_length()));
+        }
+        *result += sum;
+    }
+
+    template<class Isa>
+    void operator()(Isa) const {
+        using word = simd::word<Integer, Isa>;
+        using word64 = simd::word<uint64_t, Isa>;
+
+        word64 sums(uint64_t(0));
+        size_t i = 0;
+        for (; i + word::size <= count; i += word::size)
+            sums = sums + sum_absdiff<word64>(word::load(a + i), word::load(b + i), priority<1>());
+
+        uint64_t lanes[word64::size];
+        sums.store(lanes);
+        for (size_t j = 0; j < word64::size; ++j)
+            *result += lanes[j];
+
+        bulk_sad{a + i, b + i, count - i, result}(simd::none());
+    }
+};
+
+// SIMD words exist only for integers up to 64 bits. Wider integers
+// and registers are processed one by one
+template<class Integer>
+using has_simd_word = std::integral_constant<bool,
+    std::is_integral<Integer>::value && sizeof(Integer) <= sizeof(uint64_t)>;
+
+template<class Function>
+void bulk_dispatch(const Function &function, std::true_type) { simd::dispatch(function); }
+
+template<class Function>
+void bulk_dispatch(const Function &function, std::false_type) { function(simd::none()); }
+
+template<class Op, size_t Bits0, size_t ...Bits, class Integer>
+void bulk_apply(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count)
+{
+    bulk_dispatch(bulk_binary<Op, Integer, Bits0, Bits...>{a, b, out, count}, has_simd_word<Integer>());
+}
+
+template<class Op, size_t Bits0, size_t ...Bits, class Integer>
+void bulk_apply(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count)
+{
+    bulk_dispatch(bulk_popcount<Op, Integer, Bits0, Bits...>{values, out, count}, has_simd_word<Integer>());
+}
+
+template<class Op, size_t Bits0, size_t ...Bits, class Integer, class Target>
+void bulk_convert_apply(const packed_int<Integer, Bits0, Bits...> *values, Target *out, size_t count)
+{
+    bulk_dispatch(bulk_convert<Op, packed_int<Integer, Bits0, Bits...>, Target>{values, out, count},
+        std::integral_constant<bool, has_simd_word<Integer>::value
+            && has_simd_word<typename Target::value_type>::value>());
+}
+
+template<class Op, size_t Bits0, size_t ...Bits, class Integer>
+void bulk_apply(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    size_t amount,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count)
+{
+    bulk_dispatch(bulk_shift<Op, Integer, Bits0, Bits...>{values, amount, out, count}, has_simd_word<Integer>());
+}
+
+template<class Op, size_t Bits0, size_t ...Bits, class Integer>
+void bulk_apply(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count,
+    overflow_flags<packed_int<Integer, Bits0, Bits...>> &overflow)
+{
+    bulk_dispatch(bulk_overflow<Op, Integer, Bits0, Bits...>{a, b, out, count, &overflow}, has_simd_word<Integer>());
+}
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// Bulk functions. Each function processes `count` packed integers
+// stored in arrays, `out` may point to the same array as one of inputs
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void add_wrap(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::add_wrap_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void add_unsigned_saturate(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::add_unsigned_saturate_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void add_signed_saturate(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::add_signed_saturate_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void sub_wrap(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::sub_wrap_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void sub_unsigned_saturate(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::sub_unsigned_saturate_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void sub_signed_saturate(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::sub_signed_saturate_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void min_unsigned(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::min_unsigned_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void max_unsigned(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::max_unsigned_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void min_signed(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::min_signed_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void max_signed(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::max_signed_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void avg_unsigned(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::avg_unsigned_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void avg_signed(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::avg_signed_op>(a, b, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void absdiff_unsigned(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::absdiff_unsigned_op>(a, b, out, count);
+}
+
+// Sum of absolute differences of all packs of a and b, e.g. cost of
+// matching two blocks of pixels in motion estimation
+template<size_t Bits0, size_t ...Bits, class Integer>
+uint64_t sad_unsigned(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    size_t count) noexcept
+{
+    uint64_t result = 0;
+    detail::bulk_dispatch(detail::bulk_sad<Integer, Bits0, Bits...>{a, b, count, &result},
+        detail::has_simd_word<Integer>());
+    return result;
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void shift_left(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    size_t shift_amount,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::shift_left_op>(values, shift_amount, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void shift_right_unsigned(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    size_t shift_amount,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::shift_right_unsigned_op>(values, shift_amount, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void shift_right_signed(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    size_t shift_amount,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::shift_right_signed_op>(values, shift_amount, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void rotate_left(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    size_t amount,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::rotate_left_op>(values, amount, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void rotate_right(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    size_t amount,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::rotate_right_op>(values, amount, out, count);
+}
+
+// Shifts by amounts given for each pack, amounts[i] is used for values[i]
+template<size_t Bits0, size_t ...Bits, class Integer>
+void shift_left(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    const packed_int<Integer, Bits0, Bits...> *amounts,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::shift_left_variable_op>(values, amounts, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void shift_right_unsigned(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    const packed_int<Integer, Bits0, Bits...> *amounts,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::shift_right_unsigned_variable_op>(values, amounts, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void shift_right_signed(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    const packed_int<Integer, Bits0, Bits...> *amounts,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::shift_right_signed_variable_op>(values, amounts, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void rotate_left(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    const packed_int<Integer, Bits0, Bits...> *amounts,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::rotate_left_variable_op>(values, amounts, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void rotate_right(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    const packed_int<Integer, Bits0, Bits...> *amounts,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::rotate_right_variable_op>(values, amounts, out, count);
+}
+
+// Bit counting within each pack: out[i] = popcount_lanes(values[i]), ...
+template<size_t Bits0, size_t ...Bits, class Integer>
+void popcount_lanes(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::popcount_lanes_op>(values, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void clz_lanes(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::clz_lanes_op>(values, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void ctz_lanes(
+    const packed_int<Integer, Bits0, Bits...> *values,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::bulk_apply<detail::ctz_lanes_op>(values, out, count);
+}
+
+// Conversion to the layout of Target with the same number of packs:
+// out[i] = widen_unsigned<Target>(values[i]), ...
+template<size_t Bits0, size_t ...Bits, class Integer, class Target>
+void widen_unsigned(const packed_int<Integer, Bits0, Bits...> *values, Target *out, size_t count) noexcept
+{
+    static_assert(detail::packed_conversion<packed_int<Integer, Bits0, Bits...>, Target>::widening,
+        "Packs of Target must not be shorter");
+    detail::bulk_convert_apply<detail::widen_unsigned_op>(values, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer, class Target>
+void widen_signed(const packed_int<Integer, Bits0, Bits...> *values, Target *out, size_t count) noexcept
+{
+    static_assert(detail::packed_conversion<packed_int<Integer, Bits0, Bits...>, Target>::widening,
+        "Packs of Target must not be shorter");
+    detail::bulk_convert_apply<detail::widen_signed_op>(values, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer, class Target>
+void narrow_unsigned_saturate(const packed_int<Integer, Bits0, Bits...> *values, Target *out, size_t count) noexcept
+{
+    static_assert(detail::packed_conversion<packed_int<Integer, Bits0, Bits...>, Target>::narrowing,
+        "Packs of Target must not be longer");
+    detail::bulk_convert_apply<detail::narrow_unsigned_saturate_op>(values, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer, class Target>
+void narrow_signed_saturate(const packed_int<Integer, Bits0, Bits...> *values, Target *out, size_t count) noexcept
+{
+    static_assert(detail::packed_conversion<packed_int<Integer, Bits0, Bits...>, Target>::narrowing,
+        "Packs of Target must not be longer");
+    detail::bulk_convert_apply<detail::narrow_signed_saturate_op>(values, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer, class Target>
+void repack(const packed_int<Integer, Bits0, Bits...> *values, Target *out, size_t count) noexcept
+{
+    detail::bulk_convert_apply<detail::repack_op>(values, out, count);
+}
+
+// Lazy overflow detection: packs which overflowed in any of results
+// are recorded in overflow
+template<size_t Bits0, size_t ...Bits, class Integer>
+void add_overflow_unsigned(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count,
+    overflow_flags<packed_int<Integer, Bits0, Bits...>> &overflow) noexcept
+{
+    detail::bulk_apply<detail::add_overflow_unsigned_op>(a, b, out, count, overflow);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void add_overflow_signed(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count,
+    overflow_flags<packed_int<Integer, Bits0, Bits...>> &overflow) noexcept
+{
+    detail::bulk_apply<detail::add_overflow_signed_op>(a, b, out, count, overflow);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void sub_overflow_unsigned(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count,
+    overflow_flags<packed_int<Integer, Bits0, Bits...>> &overflow) noexcept
+{
+    detail::bulk_apply<detail::sub_overflow_unsigned_op>(a, b, out, count, overflow);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void sub_overflow_signed(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count,
+    overflow_flags<packed_int<Integer, Bits0, Bits...>> &overflow) noexcept
+{
+    detail::bulk_apply<detail::sub_overflow_signed_op>(a, b, out, count, overflow);
+}
+
+} // namespace pint
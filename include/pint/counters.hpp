@@ -0,0 +1,116 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+
+#include "pint/atomic.hpp"
+
+namespace pint {
+namespace detail {
+
+const size_t cache_line_size = 64;
+
+// Threads are numbered in order of their first update of any counters,
+// thread N updates shard N modulo number of shards
+inline size_t thread_shard_index() noexcept {
+    static std::atomic<size_t> next_index(0);
+    thread_local const size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+inline size_t default_shard_count() noexcept {
+    const size_t threads = std::thread::hardware_concurrency();
+    return threads != 0 ? threads : 1;
+}
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// Packed counters updated by many threads. Each thread adds to its own shard,
+// shards take separate cache lines, so threads don't invalidate each other's
+// caches. Reading merges all shards with add_unsigned_saturate, so counters
+// saturate at their maximum, as if they were single packed integer.
+//
+// Several threads may share a shard if there are more threads than shards:
+// updates are atomic, they just contend for the cache line
+
+template<class PackedInt>
+class sharded_counters {
+public:
+    using packed_type = PackedInt;
+
+    explicit sharded_counters(size_t shard_count = detail::default_shard_count())
+        : m_count(shard_count != 0 ? shard_count : 1)
+        , m_storage(new unsigned char[(m_count + 1) * sizeof(shard)])
+    {
+        void *data = m_storage.get();
+        size_t space = (m_count + 1) * sizeof(shard);
+        m_shards = static_cast<shard *>(std::align(alignof(shard), m_count * sizeof(shard), data, space));
+        for (size_t i = 0; i < m_count; ++i)
+            new (m_shards + i) shard();
+    }
+
+    ~sharded_counters() {
+        for (size_t i = 0; i < m_count; ++i)
+            m_shards[i].~shard();
+    }
+
+    sharded_counters(const sharded_counters &) = delete;
+    sharded_counters &operator=(const sharded_counters &) = delete;
+
+    size_t shard_count() const noexcept { return m_count; }
+
+    // Add value to counters, packs are added with unsigned saturation
+    void add(packed_type value) noexcept {
+        m_shards[detail::thread_shard_index() % m_count].value
+            .fetch_add_unsigned_saturate(value, std::memory_order_relaxed);
+    }
+
+    // Sum of all shards. Concurrent updates may be partially included
+    packed_type load() const noexcept {
+        packed_type result = m_shards[0].value.load(std::memory_order_relaxed);
+        for (size_t i = 1; i < m_count; ++i)
+            result = add_unsigned_saturate(result, m_shards[i].value.load(std::memory_order_relaxed));
+        return result;
+    }
+
+    // Sum of all shards, shards are reset to zero
+    packed_type exchange_zero() noexcept {
+        const packed_type zero(typename packed_type::value_type(0));
+        packed_type result = m_shards[0].value.exchange(zero, std::memory_order_relaxed);
+        for (size_t i = 1; i < m_count; ++i)
+            result = add_unsigned_saturate(result, m_shards[i].value.exchange(zero, std::memory_order_relaxed));
+        return result;
+    }
+
+    void reset() noexcept { exchange_zero(); }
+
+private:
+    struct alignas(detail::cache_line_size) shard {
+        atomic_packed_int<packed_type> value;
+    };
+
+    // Shards are placed in buffer aligned by hand: std::allocator doesn't
+    // align over-aligned types before C++17
+    size_t m_count;
+    std::unique_ptr<unsigned char[]> m_storage;
+    shard *m_shards;
+};
+
+} // namespace pint
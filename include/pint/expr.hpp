@@ -0,0 +1,377 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <utility>
+
+#include "pint/bulk.hpp"
+
+namespace pint {
+namespace detail {
+
+// Operands of expression evaluated for element `index`: either packed
+// integers one by one, or SIMD words of several packed integers
+template<class Integer>
+struct scalar_access {
+    using word = Integer;
+
+    template<class PackedInt>
+    static word load(const PackedInt *values, size_t index) { return values[index].value(); }
+    static word broadcast(Integer value) { return value; }
+};
+
+template<class Word>
+struct word_access {
+    using word = Word;
+
+    template<class PackedInt>
+    static word load(const PackedInt *values, size_t index) { return Word::load(values + index); }
+    static word broadcast(typename Word::value_type value) { return Word(value); }
+};
+
+// Check if SIMD instruction set has dedicated instruction for operation
+template<class Op, size_t Bits0, size_t ...Bits, class Word>
+auto has_native_test(Word word, priority<1>)
+    -> decltype(Op::native(word, word, native_lane<scalar_of<Word>, Bits0, Bits...>()), std::true_type());
+template<class Op, size_t Bits0, size_t ...Bits, class Word>
+std::false_type has_native_test(Word, priority<0>);
+
+// Word operations for layout of PackedInt
+template<class PackedInt> struct expression_ops;
+template<class Integer, size_t Bits0, size_t ...Bits>
+struct expression_ops<packed_int<Integer, Bits0, Bits...>> {
+    template<class Op, class Word>
+    using has_native = decltype(has_native_test<Op, Bits0, Bits...>(std::declval<Word>(), priority<1>()));
+
+    template<class Op, class Word>
+    static Word apply(Word a, Word b) { return apply_word<Op, Bits0, Bits...>(a, b, priority<1>()); }
+
+    template<class Word>
+    static Word add_wrap(Word a, Word b, Word &overflow) {
+        const Word sum = detail::add_wrap<Bits0, Bits...>(a, b);
+        overflow = static_cast<Word>(overflow | overflow_add_unsigned<Bits0, Bits...>(a, b, sum));
+        return sum;
+    }
+
+    template<class Word>
+    static Word sub_wrap(Word a, Word b, Word &borrow) {
+        const Word diff = detail::sub_wrap<Bits0, Bits...>(a, b);
+        borrow = static_cast<Word>(borrow | overflow_sub_unsigned<Bits0, Bits...>(a, b, diff));
+        return diff;
+    }
+
+    // Spread high order bit of each pack to the whole pack
+    template<class Word>
+    static Word spread(Word hiorder_bits) { return make_unsigned_saturation_mask<Bits0, Bits...>(hiorder_bits); }
+};
+
+template<class Derived, class PackedInt> class expression;
+template<class PackedInt> class value_expression;
+template<class PackedInt> class array_expression;
+template<class Left, class Right> class add_saturate_expression;
+template<class Left, class Right> class sub_saturate_expression;
+template<class Op, class Left, class Right> class binary_expression;
+
+// Operands of expressions: expressions, packed integers (same for all elements)
+// and arrays of packed integers
+template<class Derived, class PackedInt>
+const Derived &as_expression(const expression<Derived, PackedInt> &value) { return value.derived(); }
+
+template<class Integer, size_t Bits0, size_t ...Bits>
+value_expression<packed_int<Integer, Bits0, Bits...>> as_expression(packed_int<Integer, Bits0, Bits...> value) {
+    return value_expression<packed_int<Integer, Bits0, Bits...>>(value);
+}
+
+template<class Integer, size_t Bits0, size_t ...Bits>
+array_expression<packed_int<Integer, Bits0, Bits...>> as_expression(const packed_int<Integer, Bits0, Bits...> *values) {
+    return array_expression<packed_int<Integer, Bits0, Bits...>>(values);
+}
+
+template<class T>
+using expression_of = typename std::decay<decltype(as_expression(std::declval<T>()))>::type;
+
+// Base of expression nodes. Derived class defines
+// `template<class Access> typename Access::word eval_word(size_t index) const`
+template<class Derived, class PackedInt>
+class expression {
+public:
+    using packed_type = PackedInt;
+
+    const Derived &derived() const noexcept { return static_cast<const Derived &>(*this); }
+
+    // Value of expression for element `index` of array operands
+    packed_type eval(size_t index = 0) const noexcept {
+        return packed_type(derived().template eval_word<scalar_access<typename packed_type::value_type>>(index));
+    }
+
+    template<class Other>
+    binary_expression<min_unsigned_op, Derived, expression_of<Other>> min(const Other &other) const noexcept {
+        return binary_expression<min_unsigned_op, Derived, expression_of<Other>>(derived(), as_expression(other));
+    }
+
+    template<class Other>
+    binary_expression<max_unsigned_op, Derived, expression_of<Other>> max(const Other &other) const noexcept {
+        return binary_expression<max_unsigned_op, Derived, expression_of<Other>>(derived(), as_expression(other));
+    }
+};
+
+template<class PackedInt>
+class value_expression : public expression<value_expression<PackedInt>, PackedInt> {
+public:
+    explicit value_expression(PackedInt value) noexcept : m_value(value) {}
+
+    template<class Access>
+    typename Access::word eval_word(size_t) const { return Access::broadcast(m_value.value()); }
+
+private:
+    PackedInt m_value;
+};
+
+template<class PackedInt>
+class array_expression : public expression<array_expression<PackedInt>, PackedInt> {
+public:
+    explicit array_expression(const PackedInt *values) noexcept : m_values(values) {}
+
+    template<class Access>
+    typename Access::word eval_word(size_t index) const { return Access::load(m_values, index); }
+
+private:
+    const PackedInt *m_values;
+};
+
+template<class Left, class Right>
+class binary_node {
+    static_assert(std::is_same<typename Left::packed_type, typename Right::packed_type>::value,
+        "Operands of expression must have the same type");
+
+public:
+    binary_node(const Left &left, const Right &right) noexcept : m_left(left), m_right(right) {}
+
+protected:
+    using ops = expression_ops<typename Left::packed_type>;
+
+    Left m_left;
+    Right m_right;
+};
+
+// Operation which isn't fused with its operands
+template<class Op, class Left, class Right>
+class binary_expression
+    : public expression<binary_expression<Op, Left, Right>, typename Left::packed_type>
+    , private binary_node<Left, Right>
+{
+    using base = binary_node<Left, Right>;
+
+public:
+    using base::base;
+
+    template<class Access>
+    typename Access::word eval_word(size_t index) const {
+        return base::ops::template apply<Op>(
+            this->m_left.template eval_word<Access>(index),
+            this->m_right.template eval_word<Access>(index));
+    }
+};
+
+// Chain of unsigned saturating additions a + b + c + ... Once pack is
+// saturated, adding more can't bring it back, so the chain is computed by
+// wrapping additions, their overflow vectors are merged and saturation
+// mask is applied once. Instruction sets which saturate natively do it
+// at each step
+template<class Left, class Right>
+class add_saturate_expression
+    : public expression<add_saturate_expression<Left, Right>, typename Left::packed_type>
+    , private binary_node<Left, Right>
+{
+    using base = binary_node<Left, Right>;
+    using ops = typename base::ops;
+
+    template<class L, class R> friend class add_saturate_expression;
+
+public:
+    using base::base;
+
+    template<class Access>
+    typename Access::word eval_word(size_t index) const {
+        return eval_word<Access>(index,
+            typename ops::template has_native<add_unsigned_saturate_op, typename Access::word>());
+    }
+
+private:
+    template<class Access>
+    typename Access::word eval_word(size_t index, std::true_type) const {
+        return ops::template apply<add_unsigned_saturate_op>(
+            this->m_left.template eval_word<Access>(index),
+            this->m_right.template eval_word<Access>(index));
+    }
+
+    template<class Access>
+    typename Access::word eval_word(size_t index, std::false_type) const {
+        using word = typename Access::word;
+
+        word overflow(scalar_of<word>(0));
+        const word sum = wrapped_sum<Access>(index, overflow);
+        return static_cast<word>(sum | ops::spread(overflow));
+    }
+
+    // Wrapped sum of the chain, overflow vectors are merged into overflow
+    template<class Access>
+    typename Access::word wrapped_sum(size_t index, typename Access::word &overflow) const {
+        return ops::add_wrap(
+            chain_operand<Access>(this->m_left, index, overflow),
+            this->m_right.template eval_word<Access>(index),
+            overflow);
+    }
+
+    template<class Access, class L, class R, class Word>
+    static Word chain_operand(const add_saturate_expression<L, R> &left, size_t index, Word &overflow) {
+        return left.template wrapped_sum<Access>(index, overflow);
+    }
+
+    template<class Access, class Expression, class Word>
+    static Word chain_operand(const Expression &left, size_t index, Word &) {
+        return left.template eval_word<Access>(index);
+    }
+};
+
+// Chain of unsigned saturating subtractions a - b - c - ... Pack which
+// reached zero stays zero, so the chain is computed by wrapping subtractions
+// and packs which borrowed at any step are cleared once
+template<class Left, class Right>
+class sub_saturate_expression
+    : public expression<sub_saturate_expression<Left, Right>, typename Left::packed_type>
+    , private binary_node<Left, Right>
+{
+    using base = binary_node<Left, Right>;
+    using ops = typename base::ops;
+
+    template<class L, class R> friend class sub_saturate_expression;
+
+public:
+    using base::base;
+
+    template<class Access>
+    typename Access::word eval_word(size_t index) const {
+        return eval_word<Access>(index,
+            typename ops::template has_native<sub_unsigned_saturate_op, typename Access::word>());
+    }
+
+private:
+    template<class Access>
+    typename Access::word eval_word(size_t index, std::true_type) const {
+        return ops::template apply<sub_unsigned_saturate_op>(
+            this->m_left.template eval_word<Access>(index),
+            this->m_right.template eval_word<Access>(index));
+    }
+
+    template<class Access>
+    typename Access::word eval_word(size_t index, std::false_type) const {
+        using word = typename Access::word;
+
+        word borrow(scalar_of<word>(0));
+        const word diff = wrapped_difference<Access>(index, borrow);
+        return static_cast<word>(diff & ~ops::spread(borrow));
+    }
+
+    template<class Access>
+    typename Access::word wrapped_difference(size_t index, typename Access::word &borrow) const {
+        return ops::sub_wrap(
+            chain_operand<Access>(this->m_left, index, borrow),
+            this->m_right.template eval_word<Access>(index),
+            borrow);
+    }
+
+    template<class Access, class L, class R, class Word>
+    static Word chain_operand(const sub_saturate_expression<L, R> &left, size_t index, Word &borrow) {
+        return left.template wrapped_difference<Access>(index, borrow);
+    }
+
+    template<class Access, class Expression, class Word>
+    static Word chain_operand(const Expression &left, size_t index, Word &) {
+        return left.template eval_word<Access>(index);
+    }
+};
+
+// Operators are found by ADL, at least one operand is an expression
+template<class Derived, class PackedInt, class Other>
+add_saturate_expression<Derived, expression_of<Other>> operator+(
+    const expression<Derived, PackedInt> &left, const Other &right) noexcept
+{
+    return add_saturate_expression<Derived, expression_of<Other>>(left.derived(), as_expression(right));
+}
+
+template<class Derived, class PackedInt, class Other>
+sub_saturate_expression<Derived, expression_of<Other>> operator-(
+    const expression<Derived, PackedInt> &left, const Other &right) noexcept
+{
+    return sub_saturate_expression<Derived, expression_of<Other>>(left.derived(), as_expression(right));
+}
+
+// Expression over arrays, the tail which doesn't fill the whole SIMD
+// register is evaluated without SIMD
+template<class Expression>
+struct bulk_expression {
+    using packed_type = typename Expression::packed_type;
+    using integer = typename packed_type::value_type;
+
+    const Expression *expression;
+    packed_type *out;
+    size_t first;
+    size_t count;
+
+    void operator()(simd::none) const {
+        for (size_t i = first; i < count; ++i)
+            out[i] = packed_type(expression->template eval_word<scalar_access<integer>>(i));
+    }
+
+    template<class Isa>
+    void operator()(Isa) const {
+        using word = simd::word<integer, Isa>;
+
+        size_t i = first;
+        for (; i + word::size <= count; i += word::size)
+            expression->template eval_word<word_access<word>>(i).store(out + i);
+
+        bulk_expression{expression, out, i, count}(simd::none());
+    }
+};
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// Expressions. Operations are evaluated when the value is requested, chains
+// of saturating additions or subtractions share the saturation mask.
+// Operands are packed integers or arrays of them (`count` elements
+// are taken from each array by `evaluate`)
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+detail::value_expression<packed_int<Integer, Bits0, Bits...>> expr(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    return detail::value_expression<packed_int<Integer, Bits0, Bits...>>(value);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+detail::array_expression<packed_int<Integer, Bits0, Bits...>> expr(const packed_int<Integer, Bits0, Bits...> *values) noexcept {
+    return detail::array_expression<packed_int<Integer, Bits0, Bits...>>(values);
+}
+
+// out[i] = value of expression for element i of arrays, for i in [0, count).
+// `out` may point to one of arrays of the expression
+template<class Derived, class PackedInt>
+void evaluate(const detail::expression<Derived, PackedInt> &expression, PackedInt *out, size_t count) noexcept {
+    detail::bulk_dispatch(detail::bulk_expression<Derived>{&expression.derived(), out, 0, count},
+        detail::has_simd_word<typename PackedInt::value_type>());
+}
+
+} // namespace pint
@@ -18,6 +18,17 @@
 #include <type_traits>
 #include <utility>
 
+// Layouts (offsets of packs, masks) are computed by constexpr functions
+// in C++17, which is cheaper to compile than recursive type lists.
+// Define PINT_CONSTEXPR_LAYOUT=0 to use type lists, as in C++11
+#ifndef PINT_CONSTEXPR_LAYOUT
+#if __cpp_constexpr >= 201603 && __cpp_fold_expressions && __cpp_inline_variables
+#define PINT_CONSTEXPR_LAYOUT 1
+#else
+#define PINT_CONSTEXPR_LAYOUT 0
+#endif
+#endif
+
 namespace pint {
 
 using std::size_t;
@@ -32,6 +43,36 @@ struct identity { using type = Type; };
 template<size_t value>
 using size_t_ = std::integral_constant<size_t, value>;
 
+// Word is either unsigned integer holding single packed value or
+// SIMD register holding several packed values. Masks are always built
+// in terms of scalar type and then applied to the word.
+// Arithmetic doesn't carry between lanes, so packs must not cross them
+template<class Word> struct word_traits {
+    using scalar_type = Word;
+    using lane_type = Word;
+    static const size_t lane_bits = sizeof(Word) * 8;
+};
+template<class Word>
+using scalar_of = typename word_traits<Word>::scalar_type;
+template<class Word>
+using lane_of = typename word_traits<Word>::lane_type;
+
+// Types which can be used as storage of packed_int. unsigned __int128
+// is not integral in strict ISO mode, so it is listed explicitly
+template<class Integer>
+struct is_unsigned_integer : std::integral_constant<bool,
+    std::is_integral<Integer>::value && std::is_unsigned<Integer>::value> {};
+
+template<class Integer> struct make_signed : std::make_signed<Integer> {};
+
+#ifdef __SIZEOF_INT128__
+template<> struct is_unsigned_integer<unsigned __int128> : std::true_type {};
+template<> struct make_signed<unsigned __int128> { using type = __int128; };
+#endif
+
+// Type T for each of Bits, used to expand parameter packs
+template<class T, size_t Bits> struct type_for_bits { using type = T; };
+
 template<class ...Types> struct seq {};
 template<size_t ...Values>
 using integer_seq = seq<size_t_<Values>...>;
@@ -161,16 +202,16 @@ using take_front_n = typename take_front_n_impl<N,Seq>::type;
 template<size_t Index, class Seq> struct take_nth_impl {
     using type = take_1st<pop_front_n<Index, Seq>>;
 };
-template<class Seq> struct take_nth_impl<0, Seq> {
-    using type = take_1st<Seq>;
-};
 
 template<size_t Index, class Seq>
 using take_nth = typename take_nth_impl<Index, Seq>::type;
 
 // Slice sequence
+template<size_t First, size_t Last, class Seq> struct slice_impl {
+    using type = take_front_n<Last-First, pop_front_n<First, Seq>>;
+};
 template<size_t First, size_t Last, class Seq>
-using slice = take_front_n<Last-First, pop_front_n<First, Seq>>;
+using slice = typename slice_impl<First, Last, Seq>::type;
 
 // Zip two sequences
 template<class Seq0, class Seq1> struct zip_impl;
@@ -230,6 +271,69 @@ struct all_same<seq<First, Others...>> :
     std::is_same<seq<First, First, Others...>, seq<First, Others..., First>>::type
 {};
 
+#if PINT_CONSTEXPR_LAYOUT
+// Layout of packs. Each layout instantiates single class, offsets are
+// computed by constexpr function rather than by recursive instantiation
+template<size_t Count> struct layout_array {
+    size_t data[Count + 1];
+
+    constexpr size_t operator[](size_t index) const { return data[index]; }
+};
+
+template<size_t ...Bits> struct layout {
+    static constexpr size_t count = sizeof...(Bits);
+    static constexpr layout_array<count> bits = {{ Bits..., 0 }};
+
+    // offsets[N] = Bits0 + ... + Bits(N-1), offsets[count] is the total length
+    static constexpr layout_array<count> offsets = [] {
+        layout_array<count> result = {};
+        for (size_t i = 0; i < count; ++i)
+            result.data[i + 1] = result.data[i] + bits[i];
+        return result;
+    }();
+
+    // Pack lengths without duplicates, in order of first occurrence
+    static constexpr layout_array<count> unique_bits = [] {
+        layout_array<count> result = {};
+        size_t size = 0;
+        for (size_t i = 0; i < count; ++i) {
+            bool found = false;
+            for (size_t j = 0; j < size; ++j)
+                found = found || result.data[j] == bits[i];
+            if (!found)
+                result.data[size++] = bits[i];
+        }
+        result.data[count] = size;
+        return result;
+    }();
+    static constexpr size_t unique_count = unique_bits[count];
+};
+
+// integer_seq<Array[First + I]...>
+template<class Array, size_t First, class Indices> struct layout_seq_impl;
+template<class Array, size_t First, size_t ...I>
+struct layout_seq_impl<Array, First, std::index_sequence<I...>> {
+    using type = integer_seq<Array::value[First + I]...>;
+};
+template<class Array, size_t First, size_t Count>
+using layout_seq = typename layout_seq_impl<Array, First, std::make_index_sequence<Count>>::type;
+
+template<size_t ...Bits> struct layout_bits { static constexpr auto value = layout<Bits...>::bits; };
+template<size_t ...Bits> struct layout_offsets { static constexpr auto value = layout<Bits...>::offsets; };
+template<size_t ...Bits> struct layout_unique_bits { static constexpr auto value = layout<Bits...>::unique_bits; };
+
+// integer_seq<Bits0, Bits0 + Bits1, Bits0 + Bits1 + Bits2, ...> of first min(N, sizeof...(Bits)) elements
+template<size_t N, size_t ...Bits>
+using make_sum_vector_n = layout_seq<layout_offsets<Bits...>, 1, (N < sizeof...(Bits) ? N : sizeof...(Bits))>;
+template<size_t ...Bits>
+using make_sum_vector = make_sum_vector_n<sizeof...(Bits), Bits...>;
+
+template<size_t Index, size_t ...Bits>
+struct take_nth_impl<Index, integer_seq<Bits...>> { using type = size_t_<layout<Bits...>::bits[Index]>; };
+
+template<size_t First, size_t Last, size_t ...Bits>
+struct slice_impl<First, Last, integer_seq<Bits...>> { using type = layout_seq<layout_bits<Bits...>, First, Last - First>; };
+#else
 // Defines type which is equal to integer_seq<Bits0, Bits0 + Bits1, Bits0 + Bits1 + Bits2, ...>
 // Max is the maximum number of elements to process. Length of resulting vector is min(Max, sizeof...(Bits))
 template<size_t Max, size_t Sum, size_t ...Bits> struct make_sum_vector_impl;
@@ -252,13 +356,14 @@ template<size_t ...Bits>
 using make_sum_vector = typename make_sum_vector_impl<sizeof...(Bits), 0, Bits...>::type;
 template<size_t N, size_t ...Bits>
 using make_sum_vector_n = typename make_sum_vector_impl<N, 0, Bits...>::type;
+#endif
 
 // Sum of given bits
 template<size_t ...Bits> struct sum;
 
 #if __cpp_fold_expressions
 template<size_t ...Bits> struct sum {
-    static const size_t value = (... + Bits);
+    static const size_t value = (0 + ... + Bits);
 };
 #else
 template<size_t Bits0, size_t ...Bits>
@@ -274,6 +379,20 @@ template<class Seq> struct sum_seq;
 template<size_t ...Bits> struct sum_seq<integer_seq<Bits...>> : sum<Bits...> {};
 
 // Max of integers
+#if PINT_CONSTEXPR_LAYOUT
+constexpr size_t max_element(const size_t *numbers, size_t count) {
+    size_t result = numbers[0];
+    for (size_t i = 1; i < count; ++i)
+        result = result < numbers[i] ? numbers[i] : result;
+    return result;
+}
+
+template<size_t Number0, size_t ...Numbers>
+struct find_max {
+    static constexpr size_t numbers[] = { Number0, Numbers... };
+    static const size_t value = max_element(numbers, sizeof...(Numbers) + 1);
+};
+#else
 template<size_t Number0, size_t ...Numbers>
 struct find_max {
     static const size_t value = Number0;
@@ -283,13 +402,19 @@ template<size_t Number0, size_t Number1, size_t ...Numbers>
 struct find_max<Number0, Number1, Numbers...> {
     static const size_t value = find_max<(Number0 < Number1) ? Number1 : Number0, Numbers...>::value;
 };
+#endif
 
 // Vector of offsets
+#if PINT_CONSTEXPR_LAYOUT
+template<size_t... Bits>
+using mask_offsets_vector = layout_seq<layout_offsets<Bits...>, 0, sizeof...(Bits)>;
+#else
 template<size_t... Bits>
 using mask_offsets_vector = prepend_seq<
     size_t_<0>,
     make_sum_vector_n<sizeof...(Bits) - 1, Bits...> // (0, Bits0, Bits0 + Bits1, Bits0 + Bits1 + Bits2, ...)
 >;
+#endif
 
 // Subtract from each element of vector value
 template<class IntegerSeq, size_t Value> struct vector_sub_impl;
@@ -304,53 +429,71 @@ using vector_sub = typename vector_sub_impl<IntegerSeq, Value>::type;
 // Make mask which is equal to (1 << Bits0) | (1 << Bits1) | (1 << Bits2) | ...
 template<class T, class IntegerSeq> struct make_mask_from_bitpos_impl;
 
+// Masks are static constexpr members rather than std::integral_constant,
+// because scalar type of wide words is a class, which can't be template argument.
+// Members are defined out of class, since class types are odr-used when copied
 #if __cpp_fold_expressions
 template<class T, size_t ...Bits>
 struct make_mask_from_bitpos_impl<T, integer_seq<Bits...>> {
-    static const T value = (... | (T(1) << Bits));
+    static constexpr T value = static_cast<T>((... | (T(1) << Bits)));
 };
+template<class T, size_t ...Bits>
+constexpr T make_mask_from_bitpos_impl<T, integer_seq<Bits...>>::value;
 #else
 template<class T, size_t Bits0, size_t ...Bits>
 struct make_mask_from_bitpos_impl<T, integer_seq<Bits0, Bits...>> {
-    static const T value = (T(1) << Bits0) |
-        make_mask_from_bitpos_impl<T, integer_seq<Bits...>>::value;
+    static constexpr T value = static_cast<T>((T(1) << Bits0) |
+        make_mask_from_bitpos_impl<T, integer_seq<Bits...>>::value);
 };
+template<class T, size_t Bits0, size_t ...Bits>
+constexpr T make_mask_from_bitpos_impl<T, integer_seq<Bits0, Bits...>>::value;
 template<class T> struct make_mask_from_bitpos_impl<T, integer_seq<>> {
-    static const T value = 0;
+    static constexpr T value = T(0);
 };
+template<class T> constexpr T make_mask_from_bitpos_impl<T, integer_seq<>>::value;
 #endif
 
 // Mask = (1 << (Bits0 - 1)) | (1 << (Bits0 + Bits1 - 1)) | (1 << (Bits0 + Bits1 + Bits2 - 1)) | ...
 template<class T, size_t ...Bits>
-using mask_hiorder = std::integral_constant<T,
-    make_mask_from_bitpos_impl<T,
-        vector_sub<make_sum_vector<Bits...>, 1>
-    >::value
+using mask_hiorder = make_mask_from_bitpos_impl<T,
+    vector_sub<make_sum_vector<Bits...>, 1>
 >;
 
 // Make mask which is equal to (1 << 0) | (1 << Bits0) | (1 << Bits0 + Bits1) | (1 << Bits0 + Bits1 + Bits2) | ...
 template<class T, size_t ...Bits>
-using mask_loorder = std::integral_constant<T,
-    make_mask_from_bitpos_impl<T,
-        mask_offsets_vector<Bits...>
-    >::value
+using mask_loorder = make_mask_from_bitpos_impl<T,
+    mask_offsets_vector<Bits...>
 >;
 
-// Make mask of length Bits with all bits set to 1
+// Make mask of length Bits with all bits set to 1.
+// Shift by Bits - 1 avoids overflow when Bits is equal to size of T
 template<class T, size_t Bits> struct all_ones {
-    static const T value = (T(1) << Bits) - 1;
-};
-template<class T> struct all_ones<T, 32> {
-    static const T value = static_cast<T>(0xffffffff);
+    static constexpr T value = static_cast<T>((((T(1) << (Bits - 1)) - 1) << 1) | 1);
 };
-template<class T> struct all_ones<T, 64> {
-    static const T value = static_cast<T>(~0ULL);
+template<class T, size_t Bits> constexpr T all_ones<T, Bits>::value;
+
+// All bits except high order bit of each pack
+template<class T, size_t ...Bits> struct mask_without_hiorder {
+    static constexpr T value = static_cast<T>(
+        ~mask_hiorder<T, Bits...>::value & all_ones<T, sum<Bits...>::value>::value);
 };
+template<class T, size_t ...Bits> constexpr T mask_without_hiorder<T, Bits...>::value;
 
 // Calculate number set bits in value
-template<uint64_t number>
-struct bit_count : size_t_<1 + bit_count<number & (number - 1)>::value> {};
-template<> struct bit_count<0> : size_t_<0> {};
+#if PINT_CONSTEXPR_LAYOUT
+template<class T>
+constexpr size_t bit_count(T number) {
+    size_t result = 0;
+    for (; number != T(0); ++result)
+        number = static_cast<T>(number & (number - 1));
+    return result;
+}
+#else
+template<class T>
+constexpr size_t bit_count(T number) {
+    return number == T(0) ? 0 : 1 + bit_count(static_cast<T>(number & (number - 1)));
+}
+#endif
 
 // Make sequence of pairs <offset of mask, mask length>
 template<size_t... Bits>
@@ -364,6 +507,10 @@ using shifted_mask = std::integral_constant<Integer, (
         take_1st<OffsetAndMask>::value
 )>;
 
+#if PINT_CONSTEXPR_LAYOUT
+template<size_t Index, size_t ...Bits>
+using take_offset_and_mask = integer_seq<layout<Bits...>::offsets[Index], layout<Bits...>::bits[Index]>;
+#else
 template<size_t Index, size_t ...Bits>
 using take_offset_and_mask = take_nth<Index,
     zip<
@@ -371,6 +518,16 @@ using take_offset_and_mask = take_nth<Index,
         integer_seq<Bits...>
     >
 >;
+#endif
+
+// Pack lengths without duplicates
+#if PINT_CONSTEXPR_LAYOUT
+template<size_t ...Bits>
+using unique_bits_seq = layout_seq<layout_unique_bits<Bits...>, 0, layout<Bits...>::unique_count>;
+#else
+template<size_t ...Bits>
+using unique_bits_seq = unique<integer_seq<Bits...>>;
+#endif
 
 template<class Integer>
 constexpr Integer carry_add_vector(Integer a, Integer b) {
@@ -421,20 +578,20 @@ constexpr Integer make_truncated_int(seq<MasksAndOffsets...>, Integer value0, Va
 //    then saturation mask is (carry << 1) - (((carry >> (Bits0 - 1)) | (carry >> (Bits1 - 1)) | ...) & mask_loorder)
 // 3. ...
 
-template<class Integer, Integer hiorder, Integer loorder, class UniqueBitsSeq>
+template<class Integer, class Hiorder, class Loorder, class UniqueBitsSeq>
 struct is_saturation_mask_of_type_1_helper;
-template<class Integer, Integer hiorder, Integer loorder, size_t ...Bits>
-struct is_saturation_mask_of_type_1_helper<Integer, hiorder, loorder, integer_seq<Bits...>> {
+template<class Integer, class Hiorder, class Loorder, size_t ...Bits>
+struct is_saturation_mask_of_type_1_helper<Integer, Hiorder, Loorder, integer_seq<Bits...>> {
     static const size_t value = sum<
-        bit_count<(hiorder >> (Bits - 1)) & loorder>::value...
+        bit_count(static_cast<Integer>((Hiorder::value >> (Bits - 1)) & Loorder::value))...
     >::value;
 };
 
 template<class Integer, size_t ...Bits>
 struct is_saturation_mask_of_type_1 {
-    static const Integer hiorder = mask_hiorder<Integer, Bits...>::value;
-    static const Integer loorder = mask_loorder<Integer, Bits...>::value;
-    using unique_bits = unique<integer_seq<Bits...>>;
+    using hiorder = mask_hiorder<Integer, Bits...>;
+    using loorder = mask_loorder<Integer, Bits...>;
+    using unique_bits = unique_bits_seq<Bits...>;
 
     static const bool value = sizeof...(Bits) == is_saturation_mask_of_type_1_helper<
         Integer, hiorder, loorder, unique_bits>::value;
@@ -471,8 +628,8 @@ constexpr Integer make_unsigned_saturation_mask_type_1(Integer carrys, integer_s
 }
 #else
 template<class Integer>
-constexpr Integer make_unsigned_saturation_mask_type_1(Integer carrys, seq<>) {
-    return 0;
+constexpr Integer make_unsigned_saturation_mask_type_1(Integer /*carrys*/, seq<>) {
+    return static_cast<Integer>(0);
 }
 template<size_t Bits0, size_t ...Bits, class Integer>
 constexpr Integer make_unsigned_saturation_mask_type_1(Integer carrys, integer_seq<Bits0, Bits...>) {
@@ -484,8 +641,8 @@ template<size_t ...Bits, class Integer>
 constexpr Integer dispatch_make_unsigned_saturation_mask(
     Integer carrys, size_t_<1> /* packs of variable length (type 1) */)
 {
-    using loorder = mask_loorder<Integer, Bits...>;
-    return make_unsigned_saturation_mask_type_1(carrys, unique<integer_seq<Bits...>>())
+    using loorder = mask_loorder<scalar_of<Integer>, Bits...>;
+    return make_unsigned_saturation_mask_type_1(carrys, unique_bits_seq<Bits...>())
         & loorder::value;
 }
 
@@ -496,10 +653,33 @@ struct unsigned_saturation_mask_type_2_helper;
 template<class Integer, class ...Keys, class ...Offsets>
 struct unsigned_saturation_mask_type_2_helper<Integer, seq<seq<Keys, Offsets>...>> {
     using type = seq<
-        seq<Keys, std::integral_constant<Integer, make_mask_from_bitpos_impl<Integer, Offsets>::value>>...
+        seq<Keys, make_mask_from_bitpos_impl<Integer, Offsets>>...
+    >;
+};
+
+#if PINT_CONSTEXPR_LAYOUT
+// Lo order bits of packs Size bits long
+template<class Integer, size_t Size, class Offsets, class Bits> struct loorder_of_size;
+template<class Integer, size_t Size, size_t ...Offsets, size_t ...Bits>
+struct loorder_of_size<Integer, Size, integer_seq<Offsets...>, integer_seq<Bits...>> {
+    static constexpr Integer value = static_cast<Integer>((... |
+        (Bits == Size ? static_cast<Integer>(Integer(1) << Offsets) : Integer(0))));
+};
+
+template<class Integer, class UniqueBits, size_t ...Bits> struct unsigned_saturation_mask_type_2_map;
+template<class Integer, size_t ...UniqueBits, size_t ...Bits>
+struct unsigned_saturation_mask_type_2_map<Integer, integer_seq<UniqueBits...>, Bits...> {
+    using type = seq<
+        seq<size_t_<UniqueBits>, loorder_of_size<Integer, UniqueBits, mask_offsets_vector<Bits...>, integer_seq<Bits...>>>...
     >;
 };
 
+template<class Integer, size_t ...Bits>
+struct unsigned_saturation_mask_type_2_impl {
+    // Map of masks <MaskSize, LoOrder mask>
+    using type = typename unsigned_saturation_mask_type_2_map<Integer, unique_bits_seq<Bits...>, Bits...>::type;
+};
+#else
 template<class Integer, size_t ...Bits>
 struct unsigned_saturation_mask_type_2_impl {
     // Offsets of all masks
@@ -511,6 +691,7 @@ struct unsigned_saturation_mask_type_2_impl {
     // Make map of masks <MaskSize, LoOrder mask>
     using type = typename unsigned_saturation_mask_type_2_helper<Integer, masks_map>::type;
 };
+#endif
 template<class Integer, size_t ...Bits>
 using unsigned_saturation_mask_type_2 = typename unsigned_saturation_mask_type_2_impl<Integer, Bits...>::type;
 
@@ -524,7 +705,9 @@ constexpr Integer make_unsigned_saturation_mask_type_2(Integer carrys, seq<Masks
 }
 #else
 template<class Integer>
-constexpr Integer make_unsigned_saturation_mask_type_2(Integer /*carrys*/, seq<>) { return 0; }
+constexpr Integer make_unsigned_saturation_mask_type_2(Integer /*carrys*/, seq<>) {
+    return static_cast<Integer>(0);
+}
 template<class Mask, class ...Masks, class Integer>
 constexpr Integer make_unsigned_saturation_mask_type_2(Integer carrys, seq<Mask, Masks...>) {
     // Masks = seq<MaskSize, LoOrder Mask for MaskSize>
@@ -538,7 +721,7 @@ constexpr Integer dispatch_make_unsigned_saturation_mask(
     Integer carrys, size_t_<2> /* packs of variable length (type 2) */)
 {
     return make_unsigned_saturation_mask_type_2(carrys,
-        unsigned_saturation_mask_type_2<Integer, Bits0, Bits...>());
+        unsigned_saturation_mask_type_2<scalar_of<Integer>, Bits0, Bits...>());
 }
 
 template<size_t Bits0, size_t ...Bits, class Integer>
@@ -546,13 +729,13 @@ constexpr Integer make_unsigned_saturation_mask(Integer carrys)
 {
     return static_cast<Integer>((carrys << 1) -
         dispatch_make_unsigned_saturation_mask<Bits0, Bits...>(
-            carrys, detect_saturation_mask_type<Integer, Bits0, Bits...>())
+            carrys, detect_saturation_mask_type<scalar_of<Integer>, Bits0, Bits...>())
     );
 }
 
 // Unsigned sum with saturation
 template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr Integer add_unsigned_saturate(Integer sum, Integer carrys)
+constexpr Integer apply_unsigned_saturation(Integer sum, Integer carrys)
 {
     return sum | make_unsigned_saturation_mask<Bits0, Bits...>(carrys);
 }
@@ -562,7 +745,7 @@ constexpr Integer add_unsigned_saturate(Integer sum, Integer carrys)
 
 template<size_t Bits0, size_t ...Bits, class Integer>
 constexpr Integer make_signed_saturation_mask(Integer overflow) {
-    using saturation_mask_type = detect_saturation_mask_type<Integer, Bits0, Bits...>;
+    using saturation_mask_type = detect_saturation_mask_type<scalar_of<Integer>, Bits0, Bits...>;
     return overflow - dispatch_make_unsigned_saturation_mask<Bits0, Bits...>(overflow, saturation_mask_type());
 }
 
@@ -576,7 +759,7 @@ constexpr Integer apply_signed_saturation(Integer sum, Integer overflow)
 template<size_t Bits0, size_t ...Bits, class Integer>
 constexpr Integer add_signed_saturate(Integer a, Integer b, Integer sum)
 {
-    using mask2 = detail::mask_hiorder<Integer, Bits0, Bits...>;
+    using mask2 = detail::mask_hiorder<scalar_of<Integer>, Bits0, Bits...>;
     return apply_signed_saturation<Bits0, Bits...>(
         sum, static_cast<Integer>((~(a ^ b)) & (sum ^ b) & mask2::value));
 }
@@ -584,14 +767,14 @@ constexpr Integer add_signed_saturate(Integer a, Integer b, Integer sum)
 template<size_t Bits0, size_t ...Bits, class Integer>
 constexpr Integer sub_signed_saturate(Integer a, Integer b, Integer diff)
 {
-    using mask2 = detail::mask_hiorder<Integer, Bits0, Bits...>;
+    using mask2 = detail::mask_hiorder<scalar_of<Integer>, Bits0, Bits...>;
     return apply_signed_saturation<Bits0, Bits...>(
         diff, static_cast<Integer>(overflow_signed_sub_vector(a, b, diff) & mask2::value));
 }
 
 template<class Integer, size_t Bits0, size_t ...Bits>
 constexpr Integer make_truncate(Integer value0,
-    typename std::integral_constant<Integer, Bits>::value_type ...values)
+    typename type_for_bits<Integer, Bits>::type ...values)
 {
     static_assert(sizeof(Integer) * 8 >= detail::sum<Bits0, Bits...>::value,
         "Integral won't fit given number of bits");
@@ -636,7 +819,7 @@ constexpr Integer shift_left_mask(size_t amount, seq<Masks...>) {
 }
 #else
 template<class Integer>
-constexpr Integer shift_left_mask(size_t amount, seq<>) {
+constexpr Integer shift_left_mask(size_t /*amount*/, seq<>) {
     return 0;
 }
 
@@ -651,20 +834,28 @@ constexpr Integer shift_left_mask(size_t amount, seq<Mask, Masks...>) {
 #endif
 
 // Bits are not the same
-template<class Integer, size_t Bits0, size_t ...Bits>
-constexpr Integer shift_left(Integer value, size_t amount, std::false_type) {
-    using mask_collection = unsigned_saturation_mask_type_2<Integer, Bits0, Bits...>;
-    return (shift_left_mask<Integer>(amount, mask_collection()) & value) << amount;
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word shift_left(Word value, size_t amount, std::false_type) {
+    using mask_collection = unsigned_saturation_mask_type_2<scalar_of<Word>, Bits0, Bits...>;
+    return static_cast<Word>(
+        (value & shift_left_mask<scalar_of<Word>>(amount, mask_collection())) << amount);
 }
 
 // All bits are the same
-template<class Integer, size_t Bits0, size_t ...Bits>
-constexpr Integer shift_left(Integer value, size_t amount, std::true_type) {
-    using lo_bits_mask = mask_loorder<Integer, Bits0, Bits...>;
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word shift_left(Word value, size_t amount, std::true_type) {
+    using lo_bits_mask = mask_loorder<scalar_of<Word>, Bits0, Bits...>;
+    using hi_bits_mask = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
 
     // Reset min(amount,Bits0) of high order bits in each pack.
-    // Then shift all packs to the left
-    return (((lo_bits_mask::value << (Bits0 - amount)) - lo_bits_mask::value) & value) << amount;
+    // Then shift all packs to the left. Bit Bits0 - amount of each pack is
+    // sign bit shifted right and doubled, so a single pack of the whole
+    // integer isn't shifted by its width when amount is 0. Larger amounts
+    // are reset by the caller
+    return static_cast<Word>((value & static_cast<scalar_of<Word>>(
+        static_cast<scalar_of<Word>>(static_cast<scalar_of<Word>>(
+            hi_bits_mask::value >> (amount & (sizeof(scalar_of<Word>) * 8 - 1))) << 1)
+        - lo_bits_mask::value)) << amount);
 }
 
 #if __cpp_fold_expressions
@@ -676,7 +867,7 @@ constexpr Integer shift_right_mask(size_t amount, seq<Masks...>) {
 }
 #else
 template<class Integer>
-constexpr Integer shift_right_mask(size_t amount, seq<>) {
+constexpr Integer shift_right_mask(size_t /*amount*/, seq<>) {
     return 0;
 }
 template<class Integer, class Mask, class ...Masks>
@@ -689,19 +880,21 @@ constexpr Integer shift_right_mask(size_t amount, seq<Mask, Masks...>) {
 }
 #endif
 
-template<class Integer, size_t Bits0, size_t ...Bits>
-constexpr Integer shift_right_unsigned(Integer value, size_t amount, std::false_type) {
-    using mask_collection = unsigned_saturation_mask_type_2<Integer, Bits0, Bits...>;
-    return (~shift_right_mask<Integer>(amount, mask_collection()) & value) >> amount;
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word shift_right_unsigned(Word value, size_t amount, std::false_type) {
+    using mask_collection = unsigned_saturation_mask_type_2<scalar_of<Word>, Bits0, Bits...>;
+    return static_cast<Word>((value & static_cast<scalar_of<Word>>(
+        ~shift_right_mask<scalar_of<Word>>(amount, mask_collection()))) >> amount);
 }
 
-template<class Integer, size_t Bits0, size_t ...Bits>
-constexpr Integer shift_right_unsigned(Integer value, size_t amount, std::true_type) {
-    using lo_bits_mask = mask_loorder<Integer, Bits0, Bits...>;
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word shift_right_unsigned(Word value, size_t amount, std::true_type) {
+    using lo_bits_mask = mask_loorder<scalar_of<Word>, Bits0, Bits...>;
 
     // Reset min(amount,Bits0) of hi order bits in each pack.
     // Then shift all packs to the right
-    return ((~((lo_bits_mask::value << amount) - lo_bits_mask::value)) & value) >> amount;
+    return static_cast<Word>((value & static_cast<scalar_of<Word>>(
+        ~((lo_bits_mask::value << amount) - lo_bits_mask::value))) >> amount);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -732,6 +925,25 @@ template<> struct find_appropriate_int<8> { using type = uint8_t; };
 template<> struct find_appropriate_int<16> { using type = uint16_t; };
 template<> struct find_appropriate_int<32> { using type = uint32_t; };
 template<> struct find_appropriate_int<64> { using type = uint64_t; };
+#ifdef __SIZEOF_INT128__
+template<> struct find_appropriate_int<128> { using type = unsigned __int128; };
+#endif
+
+// Check that each pack is entirely inside of one lane of the word
+template<class Offsets, class Ends, size_t LaneBits> struct packs_fit_lanes_impl;
+template<size_t ...Offsets, size_t ...Ends, size_t LaneBits>
+struct packs_fit_lanes_impl<integer_seq<Offsets...>, integer_seq<Ends...>, LaneBits> {
+    static const bool value = std::is_same<
+        integer_seq<(Offsets / LaneBits)...>,
+        integer_seq<((Ends - 1) / LaneBits)...>
+    >::value;
+};
+template<class Word, size_t ...Bits>
+using packs_fit_lanes = packs_fit_lanes_impl<
+    mask_offsets_vector<Bits...>,
+    make_sum_vector<Bits...>,
+    word_traits<Word>::lane_bits
+>;
 
 // Make packed_int from vector of bits
 template<class Integer, class BitsVector> struct packed_int_from_seq_impl;
@@ -753,279 +965,1795 @@ struct sliced_int_impl {
 template<size_t First, size_t Last, class Integer, size_t Bits0, size_t ...Bits>
 using sliced_int = typename sliced_int_impl<First, Last, Integer, Bits0, Bits...>::type;
 
-} // namespace detail
-
-template<class Integer, size_t Bits0, size_t ...Bits>
-class packed_int {
-public:
-    static_assert(std::is_integral<Integer>::value && std::is_unsigned<Integer>::value,
-        "Integer must be unsigned integer");
-    static_assert(sizeof(Integer) * 8 >= detail::sum<Bits0, Bits...>::value,
-        "Integer won't fit given number of bits");
-
-    using value_type = Integer;
+///////////////////////////////////////////////////////////////////////////////
+// Operations on words. Public functions are thin wrappers around them,
+// SIMD backends reuse them for registers holding several packed values
 
-    constexpr explicit packed_int(value_type value) noexcept : m_value(value) {}
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word add_wrap(Word a, Word b) {
+    using mask2 = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
+    using mask1 = mask_without_hiorder<scalar_of<Word>, Bits0, Bits...>;
 
-    template<size_t BitCount = sizeof...(Bits), typename std::enable_if<BitCount != 0, int>::type = 0>
-    constexpr packed_int(value_type value0,
-        typename std::integral_constant<value_type, Bits>::value_type ...values) noexcept
-        : m_value(detail::make_truncate<value_type, Bits0, Bits...>(value0, values...))
-    {}
+    return static_cast<Word>(((a & mask1::value) + (b & mask1::value)) ^
+        ((a ^ b) & mask2::value));
+}
 
-    constexpr value_type value() const { return m_value; }
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word add_unsigned_saturate(Word a, Word b) {
+    using mask2 = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
 
-    constexpr bool operator==(packed_int other) const { return m_value == other.m_value; }
-    constexpr bool operator!=(packed_int other) const { return m_value != other.m_value; }
+    return apply_unsigned_saturation<Bits0, Bits...>(
+        // potentially overflown result
+        detail::add_wrap<Bits0, Bits...>(a, b),
+        // carry vector
+        static_cast<Word>(carry_add_vector(a, b) & mask2::value)
+    );
+}
 
-    constexpr packed_int operator|(packed_int other) const { return packed_int(m_value | other.m_value); }
-    constexpr packed_int operator&(packed_int other) const { return packed_int(m_value & other.m_value); }
-    constexpr packed_int operator^(packed_int other) const { return packed_int(m_value ^ other.m_value); }
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word add_signed_saturate(Word a, Word b) {
+    return detail::add_signed_saturate<Bits0, Bits...>(
+        a, b, detail::add_wrap<Bits0, Bits...>(a, b));
+}
 
-private:
-    value_type m_value;
-};
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word sub_wrap(Word a, Word b) {
+    using mask3 = mask_loorder<scalar_of<Word>, Bits0, Bits...>;
+    using mask2 = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
+    using mask1 = mask_without_hiorder<scalar_of<Word>, Bits0, Bits...>;
 
-template<size_t Bits0, size_t ...Bits>
-using make_packed_int = packed_int<
-    typename detail::find_appropriate_int<
-        (detail::clp2<detail::sum<Bits0, Bits...>::value - 1>::value + 7) & ~7
-    >::type,
-    Bits0, Bits...
->;
+    return static_cast<Word>(
+        ((a & mask1::value) + (~b & mask1::value) + (mask3::value & mask1::value)) ^
+        ((a ^ ~b) & mask2::value) ^ (mask2::value & mask3::value));
+}
 
-///////////////////////////////////////////////////////////////////////////////
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word sub_unsigned_saturate(Word a, Word b) {
+    using mask3 = mask_loorder<scalar_of<Word>, Bits0, Bits...>;
+    using mask2 = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
 
-template<size_t Index, size_t Bits0, size_t ...Bits, class Integer>
-constexpr Integer get(packed_int<Integer, Bits0, Bits...> packed_int)
-{
-    static_assert(Index <= sizeof...(Bits), "Incorrect index");
-    using mask_and_offset = detail::take_offset_and_mask<Index, Bits0, Bits...>;
+    // a + ~b with saturation (using carry subtraction vector),
+    // then add mask with low order bits with overflow
+    return detail::add_wrap<Bits0, Bits...>(
+        apply_unsigned_saturation<Bits0, Bits...>(
+            // potentially overflown result
+            detail::add_wrap<Bits0, Bits...>(a, static_cast<Word>(~b)),
+            // overflow vector
+            static_cast<Word>(carry_sub_vector(a, b) & mask2::value)
+        ),
+        static_cast<Word>(mask3::value)
+    );
+}
 
-    return (packed_int.value() >> detail::take_1st<mask_and_offset>::value)
-        & detail::all_ones<Integer, detail::take_2nd<mask_and_offset>::value>::value;
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word sub_signed_saturate(Word a, Word b) {
+    return detail::sub_signed_saturate<Bits0, Bits...>(
+        a, b, detail::sub_wrap<Bits0, Bits...>(a, b));
 }
 
-template<size_t Index, size_t Bits0, size_t ...Bits, class Integer>
-constexpr typename std::make_signed<Integer>::type
-    get_signed(packed_int<Integer, Bits0, Bits...> packed_int)
-{
-    static_assert(Index <= sizeof...(Bits), "Incorrect index");
-    // <offset, mask>
-    using mask_and_offset = detail::take_offset_and_mask<Index, Bits0, Bits...>;
-    using hi_order_bit_no = detail::size_t_<
-        detail::take_2nd<mask_and_offset>::value + detail::take_1st<mask_and_offset>::value>;
+// Overflow vectors of wrapped sum / difference: high order bit of each pack
+// is set if the pack overflowed. Unlike carry_add_vector of the whole
+// integer they are computed from the wrapped result, so carry out of one
+// pack doesn't leak into the next one
+template<size_t ...Bits, class Word>
+constexpr Word overflow_add_unsigned(Word a, Word b, Word sum) {
+    using hiorder = mask_hiorder<scalar_of<Word>, Bits...>;
+    return static_cast<Word>(((a & b) | ((a | b) & ~sum)) & hiorder::value);
+}
 
-    return static_cast<typename std::make_signed<Integer>::type>(
-        packed_int.value() << (sizeof(Integer) * 8 - hi_order_bit_no::value)) >>
-        (sizeof(Integer) * 8 - detail::take_2nd<mask_and_offset>::value);
+template<size_t ...Bits, class Word>
+constexpr Word overflow_add_signed(Word a, Word b, Word sum) {
+    using hiorder = mask_hiorder<scalar_of<Word>, Bits...>;
+    return static_cast<Word>(~(a ^ b) & (sum ^ b) & hiorder::value);
 }
 
-///////////////////////////////////////////////////////////////////////////////
+template<size_t ...Bits, class Word>
+constexpr Word overflow_sub_unsigned(Word a, Word b, Word diff) {
+    using hiorder = mask_hiorder<scalar_of<Word>, Bits...>;
+    return static_cast<Word>(((~a & b) | (~(a ^ b) & diff)) & hiorder::value);
+}
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> add_wrap(
-    packed_int<Integer, Bits0, Bits...> a,
-    packed_int<Integer, Bits0, Bits...> b) noexcept
-{
-    using mask2 = detail::mask_hiorder<Integer, Bits0, Bits...>;
-    using mask1 = std::integral_constant<Integer, (~mask2::value)
-        & detail::all_ones<Integer, detail::sum<Bits0, Bits...>::value>::value>;
+template<size_t ...Bits, class Word>
+constexpr Word overflow_sub_signed(Word a, Word b, Word diff) {
+    using hiorder = mask_hiorder<scalar_of<Word>, Bits...>;
+    return static_cast<Word>(overflow_signed_sub_vector(a, b, diff) & hiorder::value);
+}
 
-    return packed_int<Integer, Bits0, Bits...>(
-        ((a.value() & mask1::value) + (b.value() & mask1::value)) ^
-        ((a.value() ^ b.value()) & mask2::value));
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word min_unsigned(Word a, Word b) {
+    using hi_order_bits_mask = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
+    return interleave(a, b,
+        static_cast<Word>(
+            make_unsigned_saturation_mask<Bits0, Bits...>(
+                carry_sub_vector(a, b) & hi_order_bits_mask::value)
+        )
+    );
 }
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> add_unsigned_saturate(
-    packed_int<Integer, Bits0, Bits...> a,
-    packed_int<Integer, Bits0, Bits...> b) noexcept
-{
-    using mask2 = detail::mask_hiorder<Integer, Bits0, Bits...>;
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word max_unsigned(Word a, Word b) {
+    using hi_order_bits_mask = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
+    return interleave(a, b,
+        static_cast<Word>(
+            make_unsigned_saturation_mask<Bits0, Bits...>(
+                carry_sub_vector(b, a) & hi_order_bits_mask::value)
+        )
+    );
+}
 
-    return packed_int<Integer, Bits0, Bits...>(
-        detail::add_unsigned_saturate<Bits0, Bits...>(
-            // potentially overflown result
-            add_wrap(a, b).value(),
-            // carry vector
-            static_cast<Integer>(detail::carry_add_vector(a.value(), b.value()) & mask2::value)
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word min_signed(Word a, Word b) {
+    using hi_order_bits_mask = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
+    return interleave(a, b,
+        static_cast<Word>(
+            make_unsigned_saturation_mask<Bits0, Bits...>(
+                carry_sub_vector(
+                    a ^ hi_order_bits_mask::value,
+                    b ^ hi_order_bits_mask::value
+                ) & hi_order_bits_mask::value)
         )
     );
 }
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> add_signed_saturate(
-    packed_int<Integer, Bits0, Bits...> a,
-    packed_int<Integer, Bits0, Bits...> b) noexcept
-{
-    return packed_int<Integer, Bits0, Bits...>(
-        detail::add_signed_saturate<Bits0, Bits...>(
-            a.value(), b.value(), add_wrap(a, b).value())
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word max_signed(Word a, Word b) {
+    using hi_order_bits_mask = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
+    return interleave(a, b,
+        static_cast<Word>(
+            make_unsigned_saturation_mask<Bits0, Bits...>(
+                carry_sub_vector(
+                    b ^ hi_order_bits_mask::value,
+                    a ^ hi_order_bits_mask::value
+                ) & hi_order_bits_mask::value)
+        )
     );
 }
 
-///////////////////////////////////////////////////////////////////////////////
+// Average of each pack rounded up, (a + b + 1) / 2 without overflow.
+// a | b == (a & b) + (a ^ b), so the average is (a | b) - (a ^ b) / 2.
+// Low order bit of each pack is cleared before shift, so it doesn't move
+// to the pack below, and (a ^ b) / 2 never borrows from the pack above
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word avg_unsigned(Word a, Word b) {
+    using loorder = mask_loorder<scalar_of<Word>, Bits0, Bits...>;
+    return static_cast<Word>((a | b) - (((a ^ b) & static_cast<scalar_of<Word>>(~loorder::value)) >> 1));
+}
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> sub_wrap(
-    packed_int<Integer, Bits0, Bits...> a,
-    packed_int<Integer, Bits0, Bits...> b) noexcept
-{
-    using mask3 = detail::mask_loorder<Integer, Bits0, Bits...>;
-    using mask2 = detail::mask_hiorder<Integer, Bits0, Bits...>;
-    using mask1 = std::integral_constant<Integer, (~mask2::value)
-        & detail::all_ones<Integer, detail::sum<Bits0, Bits...>::value>::value>;
+// Inverted sign bit maps signed packs to unsigned ones biased by 2^(N-1),
+// average of biased packs is biased average
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word avg_signed(Word a, Word b) {
+    using hiorder = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
+    return static_cast<Word>(detail::avg_unsigned<Bits0, Bits...>(
+        static_cast<Word>(a ^ hiorder::value), static_cast<Word>(b ^ hiorder::value)) ^ hiorder::value);
+}
 
-    return packed_int<Integer, Bits0, Bits...>(
-        ((a.value() & mask1::value) + (~b.value() & mask1::value) + (mask3::value & mask1::value)) ^
-        ((a.value() ^ ~b.value()) & mask2::value) ^ (mask2::value & mask3::value)
-    );
+// Negate packs selected by mask (all ones or zero in each pack): ~a + 1
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word negate_masked(Word value, Word mask) {
+    using loorder = mask_loorder<scalar_of<Word>, Bits0, Bits...>;
+    return detail::add_wrap<Bits0, Bits...>(
+        static_cast<Word>(value ^ mask), static_cast<Word>(mask & loorder::value));
 }
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> sub_unsigned_saturate(
-    packed_int<Integer, Bits0, Bits...> a,
-    packed_int<Integer, Bits0, Bits...> b) noexcept
-{
-    using packed = packed_int<Integer, Bits0, Bits...>;
-    using mask3 = detail::mask_loorder<Integer, Bits0, Bits...>;
-    using mask2 = detail::mask_hiorder<Integer, Bits0, Bits...>;
+// Wrapped difference is negated in packs which borrowed
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word absdiff_unsigned(Word a, Word b, Word diff) {
+    return detail::negate_masked<Bits0, Bits...>(diff,
+        make_unsigned_saturation_mask<Bits0, Bits...>(
+            detail::overflow_sub_unsigned<Bits0, Bits...>(a, b, diff)));
+}
 
-    // a + ~b with saturation (using carry subtraction vector),
-    // then add mask with low order bits with overflow
-    return add_wrap(
-        packed(
-            detail::add_unsigned_saturate<Bits0, Bits...>(
-                // potentially overflown result
-                add_wrap(a, packed(~b.value())).value(),
-                // overflow vector
-                static_cast<Integer>(detail::carry_sub_vector(a.value(), b.value()) & mask2::value)
-            )
-        ),
-        packed(mask3::value)
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word absdiff_unsigned(Word a, Word b) {
+    return detail::absdiff_unsigned<Bits0, Bits...>(a, b, detail::sub_wrap<Bits0, Bits...>(a, b));
+}
+
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word abs_signed(Word value) {
+    using hiorder = mask_hiorder<scalar_of<Word>, Bits0, Bits...>;
+    return detail::negate_masked<Bits0, Bits...>(value,
+        make_unsigned_saturation_mask<Bits0, Bits...>(static_cast<Word>(value & hiorder::value)));
+}
+
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word neg_signed_saturate(Word value) {
+    return detail::sub_signed_saturate<Bits0, Bits...>(static_cast<Word>(scalar_of<Word>(0)), value);
+}
+
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word shift_left(Word value, size_t shift_amount) {
+    return static_cast<Word>(
+        detail::shift_left<Bits0, Bits...>(value, shift_amount,
+            all_same<integer_seq<Bits0, Bits...>>())
+        // If shift amount >= max(Bits0, Bits...), then (sign_bit(...) - 1) == 0
+        & static_cast<scalar_of<Word>>(static_cast<scalar_of<Word>>(
+            sign_bit(find_max<Bits0, Bits...>::value - shift_amount - 1)) - 1)
     );
 }
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> sub_signed_saturate(
-    packed_int<Integer, Bits0, Bits...> a,
-    packed_int<Integer, Bits0, Bits...> b) noexcept
-{
-    return packed_int<Integer, Bits0, Bits...>(
-        detail::sub_signed_saturate<Bits0, Bits...>(
-            a.value(), b.value(), sub_wrap(a, b).value())
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word shift_right_unsigned(Word value, size_t shift_amount) {
+    return static_cast<Word>(
+        detail::shift_right_unsigned<Bits0, Bits...>(value, shift_amount,
+            all_same<integer_seq<Bits0, Bits...>>())
+        & static_cast<scalar_of<Word>>(static_cast<scalar_of<Word>>(
+            sign_bit(find_max<Bits0, Bits...>::value - shift_amount - 1)) - 1)
     );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
+// Bit counting. Packs are split into fields of length Field, counted from
+// the low order bit of each pack, the last field of a pack may be shorter.
+// Counts of adjacent fields are added into fields twice as long, masks keep
+// both fields inside the same pack, so the sum never crosses pack boundaries.
+// Count of bits of pack fits the pack: N < 2^N
+
+// Bits of pack of length Bits at positions Pos, ..., Bits - 1, where
+// Pos is in even field and Pos + Shift is inside the pack
+template<class T>
+constexpr T pack_field_mask(size_t bits, size_t field, size_t shift, size_t pos) {
+    return pos >= bits ? T(0) : static_cast<T>(
+        ((pos / field) % 2 == 0 && pos + shift < bits ? static_cast<T>(T(1) << pos) : T(0))
+        | pack_field_mask<T>(bits, field, shift, pos + 1));
+}
 
-template<size_t Start, size_t End, size_t Bits0, size_t ...Bits, class Integer>
-constexpr detail::sliced_int<Start,End,Integer,Bits0,Bits...>
-    slice(packed_int<Integer, Bits0, Bits...> value) noexcept
-{
-    using lo_bits_sum = detail::sum_seq<detail::take_front_n<Start, detail::integer_seq<Bits0, Bits...>>>;
-    using middle_bits_sum = detail::sum_seq<detail::slice<Start, End, detail::integer_seq<Bits0, Bits...>>>;
+template<class T>
+constexpr T or_values(T value0) { return value0; }
 
-    return detail::sliced_int<Start,End,Integer,Bits0,Bits...>(
-        (value.value() >> lo_bits_sum::value) & detail::all_ones<Integer, middle_bits_sum::value>::value);
+template<class T, class ...Values>
+constexpr T or_values(T value0, T value1, Values ...values) {
+    return or_values(static_cast<T>(value0 | value1), values...);
 }
 
-///////////////////////////////////////////////////////////////////////////////
+template<class T, size_t Field, size_t Shift, size_t ...Bits, size_t ...Offsets>
+constexpr T field_mask_impl(integer_seq<Offsets...>) {
+    return or_values(static_cast<T>(pack_field_mask<T>(Bits, Field, Shift, 0) << Offsets)...);
+}
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> min_unsigned(
-    packed_int<Integer, Bits0, Bits...> a,
-    packed_int<Integer, Bits0, Bits...> b) noexcept
-{
-    using hi_order_bits_mask = detail::mask_hiorder<Integer, Bits0, Bits...>;
-    return packed_int<Integer, Bits0, Bits...>(
-        detail::interleave(a.value(), b.value(),
-            static_cast<Integer>(
-                detail::make_unsigned_saturation_mask<Bits0, Bits...>(
-                    detail::carry_sub_vector(a.value(), b.value()) & hi_order_bits_mask::value)
-            )
-        )
-    );
+template<class T, size_t Field, size_t Shift, size_t ...Bits>
+struct field_mask {
+    static constexpr T value = field_mask_impl<T, Field, Shift, Bits...>(mask_offsets_vector<Bits...>());
+};
+template<class T, size_t Field, size_t Shift, size_t ...Bits>
+constexpr T field_mask<T, Field, Shift, Bits...>::value;
+
+template<size_t Field, size_t MaxBits, size_t ...Bits, class Word>
+constexpr Word popcount_fields(Word value, std::false_type /* fields hold whole packs */) {
+    return value;
 }
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> max_unsigned(
-    packed_int<Integer, Bits0, Bits...> a,
-    packed_int<Integer, Bits0, Bits...> b) noexcept
-{
-    using hi_order_bits_mask = detail::mask_hiorder<Integer, Bits0, Bits...>;
-    return packed_int<Integer, Bits0, Bits...>(
-        detail::interleave(a.value(), b.value(),
-            static_cast<Integer>(
-                detail::make_unsigned_saturation_mask<Bits0, Bits...>(
-                    detail::carry_sub_vector(b.value(), a.value()) & hi_order_bits_mask::value)
-            )
-        )
-    );
+template<size_t Field, size_t MaxBits, size_t ...Bits, class Word>
+constexpr Word popcount_fields(Word value, std::true_type) {
+    using low = field_mask<scalar_of<Word>, Field, 0, Bits...>;
+    using high = field_mask<scalar_of<Word>, Field, Field, Bits...>;
+    return popcount_fields<2 * Field, MaxBits, Bits...>(
+        static_cast<Word>((value & low::value) + ((value >> Field) & high::value)),
+        std::integral_constant<bool, (2 * Field < MaxBits)>());
 }
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> min_signed(
-    packed_int<Integer, Bits0, Bits...> a,
-    packed_int<Integer, Bits0, Bits...> b) noexcept
-{
-    using hi_order_bits_mask = detail::mask_hiorder<Integer, Bits0, Bits...>;
-    return packed_int<Integer, Bits0, Bits...>(
-        detail::interleave(a.value(), b.value(),
-            static_cast<Integer>(
-                detail::make_unsigned_saturation_mask<Bits0, Bits...>(
-                    detail::carry_sub_vector(
-                        a.value() ^ hi_order_bits_mask::value,
-                        b.value() ^ hi_order_bits_mask::value
-                    ) & hi_order_bits_mask::value)
-            )
-        )
-    );
+// Number of set bits of each pack
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word popcount_lanes(Word value) {
+    using max_bits = find_max<Bits0, Bits...>;
+    return popcount_fields<1, max_bits::value, Bits0, Bits...>(value,
+        std::integral_constant<bool, (1 < max_bits::value)>());
 }
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> max_signed(
-    packed_int<Integer, Bits0, Bits...> a,
-    packed_int<Integer, Bits0, Bits...> b) noexcept
-{
-    using hi_order_bits_mask = detail::mask_hiorder<Integer, Bits0, Bits...>;
-    return packed_int<Integer, Bits0, Bits...>(
-        detail::interleave(a.value(), b.value(),
-            static_cast<Integer>(
-                detail::make_unsigned_saturation_mask<Bits0, Bits...>(
-                    detail::carry_sub_vector(
-                        b.value() ^ hi_order_bits_mask::value,
-                        a.value() ^ hi_order_bits_mask::value
-                    ) & hi_order_bits_mask::value)
-            )
-        )
-    );
+// Copy the highest set bit of each pack to all bits below it.
+// Field is longer than any pack, so mask keeps bits of the same pack
+template<size_t Shift, size_t MaxBits, size_t ...Bits, class Word>
+constexpr Word smear_right(Word value, std::false_type /* all bits are copied */) {
+    return value;
 }
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> shift_left(
-    packed_int<Integer, Bits0, Bits...> value,
-    size_t shift_amount) noexcept
-{
-    return packed_int<Integer, Bits0, Bits...>(
-        // If shift amount >= max(Bits0, Bits...), then (sign_bit(...) - 1) == 0
-        (detail::sign_bit(detail::find_max<Bits0, Bits...>::value - shift_amount - 1) - 1)
-        & detail::shift_left<Integer, Bits0, Bits...>(value.value(), shift_amount,
-            detail::all_same<detail::integer_seq<Bits0, Bits...>>())
-    );
+template<size_t Shift, size_t MaxBits, size_t ...Bits, class Word>
+constexpr Word smear_right(Word value, std::true_type) {
+    using mask = field_mask<scalar_of<Word>, MaxBits, Shift, Bits...>;
+    return smear_right<2 * Shift, MaxBits, Bits...>(
+        static_cast<Word>(value | ((value >> Shift) & mask::value)),
+        std::integral_constant<bool, (2 * Shift < MaxBits)>());
 }
 
-template<size_t Bits0, size_t ...Bits, class Integer>
-constexpr packed_int<Integer, Bits0, Bits...> shift_right_unsigned(
-    packed_int<Integer, Bits0, Bits...> value,
-    size_t shift_amount) noexcept
-{
-    return packed_int<Integer, Bits0, Bits...>(
-        (detail::sign_bit(detail::find_max<Bits0, Bits...>::value - shift_amount - 1) - 1)
-        & detail::shift_right_unsigned<Integer, Bits0, Bits...>(value.value(), shift_amount,
-            detail::all_same<detail::integer_seq<Bits0, Bits...>>())
-    );
+// Leading zeros of each pack are set, other bits are reset
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word leading_zeros(Word value) {
+    using max_bits = find_max<Bits0, Bits...>;
+    using all_bits = all_ones<scalar_of<Word>, sum<Bits0, Bits...>::value>;
+    return static_cast<Word>(~smear_right<1, max_bits::value, Bits0, Bits...>(value,
+        std::integral_constant<bool, (1 < max_bits::value)>()) & all_bits::value);
+}
+
+// Trailing zeros of each pack are set: ~value & (value - 1)
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word trailing_zeros(Word value) {
+    using loorder = mask_loorder<scalar_of<Word>, Bits0, Bits...>;
+    return static_cast<Word>(~value & detail::sub_wrap<Bits0, Bits...>(value, static_cast<Word>(loorder::value)));
+}
+
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word clz_lanes(Word value) {
+    return detail::popcount_lanes<Bits0, Bits...>(detail::leading_zeros<Bits0, Bits...>(value));
+}
+
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word ctz_lanes(Word value) {
+    return detail::popcount_lanes<Bits0, Bits...>(detail::trailing_zeros<Bits0, Bits...>(value));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversion between layouts with the same number of packs. Packs are
+// truncated to the shorter of two lengths, moved down to offsets of
+// the truncated layout, then moved up to offsets of the target layout.
+// While packs move up, distances grow with the index of the pack, so packs
+// are moved by powers of 2: step S moves packs whose distance has bit S set,
+// from the largest step to 1. Packs never overlap between steps, and N packs
+// take log2 of the longest distance steps instead of N. Moving down is
+// the same sequence reversed
+
+template<class T>
+constexpr T ones_of_length(size_t bits) {
+    return bits >= sizeof(T) * 8 ? static_cast<T>(~T(0)) : static_cast<T>((T(1) << bits) - 1);
+}
+
+// Largest power of 2 not greater than value, 0 for 0
+constexpr size_t floor_pow2(size_t value) {
+    return value < 2 ? value : 2 * floor_pow2(value / 2);
+}
+
+// Packs of given lengths at given offsets
+template<class T, class Lengths, class Offsets> struct packs_mask;
+template<class T, size_t ...Lengths, size_t ...Offsets>
+struct packs_mask<T, integer_seq<Lengths...>, integer_seq<Offsets...>> {
+    static constexpr T value = or_values(T(0), static_cast<T>(ones_of_length<T>(Lengths) << Offsets)...);
+};
+template<class T, size_t ...Lengths, size_t ...Offsets>
+constexpr T packs_mask<T, integer_seq<Lengths...>, integer_seq<Offsets...>>::value;
+
+// Sign bits of packs of given lengths at given offsets
+template<class T, class Lengths, class Offsets> struct sign_bits_mask;
+template<class T, size_t ...Lengths, size_t ...Offsets>
+struct sign_bits_mask<T, integer_seq<Lengths...>, integer_seq<Offsets...>> {
+    static constexpr T value = or_values(T(0), static_cast<T>(T(1) << (Offsets + Lengths - 1))...);
+};
+template<class T, size_t ...Lengths, size_t ...Offsets>
+constexpr T sign_bits_mask<T, integer_seq<Lengths...>, integer_seq<Offsets...>>::value;
+
+// The minimum signed value of each length extended to the length
+// of the pack at given offset, i.e. bits from Lengths - 1 to Bits - 1
+template<class T, class Lengths, class Bits, class Offsets> struct signed_min_mask;
+template<class T, size_t ...Lengths, size_t ...Bits, size_t ...Offsets>
+struct signed_min_mask<T, integer_seq<Lengths...>, integer_seq<Bits...>, integer_seq<Offsets...>> {
+    static constexpr T value = or_values(T(0),
+        static_cast<T>(ones_of_length<T>(Bits - Lengths + 1) << (Offsets + Lengths - 1))...);
+};
+template<class T, size_t ...Lengths, size_t ...Bits, size_t ...Offsets>
+constexpr T signed_min_mask<T, integer_seq<Lengths...>, integer_seq<Bits...>, integer_seq<Offsets...>>::value;
+
+// Pack at Pos if bit Step of its distance is set
+template<class T>
+constexpr T moving_pack(size_t bits, size_t pos, size_t distance, size_t step) {
+    return (distance & step) != 0 ? static_cast<T>(ones_of_length<T>(bits) << pos) : T(0);
+}
+
+// Packs moving up at Step, larger steps are done
+template<class T, size_t Step, class Lengths, class From, class To> struct move_up_mask;
+template<class T, size_t Step, size_t ...Lengths, size_t ...From, size_t ...To>
+struct move_up_mask<T, Step, integer_seq<Lengths...>, integer_seq<From...>, integer_seq<To...>> {
+    static constexpr T value = or_values(T(0),
+        moving_pack<T>(Lengths, From + ((To - From) & ~(2 * Step - 1)), To - From, Step)...);
+};
+template<class T, size_t Step, size_t ...Lengths, size_t ...From, size_t ...To>
+constexpr T move_up_mask<T, Step, integer_seq<Lengths...>, integer_seq<From...>, integer_seq<To...>>::value;
+
+// Packs moving down at Step, smaller steps are done
+template<class T, size_t Step, class Lengths, class From, class To> struct move_down_mask;
+template<class T, size_t Step, size_t ...Lengths, size_t ...From, size_t ...To>
+struct move_down_mask<T, Step, integer_seq<Lengths...>, integer_seq<From...>, integer_seq<To...>> {
+    static constexpr T value = or_values(T(0),
+        moving_pack<T>(Lengths, To + ((From - To) & ~(Step - 1)), From - To, Step)...);
+};
+template<class T, size_t Step, size_t ...Lengths, size_t ...From, size_t ...To>
+constexpr T move_down_mask<T, Step, integer_seq<Lengths...>, integer_seq<From...>, integer_seq<To...>>::value;
+
+template<class From, class To> struct max_distance;
+template<size_t ...From, size_t ...To>
+struct max_distance<integer_seq<From...>, integer_seq<To...>>
+    : size_t_<find_max<(From < To ? To - From : From - To)...>::value> {};
+
+template<size_t Step, class Lengths, class From, class To, class Word>
+constexpr Word move_up(Word value, std::false_type /* all steps are done */) {
+    return value;
+}
+
+template<size_t Step, class Lengths, class From, class To, class Word>
+constexpr Word move_up(Word value, std::true_type) {
+    using mask = move_up_mask<scalar_of<Word>, Step, Lengths, From, To>;
+    return move_up<Step / 2, Lengths, From, To>(mask::value == 0 ? value : static_cast<Word>(
+            (value & static_cast<scalar_of<Word>>(~mask::value)) | ((value & mask::value) << Step)),
+        std::integral_constant<bool, (Step > 1)>());
+}
+
+template<size_t Step, size_t MaxDistance, class Lengths, class From, class To, class Word>
+constexpr Word move_down(Word value, std::false_type /* all steps are done */) {
+    return value;
+}
+
+template<size_t Step, size_t MaxDistance, class Lengths, class From, class To, class Word>
+constexpr Word move_down(Word value, std::true_type) {
+    using mask = move_down_mask<scalar_of<Word>, Step, Lengths, From, To>;
+    return move_down<2 * Step, MaxDistance, Lengths, From, To>(mask::value == 0 ? value : static_cast<Word>(
+            (value & static_cast<scalar_of<Word>>(~mask::value)) | ((value & mask::value) >> Step)),
+        std::integral_constant<bool, (2 * Step <= MaxDistance)>());
+}
+
+// Conversion of packs of layout Bits to layout TargetBits within Word,
+// which must hold both layouts
+template<class Bits, class TargetBits> struct layout_conversion;
+template<size_t ...Bits, size_t ...TargetBits>
+struct layout_conversion<integer_seq<Bits...>, integer_seq<TargetBits...>> {
+    static_assert(sizeof...(Bits) == sizeof...(TargetBits), "Layouts must have the same number of packs");
+
+    using from = mask_offsets_vector<Bits...>;
+    using to = mask_offsets_vector<TargetBits...>;
+    using short_bits = integer_seq<(Bits < TargetBits ? Bits : TargetBits)...>;
+    using short_offsets = mask_offsets_vector<(Bits < TargetBits ? Bits : TargetBits)...>;
+
+    static const bool widening = std::is_same<short_bits, integer_seq<Bits...>>::value;
+    static const bool narrowing = std::is_same<short_bits, integer_seq<TargetBits...>>::value;
+
+    // Truncate or zero extend each pack
+    template<class Word>
+    static constexpr Word repack(Word value) {
+        using truncate = packs_mask<scalar_of<Word>, short_bits, from>;
+        using down = max_distance<from, short_offsets>;
+        using up = max_distance<short_offsets, to>;
+        return move_up<floor_pow2(up::value), short_bits, short_offsets, to>(
+            move_down<1, down::value, short_bits, from, short_offsets>(
+                static_cast<Word>(value & truncate::value), std::integral_constant<bool, (down::value != 0)>()),
+            std::integral_constant<bool, (up::value != 0)>());
+    }
+
+    // Sign bit of each pack is extended to the target length: (value ^ sign) - sign
+    template<class Word>
+    static constexpr Word widen_signed(Word value) {
+        using sign = sign_bits_mask<scalar_of<Word>, integer_seq<Bits...>, to>;
+        return detail::sub_wrap<TargetBits...>(
+            static_cast<Word>(repack(value) ^ sign::value), static_cast<Word>(sign::value));
+    }
+
+    // Range of target packs in the source layout. The minimum signed value
+    // is the sign bit of the target length extended to the source length
+    template<class T> using unsigned_max = packs_mask<T, integer_seq<TargetBits...>, from>;
+    template<class T> using signed_max = packs_mask<T, integer_seq<(TargetBits - 1)...>, from>;
+    template<class T> using signed_min = signed_min_mask<T, integer_seq<TargetBits...>, integer_seq<Bits...>, from>;
+
+    // Packs are clamped to the range of target packs before truncation
+    template<class Word>
+    static constexpr Word narrow_unsigned_saturate(Word value) {
+        using max = unsigned_max<scalar_of<Word>>;
+        return repack(detail::min_unsigned<Bits...>(value, static_cast<Word>(max::value)));
+    }
+
+    template<class Word>
+    static constexpr Word narrow_signed_saturate(Word value) {
+        using max = signed_max<scalar_of<Word>>;
+        using min = signed_min<scalar_of<Word>>;
+        return repack(detail::max_signed<Bits...>(
+            detail::min_signed<Bits...>(value, static_cast<Word>(max::value)),
+            static_cast<Word>(min::value)));
+    }
+};
+
+template<size_t ...Bits, size_t ...TargetBits>
+const bool layout_conversion<integer_seq<Bits...>, integer_seq<TargetBits...>>::widening;
+template<size_t ...Bits, size_t ...TargetBits>
+const bool layout_conversion<integer_seq<Bits...>, integer_seq<TargetBits...>>::narrowing;
+
+// Conversion of packed integers, it is computed in the wider integer
+template<class From, class To> struct packed_conversion;
+template<class Integer, size_t Bits0, size_t ...Bits, class TargetInteger, size_t TargetBits0, size_t ...TargetBits>
+struct packed_conversion<packed_int<Integer, Bits0, Bits...>, packed_int<TargetInteger, TargetBits0, TargetBits...>>
+    : layout_conversion<integer_seq<Bits0, Bits...>, integer_seq<TargetBits0, TargetBits...>>
+{
+    static_assert(std::is_same<scalar_of<Integer>, Integer>::value
+        && std::is_same<scalar_of<TargetInteger>, TargetInteger>::value,
+        "Layouts of SIMD registers can't be converted");
+
+    using word = typename std::conditional<(sizeof(Integer) < sizeof(TargetInteger)), TargetInteger, Integer>::type;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Comparison. Functions return high order bit of each pack set if condition is true,
+// compare_mask spreads it to the whole pack
+
+// High order bit of each pack is set if a < b. Unlike carry_sub_vector,
+// borrow doesn't propagate between packs, so equal packs aren't affected
+template<size_t ...Bits, class Word>
+constexpr Word less_unsigned(Word a, Word b) {
+    using hiorder = mask_hiorder<scalar_of<Word>, Bits...>;
+    return static_cast<Word>(((~a & b) | (~(a ^ b) & ~((a | hiorder::value) - (b & static_cast<scalar_of<Word>>(~hiorder::value)))))
+        & hiorder::value);
+}
+
+// Signed packs are compared as unsigned ones with inverted sign bit
+template<size_t ...Bits, class Word>
+constexpr Word less_signed(Word a, Word b) {
+    using hiorder = mask_hiorder<scalar_of<Word>, Bits...>;
+    return less_unsigned<Bits...>(static_cast<Word>(a ^ hiorder::value), static_cast<Word>(b ^ hiorder::value));
+}
+
+// High order bit of each pack is set if any bit of the pack is set.
+// Adding all ones to low order bits carries to high order bit if they are not zero
+template<size_t ...Bits, class Word>
+constexpr Word not_zero(Word value) {
+    using hiorder = mask_hiorder<scalar_of<Word>, Bits...>;
+    using loorder_bits = mask_without_hiorder<scalar_of<Word>, Bits...>;
+    return static_cast<Word>((((value & loorder_bits::value) + loorder_bits::value) | value) & hiorder::value);
+}
+
+template<size_t ...Bits, class Word>
+constexpr Word compare_mask(Word hiorder_bits) {
+    return make_unsigned_saturation_mask<Bits...>(hiorder_bits);
+}
+
+// Gather bits at given positions, the first position goes to bit 0
+template<class Integer>
+constexpr uint64_t movemask(Integer, seq<>) { return 0; }
+
+template<class Integer, class Position0, class ...Positions>
+constexpr uint64_t movemask(Integer value, seq<Position0, Positions...>) {
+    return (static_cast<uint64_t>((value >> Position0::value) & Integer(1)))
+        | (movemask(value, seq<Positions...>()) << 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Reduction. Packs of the same length are folded as a tree: the upper half
+// of packs is combined with the lower half by SWAR operation on half of layout,
+// until single pack is left. Packs of different length are combined one by one
+
+// Extend sign of the pack stored in low order bits of lane:
+// move pack to the high order bits of the lane, then shift it back
+template<size_t Bits, class Lane>
+constexpr typename make_signed<Lane>::type to_signed(Lane value) {
+    return static_cast<typename make_signed<Lane>::type>(value << (sizeof(Lane) * 8 - Bits)) >>
+        (sizeof(Lane) * 8 - Bits);
+}
+
+template<size_t Offset, size_t Bits, class T, class Integer>
+constexpr T take_pack(Integer value) {
+    return static_cast<T>((value >> Offset) & all_ones<scalar_of<Integer>, Bits>::value);
+}
+
+// Apply operation to words, layout is given as seq of pack lengths
+template<class Op, class Word, class ...Packs>
+constexpr Word apply_layout(Word a, Word b, seq<Packs...>) {
+    return Op::template apply<Packs::value...>(a, b);
+}
+
+// Operations have SWAR form applied to all packs of words,
+// and scalar form combining two unpacked values
+struct reduce_add_op {
+    template<class T>
+    static constexpr T combine(T a, T b) { return static_cast<T>(a + b); }
+};
+
+struct reduce_or_op {
+    template<size_t ...Bits, class Word>
+    static constexpr Word apply(Word a, Word b) { return static_cast<Word>(a | b); }
+
+    template<class T>
+    static constexpr T combine(T a, T b) { return static_cast<T>(a | b); }
+};
+
+struct reduce_min_unsigned_op {
+    template<size_t ...Bits, class Word>
+    static constexpr Word apply(Word a, Word b) { return detail::min_unsigned<Bits...>(a, b); }
+
+    template<class T>
+    static constexpr T combine(T a, T b) { return b < a ? b : a; }
+};
+
+struct reduce_max_unsigned_op {
+    template<size_t ...Bits, class Word>
+    static constexpr Word apply(Word a, Word b) { return detail::max_unsigned<Bits...>(a, b); }
+
+    template<class T>
+    static constexpr T combine(T a, T b) { return a < b ? b : a; }
+};
+
+struct reduce_min_signed_op : reduce_min_unsigned_op {
+    template<size_t ...Bits, class Word>
+    static constexpr Word apply(Word a, Word b) { return detail::min_signed<Bits...>(a, b); }
+};
+
+struct reduce_max_signed_op : reduce_max_unsigned_op {
+    template<size_t ...Bits, class Word>
+    static constexpr Word apply(Word a, Word b) { return detail::max_signed<Bits...>(a, b); }
+};
+
+// Fold Count packs of length Bits: single pack is left as is, the last
+// of odd number of packs is combined with the result of folding the others
+template<class Op, size_t Bits, size_t Count,
+    size_t Kind = (Count == 1) ? 0 : (Count % 2 == 1) ? 1 : 2>
+struct fold_packs {
+    template<class Integer>
+    static constexpr Integer apply(Integer value) { return value; }
+};
+
+template<class Op, size_t Bits, size_t Count>
+struct fold_packs<Op, Bits, Count, 1> {
+    template<class Integer>
+    static constexpr Integer apply(Integer value) {
+        return Op::template apply<Bits>(
+            fold_packs<Op, Bits, Count - 1>::apply(
+                static_cast<Integer>(value & all_ones<Integer, Bits * (Count - 1)>::value)),
+            static_cast<Integer>(value >> (Bits * (Count - 1))));
+    }
+};
+
+template<class Op, size_t Bits, size_t Count>
+struct fold_packs<Op, Bits, Count, 2> {
+    template<class Integer>
+    static constexpr Integer apply(Integer value) {
+        using half_mask = all_ones<Integer, Bits * (Count / 2)>;
+        return fold_packs<Op, Bits, Count / 2>::apply(
+            apply_layout<Op>(
+                static_cast<Integer>(value & half_mask::value),
+                static_cast<Integer>((value >> (Bits * (Count / 2))) & half_mask::value),
+                repeat<size_t_<Bits>, Count / 2>()));
+    }
+};
+
+// Mask of packs of length Bits at offsets 0, 2 * Bits, 4 * Bits, ... below Width
+template<class T, size_t Bits, size_t Width,
+    size_t Kind = (Width <= Bits) ? 0 : (Width <= 2 * Bits) ? 1 : 2>
+struct even_packs_mask {
+    static constexpr T value = all_ones<T, Width>::value;
+};
+template<class T, size_t Bits, size_t Width>
+struct even_packs_mask<T, Bits, Width, 1> {
+    static constexpr T value = all_ones<T, Bits>::value;
+};
+template<class T, size_t Bits, size_t Width>
+struct even_packs_mask<T, Bits, Width, 2> {
+    static constexpr T value = static_cast<T>(all_ones<T, Bits>::value |
+        (even_packs_mask<T, Bits, Width - 2 * Bits>::value << (2 * Bits)));
+};
+template<class T, size_t Bits, size_t Width, size_t Kind>
+constexpr T even_packs_mask<T, Bits, Width, Kind>::value;
+template<class T, size_t Bits, size_t Width>
+constexpr T even_packs_mask<T, Bits, Width, 1>::value;
+template<class T, size_t Bits, size_t Width>
+constexpr T even_packs_mask<T, Bits, Width, 2>::value;
+
+// Sum of packs of length Bits occupying Width bits. Each step adds pairs
+// of adjacent packs into packs twice as long, so sum never overflows
+template<size_t Bits, size_t Width, class Integer>
+constexpr Integer sum_packs(Integer value, std::false_type /* single pack */) {
+    return value;
+}
+
+template<size_t Bits, size_t Width, class Integer>
+constexpr Integer sum_packs(Integer value, std::true_type) {
+    using mask = even_packs_mask<scalar_of<Integer>, Bits, Width>;
+    return sum_packs<2 * Bits, Width>(
+        static_cast<Integer>((value & mask::value) + ((value >> Bits) & mask::value)),
+        std::integral_constant<bool, (2 * Bits < Width)>());
+}
+
+// Packs of different length are unpacked and combined one by one
+template<class Op, class Integer>
+constexpr Integer reduce_values(Integer value0) { return value0; }
+
+template<class Op, class Integer, class ...Values>
+constexpr Integer reduce_values(Integer value0, Integer value1, Values ...values) {
+    return reduce_values<Op>(Op::combine(value0, value1), values...);
+}
+
+// Sign extended pack with inverted sign bit of Integer, unsigned order of keys
+// is the same as signed order of packs
+template<size_t Bits, class Integer>
+constexpr Integer signed_key(Integer value) {
+    return static_cast<Integer>(static_cast<Integer>(
+        static_cast<Integer>(value ^ mask_hiorder<Integer, Bits>::value) - mask_hiorder<Integer, Bits>::value)
+        ^ mask_hiorder<Integer, sizeof(Integer) * 8>::value);
+}
+
+template<class Op, size_t ...Bits, size_t ...Offsets, class Integer>
+constexpr Integer reduce_mixed(Integer value, integer_seq<Offsets...>) {
+    return reduce_values<Op>(take_pack<Offsets, Bits, Integer>(value)...);
+}
+
+// Signed packs are combined as keys, result is converted back
+// to sign extended value
+template<class Op, size_t ...Bits, size_t ...Offsets, class Integer>
+constexpr Integer reduce_mixed_signed(Integer value, integer_seq<Offsets...>) {
+    return static_cast<Integer>(reduce_values<Op>(signed_key<Bits>(take_pack<Offsets, Bits, Integer>(value))...)
+        ^ mask_hiorder<Integer, sizeof(Integer) * 8>::value);
+}
+
+// Dispatch between tree folding of packs of the same length and unpacking
+template<class Op, size_t Bits0, size_t ...Bits, class Integer>
+constexpr Integer reduce(Integer value, std::true_type /* same length */) {
+    return fold_packs<Op, Bits0, sizeof...(Bits) + 1>::apply(value);
+}
+
+template<class Op, size_t Bits0, size_t ...Bits, class Integer>
+constexpr Integer reduce(Integer value, std::false_type) {
+    return reduce_mixed<Op, Bits0, Bits...>(value, mask_offsets_vector<Bits0, Bits...>());
+}
+
+template<class Op, size_t Bits0, size_t ...Bits, class Integer>
+constexpr Integer reduce_signed(Integer value, std::true_type /* same length */) {
+    return fold_packs<Op, Bits0, sizeof...(Bits) + 1>::apply(value);
+}
+
+template<class Op, size_t Bits0, size_t ...Bits, class Integer>
+constexpr Integer reduce_signed(Integer value, std::false_type) {
+    return reduce_mixed_signed<Op, Bits0, Bits...>(value, mask_offsets_vector<Bits0, Bits...>());
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr Integer reduce_add(Integer value, std::true_type /* same length */) {
+    return sum_packs<Bits0, Bits0 * (sizeof...(Bits) + 1)>(value,
+        std::integral_constant<bool, (sizeof...(Bits) > 0)>());
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr Integer reduce_add(Integer value, std::false_type) {
+    return reduce_mixed<reduce_add_op, Bits0, Bits...>(value, mask_offsets_vector<Bits0, Bits...>());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Multiplication. Product of packs of different length can't be computed by
+// single multiplication, so each pack is multiplied separately in uint64_t
+
+// High 64 bits of 128-bit product
+constexpr uint64_t mul_hi64(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+    return (a >> 32) * (b >> 32) + (((a >> 32) * (b & 0xffffffff)) >> 32)
+        + (((a & 0xffffffff) * (b >> 32)) >> 32)
+        + ((((a & 0xffffffff) * (b & 0xffffffff) >> 32)
+            + ((a >> 32) * (b & 0xffffffff) & 0xffffffff)
+            + ((a & 0xffffffff) * (b >> 32) & 0xffffffff)) >> 32);
+#endif
+}
+
+// Sign extend pack of given length to 64 bits
+template<size_t Bits>
+constexpr uint64_t sign_extend(uint64_t value) {
+    return (value ^ (uint64_t(1) << (Bits - 1))) - (uint64_t(1) << (Bits - 1));
+}
+
+constexpr uint64_t abs_value(uint64_t value) {
+    return value >> 63 ? 0 - value : value;
+}
+
+// Product of two packs is `hi:lo`, it's saturated to limit if it's greater than limit
+constexpr uint64_t saturate_product(uint64_t hi, uint64_t lo, uint64_t limit) {
+    return hi != 0 || lo > limit ? limit : lo;
+}
+
+// Operations on single pack, result is truncated by caller.
+// pack_type is the type packs of Integer are multiplied in
+struct mul_wrap_pack {
+    // Low bits of product don't depend on wider bits, so narrow
+    // multiplication is enough. Types narrower than unsigned are promoted to int
+    template<class Integer>
+    using pack_type = typename std::conditional<(sizeof(Integer) < sizeof(unsigned)), unsigned,
+        typename std::conditional<(sizeof(Integer) <= sizeof(uint64_t)), Integer, uint64_t>::type
+    >::type;
+
+    template<size_t Bits, class T>
+    static constexpr T apply(T a, T b) { return a * b; }
+};
+
+struct mul_unsigned_saturate_pack {
+    template<class Integer> using pack_type = uint64_t;
+
+    template<size_t Bits>
+    static constexpr uint64_t apply(uint64_t a, uint64_t b) {
+        return saturate_product(Bits > 32 ? mul_hi64(a, b) : 0, a * b, all_ones<uint64_t, Bits>::value);
+    }
+};
+
+struct mul_signed_saturate_pack {
+    template<class Integer> using pack_type = uint64_t;
+
+    template<size_t Bits>
+    static constexpr uint64_t apply(uint64_t a, uint64_t b) {
+        return apply_sign<Bits>((sign_extend<Bits>(a) ^ sign_extend<Bits>(b)) >> 63,
+            abs_value(sign_extend<Bits>(a)), abs_value(sign_extend<Bits>(b)));
+    }
+
+    // Product is saturated by absolute value, negative product can be
+    // one greater than positive one
+    template<size_t Bits>
+    static constexpr uint64_t apply_sign(uint64_t negative, uint64_t a, uint64_t b) {
+        return (saturate_product(Bits > 32 ? mul_hi64(a, b) : 0, a * b,
+            (uint64_t(1) << (Bits - 1)) - 1 + negative) ^ (0 - negative)) + negative;
+    }
+};
+
+struct mul_hi_pack {
+    template<class Integer> using pack_type = uint64_t;
+
+    template<size_t Bits>
+    static constexpr uint64_t apply(uint64_t a, uint64_t b) {
+        return Bits <= 32 ? (a * b) >> (Bits % 64)
+            : Bits == 64 ? mul_hi64(a, b)
+            : (mul_hi64(a, b) << (64 - Bits)) | ((a * b) >> (Bits % 64));
+    }
+};
+
+template<class Op, size_t ...Bits, size_t ...Offsets, class Integer>
+constexpr Integer multiply(Integer a, Integer b, integer_seq<Offsets...>) {
+    static_assert(find_max<Bits...>::value <= 64, "Packs longer than 64 bits can't be multiplied");
+
+    return make_truncate<Integer, Bits...>(static_cast<Integer>(
+        Op::template apply<Bits>(
+            take_pack<Offsets, Bits, typename Op::template pack_type<Integer>>(a),
+            take_pack<Offsets, Bits, typename Op::template pack_type<Integer>>(b)))...);
+}
+
+template<class Op, size_t ...Bits, class Word>
+constexpr Word multiply(Word a, Word b) {
+    return static_cast<Word>(multiply<Op, Bits...>(
+        static_cast<scalar_of<Word>>(a), static_cast<scalar_of<Word>>(b),
+        mask_offsets_vector<Bits...>()));
+}
+
+// Multiplication by constant. Product is sum of packs shifted by the positions
+// of set bits of multipliers, so it is computed without unpacking
+
+template<class T> constexpr T bit_or() { return T(0); }
+template<class T, class ...Ts>
+constexpr T bit_or(T value0, Ts ...values) { return static_cast<T>(value0 | bit_or<T>(values...)); }
+
+// Mask of packs whose multiplier has bit Bit set
+template<class T, size_t Bit, class Offsets, class Bits, class Multipliers>
+struct multiplier_bit_mask_impl;
+template<class T, size_t Bit, size_t ...Offsets, size_t ...Bits, size_t ...Multipliers>
+struct multiplier_bit_mask_impl<T, Bit, integer_seq<Offsets...>, integer_seq<Bits...>, integer_seq<Multipliers...>> {
+    static constexpr T value = bit_or<T>((Bit < Bits && ((Multipliers >> Bit) & 1))
+        ? static_cast<T>(all_ones<T, Bits>::value << Offsets) : T(0)...);
+};
+template<class T, size_t Bit, size_t ...Offsets, size_t ...Bits, size_t ...Multipliers>
+constexpr T multiplier_bit_mask_impl<T, Bit, integer_seq<Offsets...>, integer_seq<Bits...>,
+    integer_seq<Multipliers...>>::value;
+
+template<class T, size_t Bit, class Multipliers, size_t ...Bits>
+using multiplier_bit_mask = multiplier_bit_mask_impl<T, Bit,
+    mask_offsets_vector<Bits...>, integer_seq<Bits...>, Multipliers>;
+
+// Single multiplier is used for all packs
+template<size_t Packs, size_t ...Multipliers>
+using broadcast_multipliers = typename std::conditional<sizeof...(Multipliers) == 1,
+    repeat<size_t_<find_max<Multipliers...>::value>, Packs>,
+    integer_seq<Multipliers...>
+>::type;
+
+template<size_t Bit, size_t ...Bits, class Multipliers, class Word>
+constexpr Word mul_wrap_constant(Word, Word product, Multipliers, std::false_type) {
+    return product;
+}
+
+template<size_t Bit, size_t ...Bits, class Multipliers, class Word>
+constexpr Word mul_wrap_constant(Word a, Word product, Multipliers multipliers, std::true_type) {
+    using mask = multiplier_bit_mask<scalar_of<Word>, Bit, Multipliers, Bits...>;
+
+    return mul_wrap_constant<Bit + 1, Bits...>(a,
+        mask::value == scalar_of<Word>(0) ? product : detail::add_wrap<Bits...>(
+            product, static_cast<Word>(detail::shift_left<Bits...>(a, Bit) & mask::value)),
+        multipliers, std::integral_constant<bool, (Bit + 1 < find_max<Bits...>::value)>());
+}
+
+template<class Multipliers, size_t ...Bits, class Word>
+constexpr Word mul_wrap_constant(Word a) {
+    return mul_wrap_constant<0, Bits...>(a, static_cast<Word>(scalar_of<Word>(0)), Multipliers(), std::true_type());
+}
+
+// Largest value of each pack which doesn't overflow after multiplication
+template<class T, class Offsets, class Bits, class Multipliers> struct mul_threshold_impl;
+template<class T, size_t ...Offsets, size_t ...Bits, size_t ...Multipliers>
+struct mul_threshold_impl<T, integer_seq<Offsets...>, integer_seq<Bits...>, integer_seq<Multipliers...>> {
+    static constexpr T value = bit_or<T>(static_cast<T>(static_cast<T>(Multipliers == 0
+        ? all_ones<uint64_t, Bits>::value
+        : all_ones<uint64_t, Bits>::value / Multipliers) << Offsets)...);
+};
+template<class T, size_t ...Offsets, size_t ...Bits, size_t ...Multipliers>
+constexpr T mul_threshold_impl<T, integer_seq<Offsets...>, integer_seq<Bits...>, integer_seq<Multipliers...>>::value;
+
+template<class T, class Multipliers, size_t ...Bits>
+using mul_threshold = mul_threshold_impl<T, mask_offsets_vector<Bits...>, integer_seq<Bits...>, Multipliers>;
+
+template<class Multipliers, size_t ...Bits, class Word>
+constexpr Word mul_unsigned_saturate_constant(Word a) {
+    using threshold = mul_threshold<scalar_of<Word>, Multipliers, Bits...>;
+    return static_cast<Word>(mul_wrap_constant<Multipliers, Bits...>(a) |
+        make_unsigned_saturation_mask<Bits...>(
+            less_unsigned<Bits...>(static_cast<Word>(threshold::value), a)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Signed shift, rotation and shifts by amounts given for each pack
+
+struct shift_left_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static constexpr Word apply(Word value, size_t amount) { return detail::shift_left<Bits0, Bits...>(value, amount); }
+};
+
+struct shift_right_unsigned_op {
+    template<size_t Bits0, size_t ...Bits, class Word>
+    static constexpr Word apply(Word value, size_t amount) {
+        return detail::shift_right_unsigned<Bits0, Bits...>(value, amount);
+    }
+};
+
+// Bits of the result of unsigned right shift, which were shifted in, are
+// filled with sign bit of the pack. They are the bits which are not set
+// after shifting all ones
+template<size_t ...Bits, class Word>
+constexpr Word fill_sign(Word value, Word shifted, Word shifted_ones) {
+    using hiorder = mask_hiorder<scalar_of<Word>, Bits...>;
+    return static_cast<Word>(shifted |
+        (compare_mask<Bits...>(static_cast<Word>(value & hiorder::value)) & ~shifted_ones));
+}
+
+template<size_t Bits0, size_t ...Bits, class Word>
+constexpr Word shift_right_signed(Word value, size_t amount) {
+    using ones = all_ones<scalar_of<Word>, sum<Bits0, Bits...>::value>;
+    return fill_sign<Bits0, Bits...>(value,
+        detail::shift_right_unsigned<Bits0, Bits...>(value, amount),
+        detail::shift_right_unsigned<Bits0, Bits...>(static_cast<Word>(ones::value), amount));
+}
+
+// Number of bits needed to represent value
+constexpr size_t bit_width(size_t value) {
+    return value == 0 ? 0 : 1 + bit_width(value >> 1);
+}
+
+// Bits of amount of each pack, starting from bit Bit. Mask of amounts
+// with bit count Count selects bit Bit, Count == 0 selects all higher bits.
+// Lengths are clamped to avoid all_ones of zero length for packs not selected
+template<class T, size_t Bit, size_t Count, class Offsets, class Bits> struct amount_bits_mask_impl;
+template<class T, size_t Bit, size_t Count, size_t ...Offsets, size_t ...Bits>
+struct amount_bits_mask_impl<T, Bit, Count, integer_seq<Offsets...>, integer_seq<Bits...>> {
+    static constexpr T value = bit_or<T>((Bit < Bits)
+        ? static_cast<T>(all_ones<T, (Count != 0 ? Count : (Bit < Bits ? Bits - Bit : 1))>::value << (Offsets + Bit))
+        : T(0)...);
+};
+template<class T, size_t Bit, size_t Count, size_t ...Offsets, size_t ...Bits>
+constexpr T amount_bits_mask_impl<T, Bit, Count, integer_seq<Offsets...>, integer_seq<Bits...>>::value;
+
+template<class T, size_t Bit, size_t Count, size_t ...Bits>
+using amount_bits_mask = amount_bits_mask_impl<T, Bit, Count, mask_offsets_vector<Bits...>, integer_seq<Bits...>>;
+
+// Amounts less than 1 << amount_bits are applied bit by bit,
+// so they cover all shifts less than the longest pack
+template<size_t ...Bits>
+using amount_bits = size_t_<bit_width(find_max<Bits...>::value - 1)>;
+
+// Shift packs by 1 << Bit if bit Bit of their amount is set, then by the next bits.
+// Mask of packs to shift is -1 or 0 in each pack, i.e. 0 - bit
+template<class Shift, size_t Bit, size_t ...Bits, class Word>
+constexpr Word shift_variable(Word value, Word, std::false_type /* no bits left */) {
+    return value;
+}
+
+template<class Shift, size_t Bit, size_t ...Bits, class Word>
+constexpr Word shift_variable(Word value, Word amounts, std::true_type) {
+    using bit_mask = amount_bits_mask<scalar_of<Word>, Bit, 1, Bits...>;
+    return shift_variable<Shift, Bit + 1, Bits...>(
+        interleave(Shift::template apply<Bits...>(value, size_t(1) << Bit), value,
+            detail::sub_wrap<Bits...>(static_cast<Word>(scalar_of<Word>(0)),
+                static_cast<Word>((amounts & bit_mask::value) >> Bit))),
+        amounts,
+        std::integral_constant<bool, (Bit + 1 < amount_bits<Bits...>::value)>());
+}
+
+// Packs shifted by amount which isn't covered by shift_variable are zero
+template<class Shift, size_t ...Bits, class Word>
+constexpr Word shift_variable(Word value, Word amounts) {
+    using high_bits = amount_bits_mask<scalar_of<Word>, amount_bits<Bits...>::value, 0, Bits...>;
+    return static_cast<Word>(
+        shift_variable<Shift, 0, Bits...>(value, amounts,
+            std::integral_constant<bool, (0 < amount_bits<Bits...>::value)>())
+        & ~compare_mask<Bits...>(not_zero<Bits...>(static_cast<Word>(amounts & high_bits::value))));
+}
+
+template<size_t ...Bits, class Word>
+constexpr Word shift_right_signed_variable(Word value, Word amounts) {
+    using ones = all_ones<scalar_of<Word>, sum<Bits...>::value>;
+    return fill_sign<Bits...>(value,
+        shift_variable<shift_right_unsigned_op, Bits...>(value, amounts),
+        shift_variable<shift_right_unsigned_op, Bits...>(static_cast<Word>(ones::value), amounts));
+}
+
+// Each pack holds its length minus one
+template<class Integer, size_t ...Bits>
+constexpr Integer lengths_minus_1() {
+    return make_truncate<Integer, Bits...>(static_cast<Integer>(Bits - 1)...);
+}
+
+// Amounts must be less than length of packs. Shift in the opposite direction
+// is length - amount, it's split into shift by 1 and by length - 1 - amount,
+// so it doesn't exceed length - 1
+template<class Shift, class OppositeShift, size_t ...Bits, class Word>
+constexpr Word rotate_variable(Word value, Word amounts) {
+    return static_cast<Word>(shift_variable<Shift, Bits...>(value, amounts)
+        | shift_variable<OppositeShift, Bits...>(
+            OppositeShift::template apply<Bits...>(value, 1),
+            detail::sub_wrap<Bits...>(static_cast<Word>(lengths_minus_1<scalar_of<Word>, Bits...>()), amounts)));
+}
+
+// Rotation by the same amount. If all packs have the same length,
+// packs are shifted by single amount, otherwise amount of each pack is
+// computed modulo its length
+template<class Shift, class OppositeShift, size_t Bits0, size_t ...Bits, class Word>
+constexpr Word rotate(Word value, size_t amount, std::true_type /* same length */) {
+    return static_cast<Word>(Shift::template apply<Bits0, Bits...>(value, amount % Bits0)
+        | OppositeShift::template apply<Bits0, Bits...>(
+            OppositeShift::template apply<Bits0, Bits...>(value, 1), Bits0 - 1 - amount % Bits0));
+}
+
+template<class Shift, class OppositeShift, size_t Bits0, size_t ...Bits, class Word>
+constexpr Word rotate(Word value, size_t amount, std::false_type) {
+    return rotate_variable<Shift, OppositeShift, Bits0, Bits...>(value, static_cast<Word>(
+        make_truncate<scalar_of<Word>, Bits0, Bits...>(
+            static_cast<scalar_of<Word>>(amount % Bits0), static_cast<scalar_of<Word>>(amount % Bits)...)));
+}
+
+} // namespace detail
+
+template<class Integer, size_t Bits0, size_t ...Bits>
+class packed_int {
+public:
+    static_assert(detail::is_unsigned_integer<Integer>::value,
+        "Integer must be unsigned integer or SIMD register");
+    static_assert(sizeof(Integer) * 8 >= detail::sum<Bits0, Bits...>::value,
+        "Integer won't fit given number of bits");
+    static_assert(detail::packs_fit_lanes<Integer, Bits0, Bits...>::value,
+        "Packs can't cross lanes of SIMD register");
+
+    using value_type = Integer;
+    // Type of single pack, it is narrower than value_type for SIMD registers
+    using lane_type = detail::lane_of<Integer>;
+
+    constexpr explicit packed_int(value_type value) noexcept : m_value(value) {}
+
+    template<size_t BitCount = sizeof...(Bits), typename std::enable_if<BitCount != 0, int>::type = 0>
+    constexpr packed_int(lane_type value0,
+        typename detail::type_for_bits<lane_type, Bits>::type ...values) noexcept
+        : m_value(static_cast<value_type>(
+            detail::make_truncate<detail::scalar_of<value_type>, Bits0, Bits...>(value0, values...)))
+    {}
+
+    constexpr value_type value() const { return m_value; }
+
+    constexpr bool operator==(packed_int other) const { return m_value == other.m_value; }
+    constexpr bool operator!=(packed_int other) const { return m_value != other.m_value; }
+
+    constexpr packed_int operator|(packed_int other) const { return packed_int(m_value | other.m_value); }
+    constexpr packed_int operator&(packed_int other) const { return packed_int(m_value & other.m_value); }
+    constexpr packed_int operator^(packed_int other) const { return packed_int(m_value ^ other.m_value); }
+
+private:
+    value_type m_value;
+};
+
+template<size_t Bits0, size_t ...Bits>
+using make_packed_int = packed_int<
+    typename detail::find_appropriate_int<
+        (detail::clp2<detail::sum<Bits0, Bits...>::value - 1>::value + 7) & ~7
+    >::type,
+    Bits0, Bits...
+>;
+
+///////////////////////////////////////////////////////////////////////////////
+
+template<size_t Index, size_t Bits0, size_t ...Bits, class Integer>
+constexpr detail::lane_of<Integer> get(packed_int<Integer, Bits0, Bits...> packed_int)
+{
+    static_assert(Index <= sizeof...(Bits), "Incorrect index");
+    using mask_and_offset = detail::take_offset_and_mask<Index, Bits0, Bits...>;
+    using scalar = detail::scalar_of<Integer>;
+
+    return static_cast<detail::lane_of<Integer>>(
+        (static_cast<scalar>(packed_int.value()) >> detail::take_1st<mask_and_offset>::value)
+        & detail::all_ones<scalar, detail::take_2nd<mask_and_offset>::value>::value);
+}
+
+template<size_t Index, size_t Bits0, size_t ...Bits, class Integer>
+constexpr typename detail::make_signed<detail::lane_of<Integer>>::type
+    get_signed(packed_int<Integer, Bits0, Bits...> packed_int)
+{
+    static_assert(Index <= sizeof...(Bits), "Incorrect index");
+    using pack_bits = detail::take_nth<Index, detail::integer_seq<Bits0, Bits...>>;
+
+    return detail::to_signed<pack_bits::value>(get<Index>(packed_int));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> add_wrap(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::add_wrap<Bits0, Bits...>(a.value(), b.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> add_unsigned_saturate(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::add_unsigned_saturate<Bits0, Bits...>(a.value(), b.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> add_signed_saturate(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::add_signed_saturate<Bits0, Bits...>(a.value(), b.value()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> sub_wrap(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::sub_wrap<Bits0, Bits...>(a.value(), b.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> sub_unsigned_saturate(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::sub_unsigned_saturate<Bits0, Bits...>(a.value(), b.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> sub_signed_saturate(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::sub_signed_saturate<Bits0, Bits...>(a.value(), b.value()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template<size_t Start, size_t End, size_t Bits0, size_t ...Bits, class Integer>
+constexpr detail::sliced_int<Start,End,Integer,Bits0,Bits...>
+    slice(packed_int<Integer, Bits0, Bits...> value) noexcept
+{
+    using lo_bits_sum = detail::sum_seq<detail::slice<0, Start, detail::integer_seq<Bits0, Bits...>>>;
+    using middle_bits_sum = detail::sum_seq<detail::slice<Start, End, detail::integer_seq<Bits0, Bits...>>>;
+
+    using scalar = detail::scalar_of<Integer>;
+
+    return detail::sliced_int<Start,End,Integer,Bits0,Bits...>(static_cast<Integer>(
+        (static_cast<scalar>(value.value()) >> lo_bits_sum::value)
+            & detail::all_ones<scalar, middle_bits_sum::value>::value));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversion to the layout of Target with the same number of packs, e.g.
+// from packed_int<uint32_t,8,8,8,8> to packed_int<uint64_t,16,16,16,16>
+
+// Packs are zero extended, packs of Target must not be shorter
+template<class Target, size_t Bits0, size_t ...Bits, class Integer>
+constexpr Target widen_unsigned(packed_int<Integer, Bits0, Bits...> value) noexcept
+{
+    using conversion = detail::packed_conversion<packed_int<Integer, Bits0, Bits...>, Target>;
+    static_assert(conversion::widening, "Packs of Target must not be shorter");
+    return Target(static_cast<typename Target::value_type>(
+        conversion::repack(static_cast<typename conversion::word>(value.value()))));
+}
+
+// Packs are sign extended
+template<class Target, size_t Bits0, size_t ...Bits, class Integer>
+constexpr Target widen_signed(packed_int<Integer, Bits0, Bits...> value) noexcept
+{
+    using conversion = detail::packed_conversion<packed_int<Integer, Bits0, Bits...>, Target>;
+    static_assert(conversion::widening, "Packs of Target must not be shorter");
+    return Target(static_cast<typename Target::value_type>(
+        conversion::widen_signed(static_cast<typename conversion::word>(value.value()))));
+}
+
+// Packs are saturated to the range of Target packs, which must not be longer
+template<class Target, size_t Bits0, size_t ...Bits, class Integer>
+constexpr Target narrow_unsigned_saturate(packed_int<Integer, Bits0, Bits...> value) noexcept
+{
+    using conversion = detail::packed_conversion<packed_int<Integer, Bits0, Bits...>, Target>;
+    static_assert(conversion::narrowing, "Packs of Target must not be longer");
+    return Target(static_cast<typename Target::value_type>(
+        conversion::narrow_unsigned_saturate(static_cast<typename conversion::word>(value.value()))));
+}
+
+template<class Target, size_t Bits0, size_t ...Bits, class Integer>
+constexpr Target narrow_signed_saturate(packed_int<Integer, Bits0, Bits...> value) noexcept
+{
+    using conversion = detail::packed_conversion<packed_int<Integer, Bits0, Bits...>, Target>;
+    static_assert(conversion::narrowing, "Packs of Target must not be longer");
+    return Target(static_cast<typename Target::value_type>(
+        conversion::narrow_signed_saturate(static_cast<typename conversion::word>(value.value()))));
+}
+
+// Packs of any length: longer packs are zero extended, shorter ones are truncated
+template<class Target, size_t Bits0, size_t ...Bits, class Integer>
+constexpr Target repack(packed_int<Integer, Bits0, Bits...> value) noexcept
+{
+    using conversion = detail::packed_conversion<packed_int<Integer, Bits0, Bits...>, Target>;
+    return Target(static_cast<typename Target::value_type>(
+        conversion::repack(static_cast<typename conversion::word>(value.value()))));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> min_unsigned(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::min_unsigned<Bits0, Bits...>(a.value(), b.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> max_unsigned(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::max_unsigned<Bits0, Bits...>(a.value(), b.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> min_signed(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::min_signed<Bits0, Bits...>(a.value(), b.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> max_signed(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::max_signed<Bits0, Bits...>(a.value(), b.value()));
+}
+
+// Average of each pack rounded up, (a + b + 1) / 2 computed without overflow
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> avg_unsigned(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::avg_unsigned<Bits0, Bits...>(a.value(), b.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> avg_signed(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::avg_signed<Bits0, Bits...>(a.value(), b.value()));
+}
+
+// |a - b| of unsigned packs, it always fits the pack
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> absdiff_unsigned(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::absdiff_unsigned<Bits0, Bits...>(a.value(), b.value()));
+}
+
+// Magnitude of signed packs. Read as unsigned, it is exact for all values:
+// the minimum value -2^(N-1) gives 2^(N-1), which is itself as signed
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> abs_signed(
+    packed_int<Integer, Bits0, Bits...> value) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::abs_signed<Bits0, Bits...>(value.value()));
+}
+
+// Negation of signed packs, the minimum value -2^(N-1) gives 2^(N-1) - 1
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> neg_signed_saturate(
+    packed_int<Integer, Bits0, Bits...> value) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::neg_signed_saturate<Bits0, Bits...>(value.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> shift_left(
+    packed_int<Integer, Bits0, Bits...> value,
+    size_t shift_amount) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::shift_left<Bits0, Bits...>(value.value(), shift_amount));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> shift_right_unsigned(
+    packed_int<Integer, Bits0, Bits...> value,
+    size_t shift_amount) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::shift_right_unsigned<Bits0, Bits...>(value.value(), shift_amount));
+}
+
+// Shifted in bits are copies of sign bit of each pack
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> shift_right_signed(
+    packed_int<Integer, Bits0, Bits...> value,
+    size_t shift_amount) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::shift_right_signed<Bits0, Bits...>(value.value(), shift_amount));
+}
+
+// Rotation within each pack, amount is taken modulo pack length
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> rotate_left(
+    packed_int<Integer, Bits0, Bits...> value,
+    size_t amount) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::rotate<detail::shift_left_op, detail::shift_right_unsigned_op, Bits0, Bits...>(
+            value.value(), amount, detail::all_same<detail::integer_seq<Bits0, Bits...>>()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> rotate_right(
+    packed_int<Integer, Bits0, Bits...> value,
+    size_t amount) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::rotate<detail::shift_right_unsigned_op, detail::shift_left_op, Bits0, Bits...>(
+            value.value(), amount, detail::all_same<detail::integer_seq<Bits0, Bits...>>()));
+}
+
+// Shifts by amount given for each pack: pack N of value is shifted
+// by pack N of amounts. Packs shifted by their length or more are zero
+// (or copies of sign bit for signed shift)
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> shift_left(
+    packed_int<Integer, Bits0, Bits...> value,
+    packed_int<Integer, Bits0, Bits...> amounts) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::shift_variable<detail::shift_left_op, Bits0, Bits...>(value.value(), amounts.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> shift_right_unsigned(
+    packed_int<Integer, Bits0, Bits...> value,
+    packed_int<Integer, Bits0, Bits...> amounts) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::shift_variable<detail::shift_right_unsigned_op, Bits0, Bits...>(value.value(), amounts.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> shift_right_signed(
+    packed_int<Integer, Bits0, Bits...> value,
+    packed_int<Integer, Bits0, Bits...> amounts) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::shift_right_signed_variable<Bits0, Bits...>(value.value(), amounts.value()));
+}
+
+// Amount of each pack must be less than its length
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> rotate_left(
+    packed_int<Integer, Bits0, Bits...> value,
+    packed_int<Integer, Bits0, Bits...> amounts) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::rotate_variable<detail::shift_left_op, detail::shift_right_unsigned_op, Bits0, Bits...>(
+            value.value(), amounts.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> rotate_right(
+    packed_int<Integer, Bits0, Bits...> value,
+    packed_int<Integer, Bits0, Bits...> amounts) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::rotate_variable<detail::shift_right_unsigned_op, detail::shift_left_op, Bits0, Bits...>(
+            value.value(), amounts.value()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> mul_wrap(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::multiply<detail::mul_wrap_pack, Bits0, Bits...>(a.value(), b.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> mul_unsigned_saturate(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::multiply<detail::mul_unsigned_saturate_pack, Bits0, Bits...>(a.value(), b.value()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> mul_signed_saturate(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::multiply<detail::mul_signed_saturate_pack, Bits0, Bits...>(a.value(), b.value()));
+}
+
+// High half of unsigned product of each pack, product of N-bit packs is shifted right by N
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> mul_hi(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::multiply<detail::mul_hi_pack, Bits0, Bits...>(a.value(), b.value()));
+}
+
+// Multiplication by compile time constants, one per pack or single one for all packs:
+// mul_wrap<3, 5, 7>(value) or mul_wrap<3>(value)
+template<size_t ...Multipliers, size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> mul_wrap(
+    packed_int<Integer, Bits0, Bits...> a) noexcept
+{
+    static_assert(sizeof...(Multipliers) == 1 || sizeof...(Multipliers) == sizeof...(Bits) + 1,
+        "Number of multipliers must be 1 or equal to number of packs");
+
+    return packed_int<Integer, Bits0, Bits...>(detail::mul_wrap_constant<
+        detail::broadcast_multipliers<sizeof...(Bits) + 1, Multipliers...>, Bits0, Bits...>(a.value()));
+}
+
+template<size_t ...Multipliers, size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> mul_unsigned_saturate(
+    packed_int<Integer, Bits0, Bits...> a) noexcept
+{
+    static_assert(sizeof...(Multipliers) == 1 || sizeof...(Multipliers) == sizeof...(Bits) + 1,
+        "Number of multipliers must be 1 or equal to number of packs");
+
+    return packed_int<Integer, Bits0, Bits...>(detail::mul_unsigned_saturate_constant<
+        detail::broadcast_multipliers<sizeof...(Bits) + 1, Multipliers...>, Bits0, Bits...>(a.value()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Comparison. Each pack of result is either all ones (condition is true) or zero
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> cmp_eq(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    using hiorder = detail::mask_hiorder<detail::scalar_of<Integer>, Bits0, Bits...>;
+    return packed_int<Integer, Bits0, Bits...>(detail::compare_mask<Bits0, Bits...>(static_cast<Integer>(
+        detail::not_zero<Bits0, Bits...>(static_cast<Integer>(a.value() ^ b.value())) ^ hiorder::value)));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> cmp_ne(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(detail::compare_mask<Bits0, Bits...>(
+        detail::not_zero<Bits0, Bits...>(static_cast<Integer>(a.value() ^ b.value()))));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> cmp_lt_unsigned(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(detail::compare_mask<Bits0, Bits...>(
+        detail::less_unsigned<Bits0, Bits...>(a.value(), b.value())));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> cmp_gt_unsigned(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return cmp_lt_unsigned(b, a);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> cmp_le_unsigned(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    using hiorder = detail::mask_hiorder<detail::scalar_of<Integer>, Bits0, Bits...>;
+    return packed_int<Integer, Bits0, Bits...>(detail::compare_mask<Bits0, Bits...>(static_cast<Integer>(
+        detail::less_unsigned<Bits0, Bits...>(b.value(), a.value()) ^ hiorder::value)));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> cmp_ge_unsigned(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return cmp_le_unsigned(b, a);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> cmp_lt_signed(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(detail::compare_mask<Bits0, Bits...>(
+        detail::less_signed<Bits0, Bits...>(a.value(), b.value())));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> cmp_gt_signed(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return cmp_lt_signed(b, a);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> cmp_le_signed(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    using hiorder = detail::mask_hiorder<detail::scalar_of<Integer>, Bits0, Bits...>;
+    return packed_int<Integer, Bits0, Bits...>(detail::compare_mask<Bits0, Bits...>(static_cast<Integer>(
+        detail::less_signed<Bits0, Bits...>(b.value(), a.value()) ^ hiorder::value)));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> cmp_ge_signed(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return cmp_le_signed(b, a);
+}
+
+// Packs of a where mask is set, and packs of b elsewhere
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> select(
+    packed_int<Integer, Bits0, Bits...> mask,
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b) noexcept
+{
+    return packed_int<Integer, Bits0, Bits...>(detail::interleave(a.value(), b.value(), mask.value()));
+}
+
+// True if any pack is not zero
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr bool any(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    using scalar = detail::scalar_of<Integer>;
+    return static_cast<scalar>(value.value()) != scalar(0);
+}
+
+// True if all packs are not zero
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr bool all(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    using scalar = detail::scalar_of<Integer>;
+    using hiorder = detail::mask_hiorder<scalar, Bits0, Bits...>;
+    return static_cast<scalar>(detail::not_zero<Bits0, Bits...>(value.value())) == hiorder::value;
+}
+
+// High order bit of each pack, bit N of result is taken from pack N
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr uint64_t movemask(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    static_assert(sizeof...(Bits) < 64, "Number of packs must not exceed 64");
+    return detail::movemask(static_cast<detail::scalar_of<Integer>>(value.value()),
+        detail::vector_sub<detail::make_sum_vector<Bits0, Bits...>, 1>());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Lazy overflow detection. Functions return wrapped result, like add_wrap / sub_wrap,
+// and record packs which overflowed in overflow_flags. Flags are sticky, so
+// the whole batch of operations is checked once instead of saturating each result
+
+template<class PackedInt> class overflow_flags;
+
+template<class Integer, size_t Bits0, size_t ...Bits>
+class overflow_flags<packed_int<Integer, Bits0, Bits...>> {
+public:
+    using packed_type = packed_int<Integer, Bits0, Bits...>;
+
+    constexpr overflow_flags() noexcept
+        : m_bits(static_cast<Integer>(detail::scalar_of<Integer>(0))) {}
+
+    // High order bit of each pack is set if the pack overflowed
+    constexpr packed_type bits() const noexcept { return m_bits; }
+
+    // Packs which overflowed have all bits set, other packs are zero
+    constexpr packed_type mask() const noexcept {
+        return packed_type(detail::compare_mask<Bits0, Bits...>(m_bits.value()));
+    }
+
+    constexpr bool any() const noexcept { return pint::any(m_bits); }
+
+    // Bit N of result is set if pack N overflowed
+    constexpr uint64_t movemask() const noexcept { return pint::movemask(m_bits); }
+
+    // hiorder_bits has high order bit of each pack which overflowed
+    void record(packed_type hiorder_bits) noexcept { m_bits = m_bits | hiorder_bits; }
+    void merge(overflow_flags other) noexcept { record(other.m_bits); }
+    void clear() noexcept { *this = overflow_flags(); }
+
+private:
+    packed_type m_bits;
+};
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+packed_int<Integer, Bits0, Bits...> add_overflow_unsigned(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b,
+    overflow_flags<packed_int<Integer, Bits0, Bits...>> &overflow) noexcept
+{
+    const Integer sum = detail::add_wrap<Bits0, Bits...>(a.value(), b.value());
+    overflow.record(packed_int<Integer, Bits0, Bits...>(
+        detail::overflow_add_unsigned<Bits0, Bits...>(a.value(), b.value(), sum)));
+    return packed_int<Integer, Bits0, Bits...>(sum);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+packed_int<Integer, Bits0, Bits...> add_overflow_signed(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b,
+    overflow_flags<packed_int<Integer, Bits0, Bits...>> &overflow) noexcept
+{
+    const Integer sum = detail::add_wrap<Bits0, Bits...>(a.value(), b.value());
+    overflow.record(packed_int<Integer, Bits0, Bits...>(
+        detail::overflow_add_signed<Bits0, Bits...>(a.value(), b.value(), sum)));
+    return packed_int<Integer, Bits0, Bits...>(sum);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+packed_int<Integer, Bits0, Bits...> sub_overflow_unsigned(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b,
+    overflow_flags<packed_int<Integer, Bits0, Bits...>> &overflow) noexcept
+{
+    const Integer diff = detail::sub_wrap<Bits0, Bits...>(a.value(), b.value());
+    overflow.record(packed_int<Integer, Bits0, Bits...>(
+        detail::overflow_sub_unsigned<Bits0, Bits...>(a.value(), b.value(), diff)));
+    return packed_int<Integer, Bits0, Bits...>(diff);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+packed_int<Integer, Bits0, Bits...> sub_overflow_signed(
+    packed_int<Integer, Bits0, Bits...> a,
+    packed_int<Integer, Bits0, Bits...> b,
+    overflow_flags<packed_int<Integer, Bits0, Bits...>> &overflow) noexcept
+{
+    const Integer diff = detail::sub_wrap<Bits0, Bits...>(a.value(), b.value());
+    overflow.record(packed_int<Integer, Bits0, Bits...>(
+        detail::overflow_sub_signed<Bits0, Bits...>(a.value(), b.value(), diff)));
+    return packed_int<Integer, Bits0, Bits...>(diff);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Reductions combine all packs into single value
+
+// Sum of packs wrapped to the length of the longest pack
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr detail::lane_of<Integer> reduce_add(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    using scalar = detail::scalar_of<Integer>;
+    return static_cast<detail::lane_of<Integer>>(
+        detail::reduce_add<Bits0, Bits...>(static_cast<scalar>(value.value()),
+            detail::all_same<detail::integer_seq<Bits0, Bits...>>())
+        & detail::all_ones<scalar, detail::find_max<Bits0, Bits...>::value>::value);
+}
+
+// Exact sum of packs. It is less than 2 ^ (sum of lengths of packs),
+// so it always fits the scalar type of the packed_int
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr detail::scalar_of<Integer> reduce_add_wide(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    return detail::reduce_add<Bits0, Bits...>(static_cast<detail::scalar_of<Integer>>(value.value()),
+        detail::all_same<detail::integer_seq<Bits0, Bits...>>());
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr detail::lane_of<Integer> reduce_or(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    return static_cast<detail::lane_of<Integer>>(
+        detail::reduce<detail::reduce_or_op, Bits0, Bits...>(
+            static_cast<detail::scalar_of<Integer>>(value.value()),
+            detail::all_same<detail::integer_seq<Bits0, Bits...>>()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr detail::lane_of<Integer> reduce_min_unsigned(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    return static_cast<detail::lane_of<Integer>>(
+        detail::reduce<detail::reduce_min_unsigned_op, Bits0, Bits...>(
+            static_cast<detail::scalar_of<Integer>>(value.value()),
+            detail::all_same<detail::integer_seq<Bits0, Bits...>>()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr detail::lane_of<Integer> reduce_max_unsigned(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    return static_cast<detail::lane_of<Integer>>(
+        detail::reduce<detail::reduce_max_unsigned_op, Bits0, Bits...>(
+            static_cast<detail::scalar_of<Integer>>(value.value()),
+            detail::all_same<detail::integer_seq<Bits0, Bits...>>()));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr typename detail::make_signed<detail::lane_of<Integer>>::type
+    reduce_min_signed(packed_int<Integer, Bits0, Bits...> value) noexcept
+{
+    using scalar = detail::scalar_of<Integer>;
+    using max_bits = detail::find_max<Bits0, Bits...>;
+    return detail::to_signed<max_bits::value>(static_cast<detail::lane_of<Integer>>(
+        detail::reduce_signed<detail::reduce_min_signed_op, Bits0, Bits...>(static_cast<scalar>(value.value()),
+            detail::all_same<detail::integer_seq<Bits0, Bits...>>())
+        & detail::all_ones<scalar, max_bits::value>::value));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr typename detail::make_signed<detail::lane_of<Integer>>::type
+    reduce_max_signed(packed_int<Integer, Bits0, Bits...> value) noexcept
+{
+    using scalar = detail::scalar_of<Integer>;
+    using max_bits = detail::find_max<Bits0, Bits...>;
+    return detail::to_signed<max_bits::value>(static_cast<detail::lane_of<Integer>>(
+        detail::reduce_signed<detail::reduce_max_signed_op, Bits0, Bits...>(static_cast<scalar>(value.value()),
+            detail::all_same<detail::integer_seq<Bits0, Bits...>>())
+        & detail::all_ones<scalar, max_bits::value>::value));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Bit counting within each pack, e.g. of bitmaps of flags. Counts are
+// stored in packs of the result, count of pack of N bits is at most N
+
+// Number of set bits of each pack
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> popcount_lanes(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::popcount_lanes<Bits0, Bits...>(value.value()));
+}
+
+// Number of zero bits above the highest set bit of each pack, N for zero pack
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> clz_lanes(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::clz_lanes<Bits0, Bits...>(value.value()));
+}
+
+// Number of zero bits below the lowest set bit of each pack, N for zero pack
+template<size_t Bits0, size_t ...Bits, class Integer>
+constexpr packed_int<Integer, Bits0, Bits...> ctz_lanes(packed_int<Integer, Bits0, Bits...> value) noexcept {
+    return packed_int<Integer, Bits0, Bits...>(
+        detail::ctz_lanes<Bits0, Bits...>(value.value()));
 }
 
 } // namespace pint
@@ -0,0 +1,286 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+#include "pint/bulk.hpp"
+#include "pint/expr.hpp"
+
+namespace pint {
+
+///////////////////////////////////////////////////////////////////////////////
+// Pixel formats. Channels are listed from the high order bits, so the last
+// channel is the first pack, e.g. blue of rgb565 is get<0> and alpha
+// of rgba formats is get<0>
+
+using rgb565 = packed_int<uint16_t, 5, 6, 5>;
+using rgba5551 = packed_int<uint16_t, 1, 5, 5, 5>;
+using rgba4444 = packed_int<uint16_t, 4, 4, 4, 4>;
+using rgb888 = packed_int<uint32_t, 8, 8, 8>;
+using rgba8888 = packed_int<uint32_t, 8, 8, 8, 8>;
+
+namespace detail {
+
+// Average of each pack rounded down. Low order bit of each pack is
+// cleared before shift, so it doesn't move to the pack below
+template<size_t ...Bits, class Word>
+constexpr Word average_floor(Word a, Word b) {
+    using loorder = mask_loorder<scalar_of<Word>, Bits...>;
+    return static_cast<Word>((a & b) + (((a ^ b) & static_cast<scalar_of<Word>>(~loorder::value)) >> 1));
+}
+
+// Blending without multiplication: weight w / 2^Rounds is applied bit by bit,
+// from the low order bit. Each round averages the result with src if the bit
+// is set or with dst otherwise, so src gets weight sum(bit_k * 2^(k - Rounds)).
+// Each average rounds down, the result is less than exact by less than 1
+template<size_t Rounds, size_t ...Bits>
+struct blend_kernel {
+    size_t weight;
+    size_t first;   // lowest set bit of weight, rounds below it give dst
+
+    explicit blend_kernel(size_t w) noexcept : weight(w), first(0) {
+        while (first < Rounds && ((w >> first) & 1) == 0)
+            ++first;
+    }
+
+    template<class Word>
+    Word operator()(Word src, Word dst) const {
+        if (weight >> Rounds)
+            return src;
+
+        Word result = dst;
+        for (size_t k = first; k < Rounds; ++k)
+            result = average_floor<Bits...>(result, ((weight >> k) & 1) ? src : dst);
+        return result;
+    }
+};
+
+// Blending by alpha of each source pixel, alpha is the first pack. Alpha of
+// AlphaBits is mapped to weight a + a >> (AlphaBits - 1) in 1 / 2^AlphaBits
+// units, so opaque source gives weight 1. Rounds select src or dst by mask of
+// weight bit of each pixel. Alpha of source is replaced with ones, so alpha
+// of the result is src_a + dst_a * (1 - src_a)
+template<size_t AlphaBits, size_t ...Bits>
+struct blend_over_kernel {
+    template<class Word>
+    static Word select(Word weight, size_t bit, Word a, Word b) {
+        const Word mask = static_cast<Word>(scalar_of<Word>(0) - ((weight >> bit) & scalar_of<Word>(1)));
+        return static_cast<Word>((a & mask) | (b & ~mask));
+    }
+
+    template<class Word>
+    Word operator()(Word src, Word dst) const {
+        const scalar_of<Word> alpha_mask = all_ones<scalar_of<Word>, AlphaBits>::value;
+        const Word alpha = static_cast<Word>(src & alpha_mask);
+        const Word weight = static_cast<Word>(alpha + (alpha >> (AlphaBits - 1)));
+        const Word opaque_src = static_cast<Word>(src | alpha_mask);
+
+        Word result = dst;
+        for (size_t k = 0; k < AlphaBits; ++k)
+            result = average_floor<Bits...>(result, select(weight, k, opaque_src, dst));
+        return select(weight, AlphaBits, opaque_src, result);
+    }
+};
+
+template<size_t ...Bits>
+struct average_kernel {
+    template<class Word>
+    Word operator()(Word a, Word b) const { return average_floor<Bits...>(a, b); }
+};
+
+// Kernel applied to arrays of pixels, SIMD words hold several pixels.
+// The tail which doesn't fill the whole SIMD register is processed without SIMD
+template<class Kernel, class PackedInt>
+struct bulk_pixels {
+    using integer = typename PackedInt::value_type;
+
+    Kernel kernel;
+    const PackedInt *a;
+    const PackedInt *b;
+    PackedInt *out;
+    size_t count;
+
+    void operator()(simd::none) const {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = PackedInt(kernel(a[i].value(), b[i].value()));
+    }
+
+    template<class Isa>
+    void operator()(Isa) const {
+        using word = simd::word<integer, Isa>;
+
+        size_t i = 0;
+        for (; i + word::size <= count; i += word::size)
+            kernel(word::load(a + i), word::load(b + i)).store(out + i);
+
+        bulk_pixels{kernel, a + i, b + i, out + i, count - i}(simd::none());
+    }
+};
+
+template<class Kernel, class PackedInt>
+void apply_pixels(const Kernel &kernel, const PackedInt *a, const PackedInt *b, PackedInt *out, size_t count) {
+    bulk_dispatch(bulk_pixels<Kernel, PackedInt>{kernel, a, b, out, count},
+        has_simd_word<typename PackedInt::value_type>());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversion between pixel formats. Channels are matched from the high order
+// packs, if one format has an extra first pack (alpha), it is dropped or
+// filled with ones. Wider channel gets the bits of narrower one at the top,
+// low order bits repeat its high order bits (e.g. 5 bits abcde become 8 bits
+// abcdeabc), so conversion to wider format and back gives the same pixel
+
+template<class T>
+constexpr T replicate_bits(T value, size_t from, size_t to) {
+    return to <= from ? static_cast<T>(value >> (from - to))
+        : static_cast<T>((value << (to - from)) | replicate_bits(value, from, to - from));
+}
+
+template<class To, class Integer, size_t ...FromOffsets, size_t ...FromBits, size_t ...ToOffsets, size_t ...ToBits>
+constexpr To convert_packs(Integer value, integer_seq<FromOffsets...>, integer_seq<FromBits...>,
+    integer_seq<ToOffsets...>, integer_seq<ToBits...>)
+{
+    return bit_or<To>(static_cast<To>(
+        replicate_bits(take_pack<FromOffsets, FromBits, To>(value), FromBits, ToBits) << ToOffsets)...);
+}
+
+// Packs of From and To matched to each other
+template<class From, class To> struct pixel_conversion;
+template<class FromInteger, size_t ...FromBits, class ToInteger, size_t ...ToBits>
+struct pixel_conversion<packed_int<FromInteger, FromBits...>, packed_int<ToInteger, ToBits...>> {
+    static const size_t from_count = sizeof...(FromBits);
+    static const size_t to_count = sizeof...(ToBits);
+    static_assert(from_count <= to_count + 1 && to_count <= from_count + 1,
+        "Pixel formats may differ only by the first pack");
+
+    static const size_t from_first = from_count > to_count ? 1 : 0;
+    static const size_t to_first = to_count > from_count ? 1 : 0;
+
+    using from_offsets = slice<from_first, from_count, mask_offsets_vector<FromBits...>>;
+    using from_bits = slice<from_first, from_count, integer_seq<FromBits...>>;
+    using to_offsets = slice<to_first, to_count, mask_offsets_vector<ToBits...>>;
+    using to_bits = slice<to_first, to_count, integer_seq<ToBits...>>;
+
+    // Extra pack of target is filled with ones
+    static constexpr ToInteger extra = to_first ? all_ones<ToInteger, take_nth<0, integer_seq<ToBits...>>::value>::value
+        : ToInteger(0);
+
+    static ToInteger convert(FromInteger value) noexcept {
+        return static_cast<ToInteger>(extra | convert_packs<ToInteger>(value,
+            from_offsets(), from_bits(), to_offsets(), to_bits()));
+    }
+};
+
+// Pixels change their size, so they don't fit SIMD words. The loop is
+// compiled for instruction set selected at runtime, so compiler vectorizes it
+template<class From, class To>
+struct bulk_convert_pixels {
+    using conversion = pixel_conversion<From, To>;
+
+    const From *pixels;
+    To *out;
+    size_t count;
+
+    void operator()(simd::none) const {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = To(conversion::convert(pixels[i].value()));
+    }
+
+    template<class Isa>
+    void operator()(Isa) const { (*this)(simd::none()); }
+};
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// Pixel kernels over image buffers. Pixels are packed integers of any layout
+// (formats above are typical), `out` may point to one of inputs
+
+// out = src * alpha + dst * (1 - alpha) for each channel, alpha is in [0, 255].
+// Alpha is rounded to 2^-N, N is the length of the longest channel
+template<size_t Bits0, size_t ...Bits, class Integer>
+void blend(
+    const packed_int<Integer, Bits0, Bits...> *src,
+    const packed_int<Integer, Bits0, Bits...> *dst,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count,
+    uint8_t alpha) noexcept
+{
+    const size_t rounds = detail::find_max<Bits0, Bits...>::value;
+    const size_t weight = (size_t(alpha) << rounds) / 255 + ((size_t(alpha) << rounds) % 255 >= 128 ? 1 : 0);
+
+    detail::apply_pixels(detail::blend_kernel<rounds, Bits0, Bits...>(weight), src, dst, out, count);
+}
+
+// Source pixels with alpha in the first pack (rgba5551, rgba4444, rgba8888)
+// composited over dst: color channels are blended by source alpha,
+// alpha of the result is src_a + dst_a * (1 - src_a)
+template<size_t Bits0, size_t ...Bits, class Integer>
+void blend_over(
+    const packed_int<Integer, Bits0, Bits...> *src,
+    const packed_int<Integer, Bits0, Bits...> *dst,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::apply_pixels(detail::blend_over_kernel<Bits0, Bits0, Bits...>(), src, dst, out, count);
+}
+
+// Average of each channel, rounded down
+template<size_t Bits0, size_t ...Bits, class Integer>
+void average(
+    const packed_int<Integer, Bits0, Bits...> *a,
+    const packed_int<Integer, Bits0, Bits...> *b,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    detail::apply_pixels(detail::average_kernel<Bits0, Bits...>(), a, b, out, count);
+}
+
+// Amount is added to (subtracted from) each channel with saturation
+template<size_t Bits0, size_t ...Bits, class Integer>
+void brighten(
+    const packed_int<Integer, Bits0, Bits...> *pixels,
+    packed_int<Integer, Bits0, Bits...> amount,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    evaluate(expr(pixels) + amount, out, count);
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void darken(
+    const packed_int<Integer, Bits0, Bits...> *pixels,
+    packed_int<Integer, Bits0, Bits...> amount,
+    packed_int<Integer, Bits0, Bits...> *out,
+    size_t count) noexcept
+{
+    evaluate(expr(pixels) - amount, out, count);
+}
+
+// Conversion between pixel formats, e.g. rgb565 to rgba8888 and back
+template<class From, class To>
+void convert_pixels(const From *pixels, To *out, size_t count) noexcept {
+    detail::bulk_dispatch(detail::bulk_convert_pixels<From, To>{pixels, out, count},
+        std::integral_constant<bool, detail::has_simd_word<typename From::value_type>::value
+            && detail::has_simd_word<typename To::value_type>::value>());
+}
+
+template<class To, class From>
+To convert_pixel(From pixel) noexcept {
+    return To(detail::pixel_conversion<From, To>::convert(pixel.value()));
+}
+
+} // namespace pint
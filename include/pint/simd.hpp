@@ -0,0 +1,1344 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#include "pint/pint.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define PINT_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// 64-bit pdep / pext are available only in 64-bit mode
+#if defined(__x86_64__) || defined(_M_X64)
+#define PINT_SIMD_BMI2
+#endif
+
+// Code for instruction sets above compilation target is compiled only
+// in functions marked with target attribute. MSVC allows intrinsics anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define PINT_SIMD_TARGET(isa) __attribute__((target(isa)))
+#define PINT_SIMD_FLATTEN __attribute__((flatten))
+#else
+#define PINT_SIMD_TARGET(isa)
+#define PINT_SIMD_FLATTEN
+#endif
+
+namespace pint {
+namespace simd {
+
+using detail::size_t_;
+
+// Instruction sets from the least to the most capable one
+enum class level { none, sse2, sse41, avx2, avx512bw };
+
+// Tags of instruction sets. Instruction sets using the same registers
+// derive from each other
+struct none {};
+struct sse2 {};
+struct sse41 : sse2 {};
+struct avx2 {};
+struct avx512bw {};
+
+// Register holding several packed values of type Integer.
+// All arithmetic operators work on each Integer independently,
+// so word can be passed to the same functions as a single Integer.
+template<class Integer, class Isa> class word;
+
+// Native lane-wise operations. They are defined only for lane sizes supported
+// by instruction set, lane size in bits is passed as the last argument.
+template<class Word, class Lane> Word add_wrap(Word, Word, Lane) = delete;
+template<class Word, class Lane> Word add_unsigned_saturate(Word, Word, Lane) = delete;
+template<class Word, class Lane> Word add_signed_saturate(Word, Word, Lane) = delete;
+template<class Word, class Lane> Word sub_wrap(Word, Word, Lane) = delete;
+template<class Word, class Lane> Word sub_unsigned_saturate(Word, Word, Lane) = delete;
+template<class Word, class Lane> Word sub_signed_saturate(Word, Word, Lane) = delete;
+template<class Word, class Lane> Word min_unsigned(Word, Word, Lane) = delete;
+template<class Word, class Lane> Word max_unsigned(Word, Word, Lane) = delete;
+template<class Word, class Lane> Word min_signed(Word, Word, Lane) = delete;
+template<class Word, class Lane> Word max_signed(Word, Word, Lane) = delete;
+template<class Word, class Lane> Word avg_unsigned(Word, Word, Lane) = delete;
+// Sums of absolute differences of lanes, each sum is stored in 64-bit lane
+template<class Word, class Lane> Word sum_absdiff(Word, Word, Lane) = delete;
+// Number of set bits of each lane. Tag vpopcnt selects AVX-512 BITALG
+// and VPOPCNTDQ instructions, otherwise bytes are counted by pshufb lookup
+struct vpopcnt {};
+template<class Word, class Lane> Word popcount_lanes(Word, Lane) = delete;
+template<class Word, class Lane> Word popcount_lanes(Word, Lane, vpopcnt) = delete;
+// Conversion between lane sizes: Narrow lanes loaded from memory and
+// extended to Lane bits, or lanes of Lane bits truncated and stored.
+// Memory holds as many lanes as Word does
+template<class Word, class Narrow, class Lane> Word load_zero_extend(const void *, Narrow, Lane) = delete;
+template<class Word, class Narrow, class Lane> Word load_sign_extend(const void *, Narrow, Lane) = delete;
+template<class Word, class Narrow, class Lane> void store_truncate(void *, Word, Narrow, Lane) = delete;
+
+///////////////////////////////////////////////////////////////////////////////
+// Runtime detection of instruction set
+
+// The most capable instruction set supported by CPU and OS
+inline level detected_level() noexcept;
+
+namespace detail {
+
+#ifdef PINT_SIMD_X86
+
+// Registers eax, ebx, ecx, edx returned by cpuid instruction
+inline void cpuid(unsigned leaf, unsigned (&regs)[4]) noexcept {
+#if defined(_MSC_VER)
+    int result[4];
+    __cpuidex(result, static_cast<int>(leaf), 0);
+    for (size_t i = 0; i < 4; ++i)
+        regs[i] = static_cast<unsigned>(result[i]);
+#else
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Register states saved by OS on context switch
+inline unsigned long long xgetbv() noexcept {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return eax | static_cast<unsigned long long>(edx) << 32;
+#endif
+}
+
+#endif // PINT_SIMD_X86
+
+inline level detect_level() noexcept {
+#ifdef PINT_SIMD_X86
+    unsigned regs[4];
+    cpuid(0, regs);
+    const unsigned max_leaf = regs[0];
+
+    cpuid(1, regs);
+    if (!(regs[3] & (1u << 26)))
+        return level::none;
+    if (!(regs[2] & (1u << 19)))
+        return level::sse2;
+
+    // AVX registers can be used only if OS saves them (OSXSAVE and XCR0)
+    const bool avx = (regs[2] & (1u << 27)) && (regs[2] & (1u << 28));
+    if (!avx || max_leaf < 7)
+        return level::sse41;
+
+    const unsigned long long xcr0 = xgetbv();
+    cpuid(7, regs);
+    if (!(regs[1] & (1u << 5)) || (xcr0 & 0x06) != 0x06)
+        return level::sse41;
+
+    // AVX-512 requires also opmask and upper halves of zmm registers
+    if (!(regs[1] & (1u << 16)) || !(regs[1] & (1u << 30)) || (xcr0 & 0xE6) != 0xE6)
+        return level::avx2;
+
+    return level::avx512bw;
+#else
+    return level::none;
+#endif
+}
+
+const char *const level_names[] = { "none", "sse2", "sse4.1", "avx2", "avx512bw" };
+
+// Level with given name, or fallback if name is unknown
+inline level parse_level(const char *name, level fallback) noexcept {
+    for (size_t i = 0; i < sizeof(level_names) / sizeof(level_names[0]); ++i) {
+        if (std::strcmp(name, level_names[i]) == 0)
+            return static_cast<level>(i);
+    }
+
+    return fallback;
+}
+
+// Detected level, lowered by PINT_SIMD_LEVEL environment variable
+inline level initial_level() noexcept {
+    const char *name = std::getenv("PINT_SIMD_LEVEL");
+    const level requested = name ? parse_level(name, detected_level()) : detected_level();
+    return requested < detected_level() ? requested : detected_level();
+}
+
+inline std::atomic<level> &active_level() noexcept {
+    static std::atomic<level> value(initial_level());
+    return value;
+}
+
+// BMI2 is reported only if pdep / pext are fast. AMD CPUs before Zen 3
+// (family 19h) and Hygon CPUs execute them in microcode, which is slower
+// than shifting and masking each pack
+inline bool detect_bmi2() noexcept {
+#ifdef PINT_SIMD_BMI2
+    unsigned regs[4];
+    cpuid(0, regs);
+    if (regs[0] < 7)
+        return false;
+
+    // Vendor string starts in ebx: "AuthenticAMD" or "HygonGenuine"
+    const bool amd = regs[1] == 0x68747541 || regs[1] == 0x6f677948;
+
+    cpuid(1, regs);
+    const unsigned family = ((regs[0] >> 8) & 0xF) == 0xF
+        ? 0xF + ((regs[0] >> 20) & 0xFF)
+        : (regs[0] >> 8) & 0xF;
+
+    cpuid(7, regs);
+    return (regs[1] & (1u << 8)) && !(amd && family < 0x19);
+#else
+    return false;
+#endif
+}
+
+// Detected BMI2, disabled if PINT_BMI2 environment variable is 0
+inline bool initial_bmi2() noexcept {
+    const char *value = std::getenv("PINT_BMI2");
+    return detect_bmi2() && !(value && std::strcmp(value, "0") == 0);
+}
+
+inline std::atomic<bool> &active_bmi2() noexcept {
+    static std::atomic<bool> value(initial_bmi2());
+    return value;
+}
+
+// AVX-512 BITALG (8 and 16-bit lanes) and VPOPCNTDQ (32 and 64-bit lanes),
+// both are required. They are used only at avx512bw level
+inline bool detect_avx512_popcnt() noexcept {
+#ifdef PINT_SIMD_X86
+    if (detect_level() != level::avx512bw)
+        return false;
+
+    unsigned regs[4];
+    cpuid(7, regs);
+    return (regs[2] & (1u << 12)) && (regs[2] & (1u << 14));
+#else
+    return false;
+#endif
+}
+
+// Detected VPOPCNT, disabled if PINT_AVX512_POPCNT environment variable is 0
+inline bool initial_avx512_popcnt() noexcept {
+    const char *value = std::getenv("PINT_AVX512_POPCNT");
+    return detect_avx512_popcnt() && !(value && std::strcmp(value, "0") == 0);
+}
+
+inline std::atomic<bool> &active_avx512_popcnt() noexcept {
+    static std::atomic<bool> value(initial_avx512_popcnt());
+    return value;
+}
+
+} // namespace detail
+
+inline level detected_level() noexcept {
+    static const level value = detail::detect_level();
+    return value;
+}
+
+// Instruction set used by bulk functions. It is detected at first use and
+// can be lowered by PINT_SIMD_LEVEL environment variable
+// (none, sse2, sse4.1, avx2 or avx512bw) or by set_level()
+inline level current_level() noexcept {
+    return detail::active_level().load(std::memory_order_relaxed);
+}
+
+// Force instruction set, e.g. for benchmarking. Levels not supported
+// by CPU are replaced with detected_level()
+inline void set_level(level value) noexcept {
+    detail::active_level().store(
+        value < detected_level() ? value : detected_level(), std::memory_order_relaxed);
+}
+
+inline const char *level_name(level value) noexcept {
+    return detail::level_names[static_cast<size_t>(value)];
+}
+
+// True if CPU has fast pdep / pext instructions
+inline bool detected_bmi2() noexcept {
+    static const bool value = detail::detect_bmi2();
+    return value;
+}
+
+// pdep / pext are used by pack and unpack functions. They are enabled if
+// detected and can be disabled by PINT_BMI2=0 environment variable or set_bmi2()
+inline bool current_bmi2() noexcept {
+    return detail::active_bmi2().load(std::memory_order_relaxed);
+}
+
+// Enable or disable pdep / pext, they are never enabled if not detected
+inline void set_bmi2(bool enabled) noexcept {
+    detail::active_bmi2().store(enabled && detected_bmi2(), std::memory_order_relaxed);
+}
+
+// True if CPU has AVX-512 BITALG and VPOPCNTDQ instructions
+inline bool detected_avx512_popcnt() noexcept {
+    static const bool value = detail::detect_avx512_popcnt();
+    return value;
+}
+
+// VPOPCNT instructions are used by bit counting bulk functions at avx512bw
+// level. They are enabled if detected and can be disabled by PINT_AVX512_POPCNT=0
+// environment variable or set_avx512_popcnt()
+inline bool current_avx512_popcnt() noexcept {
+    return detail::active_avx512_popcnt().load(std::memory_order_relaxed);
+}
+
+inline void set_avx512_popcnt(bool enabled) noexcept {
+    detail::active_avx512_popcnt().store(enabled && detected_avx512_popcnt(), std::memory_order_relaxed);
+}
+
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////
+// Unsigned integer twice as wide as Half. It is the scalar type of registers,
+// masks for packed values are computed in it at compile time.
+// Memory layout is the same as of the register: low half goes first
+
+template<class Half>
+struct double_width {
+    static const size_t half_bits = sizeof(Half) * 8;
+
+    Half lo;
+    Half hi;
+
+    constexpr double_width() noexcept : lo(), hi() {}
+    constexpr double_width(uint64_t value) noexcept : lo(value), hi() {}
+    constexpr double_width(Half hi_, Half lo_) noexcept : lo(lo_), hi(hi_) {}
+
+    constexpr explicit operator uint64_t() const noexcept { return static_cast<uint64_t>(lo); }
+
+    constexpr friend double_width operator&(double_width a, double_width b) noexcept {
+        return double_width(a.hi & b.hi, a.lo & b.lo);
+    }
+    constexpr friend double_width operator|(double_width a, double_width b) noexcept {
+        return double_width(a.hi | b.hi, a.lo | b.lo);
+    }
+    constexpr friend double_width operator^(double_width a, double_width b) noexcept {
+        return double_width(a.hi ^ b.hi, a.lo ^ b.lo);
+    }
+    constexpr friend double_width operator~(double_width a) noexcept {
+        return double_width(~a.hi, ~a.lo);
+    }
+    constexpr friend double_width operator+(double_width a, double_width b) noexcept {
+        return double_width(a.hi + b.hi + Half(a.lo + b.lo < a.lo), a.lo + b.lo);
+    }
+    constexpr friend double_width operator-(double_width a, double_width b) noexcept {
+        return double_width(a.hi - b.hi - Half(a.lo < b.lo), a.lo - b.lo);
+    }
+
+    // Shifts are defined for any amount, bits shifted out are lost
+    constexpr friend double_width operator<<(double_width a, size_t amount) noexcept {
+        return amount == 0 ? a
+            : amount >= 2 * half_bits ? double_width()
+            : amount >= half_bits ? double_width(a.lo << (amount - half_bits), Half())
+            : double_width((a.hi << amount) | (a.lo >> (half_bits - amount)), a.lo << amount);
+    }
+    constexpr friend double_width operator>>(double_width a, size_t amount) noexcept {
+        return amount == 0 ? a
+            : amount >= 2 * half_bits ? double_width()
+            : amount >= half_bits ? double_width(Half(), a.hi >> (amount - half_bits))
+            : double_width(a.hi >> amount, (a.lo >> amount) | (a.hi << (half_bits - amount)));
+    }
+
+    constexpr friend bool operator==(double_width a, double_width b) noexcept {
+        return a.hi == b.hi && a.lo == b.lo;
+    }
+    constexpr friend bool operator!=(double_width a, double_width b) noexcept { return !(a == b); }
+    constexpr friend bool operator<(double_width a, double_width b) noexcept {
+        return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+    }
+};
+
+template<class Half> const size_t double_width<Half>::half_bits;
+
+} // namespace detail
+
+using uint128 = detail::double_width<uint64_t>;
+using uint256 = detail::double_width<uint128>;
+
+#ifdef PINT_SIMD_X86
+
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////
+// Lane-wise operations on lanes of given size (in bytes)
+
+template<size_t Size> struct sse2_lanes;
+
+template<> struct sse2_lanes<1> {
+    PINT_SIMD_TARGET("sse2") static __m128i set1(uint8_t value) { return _mm_set1_epi8(static_cast<char>(value)); }
+    PINT_SIMD_TARGET("sse2") static __m128i add(__m128i a, __m128i b) { return _mm_add_epi8(a, b); }
+    PINT_SIMD_TARGET("sse2") static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi8(a, b); }
+
+    // There are no 8-bit shifts, so shift 16-bit lanes and reset bits
+    // which were moved from neighbour lane
+    PINT_SIMD_TARGET("sse2") static __m128i sll(__m128i a, size_t amount) {
+        return amount < 8
+            ? _mm_and_si128(_mm_sll_epi16(a, _mm_cvtsi32_si128(static_cast<int>(amount))),
+                set1(static_cast<uint8_t>(0xFF << amount)))
+            : _mm_setzero_si128();
+    }
+    PINT_SIMD_TARGET("sse2") static __m128i srl(__m128i a, size_t amount) {
+        return amount < 8
+            ? _mm_and_si128(_mm_srl_epi16(a, _mm_cvtsi32_si128(static_cast<int>(amount))),
+                set1(static_cast<uint8_t>(0xFF >> amount)))
+            : _mm_setzero_si128();
+    }
+};
+
+// Shift amount for _mm_sll_* / _mm_srl_* functions. Amounts greater than
+// lane size produce zero, so clamp amount to avoid truncation of size_t
+PINT_SIMD_TARGET("sse2") inline __m128i sse2_shift_amount(size_t amount) {
+    return _mm_cvtsi32_si128(static_cast<int>(amount < 64 ? amount : 64));
+}
+
+template<> struct sse2_lanes<2> {
+    PINT_SIMD_TARGET("sse2") static __m128i set1(uint16_t value) { return _mm_set1_epi16(static_cast<short>(value)); }
+    PINT_SIMD_TARGET("sse2") static __m128i add(__m128i a, __m128i b) { return _mm_add_epi16(a, b); }
+    PINT_SIMD_TARGET("sse2") static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi16(a, b); }
+    PINT_SIMD_TARGET("sse2") static __m128i sll(__m128i a, size_t amount) { return _mm_sll_epi16(a, sse2_shift_amount(amount)); }
+    PINT_SIMD_TARGET("sse2") static __m128i srl(__m128i a, size_t amount) { return _mm_srl_epi16(a, sse2_shift_amount(amount)); }
+};
+
+template<> struct sse2_lanes<4> {
+    PINT_SIMD_TARGET("sse2") static __m128i set1(uint32_t value) { return _mm_set1_epi32(static_cast<int>(value)); }
+    PINT_SIMD_TARGET("sse2") static __m128i add(__m128i a, __m128i b) { return _mm_add_epi32(a, b); }
+    PINT_SIMD_TARGET("sse2") static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi32(a, b); }
+    PINT_SIMD_TARGET("sse2") static __m128i sll(__m128i a, size_t amount) { return _mm_sll_epi32(a, sse2_shift_amount(amount)); }
+    PINT_SIMD_TARGET("sse2") static __m128i srl(__m128i a, size_t amount) { return _mm_srl_epi32(a, sse2_shift_amount(amount)); }
+};
+
+template<> struct sse2_lanes<8> {
+    PINT_SIMD_TARGET("sse2") static __m128i set1(uint64_t value) { return _mm_set1_epi64x(static_cast<long long>(value)); }
+    PINT_SIMD_TARGET("sse2") static __m128i add(__m128i a, __m128i b) { return _mm_add_epi64(a, b); }
+    PINT_SIMD_TARGET("sse2") static __m128i sub(__m128i a, __m128i b) { return _mm_sub_epi64(a, b); }
+    PINT_SIMD_TARGET("sse2") static __m128i sll(__m128i a, size_t amount) { return _mm_sll_epi64(a, sse2_shift_amount(amount)); }
+    PINT_SIMD_TARGET("sse2") static __m128i srl(__m128i a, size_t amount) { return _mm_srl_epi64(a, sse2_shift_amount(amount)); }
+};
+
+template<size_t Size> struct avx2_lanes;
+
+template<> struct avx2_lanes<1> {
+    PINT_SIMD_TARGET("avx2") static __m256i set1(uint8_t value) { return _mm256_set1_epi8(static_cast<char>(value)); }
+    PINT_SIMD_TARGET("avx2") static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi8(a, b); }
+    PINT_SIMD_TARGET("avx2") static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi8(a, b); }
+
+    PINT_SIMD_TARGET("avx2") static __m256i sll(__m256i a, size_t amount) {
+        return amount < 8
+            ? _mm256_and_si256(_mm256_sll_epi16(a, _mm_cvtsi32_si128(static_cast<int>(amount))),
+                set1(static_cast<uint8_t>(0xFF << amount)))
+            : _mm256_setzero_si256();
+    }
+    PINT_SIMD_TARGET("avx2") static __m256i srl(__m256i a, size_t amount) {
+        return amount < 8
+            ? _mm256_and_si256(_mm256_srl_epi16(a, _mm_cvtsi32_si128(static_cast<int>(amount))),
+                set1(static_cast<uint8_t>(0xFF >> amount)))
+            : _mm256_setzero_si256();
+    }
+};
+
+template<> struct avx2_lanes<2> {
+    PINT_SIMD_TARGET("avx2") static __m256i set1(uint16_t value) { return _mm256_set1_epi16(static_cast<short>(value)); }
+    PINT_SIMD_TARGET("avx2") static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi16(a, b); }
+    PINT_SIMD_TARGET("avx2") static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi16(a, b); }
+    PINT_SIMD_TARGET("avx2") static __m256i sll(__m256i a, size_t amount) { return _mm256_sll_epi16(a, sse2_shift_amount(amount)); }
+    PINT_SIMD_TARGET("avx2") static __m256i srl(__m256i a, size_t amount) { return _mm256_srl_epi16(a, sse2_shift_amount(amount)); }
+};
+
+template<> struct avx2_lanes<4> {
+    PINT_SIMD_TARGET("avx2") static __m256i set1(uint32_t value) { return _mm256_set1_epi32(static_cast<int>(value)); }
+    PINT_SIMD_TARGET("avx2") static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+    PINT_SIMD_TARGET("avx2") static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi32(a, b); }
+    PINT_SIMD_TARGET("avx2") static __m256i sll(__m256i a, size_t amount) { return _mm256_sll_epi32(a, sse2_shift_amount(amount)); }
+    PINT_SIMD_TARGET("avx2") static __m256i srl(__m256i a, size_t amount) { return _mm256_srl_epi32(a, sse2_shift_amount(amount)); }
+};
+
+template<> struct avx2_lanes<8> {
+    PINT_SIMD_TARGET("avx2") static __m256i set1(uint64_t value) { return _mm256_set1_epi64x(static_cast<long long>(value)); }
+    PINT_SIMD_TARGET("avx2") static __m256i add(__m256i a, __m256i b) { return _mm256_add_epi64(a, b); }
+    PINT_SIMD_TARGET("avx2") static __m256i sub(__m256i a, __m256i b) { return _mm256_sub_epi64(a, b); }
+    PINT_SIMD_TARGET("avx2") static __m256i sll(__m256i a, size_t amount) { return _mm256_sll_epi64(a, sse2_shift_amount(amount)); }
+    PINT_SIMD_TARGET("avx2") static __m256i srl(__m256i a, size_t amount) { return _mm256_srl_epi64(a, sse2_shift_amount(amount)); }
+};
+
+template<size_t Size> struct avx512_lanes;
+
+template<> struct avx512_lanes<1> {
+    PINT_SIMD_TARGET("avx512bw") static __m512i set1(uint8_t value) { return _mm512_set1_epi8(static_cast<char>(value)); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i add(__m512i a, __m512i b) { return _mm512_add_epi8(a, b); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sub(__m512i a, __m512i b) { return _mm512_sub_epi8(a, b); }
+
+    PINT_SIMD_TARGET("avx512bw") static __m512i sll(__m512i a, size_t amount) {
+        return amount < 8
+            ? _mm512_and_si512(_mm512_sll_epi16(a, _mm_cvtsi32_si128(static_cast<int>(amount))),
+                set1(static_cast<uint8_t>(0xFF << amount)))
+            : _mm512_setzero_si512();
+    }
+    PINT_SIMD_TARGET("avx512bw") static __m512i srl(__m512i a, size_t amount) {
+        return amount < 8
+            ? _mm512_and_si512(_mm512_srl_epi16(a, _mm_cvtsi32_si128(static_cast<int>(amount))),
+                set1(static_cast<uint8_t>(0xFF >> amount)))
+            : _mm512_setzero_si512();
+    }
+};
+
+template<> struct avx512_lanes<2> {
+    PINT_SIMD_TARGET("avx512bw") static __m512i set1(uint16_t value) { return _mm512_set1_epi16(static_cast<short>(value)); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i add(__m512i a, __m512i b) { return _mm512_add_epi16(a, b); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sub(__m512i a, __m512i b) { return _mm512_sub_epi16(a, b); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sll(__m512i a, size_t amount) { return _mm512_sll_epi16(a, sse2_shift_amount(amount)); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i srl(__m512i a, size_t amount) { return _mm512_srl_epi16(a, sse2_shift_amount(amount)); }
+};
+
+// Unmasked AVX-512F shifts and min/max on 32 and 64-bit lanes trigger false
+// -Wmaybe-uninitialized in GCC headers, so zero-masking versions with full mask
+// are used instead. Full mask is optimized out
+template<> struct avx512_lanes<4> {
+    PINT_SIMD_TARGET("avx512bw") static __m512i set1(uint32_t value) { return _mm512_set1_epi32(static_cast<int>(value)); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i add(__m512i a, __m512i b) { return _mm512_add_epi32(a, b); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sub(__m512i a, __m512i b) { return _mm512_sub_epi32(a, b); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sll(__m512i a, size_t amount) { return _mm512_maskz_sll_epi32(static_cast<__mmask16>(-1), a, sse2_shift_amount(amount)); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i srl(__m512i a, size_t amount) { return _mm512_maskz_srl_epi32(static_cast<__mmask16>(-1), a, sse2_shift_amount(amount)); }
+};
+
+template<> struct avx512_lanes<8> {
+    PINT_SIMD_TARGET("avx512bw") static __m512i set1(uint64_t value) { return _mm512_set1_epi64(static_cast<long long>(value)); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i add(__m512i a, __m512i b) { return _mm512_add_epi64(a, b); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sub(__m512i a, __m512i b) { return _mm512_sub_epi64(a, b); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sll(__m512i a, size_t amount) { return _mm512_maskz_sll_epi64(static_cast<__mmask8>(-1), a, sse2_shift_amount(amount)); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i srl(__m512i a, size_t amount) { return _mm512_maskz_srl_epi64(static_cast<__mmask8>(-1), a, sse2_shift_amount(amount)); }
+};
+
+PINT_SIMD_TARGET("avx512bw") inline __m512i avx512_min_epu32(__m512i a, __m512i b) { return _mm512_maskz_min_epu32(static_cast<__mmask16>(-1), a, b); }
+PINT_SIMD_TARGET("avx512bw") inline __m512i avx512_min_epi32(__m512i a, __m512i b) { return _mm512_maskz_min_epi32(static_cast<__mmask16>(-1), a, b); }
+PINT_SIMD_TARGET("avx512bw") inline __m512i avx512_min_epu64(__m512i a, __m512i b) { return _mm512_maskz_min_epu64(static_cast<__mmask8>(-1), a, b); }
+PINT_SIMD_TARGET("avx512bw") inline __m512i avx512_min_epi64(__m512i a, __m512i b) { return _mm512_maskz_min_epi64(static_cast<__mmask8>(-1), a, b); }
+PINT_SIMD_TARGET("avx512bw") inline __m512i avx512_max_epu32(__m512i a, __m512i b) { return _mm512_maskz_max_epu32(static_cast<__mmask16>(-1), a, b); }
+PINT_SIMD_TARGET("avx512bw") inline __m512i avx512_max_epi32(__m512i a, __m512i b) { return _mm512_maskz_max_epi32(static_cast<__mmask16>(-1), a, b); }
+PINT_SIMD_TARGET("avx512bw") inline __m512i avx512_max_epu64(__m512i a, __m512i b) { return _mm512_maskz_max_epu64(static_cast<__mmask8>(-1), a, b); }
+PINT_SIMD_TARGET("avx512bw") inline __m512i avx512_max_epi64(__m512i a, __m512i b) { return _mm512_maskz_max_epi64(static_cast<__mmask8>(-1), a, b); }
+
+///////////////////////////////////////////////////////////////////////////////
+// Words of each register size. Operators are friends of the base class,
+// they take and return the word of particular instruction set.
+//
+// Register is kept in memory, so passing word between functions compiled
+// for different instruction sets doesn't depend on their calling conventions
+// (e.g. __m256i is passed in ymm register only if AVX is enabled).
+// After inlining compiler keeps it in register anyway.
+
+template<class Word, class Integer>
+class m128_word {
+    using lanes = sse2_lanes<sizeof(Integer)>;
+
+public:
+    using value_type = Integer;
+    static const size_t size = sizeof(__m128i) / sizeof(Integer);
+
+    PINT_SIMD_TARGET("sse2") explicit m128_word(__m128i value) noexcept {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(m_value), value);
+    }
+    // Broadcast value to all lanes
+    PINT_SIMD_TARGET("sse2") explicit m128_word(Integer value) noexcept
+        : m128_word(lanes::set1(value)) {}
+
+    PINT_SIMD_TARGET("sse2") static Word load(const void *data) noexcept {
+        return Word(_mm_loadu_si128(static_cast<const __m128i *>(data)));
+    }
+    PINT_SIMD_TARGET("sse2") void store(void *data) const noexcept {
+        _mm_storeu_si128(static_cast<__m128i *>(data), value());
+    }
+
+    PINT_SIMD_TARGET("sse2") __m128i value() const noexcept {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(m_value));
+    }
+
+    // The same register viewed as word of other lanes
+    template<class Other>
+    PINT_SIMD_TARGET("sse2") Other as() const noexcept { return Other(value()); }
+
+    PINT_SIMD_TARGET("sse2") friend Word operator&(Word a, Word b) noexcept { return Word(_mm_and_si128(a.value(), b.value())); }
+    PINT_SIMD_TARGET("sse2") friend Word operator|(Word a, Word b) noexcept { return Word(_mm_or_si128(a.value(), b.value())); }
+    PINT_SIMD_TARGET("sse2") friend Word operator^(Word a, Word b) noexcept { return Word(_mm_xor_si128(a.value(), b.value())); }
+    PINT_SIMD_TARGET("sse2") friend Word operator+(Word a, Word b) noexcept { return Word(lanes::add(a.value(), b.value())); }
+    PINT_SIMD_TARGET("sse2") friend Word operator-(Word a, Word b) noexcept { return Word(lanes::sub(a.value(), b.value())); }
+    PINT_SIMD_TARGET("sse2") friend Word operator~(Word a) noexcept {
+        return Word(_mm_xor_si128(a.value(), _mm_set1_epi32(-1)));
+    }
+
+    PINT_SIMD_TARGET("sse2") friend Word operator<<(Word a, size_t amount) noexcept { return Word(lanes::sll(a.value(), amount)); }
+    PINT_SIMD_TARGET("sse2") friend Word operator>>(Word a, size_t amount) noexcept { return Word(lanes::srl(a.value(), amount)); }
+
+    // Operations with masks, mask is broadcasted to all lanes
+    PINT_SIMD_TARGET("sse2") friend Word operator&(Word a, Integer b) noexcept { return a & Word(b); }
+    PINT_SIMD_TARGET("sse2") friend Word operator|(Word a, Integer b) noexcept { return a | Word(b); }
+    PINT_SIMD_TARGET("sse2") friend Word operator^(Word a, Integer b) noexcept { return a ^ Word(b); }
+    PINT_SIMD_TARGET("sse2") friend Word operator+(Word a, Integer b) noexcept { return a + Word(b); }
+    PINT_SIMD_TARGET("sse2") friend Word operator-(Word a, Integer b) noexcept { return a - Word(b); }
+    PINT_SIMD_TARGET("sse2") friend Word operator&(Integer a, Word b) noexcept { return Word(a) & b; }
+    PINT_SIMD_TARGET("sse2") friend Word operator|(Integer a, Word b) noexcept { return Word(a) | b; }
+    PINT_SIMD_TARGET("sse2") friend Word operator^(Integer a, Word b) noexcept { return Word(a) ^ b; }
+    PINT_SIMD_TARGET("sse2") friend Word operator+(Integer a, Word b) noexcept { return Word(a) + b; }
+    PINT_SIMD_TARGET("sse2") friend Word operator-(Integer a, Word b) noexcept { return Word(a) - b; }
+
+private:
+    long long m_value[sizeof(__m128i) / sizeof(long long)];
+};
+
+template<class Word, class Integer>
+class m256_word {
+    using lanes = avx2_lanes<sizeof(Integer)>;
+
+public:
+    using value_type = Integer;
+    static const size_t size = sizeof(__m256i) / sizeof(Integer);
+
+    PINT_SIMD_TARGET("avx2") explicit m256_word(__m256i value) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(m_value), value);
+    }
+    // Broadcast value to all lanes
+    PINT_SIMD_TARGET("avx2") explicit m256_word(Integer value) noexcept
+        : m256_word(lanes::set1(value)) {}
+
+    PINT_SIMD_TARGET("avx2") static Word load(const void *data) noexcept {
+        return Word(_mm256_loadu_si256(static_cast<const __m256i *>(data)));
+    }
+    PINT_SIMD_TARGET("avx2") void store(void *data) const noexcept {
+        _mm256_storeu_si256(static_cast<__m256i *>(data), value());
+    }
+
+    PINT_SIMD_TARGET("avx2") __m256i value() const noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(m_value));
+    }
+
+    // The same register viewed as word of other lanes
+    template<class Other>
+    PINT_SIMD_TARGET("avx2") Other as() const noexcept { return Other(value()); }
+
+    PINT_SIMD_TARGET("avx2") friend Word operator&(Word a, Word b) noexcept { return Word(_mm256_and_si256(a.value(), b.value())); }
+    PINT_SIMD_TARGET("avx2") friend Word operator|(Word a, Word b) noexcept { return Word(_mm256_or_si256(a.value(), b.value())); }
+    PINT_SIMD_TARGET("avx2") friend Word operator^(Word a, Word b) noexcept { return Word(_mm256_xor_si256(a.value(), b.value())); }
+    PINT_SIMD_TARGET("avx2") friend Word operator+(Word a, Word b) noexcept { return Word(lanes::add(a.value(), b.value())); }
+    PINT_SIMD_TARGET("avx2") friend Word operator-(Word a, Word b) noexcept { return Word(lanes::sub(a.value(), b.value())); }
+    PINT_SIMD_TARGET("avx2") friend Word operator~(Word a) noexcept {
+        return Word(_mm256_xor_si256(a.value(), _mm256_set1_epi32(-1)));
+    }
+
+    PINT_SIMD_TARGET("avx2") friend Word operator<<(Word a, size_t amount) noexcept { return Word(lanes::sll(a.value(), amount)); }
+    PINT_SIMD_TARGET("avx2") friend Word operator>>(Word a, size_t amount) noexcept { return Word(lanes::srl(a.value(), amount)); }
+
+    // Operations with masks, mask is broadcasted to all lanes
+    PINT_SIMD_TARGET("avx2") friend Word operator&(Word a, Integer b) noexcept { return a & Word(b); }
+    PINT_SIMD_TARGET("avx2") friend Word operator|(Word a, Integer b) noexcept { return a | Word(b); }
+    PINT_SIMD_TARGET("avx2") friend Word operator^(Word a, Integer b) noexcept { return a ^ Word(b); }
+    PINT_SIMD_TARGET("avx2") friend Word operator+(Word a, Integer b) noexcept { return a + Word(b); }
+    PINT_SIMD_TARGET("avx2") friend Word operator-(Word a, Integer b) noexcept { return a - Word(b); }
+    PINT_SIMD_TARGET("avx2") friend Word operator&(Integer a, Word b) noexcept { return Word(a) & b; }
+    PINT_SIMD_TARGET("avx2") friend Word operator|(Integer a, Word b) noexcept { return Word(a) | b; }
+    PINT_SIMD_TARGET("avx2") friend Word operator^(Integer a, Word b) noexcept { return Word(a) ^ b; }
+    PINT_SIMD_TARGET("avx2") friend Word operator+(Integer a, Word b) noexcept { return Word(a) + b; }
+    PINT_SIMD_TARGET("avx2") friend Word operator-(Integer a, Word b) noexcept { return Word(a) - b; }
+
+private:
+    long long m_value[sizeof(__m256i) / sizeof(long long)];
+};
+
+template<class Word, class Integer>
+class m512_word {
+    using lanes = avx512_lanes<sizeof(Integer)>;
+
+public:
+    using value_type = Integer;
+    static const size_t size = sizeof(__m512i) / sizeof(Integer);
+
+    PINT_SIMD_TARGET("avx512bw") explicit m512_word(__m512i value) noexcept {
+        _mm512_storeu_si512(m_value, value);
+    }
+    // Broadcast value to all lanes
+    PINT_SIMD_TARGET("avx512bw") explicit m512_word(Integer value) noexcept
+        : m512_word(lanes::set1(value)) {}
+
+    PINT_SIMD_TARGET("avx512bw") static Word load(const void *data) noexcept {
+        return Word(_mm512_loadu_si512(data));
+    }
+    PINT_SIMD_TARGET("avx512bw") void store(void *data) const noexcept {
+        _mm512_storeu_si512(data, value());
+    }
+
+    PINT_SIMD_TARGET("avx512bw") __m512i value() const noexcept {
+        return _mm512_loadu_si512(m_value);
+    }
+
+    // The same register viewed as word of other lanes
+    template<class Other>
+    PINT_SIMD_TARGET("avx512bw") Other as() const noexcept { return Other(value()); }
+
+    PINT_SIMD_TARGET("avx512bw") friend Word operator&(Word a, Word b) noexcept { return Word(_mm512_and_si512(a.value(), b.value())); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator|(Word a, Word b) noexcept { return Word(_mm512_or_si512(a.value(), b.value())); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator^(Word a, Word b) noexcept { return Word(_mm512_xor_si512(a.value(), b.value())); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator+(Word a, Word b) noexcept { return Word(lanes::add(a.value(), b.value())); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator-(Word a, Word b) noexcept { return Word(lanes::sub(a.value(), b.value())); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator~(Word a) noexcept {
+        return Word(_mm512_xor_si512(a.value(), _mm512_set1_epi32(-1)));
+    }
+
+    PINT_SIMD_TARGET("avx512bw") friend Word operator<<(Word a, size_t amount) noexcept { return Word(lanes::sll(a.value(), amount)); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator>>(Word a, size_t amount) noexcept { return Word(lanes::srl(a.value(), amount)); }
+
+    // Operations with masks, mask is broadcasted to all lanes
+    PINT_SIMD_TARGET("avx512bw") friend Word operator&(Word a, Integer b) noexcept { return a & Word(b); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator|(Word a, Integer b) noexcept { return a | Word(b); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator^(Word a, Integer b) noexcept { return a ^ Word(b); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator+(Word a, Integer b) noexcept { return a + Word(b); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator-(Word a, Integer b) noexcept { return a - Word(b); }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator&(Integer a, Word b) noexcept { return Word(a) & b; }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator|(Integer a, Word b) noexcept { return Word(a) | b; }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator^(Integer a, Word b) noexcept { return Word(a) ^ b; }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator+(Integer a, Word b) noexcept { return Word(a) + b; }
+    PINT_SIMD_TARGET("avx512bw") friend Word operator-(Integer a, Word b) noexcept { return Word(a) - b; }
+
+private:
+    long long m_value[sizeof(__m512i) / sizeof(long long)];
+};
+
+} // namespace detail
+
+template<class Integer>
+class word<Integer, sse2> : public detail::m128_word<word<Integer, sse2>, Integer> {
+public:
+    using isa = sse2;
+
+    PINT_SIMD_TARGET("sse2") explicit word(__m128i value) noexcept : detail::m128_word<word, Integer>(value) {}
+    PINT_SIMD_TARGET("sse2") explicit word(Integer value) noexcept : detail::m128_word<word, Integer>(value) {}
+};
+
+template<class Integer>
+class word<Integer, sse41> : public detail::m128_word<word<Integer, sse41>, Integer> {
+public:
+    using isa = sse41;
+
+    PINT_SIMD_TARGET("sse2") explicit word(__m128i value) noexcept : detail::m128_word<word, Integer>(value) {}
+    PINT_SIMD_TARGET("sse2") explicit word(Integer value) noexcept : detail::m128_word<word, Integer>(value) {}
+};
+
+template<class Integer>
+class word<Integer, avx2> : public detail::m256_word<word<Integer, avx2>, Integer> {
+public:
+    using isa = avx2;
+
+    PINT_SIMD_TARGET("avx2") explicit word(__m256i value) noexcept : detail::m256_word<word, Integer>(value) {}
+    PINT_SIMD_TARGET("avx2") explicit word(Integer value) noexcept : detail::m256_word<word, Integer>(value) {}
+};
+
+template<class Integer>
+class word<Integer, avx512bw> : public detail::m512_word<word<Integer, avx512bw>, Integer> {
+public:
+    using isa = avx512bw;
+
+    PINT_SIMD_TARGET("avx512bw") explicit word(__m512i value) noexcept : detail::m512_word<word, Integer>(value) {}
+    PINT_SIMD_TARGET("avx512bw") explicit word(Integer value) noexcept : detail::m512_word<word, Integer>(value) {}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Register used as storage of packed_int. Value of the register is Scalar,
+// packed values are added, subtracted and shifted in 64-bit lanes,
+// so packs can't cross boundaries of 64-bit lanes.
+// Operators are forwarded to the word of 64-bit lanes
+
+template<class Isa, class Scalar>
+class packed_register {
+    using lanes = word<uint64_t, Isa>;
+
+public:
+    using scalar_type = Scalar;
+
+    explicit packed_register(lanes value) noexcept : m_lanes(value) {}
+    explicit packed_register(Scalar value) noexcept : m_lanes(lanes::load(&value)) {}
+
+    explicit operator Scalar() const noexcept {
+        Scalar result;
+        m_lanes.store(&result);
+        return result;
+    }
+
+    auto value() const noexcept -> decltype(std::declval<lanes>().value()) { return m_lanes.value(); }
+
+    friend packed_register operator&(packed_register a, packed_register b) noexcept { return packed_register(a.m_lanes & b.m_lanes); }
+    friend packed_register operator|(packed_register a, packed_register b) noexcept { return packed_register(a.m_lanes | b.m_lanes); }
+    friend packed_register operator^(packed_register a, packed_register b) noexcept { return packed_register(a.m_lanes ^ b.m_lanes); }
+    friend packed_register operator+(packed_register a, packed_register b) noexcept { return packed_register(a.m_lanes + b.m_lanes); }
+    friend packed_register operator-(packed_register a, packed_register b) noexcept { return packed_register(a.m_lanes - b.m_lanes); }
+    friend packed_register operator~(packed_register a) noexcept { return packed_register(~a.m_lanes); }
+
+    friend packed_register operator<<(packed_register a, size_t amount) noexcept { return packed_register(a.m_lanes << amount); }
+    friend packed_register operator>>(packed_register a, size_t amount) noexcept { return packed_register(a.m_lanes >> amount); }
+
+    // Operations with masks
+    friend packed_register operator&(packed_register a, Scalar b) noexcept { return a & packed_register(b); }
+    friend packed_register operator|(packed_register a, Scalar b) noexcept { return a | packed_register(b); }
+    friend packed_register operator^(packed_register a, Scalar b) noexcept { return a ^ packed_register(b); }
+    friend packed_register operator+(packed_register a, Scalar b) noexcept { return a + packed_register(b); }
+    friend packed_register operator-(packed_register a, Scalar b) noexcept { return a - packed_register(b); }
+    friend packed_register operator&(Scalar a, packed_register b) noexcept { return packed_register(a) & b; }
+    friend packed_register operator|(Scalar a, packed_register b) noexcept { return packed_register(a) | b; }
+    friend packed_register operator^(Scalar a, packed_register b) noexcept { return packed_register(a) ^ b; }
+    friend packed_register operator+(Scalar a, packed_register b) noexcept { return packed_register(a) + b; }
+    friend packed_register operator-(Scalar a, packed_register b) noexcept { return packed_register(a) - b; }
+
+    friend bool operator==(packed_register a, packed_register b) noexcept { return Scalar(a) == Scalar(b); }
+    friend bool operator!=(packed_register a, packed_register b) noexcept { return Scalar(a) != Scalar(b); }
+
+private:
+    lanes m_lanes;
+};
+
+// 128-bit and 256-bit storage for packed_int, e.g. packed_int<simd::m128, 7, 7, ...>.
+// m256 requires AVX2, compile with -mavx2 to inline its operators
+using m128 = packed_register<sse2, uint128>;
+using m256 = packed_register<avx2, uint256>;
+
+// Native operation for words of instruction set Isa and instruction sets derived from it
+#define PINT_SIMD_NATIVE_OP(Isa, target, name, Lane, intrinsic) \
+    template<class Word> \
+    PINT_SIMD_TARGET(target) \
+    typename std::enable_if<std::is_base_of<Isa, typename Word::isa>::value, Word>::type \
+    name(Word a, Word b, size_t_<Lane>) noexcept { \
+        return Word(intrinsic(a.value(), b.value())); \
+    }
+
+PINT_SIMD_NATIVE_OP(sse2, "sse2", add_wrap, 8, _mm_add_epi8)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", add_wrap, 16, _mm_add_epi16)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", add_wrap, 32, _mm_add_epi32)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", add_wrap, 64, _mm_add_epi64)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", sub_wrap, 8, _mm_sub_epi8)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", sub_wrap, 16, _mm_sub_epi16)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", sub_wrap, 32, _mm_sub_epi32)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", sub_wrap, 64, _mm_sub_epi64)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", add_unsigned_saturate, 8, _mm_adds_epu8)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", add_unsigned_saturate, 16, _mm_adds_epu16)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", add_signed_saturate, 8, _mm_adds_epi8)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", add_signed_saturate, 16, _mm_adds_epi16)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", sub_unsigned_saturate, 8, _mm_subs_epu8)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", sub_unsigned_saturate, 16, _mm_subs_epu16)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", sub_signed_saturate, 8, _mm_subs_epi8)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", sub_signed_saturate, 16, _mm_subs_epi16)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", min_unsigned, 8, _mm_min_epu8)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", max_unsigned, 8, _mm_max_epu8)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", min_signed, 16, _mm_min_epi16)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", max_signed, 16, _mm_max_epi16)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", avg_unsigned, 8, _mm_avg_epu8)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", avg_unsigned, 16, _mm_avg_epu16)
+PINT_SIMD_NATIVE_OP(sse2, "sse2", sum_absdiff, 8, _mm_sad_epu8)
+
+PINT_SIMD_NATIVE_OP(sse41, "sse4.1", min_unsigned, 16, _mm_min_epu16)
+PINT_SIMD_NATIVE_OP(sse41, "sse4.1", min_unsigned, 32, _mm_min_epu32)
+PINT_SIMD_NATIVE_OP(sse41, "sse4.1", max_unsigned, 16, _mm_max_epu16)
+PINT_SIMD_NATIVE_OP(sse41, "sse4.1", max_unsigned, 32, _mm_max_epu32)
+PINT_SIMD_NATIVE_OP(sse41, "sse4.1", min_signed, 8, _mm_min_epi8)
+PINT_SIMD_NATIVE_OP(sse41, "sse4.1", min_signed, 32, _mm_min_epi32)
+PINT_SIMD_NATIVE_OP(sse41, "sse4.1", max_signed, 8, _mm_max_epi8)
+PINT_SIMD_NATIVE_OP(sse41, "sse4.1", max_signed, 32, _mm_max_epi32)
+
+PINT_SIMD_NATIVE_OP(avx2, "avx2", add_wrap, 8, _mm256_add_epi8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", add_wrap, 16, _mm256_add_epi16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", add_wrap, 32, _mm256_add_epi32)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", add_wrap, 64, _mm256_add_epi64)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", sub_wrap, 8, _mm256_sub_epi8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", sub_wrap, 16, _mm256_sub_epi16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", sub_wrap, 32, _mm256_sub_epi32)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", sub_wrap, 64, _mm256_sub_epi64)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", add_unsigned_saturate, 8, _mm256_adds_epu8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", add_unsigned_saturate, 16, _mm256_adds_epu16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", add_signed_saturate, 8, _mm256_adds_epi8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", add_signed_saturate, 16, _mm256_adds_epi16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", sub_unsigned_saturate, 8, _mm256_subs_epu8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", sub_unsigned_saturate, 16, _mm256_subs_epu16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", sub_signed_saturate, 8, _mm256_subs_epi8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", sub_signed_saturate, 16, _mm256_subs_epi16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", min_unsigned, 8, _mm256_min_epu8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", min_unsigned, 16, _mm256_min_epu16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", min_unsigned, 32, _mm256_min_epu32)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", max_unsigned, 8, _mm256_max_epu8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", max_unsigned, 16, _mm256_max_epu16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", max_unsigned, 32, _mm256_max_epu32)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", min_signed, 8, _mm256_min_epi8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", min_signed, 16, _mm256_min_epi16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", min_signed, 32, _mm256_min_epi32)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", max_signed, 8, _mm256_max_epi8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", max_signed, 16, _mm256_max_epi16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", max_signed, 32, _mm256_max_epi32)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", avg_unsigned, 8, _mm256_avg_epu8)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", avg_unsigned, 16, _mm256_avg_epu16)
+PINT_SIMD_NATIVE_OP(avx2, "avx2", sum_absdiff, 8, _mm256_sad_epu8)
+
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", add_wrap, 8, _mm512_add_epi8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", add_wrap, 16, _mm512_add_epi16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", add_wrap, 32, _mm512_add_epi32)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", add_wrap, 64, _mm512_add_epi64)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", sub_wrap, 8, _mm512_sub_epi8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", sub_wrap, 16, _mm512_sub_epi16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", sub_wrap, 32, _mm512_sub_epi32)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", sub_wrap, 64, _mm512_sub_epi64)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", add_unsigned_saturate, 8, _mm512_adds_epu8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", add_unsigned_saturate, 16, _mm512_adds_epu16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", add_signed_saturate, 8, _mm512_adds_epi8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", add_signed_saturate, 16, _mm512_adds_epi16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", sub_unsigned_saturate, 8, _mm512_subs_epu8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", sub_unsigned_saturate, 16, _mm512_subs_epu16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", sub_signed_saturate, 8, _mm512_subs_epi8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", sub_signed_saturate, 16, _mm512_subs_epi16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", min_unsigned, 8, _mm512_min_epu8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", min_unsigned, 16, _mm512_min_epu16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", min_unsigned, 32, detail::avx512_min_epu32)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", min_unsigned, 64, detail::avx512_min_epu64)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", max_unsigned, 8, _mm512_max_epu8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", max_unsigned, 16, _mm512_max_epu16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", max_unsigned, 32, detail::avx512_max_epu32)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", max_unsigned, 64, detail::avx512_max_epu64)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", min_signed, 8, _mm512_min_epi8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", min_signed, 16, _mm512_min_epi16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", min_signed, 32, detail::avx512_min_epi32)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", min_signed, 64, detail::avx512_min_epi64)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", max_signed, 8, _mm512_max_epi8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", max_signed, 16, _mm512_max_epi16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", max_signed, 32, detail::avx512_max_epi32)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", max_signed, 64, detail::avx512_max_epi64)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", avg_unsigned, 8, _mm512_avg_epu8)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", avg_unsigned, 16, _mm512_avg_epu16)
+PINT_SIMD_NATIVE_OP(avx512bw, "avx512bw", sum_absdiff, 8, _mm512_sad_epu8)
+
+#undef PINT_SIMD_NATIVE_OP
+
+namespace detail {
+
+// Bit counts of bytes: counts of low and high nibbles are looked up
+// in a register by pshufb. Bytes are summed into wider lanes by multiply-add
+// of adjacent lanes (16 and 32 bits) or by psadbw with zero (64 bits)
+template<class Isa> struct byte_popcount;
+
+template<> struct byte_popcount<sse41> {
+    PINT_SIMD_TARGET("sse4.1") static __m128i count(__m128i a) {
+        const __m128i table = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m128i nibbles = _mm_set1_epi8(0x0F);
+        return _mm_add_epi8(_mm_shuffle_epi8(table, _mm_and_si128(a, nibbles)),
+            _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(a, 4), nibbles)));
+    }
+    PINT_SIMD_TARGET("sse4.1") static __m128i sum8(__m128i a) { return a; }
+    PINT_SIMD_TARGET("sse4.1") static __m128i sum16(__m128i a) { return _mm_maddubs_epi16(a, _mm_set1_epi8(1)); }
+    PINT_SIMD_TARGET("sse4.1") static __m128i sum32(__m128i a) { return _mm_madd_epi16(sum16(a), _mm_set1_epi16(1)); }
+    PINT_SIMD_TARGET("sse4.1") static __m128i sum64(__m128i a) { return _mm_sad_epu8(a, _mm_setzero_si128()); }
+};
+
+template<> struct byte_popcount<avx2> {
+    PINT_SIMD_TARGET("avx2") static __m256i count(__m256i a) {
+        const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i nibbles = _mm256_set1_epi8(0x0F);
+        return _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(a, nibbles)),
+            _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(a, 4), nibbles)));
+    }
+    PINT_SIMD_TARGET("avx2") static __m256i sum8(__m256i a) { return a; }
+    PINT_SIMD_TARGET("avx2") static __m256i sum16(__m256i a) { return _mm256_maddubs_epi16(a, _mm256_set1_epi8(1)); }
+    PINT_SIMD_TARGET("avx2") static __m256i sum32(__m256i a) { return _mm256_madd_epi16(sum16(a), _mm256_set1_epi16(1)); }
+    PINT_SIMD_TARGET("avx2") static __m256i sum64(__m256i a) { return _mm256_sad_epu8(a, _mm256_setzero_si256()); }
+};
+
+template<> struct byte_popcount<avx512bw> {
+    PINT_SIMD_TARGET("avx512bw") static __m512i count(__m512i a) {
+        // Unmasked broadcast triggers false -Wmaybe-uninitialized in GCC headers
+        const __m512i table = _mm512_maskz_broadcast_i32x4(static_cast<__mmask16>(-1),
+            _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+        const __m512i nibbles = _mm512_set1_epi8(0x0F);
+        return _mm512_add_epi8(_mm512_shuffle_epi8(table, _mm512_and_si512(a, nibbles)),
+            _mm512_shuffle_epi8(table, _mm512_and_si512(_mm512_srli_epi16(a, 4), nibbles)));
+    }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sum8(__m512i a) { return a; }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sum16(__m512i a) { return _mm512_maddubs_epi16(a, _mm512_set1_epi8(1)); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sum32(__m512i a) { return _mm512_madd_epi16(sum16(a), _mm512_set1_epi16(1)); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i sum64(__m512i a) { return _mm512_sad_epu8(a, _mm512_setzero_si512()); }
+};
+
+} // namespace detail
+
+// pshufb requires SSSE3, it is used from sse4.1 level
+#define PINT_SIMD_POPCOUNT_OP(Isa, target, Lane, sum) \
+    template<class Word> \
+    PINT_SIMD_TARGET(target) \
+    typename std::enable_if<std::is_base_of<Isa, typename Word::isa>::value, Word>::type \
+    popcount_lanes(Word a, size_t_<Lane>) noexcept { \
+        return Word(detail::byte_popcount<Isa>::sum(detail::byte_popcount<Isa>::count(a.value()))); \
+    }
+
+PINT_SIMD_POPCOUNT_OP(sse41, "sse4.1", 8, sum8)
+PINT_SIMD_POPCOUNT_OP(sse41, "sse4.1", 16, sum16)
+PINT_SIMD_POPCOUNT_OP(sse41, "sse4.1", 32, sum32)
+PINT_SIMD_POPCOUNT_OP(sse41, "sse4.1", 64, sum64)
+PINT_SIMD_POPCOUNT_OP(avx2, "avx2", 8, sum8)
+PINT_SIMD_POPCOUNT_OP(avx2, "avx2", 16, sum16)
+PINT_SIMD_POPCOUNT_OP(avx2, "avx2", 32, sum32)
+PINT_SIMD_POPCOUNT_OP(avx2, "avx2", 64, sum64)
+PINT_SIMD_POPCOUNT_OP(avx512bw, "avx512bw", 8, sum8)
+PINT_SIMD_POPCOUNT_OP(avx512bw, "avx512bw", 16, sum16)
+PINT_SIMD_POPCOUNT_OP(avx512bw, "avx512bw", 32, sum32)
+PINT_SIMD_POPCOUNT_OP(avx512bw, "avx512bw", 64, sum64)
+
+#undef PINT_SIMD_POPCOUNT_OP
+
+// VPOPCNT instructions, callers must be compiled for PINT_SIMD_VPOPCNT_TARGET
+#define PINT_SIMD_VPOPCNT_TARGET "avx512bw,avx512bitalg,avx512vpopcntdq"
+
+#define PINT_SIMD_VPOPCNT_OP(Lane, intrinsic) \
+    template<class Word> \
+    PINT_SIMD_TARGET(PINT_SIMD_VPOPCNT_TARGET) \
+    typename std::enable_if<std::is_same<avx512bw, typename Word::isa>::value, Word>::type \
+    popcount_lanes(Word a, size_t_<Lane>, vpopcnt) noexcept { \
+        return Word(intrinsic(a.value())); \
+    }
+
+PINT_SIMD_VPOPCNT_OP(8, _mm512_popcnt_epi8)
+PINT_SIMD_VPOPCNT_OP(16, _mm512_popcnt_epi16)
+PINT_SIMD_VPOPCNT_OP(32, _mm512_popcnt_epi32)
+PINT_SIMD_VPOPCNT_OP(64, _mm512_popcnt_epi64)
+
+#undef PINT_SIMD_VPOPCNT_OP
+
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversion between lane sizes. Narrow lanes take a part of the register
+// in memory, they are loaded into the low bytes and extended, or truncated
+// into the low bytes and stored
+
+template<size_t Bytes> struct partial_register;
+
+template<> struct partial_register<2> {
+    PINT_SIMD_TARGET("sse2") static __m128i load(const void *data) {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return _mm_cvtsi32_si128(value);
+    }
+    PINT_SIMD_TARGET("sse2") static void store(void *data, __m128i value) {
+        const uint16_t low = static_cast<uint16_t>(_mm_cvtsi128_si32(value));
+        std::memcpy(data, &low, sizeof(low));
+    }
+};
+
+template<> struct partial_register<4> {
+    PINT_SIMD_TARGET("sse2") static __m128i load(const void *data) {
+        int value;
+        std::memcpy(&value, data, sizeof(value));
+        return _mm_cvtsi32_si128(value);
+    }
+    PINT_SIMD_TARGET("sse2") static void store(void *data, __m128i value) {
+        const int low = _mm_cvtsi128_si32(value);
+        std::memcpy(data, &low, sizeof(low));
+    }
+};
+
+template<> struct partial_register<8> {
+    PINT_SIMD_TARGET("sse2") static __m128i load(const void *data) { return _mm_loadl_epi64(static_cast<const __m128i *>(data)); }
+    PINT_SIMD_TARGET("sse2") static void store(void *data, __m128i value) { _mm_storel_epi64(static_cast<__m128i *>(data), value); }
+};
+
+template<> struct partial_register<16> {
+    PINT_SIMD_TARGET("sse2") static __m128i load(const void *data) { return _mm_loadu_si128(static_cast<const __m128i *>(data)); }
+    PINT_SIMD_TARGET("sse2") static void store(void *data, __m128i value) { _mm_storeu_si128(static_cast<__m128i *>(data), value); }
+};
+
+template<> struct partial_register<32> {
+    PINT_SIMD_TARGET("avx2") static __m256i load(const void *data) { return _mm256_loadu_si256(static_cast<const __m256i *>(data)); }
+    PINT_SIMD_TARGET("avx2") static void store(void *data, __m256i value) { _mm256_storeu_si256(static_cast<__m256i *>(data), value); }
+};
+
+// SSE2 extends lanes of the low half of register to lanes twice as wide
+// by interleaving them with zeros or sign masks. Lanes are truncated to the
+// low half by saturating pack of values which fit, or by shuffle of dwords
+template<size_t Lane> struct sse2_lane_step;
+
+template<> struct sse2_lane_step<8> {
+    PINT_SIMD_TARGET("sse2") static __m128i zero_extend(__m128i a) { return _mm_unpacklo_epi8(a, _mm_setzero_si128()); }
+    PINT_SIMD_TARGET("sse2") static __m128i sign_extend(__m128i a) { return _mm_unpacklo_epi8(a, _mm_cmplt_epi8(a, _mm_setzero_si128())); }
+    PINT_SIMD_TARGET("sse2") static __m128i truncate(__m128i a) {
+        const __m128i low = _mm_and_si128(a, _mm_set1_epi16(0xFF));
+        return _mm_packus_epi16(low, low);
+    }
+};
+
+template<> struct sse2_lane_step<16> {
+    PINT_SIMD_TARGET("sse2") static __m128i zero_extend(__m128i a) { return _mm_unpacklo_epi16(a, _mm_setzero_si128()); }
+    PINT_SIMD_TARGET("sse2") static __m128i sign_extend(__m128i a) { return _mm_unpacklo_epi16(a, _mm_srai_epi16(a, 15)); }
+    PINT_SIMD_TARGET("sse2") static __m128i truncate(__m128i a) {
+        const __m128i low = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        return _mm_packs_epi32(low, low);
+    }
+};
+
+template<> struct sse2_lane_step<32> {
+    PINT_SIMD_TARGET("sse2") static __m128i zero_extend(__m128i a) { return _mm_unpacklo_epi32(a, _mm_setzero_si128()); }
+    PINT_SIMD_TARGET("sse2") static __m128i sign_extend(__m128i a) { return _mm_unpacklo_epi32(a, _mm_srai_epi32(a, 31)); }
+    PINT_SIMD_TARGET("sse2") static __m128i truncate(__m128i a) { return _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0)); }
+};
+
+// Steps between Narrow and Lane bits
+template<size_t Narrow, size_t Lane> struct sse2_lane_steps {
+    using step = sse2_lane_step<Narrow>;
+    using next = sse2_lane_steps<2 * Narrow, Lane>;
+
+    PINT_SIMD_TARGET("sse2") static __m128i zero_extend(__m128i a) { return next::zero_extend(step::zero_extend(a)); }
+    PINT_SIMD_TARGET("sse2") static __m128i sign_extend(__m128i a) { return next::sign_extend(step::sign_extend(a)); }
+    PINT_SIMD_TARGET("sse2") static __m128i truncate(__m128i a) {
+        return sse2_lane_steps<Narrow, Lane / 2>::truncate(sse2_lane_step<Lane / 2>::truncate(a));
+    }
+};
+
+template<size_t Lane> struct sse2_lane_steps<Lane, Lane> {
+    PINT_SIMD_TARGET("sse2") static __m128i zero_extend(__m128i a) { return a; }
+    PINT_SIMD_TARGET("sse2") static __m128i sign_extend(__m128i a) { return a; }
+    PINT_SIMD_TARGET("sse2") static __m128i truncate(__m128i a) { return a; }
+};
+
+template<class Isa, size_t Narrow, size_t Lane> struct convert_lanes;
+
+template<size_t Narrow, size_t Lane> struct convert_lanes<sse2, Narrow, Lane> {
+    using part = partial_register<16 * Narrow / Lane>;
+    using steps = sse2_lane_steps<Narrow, Lane>;
+
+    PINT_SIMD_TARGET("sse2") static __m128i load_zero_extend(const void *data) { return steps::zero_extend(part::load(data)); }
+    PINT_SIMD_TARGET("sse2") static __m128i load_sign_extend(const void *data) { return steps::sign_extend(part::load(data)); }
+    PINT_SIMD_TARGET("sse2") static void store_truncate(void *data, __m128i value) { part::store(data, steps::truncate(value)); }
+};
+
+// AVX2 truncates lanes within 128-bit halves, as SSE2 does, and joins halves
+// into the low half. The rest of steps are done by SSE2 on the low half
+template<size_t Lane> struct avx2_lane_step;
+
+template<> struct avx2_lane_step<8> {
+    PINT_SIMD_TARGET("avx2") static __m128i truncate(__m256i a) {
+        const __m256i low = _mm256_and_si256(a, _mm256_set1_epi16(0xFF));
+        return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(low, low), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+};
+
+template<> struct avx2_lane_step<16> {
+    PINT_SIMD_TARGET("avx2") static __m128i truncate(__m256i a) {
+        const __m256i low = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+        return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packs_epi32(low, low), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+};
+
+template<> struct avx2_lane_step<32> {
+    PINT_SIMD_TARGET("avx2") static __m128i truncate(__m256i a) {
+        return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(a, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7)));
+    }
+};
+
+template<class Isa, size_t Narrow, size_t Lane> struct extend_lanes;
+
+template<size_t Narrow, size_t Lane> struct convert_lanes<avx2, Narrow, Lane> {
+    using extend = extend_lanes<avx2, Narrow, Lane>;
+
+    PINT_SIMD_TARGET("avx2") static __m256i load_zero_extend(const void *data) { return extend::zero_extend(data); }
+    PINT_SIMD_TARGET("avx2") static __m256i load_sign_extend(const void *data) { return extend::sign_extend(data); }
+    PINT_SIMD_TARGET("avx2") static void store_truncate(void *data, __m256i value) {
+        partial_register<32 * Narrow / Lane>::store(data,
+            sse2_lane_steps<Narrow, Lane / 2>::truncate(avx2_lane_step<Lane / 2>::truncate(value)));
+    }
+};
+
+template<class Isa, size_t Narrow, size_t Lane> struct truncate_lanes;
+
+template<size_t Narrow, size_t Lane> struct convert_lanes<avx512bw, Narrow, Lane> {
+    using extend = extend_lanes<avx512bw, Narrow, Lane>;
+
+    PINT_SIMD_TARGET("avx512bw") static __m512i load_zero_extend(const void *data) { return extend::zero_extend(data); }
+    PINT_SIMD_TARGET("avx512bw") static __m512i load_sign_extend(const void *data) { return extend::sign_extend(data); }
+    PINT_SIMD_TARGET("avx512bw") static void store_truncate(void *data, __m512i value) {
+        truncate_lanes<avx512bw, Narrow, Lane>::store(data, value);
+    }
+};
+
+// Lanes extended by vpmovzx / vpmovsx, Bytes of narrow lanes are loaded
+#define PINT_SIMD_EXTEND_LANES(Isa, target, Register, Narrow, Lane, Bytes, zero, sign) \
+    template<> struct extend_lanes<Isa, Narrow, Lane> { \
+        PINT_SIMD_TARGET(target) static Register zero_extend(const void *data) { \
+            return zero(partial_register<Bytes>::load(data)); \
+        } \
+        PINT_SIMD_TARGET(target) static Register sign_extend(const void *data) { \
+            return sign(partial_register<Bytes>::load(data)); \
+        } \
+    };
+
+PINT_SIMD_EXTEND_LANES(avx2, "avx2", __m256i, 8, 16, 16, _mm256_cvtepu8_epi16, _mm256_cvtepi8_epi16)
+PINT_SIMD_EXTEND_LANES(avx2, "avx2", __m256i, 8, 32, 8, _mm256_cvtepu8_epi32, _mm256_cvtepi8_epi32)
+PINT_SIMD_EXTEND_LANES(avx2, "avx2", __m256i, 8, 64, 4, _mm256_cvtepu8_epi64, _mm256_cvtepi8_epi64)
+PINT_SIMD_EXTEND_LANES(avx2, "avx2", __m256i, 16, 32, 16, _mm256_cvtepu16_epi32, _mm256_cvtepi16_epi32)
+PINT_SIMD_EXTEND_LANES(avx2, "avx2", __m256i, 16, 64, 8, _mm256_cvtepu16_epi64, _mm256_cvtepi16_epi64)
+PINT_SIMD_EXTEND_LANES(avx2, "avx2", __m256i, 32, 64, 16, _mm256_cvtepu32_epi64, _mm256_cvtepi32_epi64)
+
+// AVX-512 instructions are zero-masked with all lanes enabled, so there are
+// no undefined sources
+#define PINT_SIMD_EXTEND_LANES_512(Narrow, Lane, Bytes, Mask, zero, sign) \
+    template<> struct extend_lanes<avx512bw, Narrow, Lane> { \
+        PINT_SIMD_TARGET("avx512bw") static __m512i zero_extend(const void *data) { \
+            return zero(static_cast<Mask>(~0), partial_register<Bytes>::load(data)); \
+        } \
+        PINT_SIMD_TARGET("avx512bw") static __m512i sign_extend(const void *data) { \
+            return sign(static_cast<Mask>(~0), partial_register<Bytes>::load(data)); \
+        } \
+    };
+
+PINT_SIMD_EXTEND_LANES_512(8, 16, 32, __mmask32, _mm512_maskz_cvtepu8_epi16, _mm512_maskz_cvtepi8_epi16)
+PINT_SIMD_EXTEND_LANES_512(8, 32, 16, __mmask16, _mm512_maskz_cvtepu8_epi32, _mm512_maskz_cvtepi8_epi32)
+PINT_SIMD_EXTEND_LANES_512(8, 64, 8, __mmask8, _mm512_maskz_cvtepu8_epi64, _mm512_maskz_cvtepi8_epi64)
+PINT_SIMD_EXTEND_LANES_512(16, 32, 32, __mmask16, _mm512_maskz_cvtepu16_epi32, _mm512_maskz_cvtepi16_epi32)
+PINT_SIMD_EXTEND_LANES_512(16, 64, 16, __mmask8, _mm512_maskz_cvtepu16_epi64, _mm512_maskz_cvtepi16_epi64)
+PINT_SIMD_EXTEND_LANES_512(32, 64, 32, __mmask8, _mm512_maskz_cvtepu32_epi64, _mm512_maskz_cvtepi32_epi64)
+
+#undef PINT_SIMD_EXTEND_LANES
+#undef PINT_SIMD_EXTEND_LANES_512
+
+// Lanes truncated by vpmov, Bytes of narrow lanes are stored
+#define PINT_SIMD_TRUNCATE_LANES(Narrow, Lane, Bytes, Mask, intrinsic) \
+    template<> struct truncate_lanes<avx512bw, Narrow, Lane> { \
+        PINT_SIMD_TARGET("avx512bw") static void store(void *data, __m512i value) { \
+            partial_register<Bytes>::store(data, intrinsic(static_cast<Mask>(~0), value)); \
+        } \
+    };
+
+PINT_SIMD_TRUNCATE_LANES(8, 16, 32, __mmask32, _mm512_maskz_cvtepi16_epi8)
+PINT_SIMD_TRUNCATE_LANES(8, 32, 16, __mmask16, _mm512_maskz_cvtepi32_epi8)
+PINT_SIMD_TRUNCATE_LANES(8, 64, 8, __mmask8, _mm512_maskz_cvtepi64_epi8)
+PINT_SIMD_TRUNCATE_LANES(16, 32, 32, __mmask16, _mm512_maskz_cvtepi32_epi16)
+PINT_SIMD_TRUNCATE_LANES(16, 64, 16, __mmask8, _mm512_maskz_cvtepi64_epi16)
+PINT_SIMD_TRUNCATE_LANES(32, 64, 32, __mmask8, _mm512_maskz_cvtepi64_epi32)
+
+#undef PINT_SIMD_TRUNCATE_LANES
+
+} // namespace detail
+
+#define PINT_SIMD_CONVERT_OP(Isa, target) \
+    template<class Word, size_t Narrow, size_t Lane> \
+    PINT_SIMD_TARGET(target) \
+    typename std::enable_if<std::is_base_of<Isa, typename Word::isa>::value && (Narrow < Lane), Word>::type \
+    load_zero_extend(const void *data, size_t_<Narrow>, size_t_<Lane>) noexcept { \
+        return Word(detail::convert_lanes<Isa, Narrow, Lane>::load_zero_extend(data)); \
+    } \
+    template<class Word, size_t Narrow, size_t Lane> \
+    PINT_SIMD_TARGET(target) \
+    typename std::enable_if<std::is_base_of<Isa, typename Word::isa>::value && (Narrow < Lane), Word>::type \
+    load_sign_extend(const void *data, size_t_<Narrow>, size_t_<Lane>) noexcept { \
+        return Word(detail::convert_lanes<Isa, Narrow, Lane>::load_sign_extend(data)); \
+    } \
+    template<class Word, size_t Narrow, size_t Lane> \
+    PINT_SIMD_TARGET(target) \
+    typename std::enable_if<std::is_base_of<Isa, typename Word::isa>::value && (Narrow < Lane)>::type \
+    store_truncate(void *data, Word value, size_t_<Narrow>, size_t_<Lane>) noexcept { \
+        detail::convert_lanes<Isa, Narrow, Lane>::store_truncate(data, value.value()); \
+    }
+
+PINT_SIMD_CONVERT_OP(sse2, "sse2")
+PINT_SIMD_CONVERT_OP(avx2, "avx2")
+PINT_SIMD_CONVERT_OP(avx512bw, "avx512bw")
+
+#undef PINT_SIMD_CONVERT_OP
+
+#endif // PINT_SIMD_X86
+
+///////////////////////////////////////////////////////////////////////////////
+// Dispatch
+
+namespace detail {
+
+// Call function with the tag of instruction set. The function is inlined
+// into the code compiled for that instruction set
+template<class Function>
+void run(const Function &function, none) { function(none()); }
+
+#ifdef PINT_SIMD_X86
+
+template<class Function>
+PINT_SIMD_TARGET("sse2") PINT_SIMD_FLATTEN
+void run(const Function &function, sse2) { function(sse2()); }
+
+template<class Function>
+PINT_SIMD_TARGET("sse4.1") PINT_SIMD_FLATTEN
+void run(const Function &function, sse41) { function(sse41()); }
+
+template<class Function>
+PINT_SIMD_TARGET("avx2") PINT_SIMD_FLATTEN
+void run(const Function &function, avx2) { function(avx2()); }
+
+template<class Function>
+PINT_SIMD_TARGET("avx512bw") PINT_SIMD_FLATTEN
+void run(const Function &function, avx512bw) { function(avx512bw()); }
+
+#endif // PINT_SIMD_X86
+
+} // namespace detail
+
+// Call function with the tag of instruction set selected by current_level().
+// Function must accept tags of all instruction sets
+template<class Function>
+void dispatch(const Function &function) {
+    switch (current_level()) {
+#ifdef PINT_SIMD_X86
+    case level::avx512bw:
+        return detail::run(function, avx512bw());
+    case level::avx2:
+        return detail::run(function, avx2());
+    case level::sse41:
+        return detail::run(function, sse41());
+    case level::sse2:
+        return detail::run(function, sse2());
+#endif
+    default:
+        return detail::run(function, none());
+    }
+}
+
+} // namespace simd
+
+namespace detail {
+
+template<class Integer, class Isa>
+struct word_traits<simd::word<Integer, Isa>> {
+    using scalar_type = Integer;
+    using lane_type = Integer;
+    static const size_t lane_bits = sizeof(Integer) * 8;
+};
+
+#ifdef PINT_SIMD_X86
+
+template<class Isa, class Scalar>
+struct word_traits<simd::packed_register<Isa, Scalar>> {
+    using scalar_type = Scalar;
+    using lane_type = uint64_t;
+    static const size_t lane_bits = 64;
+};
+
+template<class Isa, class Scalar>
+struct is_unsigned_integer<simd::packed_register<Isa, Scalar>> : std::true_type {};
+
+#endif // PINT_SIMD_X86
+
+} // namespace detail
+} // namespace pint
@@ -0,0 +1,268 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "pint/bulk.hpp"
+#include "pint/unpack.hpp"
+
+namespace pint {
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////
+// Saturating counters Bits long, 64 / Bits counters per 64-bit word.
+// Counter N is pack N % (64 / Bits) of word N / (64 / Bits)
+
+template<size_t Bits>
+class counter_array {
+    static_assert(Bits <= 32 && 64 % Bits == 0, "Counters must fill 64-bit words");
+
+public:
+    using word_type = packed_int_from_seq<uint64_t, repeat<size_t_<Bits>, 64 / Bits>>;
+
+    static const size_t counters_per_word = 64 / Bits;
+    static const uint64_t max_count = all_ones<uint64_t, Bits>::value;
+
+    explicit counter_array(size_t size)
+        : m_words((size + counters_per_word - 1) / counters_per_word, word_type(uint64_t(0))) {}
+
+    size_t size_bytes() const noexcept { return m_words.size() * sizeof(word_type); }
+    const word_type *words() const noexcept { return m_words.data(); }
+
+    uint64_t get(size_t index) const noexcept {
+        return (m_words[index / counters_per_word].value() >> shift(index)) & max_count;
+    }
+
+    // Add amount to counter, it stays at max_count on overflow
+    void add(size_t index, uint64_t amount) noexcept {
+        word_type &word = m_words[index / counters_per_word];
+        word = pint::add_unsigned_saturate(word, word_type(std::min(amount, max_count) << shift(index)));
+    }
+
+    // Subtract amount from counter, it stops at zero. Saturated counter
+    // doesn't know its real value any more, so it isn't decremented
+    void sub(size_t index, uint64_t amount) noexcept {
+        word_type &word = m_words[index / counters_per_word];
+        const uint64_t saturated = static_cast<uint64_t>(get(index) == max_count);
+        word = pint::sub_unsigned_saturate(word, word_type((std::min(amount, max_count) * (1 - saturated)) << shift(index)));
+    }
+
+    void clear() noexcept { std::fill(m_words.begin(), m_words.end(), word_type(uint64_t(0))); }
+
+private:
+    static size_t shift(size_t index) noexcept { return index % counters_per_word * Bits; }
+
+    std::vector<word_type> m_words;
+};
+
+template<size_t Bits> const uint64_t counter_array<Bits>::max_count;
+
+// Probe positions of key by double hashing: hash + i * step, step is odd,
+// so probes of the same key don't repeat within power of 2 range
+struct probes {
+    uint64_t hash;
+    uint64_t step;
+
+    probes() noexcept : hash(0), step(1) {}
+    explicit probes(uint64_t key_hash) noexcept
+        : hash(key_hash), step(mix(key_hash) | 1) {}
+
+    size_t operator()(size_t i, size_t mask) const noexcept { return static_cast<size_t>((hash + i * step) & mask); }
+
+    // Finalizer of MurmurHash3
+    static uint64_t mix(uint64_t value) noexcept {
+        value = (value ^ (value >> 33)) * 0xff51afd7ed558ccdULL;
+        value = (value ^ (value >> 33)) * 0xc4ceb53fe1a85ec9ULL;
+        return value ^ (value >> 33);
+    }
+};
+
+inline size_t round_up_pow2(size_t value) noexcept {
+    size_t result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+// Minimum of counters of each key over all its probes. Counters of consecutive
+// keys are gathered into words, pack N of word is the counter of key N,
+// so minimum of a block of keys is taken by bulk min_unsigned at once.
+// Position maps probes of the key and probe number to index of counter
+template<size_t Bits, class Position>
+void query_min(const counter_array<Bits> &counters, const uint64_t *hashes, size_t count,
+    size_t probe_count, Position position, uint32_t *out)
+{
+    using word_type = typename counter_array<Bits>::word_type;
+    const size_t per_word = counter_array<Bits>::counters_per_word;
+    const size_t block_words = 32;
+    const size_t block_keys = block_words * per_word;
+
+    // Packed integers aren't default constructible, words are constructed
+    // by the first probe
+    typename std::aligned_storage<sizeof(word_type) * block_words, alignof(word_type)>::type
+        minimum_storage, gathered_storage;
+    word_type *minimum = reinterpret_cast<word_type *>(&minimum_storage);
+    word_type *gathered = reinterpret_cast<word_type *>(&gathered_storage);
+    probes key_probes[block_keys];
+    uint32_t values[block_keys];
+
+    for (size_t first = 0; first < count; first += block_keys) {
+        const size_t keys = std::min(block_keys, count - first);
+        const size_t words = (keys + per_word - 1) / per_word;
+
+        for (size_t i = 0; i < keys; ++i)
+            key_probes[i] = probes(hashes[first + i]);
+
+        for (size_t probe = 0; probe < probe_count; ++probe) {
+            word_type *target = probe == 0 ? minimum : gathered;
+            for (size_t w = 0; w < words; ++w) {
+                uint64_t word = 0;
+                for (size_t i = 0; i < per_word && w * per_word + i < keys; ++i)
+                    word |= counters.get(position(key_probes[w * per_word + i], probe)) << (i * Bits);
+                new (target + w) word_type(word);
+            }
+
+            if (probe != 0)
+                pint::min_unsigned(minimum, gathered, minimum, words);
+        }
+
+        pint::unpack(minimum, values, words);
+        std::copy(values, values + keys, out + first);
+    }
+}
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// Count-min sketch with Bits-bit saturating counters (4 and 8 bits are
+// typical). Keys are given by their 64-bit hashes. Each of `depth` rows has
+// `width` counters (rounded up to power of 2), key increments one counter
+// in each row, estimate of its count is the minimum of them
+
+template<size_t Bits>
+class count_min_sketch {
+public:
+    static const uint64_t max_count = detail::counter_array<Bits>::max_count;
+
+    count_min_sketch(size_t width, size_t depth)
+        : m_width(detail::round_up_pow2(width)), m_depth(std::max<size_t>(depth, 1)), m_counters(m_width * m_depth) {}
+
+    size_t width() const noexcept { return m_width; }
+    size_t depth() const noexcept { return m_depth; }
+    size_t size_bytes() const noexcept { return m_counters.size_bytes(); }
+
+    void insert(uint64_t hash, uint64_t count = 1) noexcept {
+        const detail::probes probes(hash);
+        for (size_t row = 0; row < m_depth; ++row)
+            m_counters.add(row * m_width + probes(row, m_width - 1), count);
+    }
+
+    void insert(const uint64_t *hashes, size_t count) noexcept {
+        for (size_t i = 0; i < count; ++i)
+            insert(hashes[i]);
+    }
+
+    // Estimated count, it is never less than the real count (unless it saturated)
+    uint64_t query(uint64_t hash) const noexcept {
+        const detail::probes probes(hash);
+        uint64_t result = max_count;
+        for (size_t row = 0; row < m_depth; ++row)
+            result = std::min(result, m_counters.get(row * m_width + probes(row, m_width - 1)));
+        return result;
+    }
+
+    void query(const uint64_t *hashes, uint32_t *out, size_t count) const noexcept {
+        const size_t width = m_width;
+        detail::query_min(m_counters, hashes, count, m_depth,
+            [width](const detail::probes &probes, size_t row) { return row * width + probes(row, width - 1); },
+            out);
+    }
+
+    void clear() noexcept { m_counters.clear(); }
+
+private:
+    size_t m_width;
+    size_t m_depth;
+    detail::counter_array<Bits> m_counters;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Counting Bloom filter with Bits-bit saturating counters. Key increments
+// `hash_count` counters of the single array (size is rounded up to power of 2),
+// erase decrements them. Saturated counters are never decremented, so
+// erase doesn't cause false negatives
+
+template<size_t Bits>
+class counting_bloom {
+public:
+    static const uint64_t max_count = detail::counter_array<Bits>::max_count;
+
+    counting_bloom(size_t size, size_t hash_count)
+        : m_size(detail::round_up_pow2(size)), m_hash_count(std::max<size_t>(hash_count, 1)), m_counters(m_size) {}
+
+    size_t size() const noexcept { return m_size; }
+    size_t hash_count() const noexcept { return m_hash_count; }
+    size_t size_bytes() const noexcept { return m_counters.size_bytes(); }
+
+    void insert(uint64_t hash) noexcept {
+        const detail::probes probes(hash);
+        for (size_t i = 0; i < m_hash_count; ++i)
+            m_counters.add(probes(i, m_size - 1), 1);
+    }
+
+    void insert(const uint64_t *hashes, size_t count) noexcept {
+        for (size_t i = 0; i < count; ++i)
+            insert(hashes[i]);
+    }
+
+    // Key must have been inserted before
+    void erase(uint64_t hash) noexcept {
+        const detail::probes probes(hash);
+        for (size_t i = 0; i < m_hash_count; ++i)
+            m_counters.sub(probes(i, m_size - 1), 1);
+    }
+
+    // Estimated number of insertions of the key, zero means it wasn't inserted
+    uint64_t count(uint64_t hash) const noexcept {
+        const detail::probes probes(hash);
+        uint64_t result = max_count;
+        for (size_t i = 0; i < m_hash_count; ++i)
+            result = std::min(result, m_counters.get(probes(i, m_size - 1)));
+        return result;
+    }
+
+    bool contains(uint64_t hash) const noexcept { return count(hash) != 0; }
+
+    void count(const uint64_t *hashes, uint32_t *out, size_t n) const noexcept {
+        const size_t mask = m_size - 1;
+        detail::query_min(m_counters, hashes, n, m_hash_count,
+            [mask](const detail::probes &probes, size_t i) { return probes(i, mask); },
+            out);
+    }
+
+    void clear() noexcept { m_counters.clear(); }
+
+private:
+    size_t m_size;
+    size_t m_hash_count;
+    detail::counter_array<Bits> m_counters;
+};
+
+} // namespace pint
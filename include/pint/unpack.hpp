@@ -0,0 +1,377 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+
+#include "pint/pint.hpp"
+#include "pint/simd.hpp"
+
+namespace pint {
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversion of packed integer to array of values, one value of type T
+// per pack, and back.
+//
+// Array is split into chunks of 64 bits: chunk holds 8 / sizeof(T) values,
+// whose packs are adjacent in packed integer. pdep deposits packs of the chunk
+// to their values at once, pext extracts them back
+
+template<class T, size_t ...Bits>
+struct unpack_checks {
+    static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value,
+        "Values must be unsigned integers");
+    static_assert(find_max<Bits...>::value <= sizeof(T) * 8, "Packs must fit values");
+    static const bool value = true;
+};
+
+// Mask of value bits of chunk, pack N takes the low order bits of value N.
+// Shift by ValueBits is done in two steps, since ValueBits may be 64
+template<size_t ValueBits, class BitsSeq> struct deposit_mask;
+template<size_t ValueBits>
+struct deposit_mask<ValueBits, integer_seq<>> {
+    static const uint64_t value = 0;
+};
+template<size_t ValueBits, size_t Bits0, size_t ...Bits>
+struct deposit_mask<ValueBits, integer_seq<Bits0, Bits...>> {
+    static const uint64_t value = all_ones<uint64_t, Bits0>::value |
+        ((deposit_mask<ValueBits, integer_seq<Bits...>>::value << (ValueBits - 1)) << 1);
+};
+
+template<class T, size_t Chunk, size_t ...Bits>
+struct unpack_chunk {
+    static const size_t values_per_chunk = 8 / sizeof(T);
+    static const size_t first = Chunk * values_per_chunk;
+    static const size_t count = (first + values_per_chunk < sizeof...(Bits))
+        ? values_per_chunk : sizeof...(Bits) - first;
+
+    using bits = slice<first, first + count, integer_seq<Bits...>>;
+
+    // Packs of the chunk in packed integer
+    static const size_t offset = sum_seq<slice<0, first, integer_seq<Bits...>>>::value;
+    static const size_t length = sum_seq<bits>::value;
+
+    static const uint64_t mask = deposit_mask<sizeof(T) * 8, bits>::value;
+};
+
+template<class T, size_t ...Bits>
+using chunk_count = size_t_<(sizeof...(Bits) + 8 / sizeof(T) - 1) / (8 / sizeof(T))>;
+
+// Packs are extracted one by one
+template<class T, class Integer>
+void unpack_scalar(Integer, T *, seq<>, seq<>) noexcept {}
+
+template<class T, class Integer, class Offset0, class ...Offsets, class Bits0, class ...Bits>
+void unpack_scalar(Integer value, T *out, seq<Offset0, Offsets...>, seq<Bits0, Bits...>) noexcept {
+    *out = take_pack<Offset0::value, Bits0::value, T>(value);
+    unpack_scalar(value, out + 1, seq<Offsets...>(), seq<Bits...>());
+}
+
+template<class Integer, class T>
+constexpr Integer pack_scalar(const T *, seq<>, seq<>) { return Integer(0); }
+
+template<class Integer, class T, class Offset0, class ...Offsets, class Bits0, class ...Bits>
+constexpr Integer pack_scalar(const T *values, seq<Offset0, Offsets...>, seq<Bits0, Bits...>) {
+    return static_cast<Integer>(
+        ((static_cast<Integer>(*values) & all_ones<Integer, Bits0::value>::value) << Offset0::value)
+        | pack_scalar<Integer>(values + 1, seq<Offsets...>(), seq<Bits...>()));
+}
+
+#ifdef PINT_SIMD_BMI2
+
+// Values are stored in memory in little endian order, so the first value
+// of chunk is the low order bits of 64-bit word
+template<class T, size_t ...Bits, size_t Chunk>
+PINT_SIMD_TARGET("bmi2")
+inline void unpack_bmi2(uint64_t, T *, size_t_<Chunk>, std::false_type /* no chunks left */) noexcept {}
+
+template<class T, size_t ...Bits, size_t Chunk>
+PINT_SIMD_TARGET("bmi2")
+inline void unpack_bmi2(uint64_t value, T *out, size_t_<Chunk>, std::true_type) noexcept {
+    using chunk = unpack_chunk<T, Chunk, Bits...>;
+
+    const uint64_t deposited = _pdep_u64(
+        (value >> chunk::offset) & all_ones<uint64_t, chunk::length>::value, chunk::mask);
+    std::memcpy(out + chunk::first, &deposited, chunk::count * sizeof(T));
+
+    unpack_bmi2<T, Bits...>(value, out, size_t_<Chunk + 1>(),
+        std::integral_constant<bool, (Chunk + 1 < chunk_count<T, Bits...>::value)>());
+}
+
+// Full chunk is loaded at once. Values of partial chunk are combined one by one:
+// loading them from memory just written by narrow stores would stall
+template<class Chunk, class T>
+inline uint64_t load_chunk(const T *values, std::true_type /* full chunk */) noexcept {
+    uint64_t result;
+    std::memcpy(&result, values, sizeof(result));
+    return result;
+}
+
+template<class Chunk, class T>
+inline uint64_t load_chunk(const T *values, std::false_type) noexcept {
+    uint64_t result = 0;
+    for (size_t i = 0; i < Chunk::count; ++i)
+        result |= uint64_t(values[i]) << (i * sizeof(T) * 8);
+    return result;
+}
+
+template<class T, size_t ...Bits, size_t Chunk>
+PINT_SIMD_TARGET("bmi2")
+inline uint64_t pack_bmi2(const T *, size_t_<Chunk>, std::false_type /* no chunks left */) noexcept { return 0; }
+
+template<class T, size_t ...Bits, size_t Chunk>
+PINT_SIMD_TARGET("bmi2")
+inline uint64_t pack_bmi2(const T *values, size_t_<Chunk>, std::true_type) noexcept {
+    using chunk = unpack_chunk<T, Chunk, Bits...>;
+
+    return (_pext_u64(load_chunk<chunk>(values + chunk::first,
+            std::integral_constant<bool, chunk::count == chunk::values_per_chunk>()), chunk::mask) << chunk::offset)
+        | pack_bmi2<T, Bits...>(values, size_t_<Chunk + 1>(),
+            std::integral_constant<bool, (Chunk + 1 < chunk_count<T, Bits...>::value)>());
+}
+
+#endif // PINT_SIMD_BMI2
+
+// pdep / pext work on 64-bit integers
+template<class Integer>
+using has_bmi2_path = std::integral_constant<bool,
+    std::is_integral<Integer>::value && sizeof(Integer) <= sizeof(uint64_t)>;
+
+// Conversion of array of packed integers, called with bmi2 tag if
+// pdep / pext are enabled
+struct bmi2 {};
+
+template<class T, class Integer, size_t ...Bits>
+struct bulk_unpack_values {
+    using packed_type = packed_int<Integer, Bits...>;
+
+    const packed_type *values;
+    T *out;
+    size_t count;
+
+    void operator()(simd::none) const {
+        for (size_t i = 0; i < count; ++i) {
+            unpack_scalar(static_cast<scalar_of<Integer>>(values[i].value()), out + i * sizeof...(Bits),
+                mask_offsets_vector<Bits...>(), integer_seq<Bits...>());
+        }
+    }
+
+#ifdef PINT_SIMD_BMI2
+    PINT_SIMD_TARGET("bmi2") PINT_SIMD_FLATTEN
+    void operator()(bmi2) const {
+        for (size_t i = 0; i < count; ++i)
+            unpack_bmi2<T, Bits...>(values[i].value(), out + i * sizeof...(Bits), size_t_<0>(), std::true_type());
+    }
+#endif
+};
+
+template<class T, class Integer, size_t ...Bits>
+struct bulk_pack_values {
+    using packed_type = packed_int<Integer, Bits...>;
+
+    const T *values;
+    packed_type *out;
+    size_t count;
+
+    void operator()(simd::none) const {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = packed_type(static_cast<Integer>(pack_scalar<scalar_of<Integer>>(
+                values + i * sizeof...(Bits), mask_offsets_vector<Bits...>(), integer_seq<Bits...>())));
+        }
+    }
+
+#ifdef PINT_SIMD_BMI2
+    PINT_SIMD_TARGET("bmi2") PINT_SIMD_FLATTEN
+    void operator()(bmi2) const {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = packed_type(static_cast<Integer>(pack_bmi2<T, Bits...>(values + i * sizeof...(Bits), size_t_<0>(), std::true_type())));
+    }
+#endif
+};
+
+template<class Function>
+void bmi2_dispatch(const Function &function, std::true_type) {
+#ifdef PINT_SIMD_BMI2
+    if (simd::current_bmi2())
+        return function(bmi2());
+#endif
+    function(simd::none());
+}
+
+template<class Function>
+void bmi2_dispatch(const Function &function, std::false_type) { function(simd::none()); }
+
+///////////////////////////////////////////////////////////////////////////////
+// Transposition of array of packed integers to columns, one column per pack,
+// and back. Records are processed by chunks which stay in L1 cache, columns
+// of chunk are converted one after another. Loop of one column is compiled
+// for instruction set selected at runtime, so compiler vectorizes it
+
+const size_t lanes_chunk_size = 1024;
+
+template<size_t Offset, size_t Bits, class T, class PackedInt>
+struct bulk_unpack_lane {
+    const PackedInt *values;
+    T *column;
+    size_t count;
+
+    // Members are copied, since stores to column of char type may alias them
+    template<class Isa>
+    void operator()(Isa) const {
+        const PackedInt *in = values;
+        T *out = column;
+        const size_t n = count;
+        for (size_t i = 0; i < n; ++i)
+            out[i] = take_pack<Offset, Bits, T>(in[i].value());
+    }
+};
+
+// The first column assigns records, others are combined with them
+template<size_t Offset, size_t Bits, class T, class PackedInt>
+struct bulk_pack_lane {
+    using integer = typename PackedInt::value_type;
+
+    const T *column;
+    PackedInt *out;
+    size_t count;
+    bool first;
+
+    template<class Isa>
+    void operator()(Isa) const {
+        if (first) {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = PackedInt(static_cast<integer>((static_cast<integer>(column[i]) & all_ones<integer, Bits>::value) << Offset));
+        } else {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = PackedInt(static_cast<integer>(out[i].value()
+                    | ((static_cast<integer>(column[i]) & all_ones<integer, Bits>::value) << Offset)));
+        }
+    }
+};
+
+template<class PackedInt>
+void unpack_columns(const PackedInt *, size_t, seq<>, seq<>) noexcept {}
+
+template<class PackedInt, class Offset0, class ...Offsets, class Bits0, class ...Bits, class T0, class ...T>
+void unpack_columns(const PackedInt *values, size_t count, seq<Offset0, Offsets...>, seq<Bits0, Bits...>,
+    T0 *column0, T *...columns) noexcept
+{
+    simd::dispatch(bulk_unpack_lane<Offset0::value, Bits0::value, T0, PackedInt>{values, column0, count});
+    unpack_columns(values, count, seq<Offsets...>(), seq<Bits...>(), columns...);
+}
+
+template<class PackedInt>
+void pack_columns(PackedInt *, size_t, bool, seq<>, seq<>) noexcept {}
+
+template<class PackedInt, class Offset0, class ...Offsets, class Bits0, class ...Bits, class T0, class ...T>
+void pack_columns(PackedInt *out, size_t count, bool first, seq<Offset0, Offsets...>, seq<Bits0, Bits...>,
+    const T0 *column0, const T *...columns) noexcept
+{
+    simd::dispatch(bulk_pack_lane<Offset0::value, Bits0::value, T0, PackedInt>{column0, out, count, first});
+    pack_columns(out, count, false, seq<Offsets...>(), seq<Bits...>(), columns...);
+}
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// Conversion of packed integers to arrays of values and back. Each pack
+// is stored in separate value of type T, e.g. packed_int<uint32_t, 3, 7, 6>
+// is converted to array of 3 uint8_t. Struct with fields of type T
+// and without padding may be used as array.
+//
+// pdep / pext are used if simd::current_bmi2() is true
+
+// Store packs of value to out[0], out[1], ...
+template<class T, size_t Bits0, size_t ...Bits, class Integer>
+void unpack(packed_int<Integer, Bits0, Bits...> value, T *out) noexcept {
+    static_assert(detail::unpack_checks<T, Bits0, Bits...>::value, "");
+    detail::bmi2_dispatch(detail::bulk_unpack_values<T, Integer, Bits0, Bits...>{&value, out, 1},
+        detail::has_bmi2_path<Integer>());
+}
+
+// Unpack count packed integers, out receives sizeof...(Bits) + 1 values per packed integer
+template<class T, size_t Bits0, size_t ...Bits, class Integer>
+void unpack(const packed_int<Integer, Bits0, Bits...> *values, T *out, size_t count) noexcept {
+    static_assert(detail::unpack_checks<T, Bits0, Bits...>::value, "");
+    detail::bmi2_dispatch(detail::bulk_unpack_values<T, Integer, Bits0, Bits...>{values, out, count},
+        detail::has_bmi2_path<Integer>());
+}
+
+// Pack count packed integers from sizeof...(Bits) + 1 values each
+template<class T, size_t Bits0, size_t ...Bits, class Integer>
+void pack(const T *values, packed_int<Integer, Bits0, Bits...> *out, size_t count) noexcept {
+    static_assert(detail::unpack_checks<T, Bits0, Bits...>::value, "");
+    detail::bmi2_dispatch(detail::bulk_pack_values<T, Integer, Bits0, Bits...>{values, out, count},
+        detail::has_bmi2_path<Integer>());
+}
+
+// Make packed integer from values[0], values[1], ..., values are truncated
+template<class PackedInt, class T>
+PackedInt pack(const T *values) noexcept {
+    PackedInt result(typename PackedInt::value_type(0));
+    pack(values, &result, 1);
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Transposition of array of packed integers (records) to columns, one array
+// per pack, and back: column N receives pack N of each record. Column may have
+// any unsigned integer type which fits its pack, e.g. uint8_t for short packs.
+// Columns are converted with SIMD if instruction set selected by
+// simd::current_level() supports it
+
+// columns[N][i] = get<N>(values[i]) for each of count values
+template<class Integer, size_t ...Bits, class ...T>
+void unpack_lanes(const packed_int<Integer, Bits...> *values, size_t count, T *...columns) noexcept {
+    static_assert(sizeof...(T) == sizeof...(Bits), "Each pack must have its column");
+    const bool checks[] = { detail::unpack_checks<T, Bits>::value... };
+    (void)checks;
+
+    for (size_t first = 0; first < count; first += detail::lanes_chunk_size) {
+        const size_t chunk = std::min(detail::lanes_chunk_size, count - first);
+        detail::unpack_columns(values + first, chunk, detail::mask_offsets_vector<Bits...>(),
+            detail::integer_seq<Bits...>(), (columns + first)...);
+    }
+}
+
+// column[i] = get<Index>(values[i]), scan of single pack
+template<size_t Index, class Integer, size_t ...Bits, class T>
+void unpack_lane(const packed_int<Integer, Bits...> *values, size_t count, T *column) noexcept {
+    static_assert(Index < sizeof...(Bits), "Incorrect index");
+    using pack_bits = detail::take_nth<Index, detail::integer_seq<Bits...>>;
+    static_assert(detail::unpack_checks<T, pack_bits::value>::value, "");
+
+    using offset = detail::take_nth<Index, detail::mask_offsets_vector<Bits...>>;
+    simd::dispatch(detail::bulk_unpack_lane<offset::value, pack_bits::value, T, packed_int<Integer, Bits...>>{
+        values, column, count});
+}
+
+// out[i] = packed_int(columns[0][i], columns[1][i], ...), values are truncated
+template<class Integer, size_t ...Bits, class ...T>
+void pack_lanes(packed_int<Integer, Bits...> *out, size_t count, const T *...columns) noexcept {
+    static_assert(sizeof...(T) == sizeof...(Bits), "Each pack must have its column");
+    const bool checks[] = { detail::unpack_checks<T, Bits>::value... };
+    (void)checks;
+
+    for (size_t first = 0; first < count; first += detail::lanes_chunk_size) {
+        const size_t chunk = std::min(detail::lanes_chunk_size, count - first);
+        detail::pack_columns(out + first, chunk, true, detail::mask_offsets_vector<Bits...>(),
+            detail::integer_seq<Bits...>(), (columns + first)...);
+    }
+}
+
+} // namespace pint
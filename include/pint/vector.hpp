@@ -0,0 +1,415 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "pint/pint.hpp"
+#include "pint/simd.hpp"
+
+namespace pint {
+namespace detail {
+
+///////////////////////////////////////////////////////////////////////////////
+// Values of Bits bits stored one after another in array of 64-bit words,
+// value may cross the boundary of words. Value N starts at bit N * Bits,
+// bits are numbered from the low order bit of the first word.
+//
+// Array is followed by padding words, so value is always read from
+// two adjacent words without branching, and SIMD loads don't leave the array
+
+const size_t bit_array_padding = 4;
+
+template<size_t Bits>
+constexpr size_t words_for(size_t count) {
+    return (count * Bits + 63) / 64 + bit_array_padding;
+}
+
+template<size_t Bits>
+inline uint64_t get_bits(const uint64_t *words, size_t index) noexcept {
+    const size_t position = index * Bits;
+    const size_t offset = position % 64;
+
+    // Second word is shifted in two steps, so shift by 64 isn't needed
+    return ((words[position / 64] >> offset) | ((words[position / 64 + 1] << 1) << (63 - offset)))
+        & all_ones<uint64_t, Bits>::value;
+}
+
+template<size_t Bits>
+inline void set_bits(uint64_t *words, size_t index, uint64_t value) noexcept {
+    const size_t position = index * Bits;
+    const size_t offset = position % 64;
+    const uint64_t mask = all_ones<uint64_t, Bits>::value;
+    value &= mask;
+
+    uint64_t *word = words + position / 64;
+    word[0] = (word[0] & ~(mask << offset)) | (value << offset);
+    word[1] = (word[1] & ~((mask >> 1) >> (63 - offset))) | ((value >> 1) >> (63 - offset));
+}
+
+// Conversion of values stored in packed vectors to bits and back
+template<class Value>
+struct vector_value {
+    static constexpr uint64_t to_bits(Value value) { return value; }
+    static constexpr Value from_bits(uint64_t bits) { return static_cast<Value>(bits); }
+};
+
+template<class Integer, size_t ...Bits>
+struct vector_value<packed_int<Integer, Bits...>> {
+    static constexpr uint64_t to_bits(packed_int<Integer, Bits...> value) { return value.value(); }
+    static constexpr packed_int<Integer, Bits...> from_bits(uint64_t bits) {
+        return packed_int<Integer, Bits...>(static_cast<Integer>(bits));
+    }
+};
+
+// Proxy returned by non-const operator[] and iterators
+template<class Vector>
+class vector_reference {
+public:
+    using value_type = typename Vector::value_type;
+
+    vector_reference(Vector &vector, size_t index) noexcept : m_vector(&vector), m_index(index) {}
+
+    operator value_type() const noexcept { return m_vector->get(m_index); }
+
+    vector_reference &operator=(value_type value) noexcept {
+        m_vector->set(m_index, value);
+        return *this;
+    }
+    vector_reference &operator=(const vector_reference &other) noexcept {
+        return *this = static_cast<value_type>(other);
+    }
+
+    // Swap referenced values, used by algorithms like std::sort
+    friend void swap(vector_reference a, vector_reference b) noexcept {
+        const value_type value = a;
+        a = b;
+        b = value;
+    }
+
+private:
+    Vector *m_vector;
+    size_t m_index;
+};
+
+// Random access iterator. Const iterator returns values, non-const
+// iterator returns proxies
+template<class Vector, class Reference>
+class vector_iterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename std::remove_const<Vector>::type::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = Reference;
+    using pointer = void;
+
+    vector_iterator() noexcept : m_vector(nullptr), m_index(0) {}
+    vector_iterator(Vector &vector, size_t index) noexcept : m_vector(&vector), m_index(index) {}
+
+    reference operator*() const noexcept { return (*m_vector)[m_index]; }
+    reference operator[](difference_type n) const noexcept { return (*m_vector)[m_index + n]; }
+
+    vector_iterator &operator++() noexcept { ++m_index; return *this; }
+    vector_iterator &operator--() noexcept { --m_index; return *this; }
+    vector_iterator operator++(int) noexcept { vector_iterator result = *this; ++m_index; return result; }
+    vector_iterator operator--(int) noexcept { vector_iterator result = *this; --m_index; return result; }
+
+    vector_iterator &operator+=(difference_type n) noexcept { m_index += n; return *this; }
+    vector_iterator &operator-=(difference_type n) noexcept { m_index -= n; return *this; }
+
+    friend vector_iterator operator+(vector_iterator it, difference_type n) noexcept { return it += n; }
+    friend vector_iterator operator+(difference_type n, vector_iterator it) noexcept { return it += n; }
+    friend vector_iterator operator-(vector_iterator it, difference_type n) noexcept { return it -= n; }
+    friend difference_type operator-(vector_iterator a, vector_iterator b) noexcept {
+        return static_cast<difference_type>(a.m_index) - static_cast<difference_type>(b.m_index);
+    }
+
+    friend bool operator==(vector_iterator a, vector_iterator b) noexcept { return a.m_index == b.m_index; }
+    friend bool operator!=(vector_iterator a, vector_iterator b) noexcept { return a.m_index != b.m_index; }
+    friend bool operator<(vector_iterator a, vector_iterator b) noexcept { return a.m_index < b.m_index; }
+    friend bool operator>(vector_iterator a, vector_iterator b) noexcept { return a.m_index > b.m_index; }
+    friend bool operator<=(vector_iterator a, vector_iterator b) noexcept { return a.m_index <= b.m_index; }
+    friend bool operator>=(vector_iterator a, vector_iterator b) noexcept { return a.m_index >= b.m_index; }
+
+private:
+    Vector *m_vector;
+    size_t m_index;
+};
+
+// Common part of packed_vector and packed_record_vector
+template<class Value, size_t Bits>
+class basic_packed_vector {
+public:
+    static_assert(Bits > 0 && Bits <= 64, "Values must be from 1 to 64 bits long");
+
+    using value_type = Value;
+    using size_type = size_t;
+    using reference = vector_reference<basic_packed_vector>;
+    using const_reference = value_type;
+    using iterator = vector_iterator<basic_packed_vector, reference>;
+    using const_iterator = vector_iterator<const basic_packed_vector, const_reference>;
+
+    static const size_t value_bits = Bits;
+
+    basic_packed_vector() : m_words(bit_array_padding), m_size(0) {}
+    explicit basic_packed_vector(size_t count, value_type value = value_type())
+        : basic_packed_vector() { resize(count, value); }
+
+    size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+
+    // Storage, ceil(size * Bits / 64) words followed by padding
+    const uint64_t *data() const noexcept { return m_words.data(); }
+    uint64_t *data() noexcept { return m_words.data(); }
+
+    value_type get(size_t index) const noexcept {
+        return vector_value<Value>::from_bits(get_bits<Bits>(m_words.data(), index));
+    }
+    void set(size_t index, value_type value) noexcept {
+        set_bits<Bits>(m_words.data(), index, vector_value<Value>::to_bits(value));
+    }
+
+    const_reference operator[](size_t index) const noexcept { return get(index); }
+    reference operator[](size_t index) noexcept { return reference(*this, index); }
+
+    iterator begin() noexcept { return iterator(*this, 0); }
+    iterator end() noexcept { return iterator(*this, m_size); }
+    const_iterator begin() const noexcept { return const_iterator(*this, 0); }
+    const_iterator end() const noexcept { return const_iterator(*this, m_size); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    void reserve(size_t count) { m_words.reserve(words_for<Bits>(count)); }
+
+    void resize(size_t count, value_type value = value_type()) {
+        if (count < m_size) {
+            // Clear removed values, so they don't appear after growing again
+            const size_t position = count * Bits;
+            m_words[position / 64] &= (uint64_t(1) << (position % 64)) - 1;
+            std::fill(m_words.begin() + position / 64 + 1, m_words.end(), uint64_t(0));
+            m_words.resize(words_for<Bits>(count));
+            m_size = count;
+            return;
+        }
+
+        m_words.resize(words_for<Bits>(count), 0);
+        if (vector_value<Value>::to_bits(value) != 0) {
+            for (size_t i = m_size; i < count; ++i)
+                set(i, value);
+        }
+        m_size = count;
+    }
+
+    void clear() { resize(0); }
+
+    void push_back(value_type value) {
+        if (m_words.size() < words_for<Bits>(m_size + 1))
+            m_words.resize(words_for<Bits>(m_size + 1), 0);
+        set(m_size++, value);
+    }
+
+private:
+    std::vector<uint64_t> m_words;
+    size_t m_size;
+};
+
+template<class Value, size_t Bits> const size_t basic_packed_vector<Value, Bits>::value_bits;
+
+///////////////////////////////////////////////////////////////////////////////
+// Bulk conversion of packed vector to array of uint32_t and back
+
+// Values are decoded one by one
+template<size_t Bits>
+void unpack_scalar(const uint64_t *words, size_t first, uint32_t *out, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i)
+        out[i] = static_cast<uint32_t>(get_bits<Bits>(words, first + i));
+}
+
+// Each block of 64 values takes exactly Bits words. Pairs of values are
+// accumulated in 64-bit register, full words are stored without reading them
+template<size_t Bits>
+void pack_block(uint64_t *words, const uint32_t *values) noexcept {
+    const size_t pair_bits = 2 * Bits;
+    uint64_t accumulator = 0;
+    size_t filled = 0;
+
+    for (size_t i = 0; i < 64; i += 2) {
+        const uint64_t pair = (values[i] & all_ones<uint64_t, Bits>::value)
+            | (uint64_t(values[i + 1] & all_ones<uint64_t, Bits>::value) << Bits);
+        accumulator |= pair << filled;
+        filled += pair_bits;
+
+        if (filled >= 64) {
+            *words++ = accumulator;
+            filled -= 64;
+            accumulator = filled ? pair >> (pair_bits - filled) : 0;
+        }
+    }
+}
+
+template<size_t Bits>
+void pack_values(uint64_t *words, size_t first, const uint32_t *values, size_t count) noexcept {
+    size_t i = 0;
+    for (; i < count && (first + i) % 64 != 0; ++i)
+        set_bits<Bits>(words, first + i, values[i]);
+
+    for (; i + 64 <= count; i += 64)
+        pack_block<Bits>(words + (first + i) / 64 * Bits, values + i);
+
+    for (; i < count; ++i)
+        set_bits<Bits>(words, first + i, values[i]);
+}
+
+#ifdef PINT_SIMD_X86
+
+// Group of 8 values starting at index divisible by 8 takes exactly Bits bytes.
+// Values 0-3 are loaded into the low 128-bit lane and values 4-7 into the high
+// one, each value is moved to its 32-bit lane by byte shuffle and shifted right
+// by its offset within the first byte. Value with offset takes up to Bits + 7 bits,
+// so values up to 25 bits long fit 32-bit lanes
+const size_t avx2_unpack_max_bits = 25;
+
+template<size_t Bits>
+PINT_SIMD_TARGET("avx2")
+void unpack_avx2(const uint64_t *words, size_t first, uint32_t *out, size_t count) noexcept {
+    const size_t high_byte = 4 * Bits / 8;
+
+    uint8_t shuffle_bytes[32];
+    uint32_t shift_amounts[8];
+    for (size_t i = 0; i < 8; ++i) {
+        const size_t position = i < 4 ? i * Bits : i * Bits - high_byte * 8;
+        for (size_t j = 0; j < 4; ++j)
+            shuffle_bytes[i * 4 + j] = static_cast<uint8_t>(position / 8 + j);
+        shift_amounts[i] = static_cast<uint32_t>(position % 8);
+    }
+
+    const __m256i shuffle = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(shuffle_bytes));
+    const __m256i shift = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(shift_amounts));
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>(all_ones<uint32_t, Bits>::value));
+
+    // Values before the first group are decoded one by one
+    const size_t head = std::min(count, (8 - first % 8) % 8);
+    unpack_scalar<Bits>(words, first, out, head);
+    size_t i = head;
+
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(words);
+    for (; i + 8 <= count; i += 8) {
+        const uint8_t *group = bytes + (first + i) / 8 * Bits;
+        const __m256i loaded = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(group))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(group + high_byte)), 1);
+
+        const __m256i values = _mm256_and_si256(
+            _mm256_srlv_epi32(_mm256_shuffle_epi8(loaded, shuffle), shift), mask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), values);
+    }
+
+    unpack_scalar<Bits>(words, first + i, out + i, count - i);
+}
+
+#endif // PINT_SIMD_X86
+
+// Unpacking called with the tag of instruction set selected at runtime.
+// Byte order of words in memory must be little endian for SIMD version,
+// so it is used only on x86
+template<size_t Bits>
+struct bulk_unpack {
+    const uint64_t *words;
+    size_t first;
+    uint32_t *out;
+    size_t count;
+
+    template<class Isa>
+    void operator()(Isa) const { unpack_scalar<Bits>(words, first, out, count); }
+
+#ifdef PINT_SIMD_X86
+    void operator()(simd::avx2) const { unpack(size_t_<(Bits <= avx2_unpack_max_bits)>()); }
+    void operator()(simd::avx512bw) const { unpack(size_t_<(Bits <= avx2_unpack_max_bits)>()); }
+
+    void unpack(size_t_<1> /* fits 32-bit lanes */) const { unpack_avx2<Bits>(words, first, out, count); }
+    void unpack(size_t_<0>) const { unpack_scalar<Bits>(words, first, out, count); }
+#endif
+};
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// Vector of unsigned integers Bits bits long, stored contiguously without
+// padding between values. Values are truncated to Bits bits on assignment.
+// get, set and operator[] take O(1) time.
+
+template<size_t Bits>
+class packed_vector : public detail::basic_packed_vector<
+    typename make_packed_int<Bits>::value_type, Bits>
+{
+    using base = detail::basic_packed_vector<typename make_packed_int<Bits>::value_type, Bits>;
+
+public:
+    packed_vector() = default;
+    explicit packed_vector(size_t count, typename base::value_type value = 0) : base(count, value) {}
+
+    // Copy count values starting from index first into out. Values are
+    // decoded with SIMD shuffles if instruction set selected by
+    // simd::current_level() supports them
+    void unpack(size_t first, uint32_t *out, size_t count) const noexcept {
+        static_assert(Bits <= 32, "Values must fit uint32_t");
+        simd::dispatch(detail::bulk_unpack<Bits>{this->data(), first, out, count});
+    }
+
+    // Replace count values starting from index first, values are truncated
+    // to Bits bits. first + count must not exceed size()
+    void pack(size_t first, const uint32_t *values, size_t count) noexcept {
+        static_assert(Bits <= 32, "Values must fit uint32_t");
+        detail::pack_values<Bits>(this->data(), first, values, count);
+    }
+};
+
+// Vector of packed integers with given lengths of packs, e.g.
+// packed_record_vector<3, 7, 6> stores 16-bit records of 3 fields.
+// Records are stored contiguously, so record takes exactly sum of Bits
+template<size_t Bits0, size_t ...Bits>
+class packed_record_vector : public detail::basic_packed_vector<
+    make_packed_int<Bits0, Bits...>, detail::sum<Bits0, Bits...>::value>
+{
+    using base = detail::basic_packed_vector<
+        make_packed_int<Bits0, Bits...>, detail::sum<Bits0, Bits...>::value>;
+
+public:
+    packed_record_vector() = default;
+    explicit packed_record_vector(size_t count,
+        typename base::value_type value = typename base::value_type(0)) : base(count, value) {}
+
+    // Field Index of record
+    template<size_t Index>
+    detail::lane_of<typename base::value_type::value_type> get_field(size_t index) const noexcept {
+        return pint::get<Index>(this->get(index));
+    }
+
+    // Copy count records starting from index first into out
+    void unpack(size_t first, typename base::value_type *out, size_t count) const noexcept {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = this->get(first + i);
+    }
+
+    void pack(size_t first, const typename base::value_type *values, size_t count) noexcept {
+        for (size_t i = 0; i < count; ++i)
+            this->set(first + i, values[i]);
+    }
+};
+
+} // namespace pint
@@ -0,0 +1,271 @@
+// Copyright 2019 Ed Nemeretsky
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//     http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+#include "pint/pint.hpp"
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+namespace pint {
+
+// Byte order of integers in memory
+enum class endian {
+    little,
+    big,
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    native = big
+#else
+    native = little
+#endif
+};
+
+namespace detail {
+
+inline uint8_t byteswap(uint8_t value) noexcept { return value; }
+
+#if defined(__GNUC__) || defined(__clang__)
+inline uint16_t byteswap(uint16_t value) noexcept { return __builtin_bswap16(value); }
+inline uint32_t byteswap(uint32_t value) noexcept { return __builtin_bswap32(value); }
+inline uint64_t byteswap(uint64_t value) noexcept { return __builtin_bswap64(value); }
+#elif defined(_MSC_VER)
+inline uint16_t byteswap(uint16_t value) noexcept { return _byteswap_ushort(value); }
+inline uint32_t byteswap(uint32_t value) noexcept { return _byteswap_ulong(value); }
+inline uint64_t byteswap(uint64_t value) noexcept { return _byteswap_uint64(value); }
+#else
+inline uint16_t byteswap(uint16_t value) noexcept { return static_cast<uint16_t>((value << 8) | (value >> 8)); }
+inline uint32_t byteswap(uint32_t value) noexcept {
+    return (uint32_t(byteswap(static_cast<uint16_t>(value))) << 16) | byteswap(static_cast<uint16_t>(value >> 16));
+}
+inline uint64_t byteswap(uint64_t value) noexcept {
+    return (uint64_t(byteswap(static_cast<uint32_t>(value))) << 32) | byteswap(static_cast<uint32_t>(value >> 32));
+}
+#endif
+
+// Integer of Order stored at unaligned address. memcpy of constant size
+// and byte swap are compiled to a single load (movbe on x86)
+template<class Integer, endian Order>
+Integer load_integer(const unsigned char *bytes) noexcept {
+    Integer value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return Order == endian::native ? value : byteswap(value);
+}
+
+template<class Integer, endian Order>
+void store_integer(unsigned char *bytes, Integer value) noexcept {
+    if (Order != endian::native)
+        value = byteswap(value);
+    std::memcpy(bytes, &value, sizeof(value));
+}
+
+template<class PackedInt> struct view_checks;
+template<class Integer, size_t ...Bits>
+struct view_checks<packed_int<Integer, Bits...>> {
+    static_assert(std::is_integral<Integer>::value && sizeof(Integer) <= sizeof(uint64_t),
+        "Views support integers up to 64 bits");
+    static const bool value = true;
+};
+
+// Offset and length of pack Index
+template<size_t Index, class PackedInt> struct pack_position;
+template<size_t Index, class Integer, size_t ...Bits>
+struct pack_position<Index, packed_int<Integer, Bits...>> {
+    using offset_and_mask = take_offset_and_mask<Index, Bits...>;
+    static const size_t offset = take_1st<offset_and_mask>::value;
+    static const size_t bits = take_2nd<offset_and_mask>::value;
+};
+
+// Common part of mutable and const views, Byte is const for const views
+template<class PackedInt, endian Order, class Byte>
+class basic_packed_view {
+    static_assert(view_checks<PackedInt>::value, "");
+
+public:
+    using packed_type = PackedInt;
+    using integer_type = typename PackedInt::value_type;
+
+    static const size_t size = sizeof(integer_type);
+
+    explicit basic_packed_view(Byte *bytes) noexcept : m_bytes(bytes) {}
+
+    Byte *data() const noexcept { return m_bytes; }
+
+    packed_type load() const noexcept { return packed_type(load_integer<integer_type, Order>(m_bytes)); }
+    operator packed_type() const noexcept { return load(); }
+
+    // Value of pack Index
+    template<size_t Index>
+    lane_of<integer_type> get() const noexcept { return pint::get<Index>(load()); }
+
+protected:
+    Byte *m_bytes;
+};
+
+template<class PackedInt, endian Order, class Byte>
+const size_t basic_packed_view<PackedInt, Order, Byte>::size;
+
+} // namespace detail
+
+///////////////////////////////////////////////////////////////////////////////
+// View of packed integer stored at any address in given byte order, e.g.
+// big endian field of network record. Values are loaded and stored with
+// unaligned access and byte swap, no copy of the record is needed.
+// View is a pointer: copying a view doesn't copy the value,
+// and const view still writes to the buffer. packed_view<const PackedInt>
+// is read-only
+
+template<class PackedInt, endian Order = endian::native>
+class packed_view : public detail::basic_packed_view<PackedInt, Order, unsigned char> {
+    using base = detail::basic_packed_view<PackedInt, Order, unsigned char>;
+
+public:
+    explicit packed_view(unsigned char *bytes) noexcept : base(bytes) {}
+#ifdef __cpp_lib_byte
+    explicit packed_view(std::byte *bytes) noexcept : base(reinterpret_cast<unsigned char *>(bytes)) {}
+#endif
+
+    void store(PackedInt value) const noexcept {
+        detail::store_integer<typename base::integer_type, Order>(this->m_bytes, value.value());
+    }
+
+    // Replace pack Index, value is truncated. Other packs are kept
+    template<size_t Index>
+    void set(detail::lane_of<typename base::integer_type> value) const noexcept {
+        using integer = typename base::integer_type;
+        using position = detail::pack_position<Index, PackedInt>;
+        const integer mask = static_cast<integer>(detail::all_ones<integer, position::bits>::value << position::offset);
+
+        const integer current = this->load().value();
+        store(PackedInt(static_cast<integer>((current & ~mask)
+            | ((static_cast<integer>(value) << position::offset) & mask))));
+    }
+};
+
+template<class PackedInt, endian Order>
+class packed_view<const PackedInt, Order> : public detail::basic_packed_view<PackedInt, Order, const unsigned char> {
+    using base = detail::basic_packed_view<PackedInt, Order, const unsigned char>;
+
+public:
+    explicit packed_view(const unsigned char *bytes) noexcept : base(bytes) {}
+#ifdef __cpp_lib_byte
+    explicit packed_view(const std::byte *bytes) noexcept : base(reinterpret_cast<const unsigned char *>(bytes)) {}
+#endif
+    packed_view(packed_view<PackedInt, Order> view) noexcept : base(view.data()) {}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Views of count packed integers stored at bytes, bytes + stride, ...,
+// e.g. field of array of fixed size records. Stride is the size of integer
+// by default, so integers are contiguous
+
+template<class PackedInt, endian Order = endian::native>
+class packed_view_array {
+public:
+    using view_type = packed_view<PackedInt, Order>;
+    using byte_type = typename std::conditional<std::is_const<PackedInt>::value,
+        const unsigned char, unsigned char>::type;
+
+    packed_view_array(byte_type *bytes, size_t count, size_t stride = view_type::size) noexcept
+        : m_bytes(bytes), m_count(count), m_stride(stride) {}
+
+    // Const array from mutable one
+    template<class Other, class = typename std::enable_if<
+        std::is_same<const Other, PackedInt>::value>::type>
+    packed_view_array(const packed_view_array<Other, Order> &other) noexcept
+        : m_bytes(other.data()), m_count(other.size()), m_stride(other.stride()) {}
+
+    view_type operator[](size_t index) const noexcept { return view_type(m_bytes + index * m_stride); }
+
+    byte_type *data() const noexcept { return m_bytes; }
+    size_t size() const noexcept { return m_count; }
+    size_t stride() const noexcept { return m_stride; }
+
+private:
+    byte_type *m_bytes;
+    size_t m_count;
+    size_t m_stride;
+};
+
+// Load all values of views into out
+template<class PackedInt, endian Order>
+void load(packed_view_array<PackedInt, Order> views, typename std::remove_const<PackedInt>::type *out) noexcept {
+    for (size_t i = 0; i < views.size(); ++i)
+        out[i] = views[i].load();
+}
+
+// Store values[i] to views[i]
+template<class PackedInt, endian Order>
+void store(const PackedInt *values, packed_view_array<PackedInt, Order> views) noexcept {
+    for (size_t i = 0; i < views.size(); ++i)
+        views[i].store(values[i]);
+}
+
+// out[i] = function(in[i]), where function takes and returns packed integer.
+// Arrays may have different byte order and stride, out must not be shorter
+// than in. out may be the same as in
+template<class In, endian InOrder, class PackedInt, endian OutOrder, class Function>
+void transform(packed_view_array<In, InOrder> in, packed_view_array<PackedInt, OutOrder> out, Function function) {
+    static_assert(std::is_same<typename std::remove_const<In>::type, PackedInt>::value,
+        "Arrays must hold the same packed integers");
+    for (size_t i = 0; i < in.size(); ++i)
+        out[i].store(function(in[i].load()));
+}
+
+// out[i] = function(a[i], b[i]), e.g. add_unsigned_saturate of fields of records
+template<class A, endian OrderA, class B, endian OrderB, class PackedInt, endian OutOrder, class Function>
+void transform(packed_view_array<A, OrderA> a, packed_view_array<B, OrderB> b,
+    packed_view_array<PackedInt, OutOrder> out, Function function)
+{
+    static_assert(std::is_same<typename std::remove_const<A>::type, PackedInt>::value
+        && std::is_same<typename std::remove_const<B>::type, PackedInt>::value,
+        "Arrays must hold the same packed integers");
+    for (size_t i = 0; i < a.size(); ++i)
+        out[i].store(function(a[i].load(), b[i].load()));
+}
+
+// Bulk function applied to views by chunks: chunk of values is loaded into
+// array on stack, function(values, count) transforms it in place, e.g. by bulk
+// functions with SIMD, and values are stored to out. Chunk stays in L1 cache,
+// so the whole buffer isn't copied
+const size_t view_chunk_size = 256;
+
+template<class In, endian InOrder, class PackedInt, endian OutOrder, class Function>
+void transform_chunks(packed_view_array<In, InOrder> in, packed_view_array<PackedInt, OutOrder> out,
+    Function function)
+{
+    static_assert(std::is_same<typename std::remove_const<In>::type, PackedInt>::value,
+        "Arrays must hold the same packed integers");
+
+    // Packed integers aren't default constructible
+    typename std::aligned_storage<sizeof(PackedInt) * view_chunk_size, alignof(PackedInt)>::type storage;
+    PackedInt *values = reinterpret_cast<PackedInt *>(&storage);
+
+    for (size_t first = 0; first < in.size(); first += view_chunk_size) {
+        const size_t count = std::min(view_chunk_size, in.size() - first);
+        for (size_t i = 0; i < count; ++i)
+            new (values + i) PackedInt(in[first + i].load());
+        function(values, count);
+        for (size_t i = 0; i < count; ++i)
+            out[first + i].store(values[i]);
+    }
+}
+
+} // namespace pint
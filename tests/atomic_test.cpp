@@ -0,0 +1,106 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/atomic.hpp"
+
+TEST(TestAtomic, LoadStore) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    pint::atomic_packed_int<PackedInt> value(PackedInt(1,2,3));
+    ASSERT_TRUE(value.is_lock_free());
+    ASSERT_EQ(PackedInt(1,2,3), value.load());
+
+    value.store(PackedInt(4,5,6));
+    ASSERT_EQ(PackedInt(4,5,6), value.exchange(PackedInt(7,8,9)));
+
+    auto expected = PackedInt(0,0,0);
+    ASSERT_FALSE(value.compare_exchange_strong(expected, PackedInt(1,1,1)));
+    ASSERT_EQ(PackedInt(7,8,9), expected);
+    ASSERT_TRUE(value.compare_exchange_strong(expected, PackedInt(1,1,1)));
+    ASSERT_EQ(PackedInt(1,1,1), value.load());
+}
+
+TEST(TestAtomic, Arithmetic) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    pint::atomic_packed_int<PackedInt> value(PackedInt(5,100,30));
+
+    ASSERT_EQ(PackedInt(5,100,30), value.fetch_add_wrap(PackedInt(4,37,38)));
+    ASSERT_EQ(PackedInt(1,9,4), value.load());
+
+    ASSERT_EQ(PackedInt(1,9,4), value.fetch_sub_wrap(PackedInt(2,10,4)));
+    ASSERT_EQ(PackedInt(7,127,0), value.load());
+
+    value.store(PackedInt(5,100,30));
+    value.fetch_add_unsigned_saturate(PackedInt(4,20,38));
+    ASSERT_EQ(PackedInt(7,120,63), value.load());
+
+    value.fetch_sub_unsigned_saturate(PackedInt(6,121,1));
+    ASSERT_EQ(PackedInt(1,0,62), value.load());
+
+    // 3 + 1, -64 + (-1), -2 + (-32)
+    value.store(PackedInt(3,64,62));
+    value.fetch_add_signed_saturate(PackedInt(1,127,32));
+    ASSERT_EQ(PackedInt(3,64,32), value.load());
+
+    // 3 - (-1), -64 - 1, -32 - 31
+    value.fetch_sub_signed_saturate(PackedInt(7,1,31));
+    ASSERT_EQ(PackedInt(3,64,32), value.load());
+}
+
+TEST(TestAtomic, MinMaxBitwise) {
+    using PackedInt = pint::make_packed_int<4,4,8>;
+
+    pint::atomic_packed_int<PackedInt> value(PackedInt(5,9,200));
+
+    value.fetch_min_unsigned(PackedInt(7,3,100));
+    ASSERT_EQ(PackedInt(5,3,100), value.load());
+    value.fetch_max_unsigned(PackedInt(6,2,150));
+    ASSERT_EQ(PackedInt(6,3,150), value.load());
+    value.fetch_min_signed(PackedInt(15,2,150));
+    ASSERT_EQ(PackedInt(15,2,150), value.load());
+    value.fetch_max_signed(PackedInt(0,8,0));
+    ASSERT_EQ(PackedInt(0,2,0), value.load());
+
+    value.fetch_or(PackedInt(1,4,255));
+    ASSERT_EQ(PackedInt(1,6,255), value.fetch_and(PackedInt(15,3,15)));
+    ASSERT_EQ(PackedInt(1,2,15), value.fetch_xor(PackedInt(1,1,1)));
+    ASSERT_EQ(PackedInt(0,3,14), value.load());
+}
+
+// Single pack of the whole integer uses native fetch_add
+TEST(TestAtomic, Native) {
+    using PackedInt = pint::packed_int<uint32_t,32>;
+
+    pint::atomic_packed_int<PackedInt> value(PackedInt(0xfffffffeu));
+    value.fetch_add_wrap(PackedInt(3u));
+    ASSERT_EQ(PackedInt(1u), value.load());
+    value.fetch_sub_wrap(PackedInt(2u));
+    ASSERT_EQ(PackedInt(0xffffffffu), value.load());
+}
+
+// Concurrent updates of different packs don't lose each other
+TEST(TestAtomic, Threads) {
+    using PackedInt = pint::packed_int<uint64_t,16,16,16,16>;
+
+    pint::atomic_packed_int<PackedInt> sum;
+    pint::atomic_packed_int<PackedInt> saturated;
+    const size_t iterations = 20000;
+
+    std::vector<std::thread> threads;
+    for (uint16_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            const auto one = PackedInt(t == 0, t == 1, t == 2, 1);
+            for (size_t i = 0; i < iterations; ++i) {
+                sum.fetch_add_wrap(one);
+                saturated.fetch_add_unsigned_saturate(PackedInt(1,1,1,1));
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    ASSERT_EQ(PackedInt(iterations, iterations, iterations, (4 * iterations) % 65536), sum.load());
+    ASSERT_EQ(PackedInt(65535,65535,65535,65535), saturated.load());
+}
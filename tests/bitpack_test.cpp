@@ -0,0 +1,147 @@
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/bitpack.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+using pint_test::ForEachLevel;
+
+// Width of values changes every block, from 0 to 32 bits
+std::vector<uint32_t> RandomColumn(size_t count, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::vector<uint32_t> result(count);
+
+    size_t width = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i % pint::bitpack::block_size == 0)
+            width = gen() % 33;
+        result[i] = static_cast<uint32_t>(gen() & ((uint64_t(1) << width) - 1));
+    }
+    return result;
+}
+
+void CheckRoundTrip(const std::vector<uint32_t> &values) {
+    const auto words = pint::bitpack::encode(values.data(), values.size());
+    ASSERT_EQ(values.size(), pint::bitpack::decoded_size(words.data(), words.size()));
+
+    std::vector<uint32_t> decoded(values.size() + 1, ~0u);
+    ASSERT_EQ(values.size(), pint::bitpack::decode(words.data(), words.size(), decoded.data()));
+    ASSERT_EQ(~0u, decoded.back());
+
+    decoded.pop_back();
+    ASSERT_EQ(values, decoded);
+}
+
+void CheckSizes() {
+    for (size_t count : {0, 1, 63, 127, 128, 129, 511, 512, 513, 1000, 5000}) {
+        SCOPED_TRACE(count);
+        CheckRoundTrip(RandomColumn(count, static_cast<unsigned>(count)));
+    }
+}
+
+} // namespace
+
+TEST(TestBitpack, RoundTrip) {
+    CheckSizes();
+
+    for (size_t width = 0; width <= 32; ++width) {
+        SCOPED_TRACE(width);
+        std::vector<uint32_t> values(1000, static_cast<uint32_t>((uint64_t(1) << width) - 1));
+        CheckRoundTrip(values);
+    }
+}
+
+// Block takes width of its largest value
+TEST(TestBitpack, Size) {
+    std::vector<uint32_t> values(10 * pint::bitpack::frame_size, 5);
+    values[1] = 7;
+    values[200] = 0;
+    ASSERT_EQ(10 * (1 + 4 * 2 * 3), pint::bitpack::encode(values.data(), values.size()).size());
+
+    std::vector<uint32_t> zeros(1000, 0);
+    ASSERT_EQ(2u, pint::bitpack::encode(zeros.data(), zeros.size()).size());
+
+    // Last frame: 3 full blocks of 1 bit and 8 values of 12 bits
+    std::vector<uint32_t> tail(3 * 128 + 8, 1);
+    tail.back() = 4095;
+    ASSERT_EQ(1 + 3 * 2 + 2, pint::bitpack::encode(tail.data(), tail.size()).size());
+}
+
+// Words taken from encoder after each call are decoded independently
+TEST(TestBitpack, Streaming) {
+    const auto values = RandomColumn(20000, 1);
+    std::mt19937 gen(2);
+
+    pint::bitpack::encoder encoder;
+    std::vector<std::vector<uint64_t>> chunks;
+    for (size_t i = 0; i < values.size();) {
+        const size_t count = std::min<size_t>(gen() % 2000, values.size() - i);
+        encoder.encode(values.data() + i, count);
+        chunks.push_back(encoder.take());
+        i += count;
+        ASSERT_EQ(i % pint::bitpack::frame_size, encoder.pending());
+    }
+    encoder.finish();
+    chunks.push_back(encoder.take());
+    ASSERT_EQ(0u, encoder.pending());
+    ASSERT_TRUE(encoder.words().empty());
+
+    std::vector<uint32_t> decoded;
+    for (const auto &chunk : chunks) {
+        std::vector<uint32_t> out(pint::bitpack::decoded_size(chunk.data(), chunk.size()));
+        ASSERT_EQ(out.size(), pint::bitpack::decode(chunk.data(), chunk.size(), out.data()));
+        decoded.insert(decoded.end(), out.begin(), out.end());
+    }
+    ASSERT_EQ(values, decoded);
+}
+
+// Decoder fills output buffer by whole frames
+TEST(TestBitpack, Decoder) {
+    const auto values = RandomColumn(5000, 3);
+    const auto words = pint::bitpack::encode(values.data(), values.size());
+
+    for (size_t capacity : {512, 1000, 1024, 4096}) {
+        SCOPED_TRACE(capacity);
+        pint::bitpack::decoder decoder(words.data(), words.size());
+        std::vector<uint32_t> decoded, out(capacity);
+
+        while (!decoder.done()) {
+            const size_t count = decoder.decode(out.data(), capacity);
+            ASSERT_LT(0u, count);
+            if (!decoder.done()) {
+                ASSERT_EQ(0u, count % pint::bitpack::frame_size);
+            }
+            decoded.insert(decoded.end(), out.begin(), out.begin() + count);
+        }
+        ASSERT_EQ(values, decoded);
+    }
+
+    pint::bitpack::decoder decoder(words.data(), words.size());
+    std::vector<uint32_t> out(100);
+    ASSERT_EQ(0u, decoder.decode(out.data(), out.size()));
+    ASSERT_FALSE(decoder.done());
+}
+
+// Decoding stops at truncated or corrupted frame
+TEST(TestBitpack, Malformed) {
+    const auto values = RandomColumn(2000, 4);
+    auto words = pint::bitpack::encode(values.data(), values.size());
+    std::vector<uint32_t> out(values.size());
+
+    ASSERT_EQ(0u, pint::bitpack::decoded_size(words.data(), words.size() - 1));
+    ASSERT_EQ(3 * pint::bitpack::frame_size, pint::bitpack::decode(words.data(), words.size() - 1, out.data()));
+    ASSERT_TRUE(std::equal(out.begin(), out.begin() + 3 * pint::bitpack::frame_size, values.begin()));
+
+    words[0] |= 33;     // width of the first block
+    ASSERT_EQ(0u, pint::bitpack::decoded_size(words.data(), words.size()));
+    ASSERT_EQ(0u, pint::bitpack::decode(words.data(), words.size(), out.data()));
+}
+
+TEST(TestBitpack, AllLevels) {
+    ForEachLevel([] {
+        CheckSizes();
+    });
+}
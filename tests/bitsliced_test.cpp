@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/bitsliced.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+using pint_test::ForEachLevel;
+
+const size_t kBits = 4;
+const size_t kSize = 256;
+
+using Sliced = pint::bitsliced<kBits, kSize>;
+using Nibbles = pint::packed_int<uint64_t, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4>;
+
+Sliced Random(unsigned seed) {
+    std::mt19937 gen(seed);
+    Sliced result;
+    for (size_t i = 0; i < kSize; ++i)
+        result.set(i, gen());
+    return result;
+}
+
+int64_t Signed(uint64_t value) {
+    return (value & 8) ? static_cast<int64_t>(value) - 16 : static_cast<int64_t>(value);
+}
+
+uint64_t Clamp(int64_t value, int64_t min, int64_t max) {
+    return static_cast<uint64_t>(std::min(std::max(value, min), max)) & 15;
+}
+
+// Result of bit-sliced function against scalar function of each pair
+void CheckFunction(std::function<Sliced(const Sliced &, const Sliced &)> function,
+    std::function<uint64_t(uint64_t, uint64_t)> expected)
+{
+    const Sliced a = Random(1), b = Random(2);
+    const Sliced result = function(a, b);
+    for (size_t i = 0; i < kSize; ++i)
+        ASSERT_EQ(expected(a.get(i), b.get(i)), result.get(i)) << "a " << a.get(i) << " b " << b.get(i);
+}
+
+void CheckFunctions() {
+    CheckFunction(pint::add_wrap<kBits, kSize>, [](uint64_t a, uint64_t b) { return (a + b) & 15; });
+    CheckFunction(pint::sub_wrap<kBits, kSize>, [](uint64_t a, uint64_t b) { return (a - b) & 15; });
+    CheckFunction(pint::add_unsigned_saturate<kBits, kSize>,
+        [](uint64_t a, uint64_t b) { return std::min<uint64_t>(a + b, 15); });
+    CheckFunction(pint::sub_unsigned_saturate<kBits, kSize>,
+        [](uint64_t a, uint64_t b) { return a > b ? a - b : 0; });
+    CheckFunction(pint::add_signed_saturate<kBits, kSize>,
+        [](uint64_t a, uint64_t b) { return Clamp(Signed(a) + Signed(b), -8, 7); });
+    CheckFunction(pint::sub_signed_saturate<kBits, kSize>,
+        [](uint64_t a, uint64_t b) { return Clamp(Signed(a) - Signed(b), -8, 7); });
+
+    CheckFunction(pint::cmp_eq<kBits, kSize>, [](uint64_t a, uint64_t b) { return a == b ? 15 : 0; });
+    CheckFunction(pint::cmp_lt_unsigned<kBits, kSize>, [](uint64_t a, uint64_t b) { return a < b ? 15 : 0; });
+    CheckFunction(pint::cmp_gt_unsigned<kBits, kSize>, [](uint64_t a, uint64_t b) { return a > b ? 15 : 0; });
+    CheckFunction(pint::cmp_lt_signed<kBits, kSize>,
+        [](uint64_t a, uint64_t b) { return Signed(a) < Signed(b) ? 15 : 0; });
+    CheckFunction(pint::cmp_gt_signed<kBits, kSize>,
+        [](uint64_t a, uint64_t b) { return Signed(a) > Signed(b) ? 15 : 0; });
+    CheckFunction(pint::min_unsigned<kBits, kSize>, [](uint64_t a, uint64_t b) { return std::min(a, b); });
+    CheckFunction(pint::max_unsigned<kBits, kSize>, [](uint64_t a, uint64_t b) { return std::max(a, b); });
+}
+
+void CheckConversion() {
+    std::mt19937 gen(3);
+    std::vector<Nibbles> values;
+    for (size_t i = 0; i < kSize / 16; ++i)
+        values.emplace_back((uint64_t(gen()) << 32) | gen());
+
+    const Sliced sliced = Sliced::from_packed(values.data());
+    for (size_t i = 0; i < kSize; ++i)
+        ASSERT_EQ((values[i / 16].value() >> (i % 16 * 4)) & 15, sliced.get(i)) << "index " << i;
+
+    std::vector<Nibbles> out(values.size(), Nibbles(0));
+    sliced.to_packed(out.data());
+    ASSERT_EQ(values, out);
+
+    // 3 packs don't divide groups
+    using Triple = pint::packed_int<uint16_t, 4, 4, 4>;
+    std::vector<Triple> triples;
+    for (size_t i = 0; i < 192 / 3; ++i)
+        triples.emplace_back(static_cast<uint16_t>(gen()));
+
+    const auto sliced_triples = pint::bitsliced<4, 192>::from_packed(triples.data());
+    for (size_t i = 0; i < 192; ++i)
+        ASSERT_EQ((triples[i / 3].value() >> (i % 3 * 4)) & 15u, sliced_triples.get(i)) << "index " << i;
+
+    std::vector<Triple> triples_out(triples.size(), Triple(0));
+    sliced_triples.to_packed(triples_out.data());
+    for (size_t i = 0; i < triples.size(); ++i)
+        ASSERT_EQ(triples[i].value() & 0xfff, triples_out[i].value());
+}
+
+} // namespace
+
+TEST(TestBitsliced, Elements) {
+    Sliced value;
+    for (size_t i = 0; i < kSize; ++i)
+        ASSERT_EQ(0u, value.get(i));
+
+    value.set(0, 15);
+    value.set(65, 0x1a);    // truncated
+    ASSERT_EQ(15u, value.get(0));
+    ASSERT_EQ(10u, value.get(65));
+    ASSERT_EQ(0u, value.get(64));
+    ASSERT_EQ(uint64_t(1), value.plane(3)[0]);
+    ASSERT_EQ(uint64_t(2), value.plane(1)[1]);
+    ASSERT_EQ(uint64_t(0), value.plane(0)[1]);
+
+    value.set(0, 0);
+    ASSERT_EQ(0u, value.get(0));
+    ASSERT_NE(Sliced(), value);
+    value.set(65, 0);
+    ASSERT_EQ(Sliced(), value);
+}
+
+TEST(TestBitsliced, Functions) {
+    CheckFunctions();
+}
+
+TEST(TestBitsliced, Reductions) {
+    const Sliced value = Random(4);
+    uint64_t sum = 0;
+    size_t fives = 0;
+    for (size_t i = 0; i < kSize; ++i) {
+        sum += value.get(i);
+        fives += value.get(i) == 5;
+    }
+    ASSERT_EQ(sum, pint::reduce_add_wide(value));
+
+    Sliced five;
+    for (size_t i = 0; i < kSize; ++i)
+        five.set(i, 5);
+    ASSERT_EQ(fives, pint::count(pint::cmp_eq(value, five)));
+    ASSERT_EQ(kSize * 15, pint::reduce_add_wide(pint::cmp_eq(value, value)));
+
+    // 1-bit elements are a bitset
+    pint::bitsliced<1, 128> bits;
+    bits.set(3, 1);
+    bits.set(100, 1);
+    ASSERT_EQ(2u, pint::reduce_add_wide(bits));
+    ASSERT_EQ(2u, pint::count(bits));
+}
+
+// Scalar and pdep / pext conversions
+TEST(TestBitsliced, Conversion) {
+    const bool initial = pint::simd::current_bmi2();
+    for (bool bmi2 : {false, true}) {
+        pint::simd::set_bmi2(bmi2);
+        SCOPED_TRACE(pint::simd::current_bmi2());
+        CheckConversion();
+    }
+    pint::simd::set_bmi2(initial);
+}
+
+TEST(TestBitsliced, AllLevels) {
+    ForEachLevel([] {
+        CheckFunctions();
+        CheckConversion();
+    });
+}
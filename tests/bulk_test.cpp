@@ -0,0 +1,428 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/bulk.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+using pint_test::ForEachLevel;
+using pint_test::RandomPackedInts;
+
+// Compare result of bulk function with the result of scalar function.
+// Odd count is used to make sure tail is processed too.
+template<class PackedInt, class BulkFunction, class ScalarFunction>
+void CheckBinary(BulkFunction bulk, ScalarFunction scalar) {
+    const size_t count = 1001;
+    const auto a = RandomPackedInts<PackedInt>(count, 1);
+    const auto b = RandomPackedInts<PackedInt>(count, 2);
+
+    std::vector<PackedInt> result(count, PackedInt(0));
+    bulk(a.data(), b.data(), result.data(), count);
+
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(scalar(a[i], b[i]), result[i]) << "index " << i;
+}
+
+template<class PackedInt>
+void CheckAllBinary() {
+    using P = PackedInt;
+    using Ptr = const P*;
+
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::add_wrap(a, b, out, n); },
+        [](P a, P b) { return pint::add_wrap(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::add_unsigned_saturate(a, b, out, n); },
+        [](P a, P b) { return pint::add_unsigned_saturate(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::add_signed_saturate(a, b, out, n); },
+        [](P a, P b) { return pint::add_signed_saturate(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::sub_wrap(a, b, out, n); },
+        [](P a, P b) { return pint::sub_wrap(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::sub_unsigned_saturate(a, b, out, n); },
+        [](P a, P b) { return pint::sub_unsigned_saturate(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::sub_signed_saturate(a, b, out, n); },
+        [](P a, P b) { return pint::sub_signed_saturate(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::min_unsigned(a, b, out, n); },
+        [](P a, P b) { return pint::min_unsigned(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::max_unsigned(a, b, out, n); },
+        [](P a, P b) { return pint::max_unsigned(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::min_signed(a, b, out, n); },
+        [](P a, P b) { return pint::min_signed(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::max_signed(a, b, out, n); },
+        [](P a, P b) { return pint::max_signed(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::avg_unsigned(a, b, out, n); },
+        [](P a, P b) { return pint::avg_unsigned(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::avg_signed(a, b, out, n); },
+        [](P a, P b) { return pint::avg_signed(a, b); });
+    CheckBinary<P>(
+        [](Ptr a, Ptr b, P *out, size_t n) { pint::absdiff_unsigned(a, b, out, n); },
+        [](P a, P b) { return pint::absdiff_unsigned(a, b); });
+}
+
+// Sum of absolute differences is the sum of reduce_add_wide of absdiff_unsigned,
+// checked for counts which end in the middle of SIMD register
+template<class PackedInt>
+void CheckSad() {
+    const size_t count = 1001;
+    const auto a = RandomPackedInts<PackedInt>(count, 5);
+    const auto b = RandomPackedInts<PackedInt>(count, 6);
+
+    uint64_t expected = 0;
+    for (size_t n = 0; n <= count; ++n) {
+        if (n % 37 == 0 || n == count) {
+            ASSERT_EQ(expected, pint::sad_unsigned(a.data(), b.data(), n)) << "count " << n;
+        }
+        if (n < count)
+            expected += static_cast<uint64_t>(pint::reduce_add_wide(pint::absdiff_unsigned(a[n], b[n])));
+    }
+}
+
+template<class PackedInt>
+void CheckShifts(size_t max_shift) {
+    const size_t count = 77;
+    const auto values = RandomPackedInts<PackedInt>(count, 3);
+    std::vector<PackedInt> result(count, PackedInt(0));
+
+    for (size_t shift = 0; shift <= max_shift; ++shift) {
+        pint::shift_left(values.data(), shift, result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(pint::shift_left(values[i], shift), result[i]) << "shift " << shift;
+
+        pint::shift_right_unsigned(values.data(), shift, result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(pint::shift_right_unsigned(values[i], shift), result[i]) << "shift " << shift;
+
+        pint::shift_right_signed(values.data(), shift, result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(pint::shift_right_signed(values[i], shift), result[i]) << "shift " << shift;
+
+        pint::rotate_left(values.data(), shift, result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(pint::rotate_left(values[i], shift), result[i]) << "shift " << shift;
+
+        pint::rotate_right(values.data(), shift, result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(pint::rotate_right(values[i], shift), result[i]) << "shift " << shift;
+    }
+
+    // Amounts of each pack are random values shifted right, so they
+    // vary from all bits set to zero
+    const auto random_amounts = RandomPackedInts<PackedInt>(count, 4);
+    std::vector<PackedInt> amounts(count, PackedInt(0));
+
+    for (size_t shift = 0; shift <= max_shift; ++shift) {
+        for (size_t i = 0; i < count; ++i)
+            amounts[i] = pint::shift_right_unsigned(random_amounts[i], shift);
+
+        pint::shift_left(values.data(), amounts.data(), result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(pint::shift_left(values[i], amounts[i]), result[i]) << "shift " << shift;
+
+        pint::shift_right_unsigned(values.data(), amounts.data(), result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(pint::shift_right_unsigned(values[i], amounts[i]), result[i]) << "shift " << shift;
+
+        pint::shift_right_signed(values.data(), amounts.data(), result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(pint::shift_right_signed(values[i], amounts[i]), result[i]) << "shift " << shift;
+
+        pint::rotate_left(values.data(), amounts.data(), result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(pint::rotate_left(values[i], amounts[i]), result[i]) << "shift " << shift;
+
+        pint::rotate_right(values.data(), amounts.data(), result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(pint::rotate_right(values[i], amounts[i]), result[i]) << "shift " << shift;
+    }
+}
+
+// Bulk functions record the same flags as scalar ones applied to each element
+template<class PackedInt, class BulkFunction, class ScalarFunction>
+void CheckOverflow(BulkFunction bulk, ScalarFunction scalar) {
+    const size_t count = 1001;
+    const auto a = RandomPackedInts<PackedInt>(count, 1);
+    const auto b = RandomPackedInts<PackedInt>(count, 2);
+
+    // Single element may set every flag, so flags are checked for short prefixes too
+    for (size_t n : { size_t(0), size_t(1), size_t(7), size_t(33), count }) {
+        std::vector<PackedInt> result(n, PackedInt(0));
+        pint::overflow_flags<PackedInt> overflow;
+        bulk(a.data(), b.data(), result.data(), n, overflow);
+
+        pint::overflow_flags<PackedInt> expected_overflow;
+        for (size_t i = 0; i < n; ++i)
+            ASSERT_EQ(scalar(a[i], b[i], expected_overflow), result[i]) << "index " << i;
+        ASSERT_EQ(expected_overflow.bits(), overflow.bits()) << "count " << n;
+    }
+}
+
+template<class PackedInt>
+void CheckAllOverflow() {
+    using P = PackedInt;
+    using Ptr = const P*;
+    using Flags = pint::overflow_flags<P>;
+
+    CheckOverflow<P>(
+        [](Ptr a, Ptr b, P *out, size_t n, Flags &f) { pint::add_overflow_unsigned(a, b, out, n, f); },
+        [](P a, P b, Flags &f) { return pint::add_overflow_unsigned(a, b, f); });
+    CheckOverflow<P>(
+        [](Ptr a, Ptr b, P *out, size_t n, Flags &f) { pint::add_overflow_signed(a, b, out, n, f); },
+        [](P a, P b, Flags &f) { return pint::add_overflow_signed(a, b, f); });
+    CheckOverflow<P>(
+        [](Ptr a, Ptr b, P *out, size_t n, Flags &f) { pint::sub_overflow_unsigned(a, b, out, n, f); },
+        [](P a, P b, Flags &f) { return pint::sub_overflow_unsigned(a, b, f); });
+    CheckOverflow<P>(
+        [](Ptr a, Ptr b, P *out, size_t n, Flags &f) { pint::sub_overflow_signed(a, b, out, n, f); },
+        [](P a, P b, Flags &f) { return pint::sub_overflow_signed(a, b, f); });
+}
+
+// Bit counting, odd count makes sure tail is processed too
+template<class PackedInt>
+void CheckBitCount() {
+    const size_t count = 1001;
+    auto values = RandomPackedInts<PackedInt>(count, 7);
+    // Zero packs and sparse values
+    for (size_t i = 0; i < count; i += 3)
+        values[i] = PackedInt(static_cast<typename PackedInt::value_type>(values[i].value() & values[i + 1].value()));
+    values[count - 1] = PackedInt(0);
+
+    std::vector<PackedInt> result(count, PackedInt(0));
+    pint::popcount_lanes(values.data(), result.data(), count);
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(pint::popcount_lanes(values[i]), result[i]) << "index " << i;
+
+    pint::clz_lanes(values.data(), result.data(), count);
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(pint::clz_lanes(values[i]), result[i]) << "index " << i;
+
+    pint::ctz_lanes(values.data(), result.data(), count);
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(pint::ctz_lanes(values[i]), result[i]) << "index " << i;
+}
+
+void CheckAllBitCount() {
+    CheckBitCount<pint::packed_int<uint32_t, 1, 2, 3, 4, 5, 6, 11>>();
+    CheckBitCount<pint::packed_int<uint64_t, 8, 8, 8, 8, 8, 8, 8, 8>>();
+    CheckBitCount<pint::packed_int<uint64_t, 16, 16, 16, 16>>();
+    CheckBitCount<pint::packed_int<uint64_t, 32, 32>>();
+    CheckBitCount<pint::packed_int<uint64_t, 64>>();
+    CheckBitCount<pint::packed_int<uint8_t, 8>>();
+    CheckBitCount<pint::packed_int<uint16_t, 8, 8>>();
+    CheckBitCount<pint::packed_int<uint32_t, 4, 4, 4, 4, 4, 4, 4, 4>>();
+}
+
+// Conversions between layouts, Target of different size makes sure lanes
+// are extended on load and truncated on store
+template<class PackedInt, class Target, class BulkFunction, class ScalarFunction>
+void CheckConvert(BulkFunction bulk, ScalarFunction scalar) {
+    const size_t count = 1001;
+    const auto values = RandomPackedInts<PackedInt>(count, 8);
+
+    std::vector<Target> result(count, Target(0));
+    bulk(values.data(), result.data(), count);
+
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(scalar(values[i]), result[i]) << "index " << i;
+}
+
+template<class Narrow, class Wide>
+void CheckAllConvert() {
+    CheckConvert<Narrow, Wide>(
+        [](const Narrow *values, Wide *out, size_t count) { pint::widen_unsigned(values, out, count); },
+        [](Narrow value) { return pint::widen_unsigned<Wide>(value); });
+    CheckConvert<Narrow, Wide>(
+        [](const Narrow *values, Wide *out, size_t count) { pint::widen_signed(values, out, count); },
+        [](Narrow value) { return pint::widen_signed<Wide>(value); });
+    CheckConvert<Wide, Narrow>(
+        [](const Wide *values, Narrow *out, size_t count) { pint::narrow_unsigned_saturate(values, out, count); },
+        [](Wide value) { return pint::narrow_unsigned_saturate<Narrow>(value); });
+    CheckConvert<Wide, Narrow>(
+        [](const Wide *values, Narrow *out, size_t count) { pint::narrow_signed_saturate(values, out, count); },
+        [](Wide value) { return pint::narrow_signed_saturate<Narrow>(value); });
+    CheckConvert<Wide, Narrow>(
+        [](const Wide *values, Narrow *out, size_t count) { pint::repack(values, out, count); },
+        [](Wide value) { return pint::repack<Narrow>(value); });
+}
+
+void CheckAllLayoutConversions() {
+    // Native lanes of both layouts
+    CheckAllConvert<pint::packed_int<uint32_t, 8, 8, 8, 8>, pint::packed_int<uint64_t, 16, 16, 16, 16>>();
+    CheckAllConvert<pint::packed_int<uint16_t, 8, 8>, pint::packed_int<uint64_t, 32, 32>>();
+    CheckAllConvert<pint::packed_int<uint8_t, 8>, pint::packed_int<uint32_t, 32>>();
+    CheckAllConvert<pint::packed_int<uint16_t, 8, 8>, pint::packed_int<uint32_t, 16, 16>>();
+    // Packs within lanes of the wider integer
+    CheckAllConvert<pint::packed_int<uint16_t, 5, 6, 5>, pint::packed_int<uint32_t, 8, 8, 8>>();
+    CheckAllConvert<pint::packed_int<uint8_t, 4, 4>, pint::packed_int<uint64_t, 16, 16>>();
+    CheckAllConvert<pint::packed_int<uint32_t, 4, 4, 4, 4, 4, 4, 4, 4>, pint::packed_int<uint32_t, 4, 4, 4, 4, 4, 4, 4, 4>>();
+}
+
+} // namespace
+
+TEST(TestBulk, VarLength8) {
+    CheckAllBinary<pint::packed_int<uint8_t, 3, 5>>();
+}
+
+TEST(TestBulk, VarLength32) {
+    CheckAllBinary<pint::packed_int<uint32_t, 1, 2, 3, 4, 5, 6, 11>>();
+}
+
+TEST(TestBulk, VarLength64_NotFull) {
+    CheckAllBinary<pint::packed_int<uint64_t, 3, 5, 7, 9, 11, 13>>();
+}
+
+TEST(TestBulk, SameLength_Native) {
+    CheckAllBinary<pint::packed_int<uint32_t, 8, 8, 8, 8>>();
+    CheckAllBinary<pint::packed_int<uint64_t, 16, 16, 16, 16>>();
+    CheckAllBinary<pint::packed_int<uint64_t, 32, 32>>();
+    CheckAllBinary<pint::packed_int<uint16_t, 16>>();
+}
+
+TEST(TestBulk, SameLength_NotNative) {
+    CheckAllBinary<pint::packed_int<uint32_t, 4, 4, 4, 4, 4, 4, 4, 4>>();
+    CheckAllBinary<pint::packed_int<uint16_t, 5, 5, 5>>();
+}
+
+#ifdef __SIZEOF_INT128__
+TEST(TestBulk, Int128) {
+    CheckAllBinary<pint::packed_int<unsigned __int128, 3, 60, 5, 33, 11, 1>>();
+    CheckShifts<pint::packed_int<unsigned __int128, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7>>(8);
+}
+#endif
+
+TEST(TestBulk, Sad) {
+    CheckSad<pint::packed_int<uint8_t, 8>>();
+    CheckSad<pint::packed_int<uint8_t, 3, 5>>();
+    CheckSad<pint::packed_int<uint16_t, 5, 6, 5>>();
+    CheckSad<pint::packed_int<uint32_t, 8, 8, 8, 8>>();
+    CheckSad<pint::packed_int<uint32_t, 10, 10, 10>>();
+    CheckSad<pint::packed_int<uint64_t, 16, 16, 16, 16>>();
+    CheckSad<pint::packed_int<uint64_t, 64>>();
+#ifdef __SIZEOF_INT128__
+    CheckSad<pint::packed_int<unsigned __int128, 3, 60, 5, 33, 11, 1>>();
+#endif
+}
+
+TEST(TestBulk, InPlace) {
+    using PackedInt = pint::packed_int<uint16_t, 5, 6, 5>;
+
+    auto a = RandomPackedInts<PackedInt>(100, 4);
+    const auto b = RandomPackedInts<PackedInt>(100, 5);
+    const auto expected = a;
+
+    pint::add_unsigned_saturate(a.data(), b.data(), a.data(), a.size());
+
+    for (size_t i = 0; i < a.size(); ++i)
+        ASSERT_EQ(pint::add_unsigned_saturate(expected[i], b[i]), a[i]);
+}
+
+TEST(TestBulk, Shifts) {
+    CheckShifts<pint::packed_int<uint8_t, 3, 5>>(6);
+    CheckShifts<pint::packed_int<uint32_t, 4, 4, 4, 4, 4, 4, 4, 4>>(5);
+    CheckShifts<pint::packed_int<uint64_t, 3, 7, 6, 20>>(21);
+    // Pack of the whole integer, shifts by 0 and by its length
+    CheckShifts<pint::packed_int<uint64_t, 64>>(64);
+    CheckShifts<pint::packed_int<uint32_t, 32>>(32);
+    CheckShifts<pint::packed_int<uint8_t, 8>>(8);
+
+    // Rotation by multiple of length doesn't change values
+    using PackedInt = pint::packed_int<uint64_t, 64>;
+    const auto values = RandomPackedInts<PackedInt>(77, 5);
+    std::vector<PackedInt> result(values.size(), PackedInt(0));
+    for (size_t amount : {0, 64, 128}) {
+        pint::rotate_left(values.data(), amount, result.data(), values.size());
+        ASSERT_EQ(values, result) << "amount " << amount;
+        pint::rotate_right(values.data(), amount, result.data(), values.size());
+        ASSERT_EQ(values, result) << "amount " << amount;
+    }
+}
+
+TEST(TestBulk, BitCount) {
+    CheckAllBitCount();
+#ifdef __SIZEOF_INT128__
+    CheckBitCount<pint::packed_int<unsigned __int128, 3, 60, 5, 33, 11, 1>>();
+#endif
+}
+
+TEST(TestBulk, Convert) {
+    CheckAllLayoutConversions();
+    CheckAllConvert<pint::packed_int<uint64_t, 3, 7, 6, 20>, pint::packed_int<uint64_t, 3, 9, 16, 30>>();
+}
+
+TEST(TestBulk, Overflow) {
+    CheckAllOverflow<pint::packed_int<uint8_t, 3, 5>>();
+    CheckAllOverflow<pint::packed_int<uint64_t, 3, 7, 6, 20>>();
+    CheckAllOverflow<pint::packed_int<uint64_t, 64>>();
+#ifdef __SIZEOF_INT128__
+    CheckAllOverflow<pint::packed_int<unsigned __int128, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7>>();
+#endif
+}
+
+// Each instruction set supported by CPU gives the same results
+TEST(TestBulk, AllLevels) {
+    ForEachLevel([] {
+        CheckAllBinary<pint::packed_int<uint32_t, 1, 2, 3, 4, 5, 6, 11>>();
+        CheckAllBinary<pint::packed_int<uint64_t, 8, 8, 8, 8, 8, 8, 8, 8>>();
+        CheckAllBinary<pint::packed_int<uint64_t, 16, 16, 16, 16>>();
+        CheckAllBinary<pint::packed_int<uint64_t, 32, 32>>();
+        CheckAllBinary<pint::packed_int<uint64_t, 64>>();
+        CheckShifts<pint::packed_int<uint8_t, 3, 5>>(6);
+        CheckShifts<pint::packed_int<uint64_t, 3, 7, 6, 20>>(21);
+        CheckShifts<pint::packed_int<uint64_t, 64>>(64);
+        CheckAllOverflow<pint::packed_int<uint32_t, 1, 2, 3, 4, 5, 6, 11>>();
+        CheckAllOverflow<pint::packed_int<uint64_t, 8, 8, 8, 8, 8, 8, 8, 8>>();
+        CheckSad<pint::packed_int<uint8_t, 8>>();
+        CheckSad<pint::packed_int<uint16_t, 5, 6, 5>>();
+        CheckSad<pint::packed_int<uint64_t, 16, 16, 16, 16>>();
+        CheckAllLayoutConversions();
+    });
+}
+
+// pshufb and VPOPCNT give the same results at avx512bw level
+TEST(TestBulk, AllPopcount) {
+    ForEachLevel([] {
+        for (bool popcnt : {false, true}) {
+            pint::simd::set_avx512_popcnt(popcnt);
+            SCOPED_TRACE(pint::simd::current_avx512_popcnt() ? "vpopcnt" : "without vpopcnt");
+            CheckAllBitCount();
+        }
+    });
+}
+
+// Nibble lookup at avx512bw level is used on CPUs without VPOPCNTDQ/BITALG,
+// force it on CPUs which have them
+TEST(TestBulk, Avx512BytePopcount) {
+    using pint::simd::level;
+    if (pint::simd::detected_level() < level::avx512bw)
+        return;
+
+    pint_test::ScopedLevel restore;
+    pint::simd::set_level(level::avx512bw);
+    pint::simd::set_avx512_popcnt(false);
+    ASSERT_EQ(level::avx512bw, pint::simd::current_level());
+    ASSERT_FALSE(pint::simd::current_avx512_popcnt());
+
+    CheckAllBitCount();
+}
+
+TEST(TestBulk, SetLevel) {
+    using pint::simd::level;
+    pint_test::ScopedLevel restore;
+
+    pint::simd::set_level(level::none);
+    EXPECT_EQ(level::none, pint::simd::current_level());
+
+    // Levels not supported by CPU are not selected
+    pint::simd::set_level(level::avx512bw);
+    EXPECT_EQ(pint::simd::detected_level(), pint::simd::current_level());
+}
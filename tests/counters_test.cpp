@@ -0,0 +1,43 @@
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/counters.hpp"
+
+TEST(TestShardedCounters, AddLoad) {
+    using PackedInt = pint::make_packed_int<16,16,16,16>;
+
+    pint::sharded_counters<PackedInt> counters(4);
+    ASSERT_EQ(4u, counters.shard_count());
+    ASSERT_EQ(PackedInt(0,0,0,0), counters.load());
+
+    counters.add(PackedInt(1,2,3,4));
+    counters.add(PackedInt(1,0,0,65535));
+    ASSERT_EQ(PackedInt(2,2,3,65535), counters.load());
+
+    ASSERT_EQ(PackedInt(2,2,3,65535), counters.exchange_zero());
+    ASSERT_EQ(PackedInt(0,0,0,0), counters.load());
+}
+
+// Sum of shards saturates, as a single packed integer does
+TEST(TestShardedCounters, Threads) {
+    using PackedInt = pint::make_packed_int<16,16,8,8,16>;
+
+    pint::sharded_counters<PackedInt> counters(3);
+    const size_t iterations = 10000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 5; ++t) {
+        threads.emplace_back([&] {
+            for (size_t i = 0; i < iterations; ++i)
+                counters.add(PackedInt(1,2,0,1,0));
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    ASSERT_EQ(PackedInt(5 * iterations, 65535, 0, 255, 0), counters.load());
+
+    counters.reset();
+    ASSERT_EQ(PackedInt(0,0,0,0,0), counters.load());
+}
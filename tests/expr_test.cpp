@@ -0,0 +1,123 @@
+#include <functional>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/expr.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+using pint_test::ForEachLevel;
+using pint_test::RandomPackedInts;
+
+// Fused expressions give the same results as operations one by one,
+// both for single elements and over arrays (odd count to cover the tail)
+template<class PackedInt>
+void CheckExpressions() {
+    using P = PackedInt;
+
+    const size_t count = 1001;
+    const auto a = RandomPackedInts<P>(count, 1);
+    const auto b = RandomPackedInts<P>(count, 2);
+    const auto c = RandomPackedInts<P>(count, 3);
+    const auto d = RandomPackedInts<P>(count, 4);
+    const P k = RandomPackedInts<P>(1, 5)[0];
+
+    const auto sum3 = pint::expr(a.data()) + b.data() + c.data();
+    const auto sum4 = pint::expr(a.data()) + b.data() + c.data() + k;
+    const auto diff3 = pint::expr(a.data()) - b.data() - c.data();
+    const auto mixed = (pint::expr(a.data()) + b.data() - c.data()).max(d.data());
+    const auto clamped = (pint::expr(a.data()) + b.data() + c.data()).min(d.data());
+    const auto nested = pint::expr(a.data()) + (pint::expr(b.data()) + c.data());
+
+    std::vector<P> out(count, P(0));
+    auto check = [&](const char *name, const std::function<P(size_t)> &expected) {
+        SCOPED_TRACE(name);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(expected(i), out[i]) << "index " << i;
+    };
+
+    pint::evaluate(sum3, out.data(), count);
+    check("sum3", [&](size_t i) {
+        return pint::add_unsigned_saturate(pint::add_unsigned_saturate(a[i], b[i]), c[i]);
+    });
+    ASSERT_EQ(out[7], sum3.eval(7));
+
+    pint::evaluate(sum4, out.data(), count);
+    check("sum4", [&](size_t i) {
+        return pint::add_unsigned_saturate(pint::add_unsigned_saturate(pint::add_unsigned_saturate(a[i], b[i]), c[i]), k);
+    });
+
+    pint::evaluate(diff3, out.data(), count);
+    check("diff3", [&](size_t i) {
+        return pint::sub_unsigned_saturate(pint::sub_unsigned_saturate(a[i], b[i]), c[i]);
+    });
+    ASSERT_EQ(out[count - 1], diff3.eval(count - 1));
+
+    pint::evaluate(mixed, out.data(), count);
+    check("mixed", [&](size_t i) {
+        return pint::max_unsigned(pint::sub_unsigned_saturate(pint::add_unsigned_saturate(a[i], b[i]), c[i]), d[i]);
+    });
+
+    pint::evaluate(clamped, out.data(), count);
+    check("clamped", [&](size_t i) {
+        return pint::min_unsigned(pint::add_unsigned_saturate(pint::add_unsigned_saturate(a[i], b[i]), c[i]), d[i]);
+    });
+
+    pint::evaluate(nested, out.data(), count);
+    check("nested", [&](size_t i) {
+        return pint::add_unsigned_saturate(a[i], pint::add_unsigned_saturate(b[i], c[i]));
+    });
+}
+
+} // namespace
+
+TEST(TestExpr, Scalar) {
+    using PackedInt = pint::packed_int<uint16_t, 5, 6, 5>;
+    const PackedInt a(30, 10, 1), b(3, 60, 2), c(4, 1, 31);
+
+    ASSERT_EQ(PackedInt(31, 63, 31), (pint::expr(a) + b + c).eval());
+    ASSERT_EQ(PackedInt(23, 0, 0), (pint::expr(a) - b - c).eval());
+    ASSERT_EQ(PackedInt(4, 63, 31), (pint::expr(a) + b + c).min(PackedInt(4, 63, 31)).eval());
+    ASSERT_EQ(PackedInt(26, 60, 9), (pint::expr(a) - b - c + b).max(PackedInt(0, 9, 9)).eval());
+}
+
+TEST(TestExpr, VarLength) {
+    CheckExpressions<pint::packed_int<uint8_t, 3, 5>>();
+    CheckExpressions<pint::packed_int<uint32_t, 1, 2, 3, 4, 5, 6, 11>>();
+    CheckExpressions<pint::packed_int<uint64_t, 3, 5, 7, 9, 11, 13>>();
+}
+
+TEST(TestExpr, SameLength) {
+    CheckExpressions<pint::packed_int<uint32_t, 8, 8, 8, 8>>();
+    CheckExpressions<pint::packed_int<uint64_t, 16, 16, 16, 16>>();
+    CheckExpressions<pint::packed_int<uint32_t, 4, 4, 4, 4, 4, 4, 4, 4>>();
+    CheckExpressions<pint::packed_int<uint64_t, 64>>();
+}
+
+#ifdef __SIZEOF_INT128__
+TEST(TestExpr, Int128) {
+    CheckExpressions<pint::packed_int<unsigned __int128, 3, 60, 5, 33, 11, 1>>();
+}
+#endif
+
+// Output may be one of operands
+TEST(TestExpr, InPlace) {
+    using PackedInt = pint::packed_int<uint16_t, 5, 6, 5>;
+
+    auto a = RandomPackedInts<PackedInt>(100, 6);
+    const auto b = RandomPackedInts<PackedInt>(100, 7);
+    const auto expected = a;
+
+    pint::evaluate(pint::expr(a.data()) + b.data() + b.data(), a.data(), a.size());
+
+    for (size_t i = 0; i < a.size(); ++i)
+        ASSERT_EQ(pint::add_unsigned_saturate(pint::add_unsigned_saturate(expected[i], b[i]), b[i]), a[i]);
+}
+
+TEST(TestExpr, AllLevels) {
+    ForEachLevel([] {
+        CheckExpressions<pint::packed_int<uint32_t, 1, 2, 3, 4, 5, 6, 11>>();
+        CheckExpressions<pint::packed_int<uint64_t, 8, 8, 8, 8, 8, 8, 8, 8>>();
+    });
+}
@@ -0,0 +1,64 @@
+// Compile time benchmark: instantiates operations on many pseudo-random
+// layouts. Compare build time of pint_layout_bench (constexpr layouts) and
+// pint_layout_bench_recursive (recursive type lists)
+
+#include <cstdio>
+#include <utility>
+
+#include "pint/pint.hpp"
+
+#ifndef LAYOUT_BENCH_COUNT
+#define LAYOUT_BENCH_COUNT 500
+#endif
+
+namespace {
+
+constexpr uint64_t random_value(size_t layout, size_t pack) {
+    return ((layout + 1) * 0x9e3779b97f4a7c15ULL + pack * 0xbf58476d1ce4e5b9ULL) >> 40;
+}
+
+// 2 to 16 packs, which fit 64 bits
+constexpr size_t pack_count(size_t layout) {
+    return 2 + random_value(layout, 1000) % 15;
+}
+
+constexpr size_t pack_bits(size_t layout, size_t pack) {
+    return 1 + random_value(layout, pack) % (64 / pack_count(layout));
+}
+
+template<size_t Layout, class Packs> struct random_layout_impl;
+template<size_t Layout, size_t ...Packs>
+struct random_layout_impl<Layout, std::index_sequence<Packs...>> {
+    using type = pint::packed_int<uint64_t, pack_bits(Layout, Packs)...>;
+};
+template<size_t Layout>
+using random_layout = typename random_layout_impl<Layout, std::make_index_sequence<pack_count(Layout)>>::type;
+
+template<class PackedInt>
+uint64_t exercise(uint64_t a, uint64_t b) {
+    const PackedInt x(a), y(b);
+    return pint::add_unsigned_saturate(x, y).value()
+        ^ pint::add_signed_saturate(x, y).value()
+        ^ pint::sub_unsigned_saturate(x, y).value()
+        ^ pint::max_unsigned(x, y).value()
+        ^ pint::shift_left(x, 3).value()
+        ^ pint::get<1>(x)
+        ^ pint::slice<0, 2>(x).value();
+}
+
+template<size_t ...Layouts>
+uint64_t exercise_all(uint64_t a, uint64_t b, std::index_sequence<Layouts...>) {
+    uint64_t result = 0;
+    const uint64_t values[] = { exercise<random_layout<Layouts>>(a + Layouts, b)... };
+    for (auto value : values)
+        result ^= value;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **) {
+    std::printf("%llu\n", static_cast<unsigned long long>(
+        exercise_all(static_cast<uint64_t>(argc), 12345, std::make_index_sequence<LAYOUT_BENCH_COUNT>())));
+    return 0;
+}
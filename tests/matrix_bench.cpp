@@ -0,0 +1,439 @@
+// Benchmark matrix: public operations on uniform and mixed layouts
+// of each storage type, over datasets from L1-resident to DRAM-bound.
+// Each case is run by bitfield union (what hand written code compiles to),
+// by scalar pint function applied in a loop and by bulk pint function (SIMD)
+// if there is one. Unary operations and reductions ignore the second array,
+// shifts and rotations are by kMatrixShift, reductions are stored to the
+// whole packed integer.
+//
+// Names are Matrix/<storage>_<layout>/<operation>/<implementation>/<bytes of one array>,
+// select subsets with --benchmark_filter, e.g. 'Matrix/u16_5_6_5/.*/4096'
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <typeindex>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "pint/bulk.hpp"
+
+#include "perf_counters.hpp"
+
+namespace {
+
+// Datasets are the same from run to run
+const uint64_t kMatrixSeed = 0x5eed;
+
+// Bytes of each input array: L1, L2, L3 and DRAM resident
+const int64_t kMatrixSizes[] = { 4 << 10, 128 << 10, 4 << 20, 64 << 20 };
+
+// Amount of shifts and rotations, it exceeds the shortest packs
+const size_t kMatrixShift = 3;
+
+////////////////////////////////////////////////////////////////////////////////
+// Operations on single field of bitfield union. Fields are unsigned values
+// of Bits bits, result is truncated when stored to the field
+
+template<size_t Bits>
+struct Field {
+    static const size_t bits = Bits;
+    static const uint64_t max = ~uint64_t(0) >> (64 - Bits);
+    static const int64_t smax = static_cast<int64_t>(max >> 1);
+    static const int64_t smin = -smax - 1;
+
+    static int64_t to_signed(uint64_t x) {
+        return static_cast<int64_t>(x << (64 - Bits)) >> (64 - Bits);
+    }
+    static uint64_t clamp_signed(int64_t x) { return static_cast<uint64_t>(std::min(std::max(x, smin), smax)); }
+    static uint64_t mask(bool condition) { return condition ? max : 0; }
+
+    static uint64_t rotate_left(uint64_t x, size_t amount) {
+        return amount % Bits == 0 ? x : (x << (amount % Bits)) | (x >> (Bits - amount % Bits));
+    }
+};
+
+// Operations with bulk function are applied to each field of
+// bitfield union, reductions combine fields
+#define MATRIX_OP(Name, function, has_bulk, ...) \
+    struct Name { \
+        using bulk_type = std::integral_constant<bool, has_bulk>; \
+        static const char *name() { return #function; } \
+        template<class P> \
+        static P scalar(P a, P b) { return pint::function(a, b); } \
+        template<class P> \
+        static void bulk(const P *a, const P *b, P *out, size_t n) { pint::function(a, b, out, n); } \
+        template<class B> \
+        static B bitfields(B a, B b) { return B::template apply<Name>(a, b); } \
+        template<class F> \
+        static uint64_t field(uint64_t x, uint64_t y) { (void)y; __VA_ARGS__ } \
+    };
+
+#define MATRIX_UNARY_OP(Name, function, has_bulk, amount, ...) \
+    struct Name { \
+        using bulk_type = std::integral_constant<bool, has_bulk>; \
+        static const char *name() { return #function; } \
+        template<class P> \
+        static P scalar(P a, P) { return pint::function(a amount); } \
+        template<class P> \
+        static void bulk(const P *a, const P *, P *out, size_t n) { pint::function(a amount, out, n); } \
+        template<class B> \
+        static B bitfields(B a, B b) { return B::template apply<Name>(a, b); } \
+        template<class F> \
+        static uint64_t field(uint64_t x, uint64_t) { __VA_ARGS__ } \
+    };
+
+#define MATRIX_REDUCE_OP(Name, function, ...) \
+    struct Name { \
+        using bulk_type = std::false_type; \
+        static const char *name() { return #function; } \
+        template<class P> \
+        static P scalar(P a, P) { return P(static_cast<typename P::value_type>(pint::function(a))); } \
+        template<class P> \
+        static void bulk(const P *, const P *, P *, size_t) {} \
+        template<class B> \
+        static B bitfields(B a, B) { return B::template reduce<Name>(a); } \
+        static uint64_t combine(uint64_t x, uint64_t y) { __VA_ARGS__ } \
+    };
+
+// Shifts take amount after the value, other unary operations take nothing
+#define MATRIX_SHIFT , kMatrixShift
+
+MATRIX_OP(AddWrap, add_wrap, true, return x + y;)
+MATRIX_OP(AddUnsignedSaturate, add_unsigned_saturate, true, return x + y > F::max ? F::max : x + y;)
+MATRIX_OP(AddSignedSaturate, add_signed_saturate, true, return F::clamp_signed(F::to_signed(x) + F::to_signed(y));)
+MATRIX_OP(SubWrap, sub_wrap, true, return x - y;)
+MATRIX_OP(SubUnsignedSaturate, sub_unsigned_saturate, true, return x > y ? x - y : 0;)
+MATRIX_OP(SubSignedSaturate, sub_signed_saturate, true, return F::clamp_signed(F::to_signed(x) - F::to_signed(y));)
+MATRIX_OP(MinUnsigned, min_unsigned, true, return std::min(x, y);)
+MATRIX_OP(MaxUnsigned, max_unsigned, true, return std::max(x, y);)
+MATRIX_OP(MinSigned, min_signed, true, return static_cast<uint64_t>(std::min(F::to_signed(x), F::to_signed(y)));)
+MATRIX_OP(MaxSigned, max_signed, true, return static_cast<uint64_t>(std::max(F::to_signed(x), F::to_signed(y)));)
+MATRIX_OP(AvgUnsigned, avg_unsigned, true, return (x >> 1) + (y >> 1) + ((x | y) & 1);)
+MATRIX_OP(AvgSigned, avg_signed, true,
+    return static_cast<uint64_t>((F::to_signed(x) >> 1) + (F::to_signed(y) >> 1) + static_cast<int64_t>((x | y) & 1));)
+MATRIX_OP(AbsdiffUnsigned, absdiff_unsigned, true, return x > y ? x - y : y - x;)
+
+// Fields of layouts are at most 16 bits long, so products fit 64 bits
+MATRIX_OP(MulWrap, mul_wrap, false, return x * y;)
+MATRIX_OP(MulUnsignedSaturate, mul_unsigned_saturate, false, return std::min(x * y, F::max);)
+MATRIX_OP(MulSignedSaturate, mul_signed_saturate, false, return F::clamp_signed(F::to_signed(x) * F::to_signed(y));)
+MATRIX_OP(MulHi, mul_hi, false, return (x * y) >> F::bits;)
+
+MATRIX_OP(CmpEq, cmp_eq, false, return F::mask(x == y);)
+MATRIX_OP(CmpNe, cmp_ne, false, return F::mask(x != y);)
+MATRIX_OP(CmpLtUnsigned, cmp_lt_unsigned, false, return F::mask(x < y);)
+MATRIX_OP(CmpGtUnsigned, cmp_gt_unsigned, false, return F::mask(x > y);)
+MATRIX_OP(CmpLeUnsigned, cmp_le_unsigned, false, return F::mask(x <= y);)
+MATRIX_OP(CmpGeUnsigned, cmp_ge_unsigned, false, return F::mask(x >= y);)
+MATRIX_OP(CmpLtSigned, cmp_lt_signed, false, return F::mask(F::to_signed(x) < F::to_signed(y));)
+MATRIX_OP(CmpGtSigned, cmp_gt_signed, false, return F::mask(F::to_signed(x) > F::to_signed(y));)
+MATRIX_OP(CmpLeSigned, cmp_le_signed, false, return F::mask(F::to_signed(x) <= F::to_signed(y));)
+MATRIX_OP(CmpGeSigned, cmp_ge_signed, false, return F::mask(F::to_signed(x) >= F::to_signed(y));)
+
+MATRIX_UNARY_OP(ShiftLeft, shift_left, true, MATRIX_SHIFT, return x << kMatrixShift;)
+MATRIX_UNARY_OP(ShiftRightUnsigned, shift_right_unsigned, true, MATRIX_SHIFT, return x >> kMatrixShift;)
+MATRIX_UNARY_OP(ShiftRightSigned, shift_right_signed, true, MATRIX_SHIFT, return static_cast<uint64_t>(F::to_signed(x) >> kMatrixShift);)
+MATRIX_UNARY_OP(RotateLeft, rotate_left, true, MATRIX_SHIFT, return F::rotate_left(x, kMatrixShift);)
+MATRIX_UNARY_OP(RotateRight, rotate_right, true, MATRIX_SHIFT, return F::rotate_left(x, F::bits - kMatrixShift % F::bits);)
+MATRIX_UNARY_OP(AbsSigned, abs_signed, false, , return static_cast<uint64_t>(std::abs(F::to_signed(x)));)
+MATRIX_UNARY_OP(NegSignedSaturate, neg_signed_saturate, false, , return F::clamp_signed(-F::to_signed(x));)
+MATRIX_UNARY_OP(PopcountLanes, popcount_lanes, true, , return static_cast<uint64_t>(__builtin_popcountll(x));)
+MATRIX_UNARY_OP(ClzLanes, clz_lanes, true, ,
+    return x == 0 ? F::bits : static_cast<uint64_t>(__builtin_clzll(x)) - (64 - F::bits);)
+MATRIX_UNARY_OP(CtzLanes, ctz_lanes, true, , return x == 0 ? F::bits : static_cast<uint64_t>(__builtin_ctzll(x));)
+
+MATRIX_REDUCE_OP(ReduceAdd, reduce_add, return x + y;)
+MATRIX_REDUCE_OP(ReduceOr, reduce_or, return x | y;)
+MATRIX_REDUCE_OP(ReduceMinUnsigned, reduce_min_unsigned, return std::min(x, y);)
+MATRIX_REDUCE_OP(ReduceMaxUnsigned, reduce_max_unsigned, return std::max(x, y);)
+
+#undef MATRIX_OP
+#undef MATRIX_UNARY_OP
+#undef MATRIX_REDUCE_OP
+#undef MATRIX_SHIFT
+
+////////////////////////////////////////////////////////////////////////////////
+// Bitfield unions of the layouts below, the first field is the first pack
+
+template<class T, size_t ...Bits> union Bitfields;
+
+template<class T, size_t B0, size_t B1>
+union Bitfields<T, B0, B1> {
+    struct { T f0 : B0; T f1 : B1; } f;
+    T value;
+
+    template<class Op>
+    static Bitfields apply(Bitfields a, Bitfields b) {
+        Bitfields r{};
+        r.f.f0 = static_cast<T>(Op::template field<Field<B0>>(a.f.f0, b.f.f0));
+        r.f.f1 = static_cast<T>(Op::template field<Field<B1>>(a.f.f1, b.f.f1));
+        return r;
+    }
+
+    template<class Op>
+    static Bitfields reduce(Bitfields a) {
+        Bitfields r{};
+        r.value = static_cast<T>(Op::combine(a.f.f0, a.f.f1));
+        return r;
+    }
+};
+
+template<class T, size_t B0, size_t B1, size_t B2>
+union Bitfields<T, B0, B1, B2> {
+    struct { T f0 : B0; T f1 : B1; T f2 : B2; } f;
+    T value;
+
+    template<class Op>
+    static Bitfields apply(Bitfields a, Bitfields b) {
+        Bitfields r{};
+        r.f.f0 = static_cast<T>(Op::template field<Field<B0>>(a.f.f0, b.f.f0));
+        r.f.f1 = static_cast<T>(Op::template field<Field<B1>>(a.f.f1, b.f.f1));
+        r.f.f2 = static_cast<T>(Op::template field<Field<B2>>(a.f.f2, b.f.f2));
+        return r;
+    }
+
+    template<class Op>
+    static Bitfields reduce(Bitfields a) {
+        Bitfields r{};
+        r.value = static_cast<T>(Op::combine(Op::combine(a.f.f0, a.f.f1), a.f.f2));
+        return r;
+    }
+};
+
+template<class T, size_t B0, size_t B1, size_t B2, size_t B3>
+union Bitfields<T, B0, B1, B2, B3> {
+    struct { T f0 : B0; T f1 : B1; T f2 : B2; T f3 : B3; } f;
+    T value;
+
+    template<class Op>
+    static Bitfields apply(Bitfields a, Bitfields b) {
+        Bitfields r{};
+        r.f.f0 = static_cast<T>(Op::template field<Field<B0>>(a.f.f0, b.f.f0));
+        r.f.f1 = static_cast<T>(Op::template field<Field<B1>>(a.f.f1, b.f.f1));
+        r.f.f2 = static_cast<T>(Op::template field<Field<B2>>(a.f.f2, b.f.f2));
+        r.f.f3 = static_cast<T>(Op::template field<Field<B3>>(a.f.f3, b.f.f3));
+        return r;
+    }
+
+    template<class Op>
+    static Bitfields reduce(Bitfields a) {
+        Bitfields r{};
+        r.value = static_cast<T>(Op::combine(Op::combine(Op::combine(a.f.f0, a.f.f1), a.f.f2), a.f.f3));
+        return r;
+    }
+};
+
+template<class T, size_t B0, size_t B1, size_t B2, size_t B3, size_t B4, size_t B5, size_t B6>
+union Bitfields<T, B0, B1, B2, B3, B4, B5, B6> {
+    struct { T f0 : B0; T f1 : B1; T f2 : B2; T f3 : B3; T f4 : B4; T f5 : B5; T f6 : B6; } f;
+    T value;
+
+    template<class Op>
+    static Bitfields apply(Bitfields a, Bitfields b) {
+        Bitfields r{};
+        r.f.f0 = static_cast<T>(Op::template field<Field<B0>>(a.f.f0, b.f.f0));
+        r.f.f1 = static_cast<T>(Op::template field<Field<B1>>(a.f.f1, b.f.f1));
+        r.f.f2 = static_cast<T>(Op::template field<Field<B2>>(a.f.f2, b.f.f2));
+        r.f.f3 = static_cast<T>(Op::template field<Field<B3>>(a.f.f3, b.f.f3));
+        r.f.f4 = static_cast<T>(Op::template field<Field<B4>>(a.f.f4, b.f.f4));
+        r.f.f5 = static_cast<T>(Op::template field<Field<B5>>(a.f.f5, b.f.f5));
+        r.f.f6 = static_cast<T>(Op::template field<Field<B6>>(a.f.f6, b.f.f6));
+        return r;
+    }
+
+    template<class Op>
+    static Bitfields reduce(Bitfields a) {
+        Bitfields r{};
+        const uint64_t low = Op::combine(Op::combine(Op::combine(a.f.f0, a.f.f1), a.f.f2), a.f.f3);
+        r.value = static_cast<T>(Op::combine(Op::combine(Op::combine(low, a.f.f4), a.f.f5), a.f.f6));
+        return r;
+    }
+};
+
+template<class PackedInt> struct BitfieldsOf;
+template<class Integer, size_t ...Bits>
+struct BitfieldsOf<pint::packed_int<Integer, Bits...>> { using type = Bitfields<Integer, Bits...>; };
+
+////////////////////////////////////////////////////////////////////////////////
+// Input arrays of the running case. Only one dataset is kept,
+// so DRAM sized datasets of all layouts don't take memory at once
+
+template<class PackedInt>
+struct Dataset {
+    using bitfields = typename BitfieldsOf<PackedInt>::type;
+
+    std::vector<PackedInt> a, b, out;
+    std::vector<bitfields> bits_a, bits_b, bits_out;
+
+    explicit Dataset(size_t count) {
+        std::mt19937_64 gen(kMatrixSeed);
+        for (size_t i = 0; i < count; ++i) {
+            using value_type = typename PackedInt::value_type;
+            a.push_back(pint::add_wrap(PackedInt(static_cast<value_type>(gen())), PackedInt(0)));
+            b.push_back(pint::add_wrap(PackedInt(static_cast<value_type>(gen())), PackedInt(0)));
+
+            bitfields x{}, y{};
+            x.value = a.back().value();
+            y.value = b.back().value();
+            bits_a.push_back(x);
+            bits_b.push_back(y);
+        }
+        out.assign(count, PackedInt(0));
+        bits_out.assign(count, bitfields{});
+    }
+};
+
+struct CurrentDataset {
+    std::shared_ptr<void> data;
+    std::type_index type{typeid(void)};
+    size_t count = 0;
+};
+
+CurrentDataset g_current_dataset;
+
+template<class PackedInt>
+Dataset<PackedInt> &GetDataset(size_t count) {
+    auto &current = g_current_dataset;
+    if (current.type != typeid(PackedInt) || current.count != count) {
+        current.data.reset();
+        current.data = std::make_shared<Dataset<PackedInt>>(count);
+        current.type = typeid(PackedInt);
+        current.count = count;
+    }
+    return *static_cast<Dataset<PackedInt> *>(current.data.get());
+}
+
+void SetProcessed(benchmark::State &state, size_t count, size_t size) {
+    state.SetItemsProcessed(static_cast<int64_t>(count) * state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(3 * count * size) * state.iterations());
+}
+
+template<class PackedInt, class Op>
+void MatrixBitfields(benchmark::State &state) {
+    const size_t count = static_cast<size_t>(state.range(0)) / sizeof(PackedInt);
+    auto &data = GetDataset<PackedInt>(count);
+    PerfCounters perf;
+    perf.Start();
+    using bitfields = typename Dataset<PackedInt>::bitfields;
+
+    for (auto $ : state) {
+        for (size_t i = 0; i < count; ++i)
+            data.bits_out[i] = Op::template bitfields<bitfields>(data.bits_a[i], data.bits_b[i]);
+        benchmark::ClobberMemory();
+    }
+    perf.Stop(state, count);
+    SetProcessed(state, count, sizeof(PackedInt));
+}
+
+template<class PackedInt, class Op>
+void MatrixPint(benchmark::State &state) {
+    const size_t count = static_cast<size_t>(state.range(0)) / sizeof(PackedInt);
+    auto &data = GetDataset<PackedInt>(count);
+    PerfCounters perf;
+    perf.Start();
+
+    for (auto $ : state) {
+        for (size_t i = 0; i < count; ++i)
+            data.out[i] = Op::scalar(data.a[i], data.b[i]);
+        benchmark::ClobberMemory();
+    }
+    perf.Stop(state, count);
+    SetProcessed(state, count, sizeof(PackedInt));
+}
+
+template<class PackedInt, class Op>
+void MatrixPintBulk(benchmark::State &state) {
+    const size_t count = static_cast<size_t>(state.range(0)) / sizeof(PackedInt);
+    auto &data = GetDataset<PackedInt>(count);
+    PerfCounters perf;
+    perf.Start();
+
+    for (auto $ : state) {
+        Op::bulk(data.a.data(), data.b.data(), data.out.data(), count);
+        benchmark::ClobberMemory();
+    }
+    perf.Stop(state, count);
+    SetProcessed(state, count, sizeof(PackedInt));
+    state.SetLabel(pint::simd::level_name(pint::simd::current_level()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Registration of layouts x operations x implementations x sizes
+
+template<class PackedInt> struct LayoutName;
+template<class Integer, size_t ...Bits>
+struct LayoutName<pint::packed_int<Integer, Bits...>> {
+    static std::string get() {
+        std::string result = "u" + std::to_string(sizeof(Integer) * 8);
+        for (size_t bits : { Bits... })
+            result += "_" + std::to_string(bits);
+        return result;
+    }
+};
+
+void AddSizes(benchmark::internal::Benchmark *bench) {
+    for (int64_t size : kMatrixSizes)
+        bench->Arg(size);
+}
+
+template<class PackedInt, class Op>
+void RegisterBulk(const std::string &prefix, std::true_type) {
+    AddSizes(benchmark::RegisterBenchmark((prefix + "PintBulk").c_str(), MatrixPintBulk<PackedInt, Op>));
+}
+
+template<class PackedInt, class Op>
+void RegisterBulk(const std::string &, std::false_type) {}
+
+template<class PackedInt, class Op>
+void RegisterCase() {
+    const std::string prefix = "Matrix/" + LayoutName<PackedInt>::get() + "/" + Op::name() + "/";
+
+    AddSizes(benchmark::RegisterBenchmark((prefix + "Bitfields").c_str(), MatrixBitfields<PackedInt, Op>));
+    AddSizes(benchmark::RegisterBenchmark((prefix + "Pint").c_str(), MatrixPint<PackedInt, Op>));
+    RegisterBulk<PackedInt, Op>(prefix, typename Op::bulk_type());
+}
+
+template<class PackedInt, class ...Ops>
+void RegisterLayout() {
+    const int cases[] = { (RegisterCase<PackedInt, Ops>(), 0)... };
+    (void)cases;
+}
+
+template<class PackedInt>
+void RegisterAllOps() {
+    RegisterLayout<PackedInt,
+        AddWrap, AddUnsignedSaturate, AddSignedSaturate,
+        SubWrap, SubUnsignedSaturate, SubSignedSaturate,
+        MinUnsigned, MaxUnsigned, MinSigned, MaxSigned,
+        AvgUnsigned, AvgSigned, AbsdiffUnsigned>();
+    RegisterLayout<PackedInt,
+        MulWrap, MulUnsignedSaturate, MulSignedSaturate, MulHi>();
+    RegisterLayout<PackedInt,
+        CmpEq, CmpNe, CmpLtUnsigned, CmpGtUnsigned, CmpLeUnsigned, CmpGeUnsigned,
+        CmpLtSigned, CmpGtSigned, CmpLeSigned, CmpGeSigned>();
+    RegisterLayout<PackedInt,
+        ShiftLeft, ShiftRightUnsigned, ShiftRightSigned, RotateLeft, RotateRight,
+        AbsSigned, NegSignedSaturate, PopcountLanes, ClzLanes, CtzLanes>();
+    RegisterLayout<PackedInt,
+        ReduceAdd, ReduceOr, ReduceMinUnsigned, ReduceMaxUnsigned>();
+}
+
+// Uniform and mixed layout of each storage type
+const int kMatrixRegistered = [] {
+    RegisterAllOps<pint::packed_int<uint8_t, 4, 4>>();
+    RegisterAllOps<pint::packed_int<uint8_t, 3, 5>>();
+    RegisterAllOps<pint::packed_int<uint16_t, 8, 8>>();
+    RegisterAllOps<pint::packed_int<uint16_t, 5, 6, 5>>();
+    RegisterAllOps<pint::packed_int<uint32_t, 8, 8, 8, 8>>();
+    RegisterAllOps<pint::packed_int<uint32_t, 1, 2, 3, 4, 5, 6, 11>>();
+    RegisterAllOps<pint::packed_int<uint64_t, 16, 16, 16, 16>>();
+    RegisterAllOps<pint::packed_int<uint64_t, 3, 5, 7, 9, 11, 13, 16>>();
+    return 0;
+}();
+
+} // namespace
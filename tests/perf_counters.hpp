@@ -0,0 +1,139 @@
+// Hardware performance counters of benchmarks. Counters are opened with
+// perf_event_open for the calling thread, user space only, and reported
+// per processed item as custom benchmark counters:
+//   cycles, instructions, IPC, branch-misses, L1d-misses, LLC-misses
+// Counters which can't be opened (no PMU in VM, perf_event_paranoid > 2,
+// not Linux) are not reported, benchmarks run as usual
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <benchmark/benchmark.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class PerfCounters {
+public:
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+    ~PerfCounters() { Close(); }
+
+    // Set PINT_PERF_COUNTERS=0 to disable counters
+    static bool Enabled() {
+        static const bool enabled = [] {
+            const char *value = std::getenv("PINT_PERF_COUNTERS");
+            return !value || std::strcmp(value, "0") != 0;
+        }();
+        return enabled;
+    }
+
+    void Start() {
+#ifdef __linux__
+        Close();
+        if (!Enabled())
+            return;
+
+        for (size_t i = 0; i < kEvents; ++i)
+            m_fds[i] = Open(kEventTypes[i], kEventConfigs[i]);
+        for (int fd : m_fds) {
+            if (fd >= 0)
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Stop counting and report counters divided by the number of items
+    // processed by all iterations
+    void Stop(benchmark::State &state, uint64_t items_per_iteration) {
+#ifdef __linux__
+        double values[kEvents];
+        bool valid[kEvents];
+        for (size_t i = 0; i < kEvents; ++i)
+            valid[i] = Read(m_fds[i], values[i]);
+        Close();
+
+        const double items = static_cast<double>(items_per_iteration) * static_cast<double>(state.iterations());
+        if (items == 0)
+            return;
+
+        for (size_t i = 0; i < kEvents; ++i) {
+            if (valid[i])
+                state.counters[kEventNames[i]] = values[i] / items;
+        }
+        if (valid[kCycles] && valid[kInstructions] && values[kCycles] > 0)
+            state.counters["IPC"] = values[kInstructions] / values[kCycles];
+#else
+        (void)state;
+        (void)items_per_iteration;
+#endif
+    }
+
+private:
+#ifdef __linux__
+    enum { kCycles, kInstructions, kBranchMisses, kL1dMisses, kLlcMisses, kEvents };
+
+    static constexpr uint32_t kEventTypes[kEvents] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+    };
+    static constexpr uint64_t kEventConfigs[kEvents] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES
+    };
+    static constexpr const char *kEventNames[kEvents] = {
+        "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses"
+    };
+
+    static int Open(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // Events are opened separately rather than as a group, so PMU with
+        // few counters multiplexes them, values are scaled by time running
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    static bool Read(int fd, double &value) {
+        if (fd < 0)
+            return false;
+
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t data[3];   // value, time enabled, time running
+        if (read(fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+            return false;
+
+        value = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+        return true;
+    }
+
+    void Close() {
+        for (int &fd : m_fds) {
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+        }
+    }
+
+    int m_fds[kEvents] = { -1, -1, -1, -1, -1 };
+#else
+    void Close() {}
+#endif
+};
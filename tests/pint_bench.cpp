@@ -1,5 +1,9 @@
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 #include <random>
 #include <vector>
 
@@ -18,6 +22,19 @@
 #endif
 
 #include "pint/pint.hpp"
+#include "pint/atomic.hpp"
+#include "pint/bitpack.hpp"
+#include "pint/bitsliced.hpp"
+#include "pint/bulk.hpp"
+#include "pint/counters.hpp"
+#include "pint/expr.hpp"
+#include "pint/pixel.hpp"
+#include "pint/sketch.hpp"
+#include "pint/unpack.hpp"
+#include "pint/view.hpp"
+#include "pint/vector.hpp"
+
+#include "perf_counters.hpp"
 
 using TestVector = std::vector<std::pair<uint32_t, uint32_t>>;
 
@@ -25,8 +42,8 @@ TestVector GetRandomPairs(size_t amount_of_pairs) {
     std::vector<std::pair<uint32_t, uint32_t>> result;
     result.reserve(amount_of_pairs);
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
+    // Fixed seed, so results of runs are comparable
+    std::mt19937 gen(1);
     std::uniform_int_distribution<uint32_t> dist;
 
     for (; amount_of_pairs; --amount_of_pairs) {
@@ -60,9 +77,11 @@ class PairsBenchmarks : public benchmark::Fixture {
 public:
     void SetUp(benchmark::State &st) override {
         sum = 0;
+        perf.Start();
     }
 
     void TearDown(benchmark::State &state) override {
+        perf.Stop(state, numbers.size());
         state.SetItemsProcessed(numbers.size() * state.iterations());
         state.SetLabel("Sum = " + std::to_string(sum));
     }
@@ -70,6 +89,7 @@ public:
 protected:
     static TestVector numbers;
     uint32_t sum;
+    PerfCounters perf;
 };
 
 TestVector PairsBenchmarks::numbers = GetRandomPairs(100000000);
@@ -682,3 +702,1544 @@ BENCHMARK_F(AddSatS0, UnionClamp)(benchmark::State& state) {
         }
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// Multiplication vs unpacking with get<> and repacking with constructor
+
+using MulPackedInt = pint::packed_int<uint32_t,1,2,3,4,5,6,11>;
+
+MulPackedInt MulWrapUnpack(MulPackedInt a, MulPackedInt b) {
+    using pint::get;
+    return MulPackedInt(get<0>(a) * get<0>(b), get<1>(a) * get<1>(b), get<2>(a) * get<2>(b),
+        get<3>(a) * get<3>(b), get<4>(a) * get<4>(b), get<5>(a) * get<5>(b), get<6>(a) * get<6>(b));
+}
+
+MulPackedInt MulSatUnpack(MulPackedInt a, MulPackedInt b) {
+    using pint::get;
+    return MulPackedInt(uclamp<1>(get<0>(a) * get<0>(b)), uclamp<2>(get<1>(a) * get<1>(b)),
+        uclamp<3>(get<2>(a) * get<2>(b)), uclamp<4>(get<3>(a) * get<3>(b)),
+        uclamp<5>(get<4>(a) * get<4>(b)), uclamp<6>(get<5>(a) * get<5>(b)),
+        uclamp<11>(get<6>(a) * get<6>(b)));
+}
+
+using MulWrap = PairsBenchmarks;
+
+BENCHMARK_F(MulWrap, Pint)(benchmark::State& state) {
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += pint::mul_wrap(MulPackedInt(pair.first), MulPackedInt(pair.second)).value();
+    }
+}
+
+BENCHMARK_F(MulWrap, Unpack)(benchmark::State& state) {
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += MulWrapUnpack(MulPackedInt(pair.first), MulPackedInt(pair.second)).value();
+    }
+}
+
+BENCHMARK_F(MulWrap, PintConstant)(benchmark::State& state) {
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += pint::mul_wrap<1,3,5,7,9,11,13>(MulPackedInt(pair.first)).value();
+    }
+}
+
+BENCHMARK_F(MulWrap, UnpackConstant)(benchmark::State& state) {
+    const auto multipliers = MulPackedInt(1,3,5,7,9,11,13);
+
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += MulWrapUnpack(MulPackedInt(pair.first), multipliers).value();
+    }
+}
+
+using MulSatU = PairsBenchmarks;
+
+BENCHMARK_F(MulSatU, Pint)(benchmark::State& state) {
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += pint::mul_unsigned_saturate(MulPackedInt(pair.first), MulPackedInt(pair.second)).value();
+    }
+}
+
+BENCHMARK_F(MulSatU, Unpack)(benchmark::State& state) {
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += MulSatUnpack(MulPackedInt(pair.first), MulPackedInt(pair.second)).value();
+    }
+}
+
+BENCHMARK_F(MulSatU, PintConstant)(benchmark::State& state) {
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += pint::mul_unsigned_saturate<1,3,5,7,9,11,13>(MulPackedInt(pair.first)).value();
+    }
+}
+
+BENCHMARK_F(MulSatU, UnpackConstant)(benchmark::State& state) {
+    const auto multipliers = MulPackedInt(1,3,5,7,9,11,13);
+
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += MulSatUnpack(MulPackedInt(pair.first), multipliers).value();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reductions vs unpacking with get<>
+
+using ReducePackedInt = pint::packed_int<uint64_t,8,8,8,8,8,8,8,8>;
+
+ReducePackedInt MakeReducePackedInt(const std::pair<uint32_t, uint32_t> &pair) {
+    return ReducePackedInt((uint64_t(pair.first) << 32) | pair.second);
+}
+
+uint32_t ReduceAddUnpack(ReducePackedInt value) {
+    using pint::get;
+    return get<0>(value) + get<1>(value) + get<2>(value) + get<3>(value)
+        + get<4>(value) + get<5>(value) + get<6>(value) + get<7>(value);
+}
+
+uint32_t ReduceMaxUnpack(ReducePackedInt value) {
+    using pint::get;
+    return std::max({get<0>(value), get<1>(value), get<2>(value), get<3>(value),
+        get<4>(value), get<5>(value), get<6>(value), get<7>(value)});
+}
+
+using ReduceAdd = PairsBenchmarks;
+
+BENCHMARK_F(ReduceAdd, Pint)(benchmark::State& state) {
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += pint::reduce_add_wide(MakeReducePackedInt(pair));
+    }
+}
+
+BENCHMARK_F(ReduceAdd, Unpack)(benchmark::State& state) {
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += ReduceAddUnpack(MakeReducePackedInt(pair));
+    }
+}
+
+using ReduceMaxU = PairsBenchmarks;
+
+BENCHMARK_F(ReduceMaxU, Pint)(benchmark::State& state) {
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += pint::reduce_max_unsigned(MakeReducePackedInt(pair));
+    }
+}
+
+BENCHMARK_F(ReduceMaxU, Unpack)(benchmark::State& state) {
+    for (auto $ : state) {
+        sum = 0;
+        for (auto &pair : numbers)
+            sum += ReduceMaxUnpack(MakeReducePackedInt(pair));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Bulk functions vs loop over scalar functions
+
+template<class PackedInt>
+class ArraysBenchmarks : public PairsBenchmarks {
+public:
+    void SetUp(benchmark::State &state) override {
+        if (first.empty()) {
+            first.reserve(kArraySize);
+            second.reserve(kArraySize);
+            for (size_t i = 0; i < kArraySize; ++i) {
+                first.emplace_back(numbers[i].first);
+                second.emplace_back(numbers[i].second);
+            }
+            result.assign(kArraySize, PackedInt(0));
+        }
+
+        // Counting starts after arrays are filled
+        PairsBenchmarks::SetUp(state);
+    }
+
+    void TearDown(benchmark::State &state) override {
+        perf.Stop(state, first.size());
+        for (auto value : result)
+            sum += value.value();
+
+        state.SetItemsProcessed(first.size() * state.iterations());
+        state.SetLabel(std::string(pint::simd::level_name(pint::simd::current_level()))
+            + ", Sum = " + std::to_string(sum));
+        pint::simd::set_level(initial_level);
+    }
+
+protected:
+    // Force instruction set passed as benchmark argument
+    bool ForceLevel(benchmark::State &state) {
+        const auto level = static_cast<pint::simd::level>(state.range(0));
+        if (level > pint::simd::detected_level()) {
+            state.SkipWithError("Instruction set is not supported by CPU");
+            return false;
+        }
+
+        pint::simd::set_level(level);
+        return true;
+    }
+
+    const pint::simd::level initial_level = pint::simd::current_level();
+
+    static const size_t kArraySize = 10000000;
+    static std::vector<PackedInt> first, second, result;
+};
+
+template<class PackedInt> std::vector<PackedInt> ArraysBenchmarks<PackedInt>::first;
+template<class PackedInt> std::vector<PackedInt> ArraysBenchmarks<PackedInt>::second;
+template<class PackedInt> std::vector<PackedInt> ArraysBenchmarks<PackedInt>::result;
+
+using AddWrapBulk = ArraysBenchmarks<pint::packed_int<uint32_t,1,2,3,4,5,6,11>>;
+
+BENCHMARK_F(AddWrapBulk, Pint)(benchmark::State& state) {
+    for (auto $ : state) {
+        for (size_t i = 0; i < first.size(); ++i)
+            result[i] = pint::add_wrap(first[i], second[i]);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_F(AddWrapBulk, PintBulk)(benchmark::State& state) {
+    for (auto $ : state) {
+        pint::add_wrap(first.data(), second.data(), result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_DEFINE_F(AddWrapBulk, PintBulkLevel)(benchmark::State& state) {
+    if (!ForceLevel(state))
+        return;
+
+    for (auto $ : state) {
+        pint::add_wrap(first.data(), second.data(), result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_REGISTER_F(AddWrapBulk, PintBulkLevel)->DenseRange(0, 4);
+
+using AddWrap0Bulk = ArraysBenchmarks<pint::packed_int<uint32_t,8,8,8,8>>;
+
+BENCHMARK_F(AddWrap0Bulk, Pint)(benchmark::State& state) {
+    for (auto $ : state) {
+        for (size_t i = 0; i < first.size(); ++i)
+            result[i] = pint::add_wrap(first[i], second[i]);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_F(AddWrap0Bulk, PintBulk)(benchmark::State& state) {
+    for (auto $ : state) {
+        pint::add_wrap(first.data(), second.data(), result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_DEFINE_F(AddWrap0Bulk, PintBulkLevel)(benchmark::State& state) {
+    if (!ForceLevel(state))
+        return;
+
+    for (auto $ : state) {
+        pint::add_wrap(first.data(), second.data(), result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_REGISTER_F(AddWrap0Bulk, PintBulkLevel)->DenseRange(0, 4);
+
+using AddSatU2Bulk = ArraysBenchmarks<pint::packed_int<uint32_t,1,2,3,4,5,6,11>>;
+
+BENCHMARK_F(AddSatU2Bulk, Pint)(benchmark::State& state) {
+    for (auto $ : state) {
+        for (size_t i = 0; i < first.size(); ++i)
+            result[i] = pint::add_unsigned_saturate(first[i], second[i]);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_F(AddSatU2Bulk, PintBulk)(benchmark::State& state) {
+    for (auto $ : state) {
+        pint::add_unsigned_saturate(first.data(), second.data(), result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_DEFINE_F(AddSatU2Bulk, PintBulkLevel)(benchmark::State& state) {
+    if (!ForceLevel(state))
+        return;
+
+    for (auto $ : state) {
+        pint::add_unsigned_saturate(first.data(), second.data(), result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_REGISTER_F(AddSatU2Bulk, PintBulkLevel)->DenseRange(0, 4);
+
+// Wrapped sum with overflow flags checked once per array,
+// compared with AddSatU2Bulk which saturates each sum
+using AddOverflowU2Bulk = ArraysBenchmarks<pint::packed_int<uint32_t,1,2,3,4,5,6,11>>;
+
+BENCHMARK_F(AddOverflowU2Bulk, Pint)(benchmark::State& state) {
+    pint::overflow_flags<pint::packed_int<uint32_t,1,2,3,4,5,6,11>> overflow;
+    for (auto $ : state) {
+        for (size_t i = 0; i < first.size(); ++i)
+            result[i] = pint::add_overflow_unsigned(first[i], second[i], overflow);
+        benchmark::ClobberMemory();
+    }
+    benchmark::DoNotOptimize(overflow.any());
+}
+
+BENCHMARK_DEFINE_F(AddOverflowU2Bulk, PintBulkLevel)(benchmark::State& state) {
+    if (!ForceLevel(state))
+        return;
+
+    pint::overflow_flags<pint::packed_int<uint32_t,1,2,3,4,5,6,11>> overflow;
+    for (auto $ : state) {
+        pint::add_overflow_unsigned(first.data(), second.data(), result.data(), first.size(), overflow);
+        benchmark::ClobberMemory();
+    }
+    benchmark::DoNotOptimize(overflow.any());
+}
+BENCHMARK_REGISTER_F(AddOverflowU2Bulk, PintBulkLevel)->DenseRange(0, 4);
+
+using MinS2Bulk = ArraysBenchmarks<pint::packed_int<uint32_t,1,2,3,4,5,6,11>>;
+
+BENCHMARK_F(MinS2Bulk, Pint)(benchmark::State& state) {
+    for (auto $ : state) {
+        for (size_t i = 0; i < first.size(); ++i)
+            result[i] = pint::min_signed(first[i], second[i]);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_F(MinS2Bulk, PintBulk)(benchmark::State& state) {
+    for (auto $ : state) {
+        pint::min_signed(first.data(), second.data(), result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_DEFINE_F(MinS2Bulk, PintBulkLevel)(benchmark::State& state) {
+    if (!ForceLevel(state))
+        return;
+
+    for (auto $ : state) {
+        pint::min_signed(first.data(), second.data(), result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_REGISTER_F(MinS2Bulk, PintBulkLevel)->DenseRange(0, 4);
+
+////////////////////////////////////////////////////////////////////////////////
+// Expression min(a + b + b, a): fused evaluation vs bulk function per
+// operation (with temporary array) vs loop over scalar functions
+
+using ExprU2 = ArraysBenchmarks<pint::packed_int<uint32_t,1,2,3,4,5,6,11>>;
+
+BENCHMARK_F(ExprU2, Pint)(benchmark::State& state) {
+    for (auto $ : state) {
+        for (size_t i = 0; i < first.size(); ++i) {
+            result[i] = pint::min_unsigned(
+                pint::add_unsigned_saturate(pint::add_unsigned_saturate(first[i], second[i]), second[i]),
+                first[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_F(ExprU2, PintBulk)(benchmark::State& state) {
+    for (auto $ : state) {
+        pint::add_unsigned_saturate(first.data(), second.data(), result.data(), first.size());
+        pint::add_unsigned_saturate(result.data(), second.data(), result.data(), first.size());
+        pint::min_unsigned(result.data(), first.data(), result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_F(ExprU2, PintExpr)(benchmark::State& state) {
+    for (auto $ : state) {
+        pint::evaluate((pint::expr(first.data()) + second.data() + second.data()).min(first.data()),
+            result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_DEFINE_F(ExprU2, PintExprLevel)(benchmark::State& state) {
+    if (!ForceLevel(state))
+        return;
+
+    for (auto $ : state) {
+        pint::evaluate((pint::expr(first.data()) + second.data() + second.data()).min(first.data()),
+            result.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_REGISTER_F(ExprU2, PintExprLevel)->DenseRange(0, 4);
+
+////////////////////////////////////////////////////////////////////////////////
+// Packed vector: bulk unpacking and packing vs get / set of each value
+
+class PackedVectorBenchmarks : public ArraysBenchmarks<pint::packed_int<uint32_t,11>> {
+public:
+    void SetUp(benchmark::State &state) override {
+        ArraysBenchmarks::SetUp(state);
+
+        if (!values.empty())
+            return;
+
+        values.reserve(kArraySize);
+        for (size_t i = 0; i < kArraySize; ++i)
+            values.push_back(numbers[i].first & 0x7ff);
+
+        vector.resize(kArraySize);
+        vector.pack(0, values.data(), values.size());
+        unpacked.assign(kArraySize, 0);
+    }
+
+    void TearDown(benchmark::State &state) override {
+        sum = unpacked[state.iterations() % kArraySize] + vector.get(kArraySize / 2);
+        ArraysBenchmarks::TearDown(state);
+    }
+
+protected:
+    static std::vector<uint32_t> values, unpacked;
+    static pint::packed_vector<11> vector;
+};
+
+std::vector<uint32_t> PackedVectorBenchmarks::values;
+std::vector<uint32_t> PackedVectorBenchmarks::unpacked;
+pint::packed_vector<11> PackedVectorBenchmarks::vector;
+
+BENCHMARK_F(PackedVectorBenchmarks, Get)(benchmark::State& state) {
+    for (auto $ : state) {
+        for (size_t i = 0; i < vector.size(); ++i)
+            unpacked[i] = vector.get(i);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_DEFINE_F(PackedVectorBenchmarks, UnpackLevel)(benchmark::State& state) {
+    if (!ForceLevel(state))
+        return;
+
+    for (auto $ : state) {
+        vector.unpack(0, unpacked.data(), vector.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_REGISTER_F(PackedVectorBenchmarks, UnpackLevel)->DenseRange(0, 4);
+
+BENCHMARK_F(PackedVectorBenchmarks, Set)(benchmark::State& state) {
+    for (auto $ : state) {
+        for (size_t i = 0; i < values.size(); ++i)
+            vector.set(i, values[i]);
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_F(PackedVectorBenchmarks, Pack)(benchmark::State& state) {
+    for (auto $ : state) {
+        vector.pack(0, values.data(), values.size());
+        benchmark::ClobberMemory();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Conversion to array of values and back: pdep / pext vs get<> and constructor
+
+class UnpackBenchmarks : public ArraysBenchmarks<pint::packed_int<uint32_t,1,2,3,4,5,6,11>> {
+public:
+    void SetUp(benchmark::State &state) override {
+        ArraysBenchmarks::SetUp(state);
+
+        if (!fields.empty())
+            return;
+
+        fields.assign(kArraySize * kPacks, 0);
+        pint::unpack(first.data(), fields.data(), first.size());
+    }
+
+    void TearDown(benchmark::State &state) override {
+        sum = fields[state.iterations() % fields.size()];
+        ArraysBenchmarks::TearDown(state);
+        state.SetLabel(std::string(pint::simd::current_bmi2() ? "bmi2" : "scalar")
+            + ", Sum = " + std::to_string(sum));
+        pint::simd::set_bmi2(initial_bmi2);
+    }
+
+protected:
+    // Enable pdep / pext if benchmark argument is 1
+    bool ForceBmi2(benchmark::State &state) {
+        if (state.range(0) && !pint::simd::detected_bmi2()) {
+            state.SkipWithError("BMI2 is not supported by CPU");
+            return false;
+        }
+
+        pint::simd::set_bmi2(state.range(0) != 0);
+        return true;
+    }
+
+    const bool initial_bmi2 = pint::simd::current_bmi2();
+
+    static const size_t kPacks = 7;
+    static std::vector<uint16_t> fields;
+};
+
+std::vector<uint16_t> UnpackBenchmarks::fields;
+
+BENCHMARK_F(UnpackBenchmarks, Get)(benchmark::State& state) {
+    using pint::get;
+
+    for (auto $ : state) {
+        for (size_t i = 0; i < first.size(); ++i) {
+            uint16_t *out = &fields[i * kPacks];
+            out[0] = get<0>(first[i]); out[1] = get<1>(first[i]); out[2] = get<2>(first[i]);
+            out[3] = get<3>(first[i]); out[4] = get<4>(first[i]); out[5] = get<5>(first[i]);
+            out[6] = get<6>(first[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_DEFINE_F(UnpackBenchmarks, Unpack)(benchmark::State& state) {
+    if (!ForceBmi2(state))
+        return;
+
+    for (auto $ : state) {
+        pint::unpack(first.data(), fields.data(), first.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_REGISTER_F(UnpackBenchmarks, Unpack)->DenseRange(0, 1);
+
+// Constructor truncates and shifts each pack (make_truncate)
+BENCHMARK_F(UnpackBenchmarks, Construct)(benchmark::State& state) {
+    using PackedInt = pint::packed_int<uint32_t,1,2,3,4,5,6,11>;
+
+    for (auto $ : state) {
+        for (size_t i = 0; i < result.size(); ++i) {
+            const uint16_t *in = &fields[i * kPacks];
+            result[i] = PackedInt(in[0], in[1], in[2], in[3], in[4], in[5], in[6]);
+        }
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_DEFINE_F(UnpackBenchmarks, Pack)(benchmark::State& state) {
+    if (!ForceBmi2(state))
+        return;
+
+    for (auto $ : state) {
+        pint::pack(fields.data(), result.data(), result.size());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_REGISTER_F(UnpackBenchmarks, Pack)->DenseRange(0, 1);
+
+// Records to columns and back, scan of one pack of records vs its column.
+// Copy of records is the memory bandwidth reference
+
+class LanesBenchmarks : public ArraysBenchmarks<pint::packed_int<uint32_t,1,2,3,4,5,6,11>> {
+public:
+    void SetUp(benchmark::State &state) override {
+        if (columns.empty()) {
+            columns.assign(6, std::vector<uint8_t>(kArraySize));
+            wide_column.assign(kArraySize, 0);
+        }
+        ArraysBenchmarks::SetUp(state);
+    }
+
+protected:
+    void UnpackLanes() {
+        pint::unpack_lanes(first.data(), first.size(), columns[0].data(), columns[1].data(), columns[2].data(),
+            columns[3].data(), columns[4].data(), columns[5].data(), wide_column.data());
+    }
+
+    static std::vector<std::vector<uint8_t>> columns;
+    static std::vector<uint16_t> wide_column;
+};
+
+std::vector<std::vector<uint8_t>> LanesBenchmarks::columns;
+std::vector<uint16_t> LanesBenchmarks::wide_column;
+
+BENCHMARK_F(LanesBenchmarks, Copy)(benchmark::State& state) {
+    for (auto $ : state) {
+        std::copy(first.begin(), first.end(), result.begin());
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_F(LanesBenchmarks, Get)(benchmark::State& state) {
+    using pint::get;
+
+    for (auto $ : state) {
+        for (size_t i = 0; i < first.size(); ++i) {
+            columns[0][i] = get<0>(first[i]); columns[1][i] = get<1>(first[i]); columns[2][i] = get<2>(first[i]);
+            columns[3][i] = get<3>(first[i]); columns[4][i] = get<4>(first[i]); columns[5][i] = get<5>(first[i]);
+            wide_column[i] = get<6>(first[i]);
+        }
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK_DEFINE_F(LanesBenchmarks, UnpackLanes)(benchmark::State& state) {
+    if (!ForceLevel(state))
+        return;
+
+    for (auto $ : state) {
+        UnpackLanes();
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_REGISTER_F(LanesBenchmarks, UnpackLanes)->DenseRange(0, 4);
+
+BENCHMARK_DEFINE_F(LanesBenchmarks, PackLanes)(benchmark::State& state) {
+    if (!ForceLevel(state))
+        return;
+
+    UnpackLanes();
+    for (auto $ : state) {
+        pint::pack_lanes(result.data(), result.size(), columns[0].data(), columns[1].data(), columns[2].data(),
+            columns[3].data(), columns[4].data(), columns[5].data(), wide_column.data());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_REGISTER_F(LanesBenchmarks, PackLanes)->DenseRange(0, 4);
+
+// Sum of pack 3 over records and over its column
+BENCHMARK_F(LanesBenchmarks, ScanRecords)(benchmark::State& state) {
+    for (auto $ : state) {
+        uint32_t total = 0;
+        for (auto record : first)
+            total += pint::get<3>(record);
+        sum = total;
+    }
+}
+
+BENCHMARK_F(LanesBenchmarks, ScanColumn)(benchmark::State& state) {
+    UnpackLanes();
+    for (auto $ : state) {
+        uint32_t total = 0;
+        for (auto value : columns[3])
+            total += value;
+        sum = total;
+    }
+}
+
+// Counters shared by all threads: 4 saturating 16-bit counters in one word,
+// updated atomically, under mutex, or in per-thread shards merged on read
+using SharedCounters = pint::packed_int<uint64_t,16,16,16,16>;
+const SharedCounters kCountersIncrement(1, 0, 1, 2);
+
+void CountersAtomic(benchmark::State& state) {
+    static pint::atomic_packed_int<SharedCounters> counters;
+    for (auto $ : state)
+        counters.fetch_add_unsigned_saturate(kCountersIncrement, std::memory_order_relaxed);
+
+    state.SetItemsProcessed(state.iterations());
+    benchmark::DoNotOptimize(counters.load().value());
+}
+BENCHMARK(CountersAtomic)->ThreadRange(1, 16)->UseRealTime();
+
+void CountersMutex(benchmark::State& state) {
+    static std::mutex mutex;
+    static SharedCounters counters(0);
+    for (auto $ : state) {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters = pint::add_unsigned_saturate(counters, kCountersIncrement);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    benchmark::DoNotOptimize(counters.value());
+}
+BENCHMARK(CountersMutex)->ThreadRange(1, 16)->UseRealTime();
+
+void CountersSharded(benchmark::State& state) {
+    struct alignas(64) Shard { SharedCounters value{0}; };
+    static Shard shards[16];
+
+    SharedCounters &counters = shards[state.thread_index()].value;
+    for (auto $ : state) {
+        counters = pint::add_unsigned_saturate(counters, kCountersIncrement);
+        benchmark::DoNotOptimize(counters);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(CountersSharded)->ThreadRange(1, 16)->UseRealTime();
+
+// The same counters in sharded_counters: 16 shards, one per thread
+void ShardedCountersAdd(benchmark::State& state) {
+    static pint::sharded_counters<SharedCounters> counters(16);
+    for (auto $ : state)
+        counters.add(kCountersIncrement);
+
+    state.SetItemsProcessed(state.iterations());
+    benchmark::DoNotOptimize(counters.load().value());
+}
+BENCHMARK(ShardedCountersAdd)->ThreadRange(1, 16)->UseRealTime();
+
+// Read latency is linear in number of shards
+void ShardedCountersLoad(benchmark::State& state) {
+    pint::sharded_counters<SharedCounters> counters(state.range(0));
+    counters.add(kCountersIncrement);
+
+    for (auto $ : state)
+        benchmark::DoNotOptimize(counters.load().value());
+}
+BENCHMARK(ShardedCountersLoad)->RangeMultiplier(4)->Range(1, 256);
+
+// Count-min sketch with 2^20 x 4 counters: packed 4 and 8-bit counters
+// compared with plain uint8_t array, which saturates at 255
+class ByteCountMinSketch {
+public:
+    ByteCountMinSketch(size_t width, size_t depth)
+        : m_width(width), m_depth(depth), m_counters(width * depth, 0) {}
+
+    size_t size_bytes() const { return m_counters.size(); }
+
+    void insert(uint64_t hash) {
+        const pint::detail::probes probes(hash);
+        for (size_t row = 0; row < m_depth; ++row) {
+            uint8_t &counter = m_counters[row * m_width + probes(row, m_width - 1)];
+            counter += counter != 255;
+        }
+    }
+
+    uint32_t query(uint64_t hash) const {
+        const pint::detail::probes probes(hash);
+        uint32_t result = 255;
+        for (size_t row = 0; row < m_depth; ++row)
+            result = std::min<uint32_t>(result, m_counters[row * m_width + probes(row, m_width - 1)]);
+        return result;
+    }
+
+private:
+    size_t m_width;
+    size_t m_depth;
+    std::vector<uint8_t> m_counters;
+};
+
+const size_t kSketchWidth = 1 << 20;
+const size_t kSketchDepth = 4;
+
+const std::vector<uint64_t> &SketchKeys() {
+    static const std::vector<uint64_t> keys = [] {
+        std::mt19937_64 gen(1);
+        std::vector<uint64_t> result(1 << 20);
+        for (auto &key : result)
+            key = gen() % 100000;
+        return result;
+    }();
+    return keys;
+}
+
+template<class Sketch>
+void SketchInsert(benchmark::State& state, Sketch &sketch) {
+    const auto &keys = SketchKeys();
+    for (auto $ : state) {
+        for (auto key : keys)
+            sketch.insert(key);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(keys.size() * state.iterations());
+    state.counters["bytes"] = sketch.size_bytes();
+}
+
+template<class Sketch>
+void SketchQuery(benchmark::State& state, const Sketch &sketch) {
+    const auto &keys = SketchKeys();
+    uint64_t sum = 0;
+    for (auto $ : state) {
+        for (auto key : keys)
+            sum += sketch.query(key);
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(keys.size() * state.iterations());
+    state.counters["bytes"] = sketch.size_bytes();
+}
+
+template<class Sketch>
+void SketchQueryBatch(benchmark::State& state, const Sketch &sketch) {
+    const auto &keys = SketchKeys();
+    std::vector<uint32_t> result(keys.size());
+    for (auto $ : state) {
+        sketch.query(keys.data(), result.data(), keys.size());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(keys.size() * state.iterations());
+    state.counters["bytes"] = sketch.size_bytes();
+}
+
+pint::count_min_sketch<4> &CountMin4() {
+    static pint::count_min_sketch<4> sketch(kSketchWidth, kSketchDepth);
+    return sketch;
+}
+
+pint::count_min_sketch<8> &CountMin8() {
+    static pint::count_min_sketch<8> sketch(kSketchWidth, kSketchDepth);
+    return sketch;
+}
+
+ByteCountMinSketch &CountMinBytes() {
+    static ByteCountMinSketch sketch(kSketchWidth, kSketchDepth);
+    return sketch;
+}
+
+void CountMinInsert4(benchmark::State& state) { SketchInsert(state, CountMin4()); }
+void CountMinInsert8(benchmark::State& state) { SketchInsert(state, CountMin8()); }
+void CountMinInsertBytes(benchmark::State& state) { SketchInsert(state, CountMinBytes()); }
+void CountMinQuery4(benchmark::State& state) { SketchQuery(state, CountMin4()); }
+void CountMinQuery8(benchmark::State& state) { SketchQuery(state, CountMin8()); }
+void CountMinQueryBytes(benchmark::State& state) { SketchQuery(state, CountMinBytes()); }
+void CountMinQueryBatch4(benchmark::State& state) { SketchQueryBatch(state, CountMin4()); }
+void CountMinQueryBatch8(benchmark::State& state) { SketchQueryBatch(state, CountMin8()); }
+
+BENCHMARK(CountMinInsert4);
+BENCHMARK(CountMinInsert8);
+BENCHMARK(CountMinInsertBytes);
+BENCHMARK(CountMinQuery4);
+BENCHMARK(CountMinQuery8);
+BENCHMARK(CountMinQueryBytes);
+BENCHMARK(CountMinQueryBatch4);
+BENCHMARK(CountMinQueryBatch8);
+
+////////////////////////////////////////////////////////////////////////////////
+// Pixel kernels on 4K RGB565 frames vs code which unpacks each channel
+
+const size_t kFramePixels = 3840 * 2160;
+
+struct Frames {
+    std::vector<pint::rgb565> src, dst, out;
+    std::vector<pint::rgba8888> wide;
+};
+
+Frames &PixelFrames() {
+    static Frames frames = [] {
+        std::mt19937 gen(1);
+        Frames result;
+        for (size_t i = 0; i < kFramePixels; ++i) {
+            result.src.emplace_back(static_cast<uint16_t>(gen()));
+            result.dst.emplace_back(static_cast<uint16_t>(gen()));
+        }
+        result.out.assign(kFramePixels, pint::rgb565(0));
+        result.wide.assign(kFramePixels, pint::rgba8888(0u));
+        return result;
+    }();
+    return frames;
+}
+
+void SetPixels(benchmark::State& state) {
+    state.SetItemsProcessed(kFramePixels * state.iterations());
+    state.SetLabel(pint::simd::level_name(pint::simd::current_level()));
+}
+
+const uint8_t kBlendAlpha = 100;
+const pint::rgb565 kBrightness(2, 4, 2);
+
+void BlendRGB565Unpack(benchmark::State& state) {
+    auto &f = PixelFrames();
+    const uint32_t a = (kBlendAlpha * 64 + 127) / 255;
+    for (auto $ : state) {
+        for (size_t i = 0; i < kFramePixels; ++i) {
+            const uint32_t s = f.src[i].value(), d = f.dst[i].value();
+            const uint32_t r = ((s >> 11) * a + (d >> 11) * (64 - a)) >> 6;
+            const uint32_t g = (((s >> 5) & 63) * a + ((d >> 5) & 63) * (64 - a)) >> 6;
+            const uint32_t b = ((s & 31) * a + (d & 31) * (64 - a)) >> 6;
+            f.out[i] = pint::rgb565(static_cast<uint16_t>(r << 11 | g << 5 | b));
+        }
+        benchmark::ClobberMemory();
+    }
+    SetPixels(state);
+}
+BENCHMARK(BlendRGB565Unpack);
+
+void BlendRGB565Pint(benchmark::State& state) {
+    auto &f = PixelFrames();
+    for (auto $ : state) {
+        pint::blend(f.src.data(), f.dst.data(), f.out.data(), kFramePixels, kBlendAlpha);
+        benchmark::ClobberMemory();
+    }
+    SetPixels(state);
+}
+BENCHMARK(BlendRGB565Pint);
+
+void AverageRGB565Unpack(benchmark::State& state) {
+    auto &f = PixelFrames();
+    for (auto $ : state) {
+        for (size_t i = 0; i < kFramePixels; ++i) {
+            const uint32_t s = f.src[i].value(), d = f.dst[i].value();
+            const uint32_t r = ((s >> 11) + (d >> 11)) >> 1;
+            const uint32_t g = (((s >> 5) & 63) + ((d >> 5) & 63)) >> 1;
+            const uint32_t b = ((s & 31) + (d & 31)) >> 1;
+            f.out[i] = pint::rgb565(static_cast<uint16_t>(r << 11 | g << 5 | b));
+        }
+        benchmark::ClobberMemory();
+    }
+    SetPixels(state);
+}
+BENCHMARK(AverageRGB565Unpack);
+
+void AverageRGB565Pint(benchmark::State& state) {
+    auto &f = PixelFrames();
+    for (auto $ : state) {
+        pint::average(f.src.data(), f.dst.data(), f.out.data(), kFramePixels);
+        benchmark::ClobberMemory();
+    }
+    SetPixels(state);
+}
+BENCHMARK(AverageRGB565Pint);
+
+void BrightenRGB565Unpack(benchmark::State& state) {
+    auto &f = PixelFrames();
+    const uint32_t add = kBrightness.value();
+    for (auto $ : state) {
+        for (size_t i = 0; i < kFramePixels; ++i) {
+            const uint32_t s = f.src[i].value();
+            const uint32_t r = std::min<uint32_t>((s >> 11) + (add >> 11), 31);
+            const uint32_t g = std::min<uint32_t>(((s >> 5) & 63) + ((add >> 5) & 63), 63);
+            const uint32_t b = std::min<uint32_t>((s & 31) + (add & 31), 31);
+            f.out[i] = pint::rgb565(static_cast<uint16_t>(r << 11 | g << 5 | b));
+        }
+        benchmark::ClobberMemory();
+    }
+    SetPixels(state);
+}
+BENCHMARK(BrightenRGB565Unpack);
+
+void BrightenRGB565Pint(benchmark::State& state) {
+    auto &f = PixelFrames();
+    for (auto $ : state) {
+        pint::brighten(f.src.data(), kBrightness, f.out.data(), kFramePixels);
+        benchmark::ClobberMemory();
+    }
+    SetPixels(state);
+}
+BENCHMARK(BrightenRGB565Pint);
+
+void ConvertRGB565ToRGBA8888Unpack(benchmark::State& state) {
+    auto &f = PixelFrames();
+    for (auto $ : state) {
+        for (size_t i = 0; i < kFramePixels; ++i) {
+            const uint32_t s = f.src[i].value();
+            const uint32_t r = s >> 11, g = (s >> 5) & 63, b = s & 31;
+            f.wide[i] = pint::rgba8888((r << 3 | r >> 2) << 24 | (g << 2 | g >> 4) << 16 | (b << 3 | b >> 2) << 8 | 0xff);
+        }
+        benchmark::ClobberMemory();
+    }
+    SetPixels(state);
+}
+BENCHMARK(ConvertRGB565ToRGBA8888Unpack);
+
+void ConvertRGB565ToRGBA8888Pint(benchmark::State& state) {
+    auto &f = PixelFrames();
+    for (auto $ : state) {
+        pint::convert_pixels(f.src.data(), f.wide.data(), kFramePixels);
+        benchmark::ClobberMemory();
+    }
+    SetPixels(state);
+}
+BENCHMARK(ConvertRGB565ToRGBA8888Pint);
+
+void ConvertRGBA8888ToRGB565Unpack(benchmark::State& state) {
+    auto &f = PixelFrames();
+    for (auto $ : state) {
+        for (size_t i = 0; i < kFramePixels; ++i) {
+            const uint32_t s = f.wide[i].value();
+            f.out[i] = pint::rgb565(static_cast<uint16_t>((s >> 27) << 11 | ((s >> 18) & 63) << 5 | ((s >> 11) & 31)));
+        }
+        benchmark::ClobberMemory();
+    }
+    SetPixels(state);
+}
+BENCHMARK(ConvertRGBA8888ToRGB565Unpack);
+
+void ConvertRGBA8888ToRGB565Pint(benchmark::State& state) {
+    auto &f = PixelFrames();
+    for (auto $ : state) {
+        pint::convert_pixels(f.wide.data(), f.out.data(), kFramePixels);
+        benchmark::ClobberMemory();
+    }
+    SetPixels(state);
+}
+BENCHMARK(ConvertRGBA8888ToRGB565Pint);
+
+// Sum of absolute differences, the cost function of motion estimation
+void SadRGB565Unpack(benchmark::State& state) {
+    auto &f = PixelFrames();
+    for (auto $ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kFramePixels; ++i) {
+            const int s = f.src[i].value(), d = f.dst[i].value();
+            sum += std::abs((s >> 11) - (d >> 11)) + std::abs(((s >> 5) & 63) - ((d >> 5) & 63))
+                + std::abs((s & 31) - (d & 31));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    SetPixels(state);
+}
+BENCHMARK(SadRGB565Unpack);
+
+void SadRGB565Pint(benchmark::State& state) {
+    auto &f = PixelFrames();
+    for (auto $ : state)
+        benchmark::DoNotOptimize(pint::sad_unsigned(f.src.data(), f.dst.data(), kFramePixels));
+    SetPixels(state);
+}
+BENCHMARK(SadRGB565Pint);
+
+// 8-bit luma, 8 pixels per packed integer: psadbw
+using Luma8 = pint::packed_int<uint64_t, 8, 8, 8, 8, 8, 8, 8, 8>;
+
+const size_t kLumaWords = kFramePixels / 8;
+
+std::vector<Luma8> RandomLuma(unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::vector<Luma8> result;
+    for (size_t i = 0; i < kLumaWords; ++i)
+        result.emplace_back(static_cast<uint64_t>(gen()));
+    return result;
+}
+
+void SadLumaUnpack(benchmark::State& state) {
+    static const auto a = RandomLuma(1), b = RandomLuma(2);
+    for (auto $ : state) {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kLumaWords; ++i) {
+            const uint64_t x = a[i].value(), y = b[i].value();
+            for (size_t j = 0; j < 64; j += 8)
+                sum += static_cast<uint64_t>(std::abs(int((x >> j) & 0xff) - int((y >> j) & 0xff)));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    SetPixels(state);
+}
+BENCHMARK(SadLumaUnpack);
+
+void SadLumaPint(benchmark::State& state) {
+    static const auto a = RandomLuma(1), b = RandomLuma(2);
+    for (auto $ : state)
+        benchmark::DoNotOptimize(pint::sad_unsigned(a.data(), b.data(), kLumaWords));
+    SetPixels(state);
+}
+BENCHMARK(SadLumaPint);
+
+////////////////////////////////////////////////////////////////////////////////
+// Bit-packing codec of time series deltas: widths vary from 3 to 12 bits
+// by blocks. Throughput is measured in bytes of uint32_t values, as memcpy
+
+const size_t kDeltas = 4 << 20;
+
+const std::vector<uint32_t> &Deltas() {
+    static const std::vector<uint32_t> deltas = [] {
+        std::mt19937 gen(1);
+        std::vector<uint32_t> result(kDeltas);
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kDeltas; ++i) {
+            if (i % pint::bitpack::block_size == 0)
+                mask = (uint32_t(1) << (3 + gen() % 10)) - 1;
+            result[i] = gen() & mask;
+        }
+        return result;
+    }();
+    return deltas;
+}
+
+void SetDeltaBytes(benchmark::State& state, size_t words) {
+    state.SetBytesProcessed(kDeltas * sizeof(uint32_t) * state.iterations());
+    state.counters["ratio"] = double(kDeltas * sizeof(uint32_t)) / double(words * sizeof(uint64_t));
+}
+
+void BitpackMemcpy(benchmark::State& state) {
+    const auto &deltas = Deltas();
+    std::vector<uint32_t> out(kDeltas);
+    for (auto $ : state) {
+        std::memcpy(out.data(), deltas.data(), kDeltas * sizeof(uint32_t));
+        benchmark::ClobberMemory();
+    }
+    SetDeltaBytes(state, kDeltas / 2);
+}
+BENCHMARK(BitpackMemcpy);
+
+void BitpackEncode(benchmark::State& state) {
+    const auto &deltas = Deltas();
+    pint::bitpack::encoder encoder;
+    std::vector<uint64_t> words;
+    for (auto $ : state) {
+        encoder.encode(deltas.data(), kDeltas);
+        encoder.finish();
+        words = encoder.take();
+        benchmark::DoNotOptimize(words.data());
+    }
+    SetDeltaBytes(state, words.size());
+}
+BENCHMARK(BitpackEncode);
+
+// Argument is SIMD level
+void BitpackDecode(benchmark::State& state) {
+    const auto level = static_cast<pint::simd::level>(state.range(0));
+    if (level > pint::simd::detected_level()) {
+        state.SkipWithError("Instruction set is not supported by CPU");
+        return;
+    }
+
+    const auto &deltas = Deltas();
+    const auto words = pint::bitpack::encode(deltas.data(), kDeltas);
+    std::vector<uint32_t> out(kDeltas);
+
+    const auto initial = pint::simd::current_level();
+    pint::simd::set_level(level);
+    for (auto $ : state) {
+        pint::bitpack::decode(words.data(), words.size(), out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(pint::simd::level_name(level));
+    pint::simd::set_level(initial);
+
+    if (out != deltas)
+        state.SkipWithError("Decoded values differ");
+    SetDeltaBytes(state, words.size());
+}
+BENCHMARK(BitpackDecode)->DenseRange(0, 4);
+
+////////////////////////////////////////////////////////////////////////////////
+// Big endian rgb565 field of 7-byte records brightened in place: copy to
+// array of packed integers with byte swap and back vs views over records
+
+const size_t kRecords = 1 << 20;
+const size_t kRecordSize = 7;
+const size_t kPixelOffset = 5;
+
+std::vector<unsigned char> &Records() {
+    static std::vector<unsigned char> records = [] {
+        std::mt19937 gen(1);
+        std::vector<unsigned char> result(kRecords * kRecordSize);
+        for (auto &byte : result)
+            byte = static_cast<unsigned char>(gen());
+        return result;
+    }();
+    return records;
+}
+
+void ViewsCopy(benchmark::State& state) {
+    auto &records = Records();
+    std::vector<pint::rgb565> pixels(kRecords, pint::rgb565(0));
+    for (auto $ : state) {
+        for (size_t i = 0; i < kRecords; ++i) {
+            uint16_t value;
+            std::memcpy(&value, records.data() + i * kRecordSize + kPixelOffset, sizeof(value));
+            pixels[i] = pint::rgb565(static_cast<uint16_t>((value >> 8) | (value << 8)));
+        }
+        pint::brighten(pixels.data(), kBrightness, pixels.data(), kRecords);
+        for (size_t i = 0; i < kRecords; ++i) {
+            const uint16_t value = static_cast<uint16_t>((pixels[i].value() >> 8) | (pixels[i].value() << 8));
+            std::memcpy(records.data() + i * kRecordSize + kPixelOffset, &value, sizeof(value));
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(kRecords * state.iterations());
+}
+BENCHMARK(ViewsCopy);
+
+void ViewsTransform(benchmark::State& state) {
+    auto &records = Records();
+    pint::packed_view_array<pint::rgb565, pint::endian::big> pixels(
+        records.data() + kPixelOffset, kRecords, kRecordSize);
+    for (auto $ : state) {
+        pint::transform(pixels, pixels, [](pint::rgb565 pixel) {
+            return pint::add_unsigned_saturate(pixel, kBrightness);
+        });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(kRecords * state.iterations());
+}
+BENCHMARK(ViewsTransform);
+
+void ViewsTransformChunks(benchmark::State& state) {
+    auto &records = Records();
+    pint::packed_view_array<pint::rgb565, pint::endian::big> pixels(
+        records.data() + kPixelOffset, kRecords, kRecordSize);
+    for (auto $ : state) {
+        pint::transform_chunks(pixels, pixels, [](pint::rgb565 *values, size_t count) {
+            pint::brighten(values, kBrightness, values, count);
+        });
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(kRecords * state.iterations());
+}
+BENCHMARK(ViewsTransformChunks);
+
+////////////////////////////////////////////////////////////////////////////////
+// Saturating addition of 4-bit counters: SWAR on packed integers, one
+// by one and bulk, vs bit-sliced blocks, and conversion between the forms.
+// Items are 4-bit elements
+
+const size_t kNibbles = 1 << 20;
+using Nibbles = pint::packed_int<uint64_t,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4>;
+using SlicedNibbles = pint::bitsliced<4, 4096>;
+const size_t kNibblesPerWord = 16;
+
+const std::vector<Nibbles> &RandomNibbles(unsigned seed) {
+    static std::vector<Nibbles> arrays[2];
+    auto &result = arrays[seed % 2];
+    if (result.empty()) {
+        std::mt19937_64 gen(seed);
+        for (size_t i = 0; i < kNibbles / kNibblesPerWord; ++i)
+            result.emplace_back(gen());
+    }
+    return result;
+}
+
+std::vector<SlicedNibbles> ToSliced(const std::vector<Nibbles> &values) {
+    const size_t words = SlicedNibbles::size / kNibblesPerWord;
+    std::vector<SlicedNibbles> result;
+    for (size_t i = 0; i < values.size(); i += words)
+        result.push_back(SlicedNibbles::from_packed(values.data() + i));
+    return result;
+}
+
+bool SetBenchmarkLevel(benchmark::State& state) {
+    const auto level = static_cast<pint::simd::level>(state.range(0));
+    if (level > pint::simd::detected_level()) {
+        state.SkipWithError("Instruction set is not supported by CPU");
+        return false;
+    }
+    pint::simd::set_level(level);
+    state.SetLabel(pint::simd::level_name(level));
+    return true;
+}
+
+void NibblesSaturateSwar(benchmark::State& state) {
+    const auto &a = RandomNibbles(0), &b = RandomNibbles(1);
+    std::vector<Nibbles> out(a.size(), Nibbles(0));
+    for (auto $ : state) {
+        for (size_t i = 0; i < a.size(); ++i)
+            out[i] = pint::add_unsigned_saturate(a[i], b[i]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(kNibbles * state.iterations());
+}
+BENCHMARK(NibblesSaturateSwar);
+
+// Argument is SIMD level
+void NibblesSaturateBulk(benchmark::State& state) {
+    const auto initial = pint::simd::current_level();
+    if (!SetBenchmarkLevel(state))
+        return;
+
+    const auto &a = RandomNibbles(0), &b = RandomNibbles(1);
+    std::vector<Nibbles> out(a.size(), Nibbles(0));
+    for (auto $ : state) {
+        pint::add_unsigned_saturate(a.data(), b.data(), out.data(), out.size());
+        benchmark::ClobberMemory();
+    }
+    pint::simd::set_level(initial);
+    state.SetItemsProcessed(kNibbles * state.iterations());
+}
+BENCHMARK(NibblesSaturateBulk)->DenseRange(0, 4);
+
+void NibblesSaturateBitsliced(benchmark::State& state) {
+    const auto initial = pint::simd::current_level();
+    if (!SetBenchmarkLevel(state))
+        return;
+
+    const auto a = ToSliced(RandomNibbles(0)), b = ToSliced(RandomNibbles(1));
+    std::vector<SlicedNibbles> out(a.size());
+    for (auto $ : state) {
+        for (size_t i = 0; i < a.size(); ++i)
+            out[i] = pint::add_unsigned_saturate(a[i], b[i]);
+        benchmark::ClobberMemory();
+    }
+    pint::simd::set_level(initial);
+    state.SetItemsProcessed(kNibbles * state.iterations());
+}
+BENCHMARK(NibblesSaturateBitsliced)->DenseRange(0, 4);
+
+// Sum of all counters by popcount of planes vs unpacking them
+void NibblesSumSwar(benchmark::State& state) {
+    const auto &a = RandomNibbles(0);
+    for (auto $ : state) {
+        uint64_t total = 0;
+        for (auto value : a)
+            total += pint::reduce_add_wide(value);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(kNibbles * state.iterations());
+}
+BENCHMARK(NibblesSumSwar);
+
+void NibblesSumBitsliced(benchmark::State& state) {
+    const auto a = ToSliced(RandomNibbles(0));
+    for (auto $ : state) {
+        uint64_t total = 0;
+        for (const auto &value : a)
+            total += pint::reduce_add_wide(value);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(kNibbles * state.iterations());
+}
+BENCHMARK(NibblesSumBitsliced);
+
+// Argument is 1 if pdep / pext are used
+void NibblesToBitsliced(benchmark::State& state) {
+    const bool initial = pint::simd::current_bmi2();
+    pint::simd::set_bmi2(state.range(0) != 0);
+    state.SetLabel(pint::simd::current_bmi2() ? "bmi2" : "scalar");
+
+    const auto &a = RandomNibbles(0);
+    for (auto $ : state)
+        benchmark::DoNotOptimize(ToSliced(a));
+    pint::simd::set_bmi2(initial);
+    state.SetItemsProcessed(kNibbles * state.iterations());
+}
+BENCHMARK(NibblesToBitsliced)->DenseRange(0, 1);
+
+void NibblesFromBitsliced(benchmark::State& state) {
+    const bool initial = pint::simd::current_bmi2();
+    pint::simd::set_bmi2(state.range(0) != 0);
+    state.SetLabel(pint::simd::current_bmi2() ? "bmi2" : "scalar");
+
+    const auto a = ToSliced(RandomNibbles(0));
+    std::vector<Nibbles> out(kNibbles / kNibblesPerWord, Nibbles(0));
+    const size_t words = SlicedNibbles::size / kNibblesPerWord;
+    for (auto $ : state) {
+        for (size_t i = 0; i < a.size(); ++i)
+            a[i].to_packed(out.data() + i * words);
+        benchmark::ClobberMemory();
+    }
+    pint::simd::set_bmi2(initial);
+    state.SetItemsProcessed(kNibbles * state.iterations());
+}
+BENCHMARK(NibblesFromBitsliced)->DenseRange(0, 1);
+
+////////////////////////////////////////////////////////////////////////////////
+// Bit counting in 8 bitmaps of 8 flags: bytes unpacked and counted one by
+// one vs lane-wise functions. Argument of bulk functions is SIMD level,
+// 5 is avx512bw with VPOPCNT instructions. Items are packed integers
+
+using Flags = pint::packed_int<uint64_t,8,8,8,8,8,8,8,8>;
+const size_t kFlags = 1 << 16;
+
+const std::vector<Flags> &RandomFlags() {
+    static const std::vector<Flags> flags = [] {
+        std::mt19937_64 gen(1);
+        std::vector<Flags> result;
+        for (size_t i = 0; i < kFlags; ++i)
+            result.emplace_back(gen() & gen());
+        return result;
+    }();
+    return flags;
+}
+
+bool SetPopcountLevel(benchmark::State& state) {
+    const bool vpopcnt = state.range(0) == 5;
+    if (vpopcnt && !pint::simd::detected_avx512_popcnt()) {
+        state.SkipWithError("VPOPCNT is not supported by CPU");
+        return false;
+    }
+    pint::simd::set_avx512_popcnt(vpopcnt);
+
+    const auto level = static_cast<pint::simd::level>(std::min<int64_t>(state.range(0), 4));
+    if (level > pint::simd::detected_level()) {
+        state.SkipWithError("Instruction set is not supported by CPU");
+        return false;
+    }
+    pint::simd::set_level(level);
+    state.SetLabel(std::string(pint::simd::level_name(level)) + (vpopcnt ? ", vpopcnt" : ""));
+    return true;
+}
+
+void PopcountLanesUnpack(benchmark::State& state) {
+    const auto &flags = RandomFlags();
+    std::vector<Flags> out(kFlags, Flags(0));
+    for (auto $ : state) {
+        for (size_t i = 0; i < kFlags; ++i) {
+            uint64_t counts = 0;
+            for (size_t lane = 0; lane < 8; ++lane)
+                counts |= static_cast<uint64_t>(__builtin_popcount((flags[i].value() >> (lane * 8)) & 0xff)) << (lane * 8);
+            out[i] = Flags(counts);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(kFlags * state.iterations());
+}
+BENCHMARK(PopcountLanesUnpack);
+
+void PopcountLanesScalar(benchmark::State& state) {
+    const auto &flags = RandomFlags();
+    std::vector<Flags> out(kFlags, Flags(0));
+    for (auto $ : state) {
+        for (size_t i = 0; i < kFlags; ++i)
+            out[i] = pint::popcount_lanes(flags[i]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(kFlags * state.iterations());
+}
+BENCHMARK(PopcountLanesScalar);
+
+template<class Function>
+void BitCountBulk(benchmark::State& state, Function function) {
+    const auto initial = pint::simd::current_level();
+    const bool initial_popcnt = pint::simd::current_avx512_popcnt();
+    if (SetPopcountLevel(state)) {
+        const auto &flags = RandomFlags();
+        std::vector<Flags> out(kFlags, Flags(0));
+        for (auto $ : state) {
+            function(flags.data(), out.data(), kFlags);
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(kFlags * state.iterations());
+    }
+    pint::simd::set_level(initial);
+    pint::simd::set_avx512_popcnt(initial_popcnt);
+}
+
+void PopcountLanesBulk(benchmark::State& state) {
+    BitCountBulk(state, [](const Flags *in, Flags *out, size_t n) { pint::popcount_lanes(in, out, n); });
+}
+BENCHMARK(PopcountLanesBulk)->DenseRange(0, 5);
+
+void ClzLanesBulk(benchmark::State& state) {
+    BitCountBulk(state, [](const Flags *in, Flags *out, size_t n) { pint::clz_lanes(in, out, n); });
+}
+BENCHMARK(ClzLanesBulk)->DenseRange(0, 5);
+
+void CtzLanesBulk(benchmark::State& state) {
+    BitCountBulk(state, [](const Flags *in, Flags *out, size_t n) { pint::ctz_lanes(in, out, n); });
+}
+BENCHMARK(CtzLanesBulk)->DenseRange(0, 5);
+
+////////////////////////////////////////////////////////////////////////////////
+// Conversion of 4 bytes to 4 words and back, as accumulators of AddSatU0
+// are widened: packs unpacked and packed one by one vs conversion functions.
+// Argument of bulk functions is SIMD level. Items are packed integers
+
+using Bytes4 = pint::packed_int<uint32_t,8,8,8,8>;
+using Words4 = pint::packed_int<uint64_t,16,16,16,16>;
+const size_t kConverted = 1 << 16;
+
+const std::vector<Bytes4> &RandomBytes4() {
+    static const std::vector<Bytes4> values = [] {
+        std::mt19937 gen(1);
+        std::vector<Bytes4> result;
+        for (size_t i = 0; i < kConverted; ++i)
+            result.emplace_back(static_cast<uint32_t>(gen()));
+        return result;
+    }();
+    return values;
+}
+
+const std::vector<Words4> &RandomWords4() {
+    static const std::vector<Words4> values = [] {
+        std::mt19937 gen(2);
+        std::vector<Words4> result;
+        for (size_t i = 0; i < kConverted; ++i)
+            result.emplace_back(gen() % 512, gen() % 512, gen() % 512, gen() % 512);
+        return result;
+    }();
+    return values;
+}
+
+void WidenUnpack(benchmark::State& state) {
+    const auto &values = RandomBytes4();
+    std::vector<Words4> out(kConverted, Words4(0));
+    for (auto $ : state) {
+        for (size_t i = 0; i < kConverted; ++i) {
+            out[i] = Words4(pint::get<0>(values[i]), pint::get<1>(values[i]),
+                pint::get<2>(values[i]), pint::get<3>(values[i]));
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(kConverted * state.iterations());
+}
+BENCHMARK(WidenUnpack);
+
+void WidenScalar(benchmark::State& state) {
+    const auto &values = RandomBytes4();
+    std::vector<Words4> out(kConverted, Words4(0));
+    for (auto $ : state) {
+        for (size_t i = 0; i < kConverted; ++i)
+            out[i] = pint::widen_unsigned<Words4>(values[i]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(kConverted * state.iterations());
+}
+BENCHMARK(WidenScalar);
+
+void WidenBulk(benchmark::State& state) {
+    const auto initial = pint::simd::current_level();
+    if (!SetBenchmarkLevel(state))
+        return;
+
+    const auto &values = RandomBytes4();
+    std::vector<Words4> out(kConverted, Words4(0));
+    for (auto $ : state) {
+        pint::widen_unsigned(values.data(), out.data(), kConverted);
+        benchmark::ClobberMemory();
+    }
+    pint::simd::set_level(initial);
+    state.SetItemsProcessed(kConverted * state.iterations());
+}
+BENCHMARK(WidenBulk)->DenseRange(0, 4);
+
+void NarrowSaturateUnpack(benchmark::State& state) {
+    const auto &values = RandomWords4();
+    std::vector<Bytes4> out(kConverted, Bytes4(0));
+    for (auto $ : state) {
+        for (size_t i = 0; i < kConverted; ++i) {
+            out[i] = Bytes4(std::min<uint64_t>(pint::get<0>(values[i]), 255),
+                std::min<uint64_t>(pint::get<1>(values[i]), 255),
+                std::min<uint64_t>(pint::get<2>(values[i]), 255),
+                std::min<uint64_t>(pint::get<3>(values[i]), 255));
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(kConverted * state.iterations());
+}
+BENCHMARK(NarrowSaturateUnpack);
+
+void NarrowSaturateScalar(benchmark::State& state) {
+    const auto &values = RandomWords4();
+    std::vector<Bytes4> out(kConverted, Bytes4(0));
+    for (auto $ : state) {
+        for (size_t i = 0; i < kConverted; ++i)
+            out[i] = pint::narrow_unsigned_saturate<Bytes4>(values[i]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(kConverted * state.iterations());
+}
+BENCHMARK(NarrowSaturateScalar);
+
+void NarrowSaturateBulk(benchmark::State& state) {
+    const auto initial = pint::simd::current_level();
+    if (!SetBenchmarkLevel(state))
+        return;
+
+    const auto &values = RandomWords4();
+    std::vector<Bytes4> out(kConverted, Bytes4(0));
+    for (auto $ : state) {
+        pint::narrow_unsigned_saturate(values.data(), out.data(), kConverted);
+        benchmark::ClobberMemory();
+    }
+    pint::simd::set_level(initial);
+    state.SetItemsProcessed(kConverted * state.iterations());
+}
+BENCHMARK(NarrowSaturateBulk)->DenseRange(0, 4);
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <array>
+#include <cstdlib>
 #include <utility>
 
 #include <gtest/gtest.h>
@@ -86,6 +88,27 @@ static_assert(std::is_same<MakePackedIntValueType<63>, uint64_t>::value,
 static_assert(std::is_same<MakePackedIntValueType<64>, uint64_t>::value,
     "Value type must be uint64_t");
 
+// Layout helpers give the same results with constexpr layouts and type lists
+template<size_t ...Values> using LayoutSeq = pint::detail::integer_seq<Values...>;
+
+static_assert(std::is_same<pint::detail::mask_offsets_vector<3, 5, 2>, LayoutSeq<0, 3, 8>>::value,
+    "Offsets of packs");
+static_assert(std::is_same<pint::detail::make_sum_vector<3, 5, 2>, LayoutSeq<3, 8, 10>>::value,
+    "Ends of packs");
+static_assert(std::is_same<pint::detail::make_sum_vector_n<2, 3, 5, 2>, LayoutSeq<3, 8>>::value,
+    "Ends of first packs");
+static_assert(std::is_same<pint::detail::unique_bits_seq<3, 5, 3, 2, 5>, LayoutSeq<3, 5, 2>>::value,
+    "Unique pack lengths");
+static_assert(std::is_same<pint::detail::slice<1, 3, LayoutSeq<3, 5, 2, 7>>, LayoutSeq<5, 2>>::value,
+    "Slice of sequence");
+static_assert(pint::detail::take_nth<2, LayoutSeq<3, 5, 2, 7>>::value == 2, "Element of sequence");
+static_assert(pint::detail::find_max<3, 9, 2, 7>::value == 9, "Max of integers");
+static_assert(pint::detail::mask_hiorder<uint32_t, 4, 8>::value == 0x808, "Hi order bits");
+static_assert(pint::detail::mask_loorder<uint32_t, 4, 8>::value == 0x11, "Lo order bits");
+static_assert(pint::detail::detect_saturation_mask_type<uint32_t, 4, 4, 4>::value == 0, "Same lengths");
+static_assert(pint::detail::detect_saturation_mask_type<uint32_t, 4, 8>::value == 1, "Saturation mask type 1");
+static_assert(pint::detail::detect_saturation_mask_type<uint32_t, 4, 4, 8>::value == 2, "Saturation mask type 2");
+
 TEST(TestMakeTruncate, InputWithoutOverflow)
 {
     using PackedInt = pint::make_packed_int<5, 6, 5>;
@@ -147,6 +170,143 @@ TEST(TestSlice, Slice) {
 
 //////////////////////////////////////////////////////////////////////////////
 
+TEST(TestConvert, Widen) {
+    using Narrow = pint::packed_int<uint32_t,8,8,8,8>;
+    using Wide = pint::packed_int<uint64_t,16,16,16,16>;
+
+    static_assert(pint::widen_unsigned<Wide>(Narrow(1, 2, 3, 250)) == Wide(1, 2, 3, 250), "Zero extension");
+    static_assert(pint::widen_signed<Wide>(Narrow(1, -2, 3, -128)) == Wide(1, -2, 3, -128), "Sign extension");
+
+    // Packs of different lengths, target is narrower integer
+    using Pixel = pint::packed_int<uint16_t,5,6,5>;
+    using Rgb = pint::packed_int<uint32_t,8,8,8>;
+    ASSERT_EQ(Rgb(31, 0, 16), pint::widen_unsigned<Rgb>(Pixel(31, 0, 16)));
+    ASSERT_EQ(Rgb(-1, 0, -16), pint::widen_signed<Rgb>(Pixel(31, 0, 16)));
+    using Byte = pint::packed_int<uint8_t,8>;
+    ASSERT_EQ(Byte(0xf0), pint::widen_signed<Byte>(pint::packed_int<uint64_t,5>(0x10)));
+}
+
+TEST(TestConvert, Narrow) {
+    using Narrow = pint::packed_int<uint32_t,8,8,8,8>;
+    using Wide = pint::packed_int<uint64_t,16,16,16,16>;
+
+    static_assert(pint::narrow_unsigned_saturate<Narrow>(Wide(1, 300, 255, 65535)) == Narrow(1, 255, 255, 255),
+        "Unsigned saturation");
+    static_assert(pint::narrow_signed_saturate<Narrow>(Wide(1, 300, -129, -5)) == Narrow(1, 127, -128, -5),
+        "Signed saturation");
+
+    using Pixel = pint::packed_int<uint16_t,5,6,5>;
+    using Rgb = pint::packed_int<uint32_t,8,8,8>;
+    ASSERT_EQ(Pixel(31, 63, 16), pint::narrow_unsigned_saturate<Pixel>(Rgb(200, 63, 16)));
+    ASSERT_EQ(Pixel(15, -32, -16), pint::narrow_signed_saturate<Pixel>(Rgb(100, -100, -16)));
+}
+
+TEST(TestConvert, Repack) {
+    using PackedInt = pint::packed_int<uint32_t,5,6,5>;
+    using Repacked = pint::packed_int<uint16_t,3,9,4>;
+
+    static_assert(pint::repack<Repacked>(PackedInt(31, 63, 17)) == Repacked(7, 63, 1), "Truncation and extension");
+    ASSERT_EQ(PackedInt(7, 63, 1), pint::repack<PackedInt>(Repacked(7, 63, 1)));
+    ASSERT_EQ(PackedInt(1, 2, 3), pint::repack<PackedInt>(PackedInt(1, 2, 3)));
+}
+
+// Packs of value converted one by one: zero or sign extended, saturated to
+// the target length or truncated
+struct ConvertedPacks {
+    std::array<uint64_t, 8> repacked, sign_extended, unsigned_saturated, signed_saturated;
+};
+
+template<class Integer, size_t ...Bits, class TargetInteger, size_t ...TargetBits, size_t ...Indexes>
+ConvertedPacks ConvertPacks(pint::packed_int<Integer, Bits...> value, pint::packed_int<TargetInteger, TargetBits...>,
+    IndexSeq<Indexes...>)
+{
+    const size_t lengths[] = { Bits... };
+    const size_t target_lengths[] = { TargetBits... };
+    const uint64_t values[] = { static_cast<uint64_t>(pint::get<Indexes>(value))... };
+
+    ConvertedPacks result;
+    for (size_t i = 0; i < sizeof...(Indexes); ++i) {
+        const auto target_ones = target_lengths[i] == 64 ? ~uint64_t(0) : (uint64_t(1) << target_lengths[i]) - 1;
+        const auto sign = uint64_t(1) << (lengths[i] - 1);
+        const auto signed_value = static_cast<int64_t>(((values[i] ^ sign) - sign));
+        const auto signed_max = static_cast<int64_t>(target_ones >> 1);
+
+        result.repacked[i] = values[i] & target_ones;
+        result.sign_extended[i] = static_cast<uint64_t>(signed_value) & target_ones;
+        result.unsigned_saturated[i] = std::min(values[i], target_ones);
+        result.signed_saturated[i] = static_cast<uint64_t>(
+            std::max(std::min(signed_value, signed_max), -signed_max - 1)) & target_ones;
+    }
+    return result;
+}
+
+template<class Target, size_t ...Indexes>
+Target ToPacked(const std::array<uint64_t, 8> &packs, IndexSeq<Indexes...>) {
+    return Target(static_cast<typename Target::value_type>(packs[Indexes])...);
+}
+
+// Extension if all packs are widened, saturation if all packs are narrowed
+template<class PackedInt, class Target, class Indexes>
+void CheckConvertDirection(PackedInt, Target, const ConvertedPacks &, Indexes, std::integral_constant<int, 0>) {}
+
+template<class PackedInt, class Target, class Indexes>
+void CheckConvertDirection(PackedInt value, Target, const ConvertedPacks &expected, Indexes indexes,
+    std::integral_constant<int, 1>)
+{
+    ASSERT_EQ(ToPacked<Target>(expected.repacked, indexes), pint::widen_unsigned<Target>(value));
+    ASSERT_EQ(ToPacked<Target>(expected.sign_extended, indexes), pint::widen_signed<Target>(value));
+}
+
+template<class PackedInt, class Target, class Indexes>
+void CheckConvertDirection(PackedInt value, Target, const ConvertedPacks &expected, Indexes indexes,
+    std::integral_constant<int, 2>)
+{
+    ASSERT_EQ(ToPacked<Target>(expected.unsigned_saturated, indexes), pint::narrow_unsigned_saturate<Target>(value));
+    ASSERT_EQ(ToPacked<Target>(expected.signed_saturated, indexes), pint::narrow_signed_saturate<Target>(value));
+}
+
+template<class Integer, size_t ...Bits, class TargetInteger, size_t ...TargetBits>
+void CheckConvert(pint::packed_int<Integer, Bits...>, pint::packed_int<TargetInteger, TargetBits...> target) {
+    using PackedInt = pint::packed_int<Integer, Bits...>;
+    using Target = pint::packed_int<TargetInteger, TargetBits...>;
+    using Indexes = MakeIndexSeq<sizeof...(Bits)>;
+    using conversion = pint::detail::packed_conversion<PackedInt, Target>;
+    using direction = std::integral_constant<int, conversion::widening ? 1 : conversion::narrowing ? 2 : 0>;
+
+    uint64_t seed = 1;
+    for (size_t i = 0; i < 1000; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const auto value = pint::add_wrap(PackedInt(static_cast<Integer>(seed >> 5)), PackedInt(0));
+        const auto expected = ConvertPacks(value, target, Indexes());
+
+        ASSERT_EQ(ToPacked<Target>(expected.repacked, Indexes()), pint::repack<Target>(value));
+        CheckConvertDirection(value, target, expected, Indexes(), direction());
+    }
+}
+
+TEST(TestConvert, Random) {
+    using Native8 = pint::packed_int<uint32_t,8,8,8,8>;
+    using Native16 = pint::packed_int<uint64_t,16,16,16,16>;
+    CheckConvert(Native8(0), Native16(0));
+    CheckConvert(Native16(0), Native8(0));
+
+    using Pixel = pint::packed_int<uint16_t,5,6,5>;
+    using Rgb = pint::packed_int<uint32_t,8,8,8>;
+    CheckConvert(Pixel(0), Rgb(0));
+    CheckConvert(Rgb(0), Pixel(0));
+
+    CheckConvert(pint::packed_int<uint8_t,3,5>(0), pint::packed_int<uint64_t,32,32>(0));
+    CheckConvert(pint::packed_int<uint64_t,32,32>(0), pint::packed_int<uint8_t,3,5>(0));
+    CheckConvert(pint::packed_int<uint64_t,64>(0), pint::packed_int<uint8_t,7>(0));
+    CheckConvert(pint::packed_int<uint8_t,7>(0), pint::packed_int<uint64_t,64>(0));
+
+    // Packs are both widened and narrowed
+    CheckConvert(pint::packed_int<uint32_t,1,2,3,4,5,6,11>(0), pint::packed_int<uint64_t,2,1,5,4,9,6,20>(0));
+    CheckConvert(pint::packed_int<uint64_t,3,13,17,31>(0), pint::packed_int<uint64_t,4,12,18,30>(0));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 TEST(TestAddWrap, NoOverflow) {
     using PackedInt = pint::make_packed_int<5, 6, 5>;
 
@@ -627,6 +787,82 @@ TEST(TestMaxSigned, PositiveNegative) {
 
 //////////////////////////////////////////////////////////////////////////////
 
+TEST(TestAverage, Unsigned) {
+    using PackedInt = pint::make_packed_int<4,6,4>;
+
+    constexpr auto a = PackedInt(15,63,0);
+    constexpr auto b = PackedInt(14,62,3);
+
+    ASSERT_EQ(PackedInt(15,63,2), pint::avg_unsigned(a,b));
+}
+
+TEST(TestAverage, Signed) {
+    using PackedInt = pint::make_packed_int<4,6,4>;
+
+    constexpr auto a = PackedInt(-8,31,-1);
+    constexpr auto b = PackedInt(-7,-32,-2);
+
+    ASSERT_EQ(PackedInt(-7,0,-1), pint::avg_signed(a,b));
+}
+
+TEST(TestAbsDiff, Unsigned) {
+    using PackedInt = pint::make_packed_int<4,6,4>;
+
+    constexpr auto a = PackedInt(15,0,7);
+    constexpr auto b = PackedInt(0,63,7);
+
+    ASSERT_EQ(PackedInt(15,63,0), pint::absdiff_unsigned(a,b));
+    ASSERT_EQ(PackedInt(15,63,0), pint::absdiff_unsigned(b,a));
+}
+
+TEST(TestAbs, Signed) {
+    using PackedInt = pint::make_packed_int<4,6,4>;
+
+    ASSERT_EQ(PackedInt(1,31,0), pint::abs_signed(PackedInt(-1,-31,0)));
+    ASSERT_EQ(PackedInt(7,5,8), pint::abs_signed(PackedInt(7,5,-8)));
+}
+
+TEST(TestNegSignedSaturate, Signed) {
+    using PackedInt = pint::make_packed_int<4,6,4>;
+
+    ASSERT_EQ(PackedInt(1,-31,0), pint::neg_signed_saturate(PackedInt(-1,31,0)));
+    ASSERT_EQ(PackedInt(7,-5,-7), pint::neg_signed_saturate(PackedInt(-8,5,7)));
+}
+
+// All pairs of values of small layout compared with the arithmetic on each pack
+TEST(TestAverage, AllValues) {
+    using PackedInt = pint::packed_int<uint8_t, 3, 5>;
+
+    for (unsigned x = 0; x < 256; ++x) {
+        for (unsigned y = 0; y < 256; ++y) {
+            const auto a = PackedInt(static_cast<uint8_t>(x)), b = PackedInt(static_cast<uint8_t>(y));
+
+            const auto avg = pint::avg_unsigned(a, b);
+            ASSERT_EQ((pint::get<0>(a) + pint::get<0>(b) + 1u) / 2, pint::get<0>(avg));
+            ASSERT_EQ((pint::get<1>(a) + pint::get<1>(b) + 1u) / 2, pint::get<1>(avg));
+
+            const auto avg_signed = pint::avg_signed(a, b);
+            ASSERT_EQ((pint::get_signed<0>(a) + pint::get_signed<0>(b) + 1) >> 1, pint::get_signed<0>(avg_signed));
+            ASSERT_EQ((pint::get_signed<1>(a) + pint::get_signed<1>(b) + 1) >> 1, pint::get_signed<1>(avg_signed));
+
+            const auto diff = pint::absdiff_unsigned(a, b);
+            ASSERT_EQ(std::abs(int(pint::get<0>(a)) - int(pint::get<0>(b))), int(pint::get<0>(diff)));
+            ASSERT_EQ(std::abs(int(pint::get<1>(a)) - int(pint::get<1>(b))), int(pint::get<1>(diff)));
+        }
+
+        const auto a = PackedInt(static_cast<uint8_t>(x));
+        const auto abs = pint::abs_signed(a);
+        ASSERT_EQ(std::abs(int(pint::get_signed<0>(a))), int(pint::get<0>(abs)));
+        ASSERT_EQ(std::abs(int(pint::get_signed<1>(a))), int(pint::get<1>(abs)));
+
+        const auto neg = pint::neg_signed_saturate(a);
+        ASSERT_EQ(std::min(-int(pint::get_signed<0>(a)), 3), int(pint::get_signed<0>(neg)));
+        ASSERT_EQ(std::min(-int(pint::get_signed<1>(a)), 15), int(pint::get_signed<1>(neg)));
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 TEST(TestShiftLeft, SameLength_ShiftNotExceed)
 {
     using PackedInt = pint::make_packed_int<4,4,4>;
@@ -778,3 +1014,646 @@ TEST(TestShiftRight, VarLength_ShiftExceed)
     const volatile size_t shift = 6;
     ASSERT_EQ(expected_value, shift_right_unsigned(value, shift));
 }
+
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(TestShiftRightSigned, SameLength)
+{
+    using PackedInt = pint::make_packed_int<4,4,4>;
+
+    // -4, 4, -1
+    constexpr auto value = PackedInt(12,4,15);
+    constexpr auto expected_value = PackedInt(14,2,15);
+
+    ASSERT_EQ(expected_value, shift_right_signed(value, 1));
+}
+
+TEST(TestShiftRightSigned, SameLength_ShiftExceed)
+{
+    using PackedInt = pint::make_packed_int<4,4,4>;
+
+    constexpr auto value = PackedInt(12,4,15);
+    constexpr auto expected_value = PackedInt(15,0,15);
+
+    const volatile size_t shift = 4;
+    ASSERT_EQ(expected_value, shift_right_signed(value, shift));
+    ASSERT_EQ(expected_value, shift_right_signed(value, 3));
+}
+
+TEST(TestShiftRightSigned, VarLength_ShiftExceedPartially)
+{
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    // -3, -22, 21
+    constexpr auto value = PackedInt(5,106,21);
+    constexpr auto expected_value = PackedInt(7,126,1);
+
+    const volatile size_t shift = 4;
+    ASSERT_EQ(expected_value, shift_right_signed(value, shift));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(TestRotate, SameLength)
+{
+    using PackedInt = pint::make_packed_int<4,4,4>;
+
+    constexpr auto value = PackedInt(1,6,9);
+
+    ASSERT_EQ(PackedInt(4,9,6), rotate_left(value, 2));
+    ASSERT_EQ(PackedInt(4,9,6), rotate_right(value, 2));
+    ASSERT_EQ(PackedInt(2,12,3), rotate_left(value, 5));
+    ASSERT_EQ(PackedInt(8,3,12), rotate_right(value, 1));
+    ASSERT_EQ(value, rotate_left(value, 0));
+    ASSERT_EQ(value, rotate_right(value, 4));
+}
+
+// Single pack fills the whole integer, amounts of 0 and multiples
+// of its length don't change the value. Amounts aren't known at compile time
+TEST(TestRotate, FullWidth)
+{
+    const volatile size_t zero = 0, one = 1;
+
+    using PackedInt64 = pint::packed_int<uint64_t,64>;
+    constexpr auto value64 = PackedInt64(0x8000000000000001);
+
+    ASSERT_EQ(value64, rotate_left(value64, zero));
+    ASSERT_EQ(value64, rotate_left(value64, zero + 64));
+    ASSERT_EQ(value64, rotate_right(value64, zero));
+    ASSERT_EQ(value64, rotate_right(value64, zero + 128));
+    ASSERT_EQ(PackedInt64(3), rotate_left(value64, one));
+    ASSERT_EQ(PackedInt64(3), rotate_right(value64, one + 62));
+    ASSERT_EQ(value64, shift_left(value64, zero));
+    ASSERT_EQ(value64, rotate_left(value64, PackedInt64(zero)));
+
+    using PackedInt32 = pint::packed_int<uint32_t,32>;
+    constexpr auto value32 = PackedInt32(0x80000001);
+
+    ASSERT_EQ(value32, rotate_left(value32, zero));
+    ASSERT_EQ(value32, rotate_left(value32, zero + 32));
+    ASSERT_EQ(value32, rotate_right(value32, zero + 32));
+    ASSERT_EQ(PackedInt32(0xc0000000), rotate_right(value32, one));
+}
+
+TEST(TestRotate, VarLength)
+{
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto value = PackedInt(1,65,33);
+
+    // Amount is taken modulo length of each pack
+    const volatile size_t amount = 7;
+    ASSERT_EQ(PackedInt(2,65,3), rotate_left(value, amount));
+    ASSERT_EQ(PackedInt(4,65,48), rotate_right(value, amount));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(TestShiftVariable, SameLength)
+{
+    using PackedInt = pint::make_packed_int<4,4,4,4>;
+
+    constexpr auto value = PackedInt(9,9,9,9);
+    constexpr auto amounts = PackedInt(0,1,3,4);
+
+    ASSERT_EQ(PackedInt(9,2,8,0), shift_left(value, amounts));
+    ASSERT_EQ(PackedInt(9,4,1,0), shift_right_unsigned(value, amounts));
+    ASSERT_EQ(PackedInt(9,12,15,15), shift_right_signed(value, amounts));
+    ASSERT_EQ(PackedInt(9,3,12,9), rotate_left(value, PackedInt(0,1,3,0)));
+    ASSERT_EQ(PackedInt(9,12,3,9), rotate_right(value, PackedInt(0,1,3,0)));
+}
+
+TEST(TestShiftVariable, VarLength_ShiftExceed)
+{
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto value = PackedInt(5,106,42);
+
+    ASSERT_EQ(PackedInt(0,0,0), shift_left(value, PackedInt(3,127,6)));
+    ASSERT_EQ(PackedInt(0,1,0), shift_right_unsigned(value, PackedInt(7,6,63)));
+    ASSERT_EQ(PackedInt(7,127,63), shift_right_signed(value, PackedInt(7,8,32)));
+}
+
+// Shift of each pack is the same as shift of the whole integer by its amount
+TEST(TestShiftVariable, VarLength_AllAmounts)
+{
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto value = PackedInt(5,106,42);
+
+    for (unsigned amount = 0; amount < 128; ++amount) {
+        const auto amounts = PackedInt(amount % 8, amount, amount % 64);
+
+        const auto left = shift_left(value, amounts);
+        ASSERT_EQ(pint::get<0>(shift_left(value, amount % 8)), pint::get<0>(left)) << amount;
+        ASSERT_EQ(pint::get<1>(shift_left(value, amount)), pint::get<1>(left)) << amount;
+        ASSERT_EQ(pint::get<2>(shift_left(value, amount % 64)), pint::get<2>(left)) << amount;
+
+        const auto right = shift_right_signed(value, amounts);
+        ASSERT_EQ(pint::get<0>(shift_right_signed(value, amount % 8)), pint::get<0>(right)) << amount;
+        ASSERT_EQ(pint::get<1>(shift_right_signed(value, amount)), pint::get<1>(right)) << amount;
+        ASSERT_EQ(pint::get<2>(shift_right_signed(value, amount % 64)), pint::get<2>(right)) << amount;
+
+        const auto rotated = rotate_right(value, PackedInt(amount % 3, amount % 7, amount % 6));
+        ASSERT_EQ(pint::get<0>(rotate_right(value, amount)), pint::get<0>(rotated)) << amount;
+        ASSERT_EQ(pint::get<1>(rotate_right(value, amount)), pint::get<1>(rotated)) << amount;
+        ASSERT_EQ(pint::get<2>(rotate_right(value, amount)), pint::get<2>(rotated)) << amount;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(TestMulWrap, NoOverflow) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto a = PackedInt(2,10,7);
+    constexpr auto b = PackedInt(3,12,9);
+    constexpr auto expected_value = PackedInt(6,120,63);
+
+    ASSERT_EQ(expected_value, pint::mul_wrap(a, b));
+}
+
+TEST(TestMulWrap, WithOverflow) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto a = PackedInt(5,100,33);
+    constexpr auto b = PackedInt(3,3,2);
+    constexpr auto expected_value = PackedInt(15 & 7, 300 & 127, 66 & 63);
+
+    ASSERT_EQ(expected_value, pint::mul_wrap(a, b));
+}
+
+TEST(TestMulWrap, 64BitPacks) {
+    using PackedInt = pint::packed_int<uint64_t, 64>;
+
+    ASSERT_EQ(PackedInt(0xfffffffffffffffe), pint::mul_wrap(PackedInt(~0ULL), PackedInt(2)));
+}
+
+TEST(TestMulUnsignedSaturate, NoOverflow) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto a = PackedInt(2,10,7);
+    constexpr auto b = PackedInt(3,12,9);
+    constexpr auto expected_value = PackedInt(6,120,63);
+
+    ASSERT_EQ(expected_value, pint::mul_unsigned_saturate(a, b));
+}
+
+TEST(TestMulUnsignedSaturate, WithOverflow) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto a = PackedInt(5,100,33);
+    constexpr auto b = PackedInt(1,3,2);
+    constexpr auto expected_value = PackedInt(5,127,63);
+
+    ASSERT_EQ(expected_value, pint::mul_unsigned_saturate(a, b));
+}
+
+TEST(TestMulUnsignedSaturate, WidePacks) {
+    using PackedInt = pint::packed_int<uint64_t, 40, 24>;
+
+    constexpr auto a = PackedInt(1ULL << 30, 1 << 12);
+    constexpr auto b = PackedInt(1ULL << 10, 1 << 11);
+    constexpr auto expected_value = PackedInt((1ULL << 40) - 1, 1 << 23);
+
+    ASSERT_EQ(expected_value, pint::mul_unsigned_saturate(a, b));
+}
+
+TEST(TestMulSignedSaturate, NoOverflow) {
+    using PackedInt = pint::make_packed_int<4,7,5>;
+
+    constexpr auto a = PackedInt(-2,-10,3);
+    constexpr auto b = PackedInt(3,-6,-5);
+    constexpr auto expected_value = PackedInt(-6,60,-15);
+
+    ASSERT_EQ(expected_value, pint::mul_signed_saturate(a, b));
+}
+
+TEST(TestMulSignedSaturate, WithOverflow) {
+    using PackedInt = pint::make_packed_int<4,7,5>;
+
+    constexpr auto a = PackedInt(-8,-10,-16);
+    constexpr auto b = PackedInt(-1,7,1);
+    constexpr auto expected_value = PackedInt(7,-64,-16);
+
+    ASSERT_EQ(expected_value, pint::mul_signed_saturate(a, b));
+}
+
+TEST(TestMulSignedSaturate, 64BitPacks) {
+    using PackedInt = pint::packed_int<uint64_t, 64>;
+
+    ASSERT_EQ(PackedInt(1ULL << 63),
+        pint::mul_signed_saturate(PackedInt(1ULL << 62), PackedInt(static_cast<uint64_t>(-3))));
+    ASSERT_EQ(PackedInt(~0ULL >> 1),
+        pint::mul_signed_saturate(PackedInt(1ULL << 63), PackedInt(static_cast<uint64_t>(-1))));
+}
+
+TEST(TestMulHi, VarLength) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto a = PackedInt(5,100,33);
+    constexpr auto b = PackedInt(7,3,63);
+    constexpr auto expected_value = PackedInt(35 >> 3, 300 >> 7, (33 * 63) >> 6);
+
+    ASSERT_EQ(expected_value, pint::mul_hi(a, b));
+}
+
+TEST(TestMulHi, WidePacks) {
+    using PackedInt = pint::packed_int<uint64_t, 40, 24>;
+
+    constexpr auto a = PackedInt((1ULL << 40) - 1, 1 << 20);
+    constexpr auto b = PackedInt(1ULL << 39, 1 << 10);
+    constexpr auto expected_value = PackedInt(((1ULL << 40) - 1) >> 1, 1 << 6);
+
+    ASSERT_EQ(expected_value, pint::mul_hi(a, b));
+}
+
+TEST(TestMulConstant, SameMultiplier) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto value = PackedInt(5,100,33);
+
+    ASSERT_EQ(pint::mul_wrap(value, PackedInt(3,3,3)), pint::mul_wrap<3>(value));
+    ASSERT_EQ(pint::mul_unsigned_saturate(value, PackedInt(3,3,3)), pint::mul_unsigned_saturate<3>(value));
+}
+
+// Compare multiplication by constant with multiplication of two packed integers
+template<size_t ...Multipliers, class PackedInt>
+void CheckMulConstant(PackedInt multipliers) {
+    uint64_t seed = 1;
+    for (size_t i = 0; i < 1000; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const auto value = pint::add_wrap(
+            PackedInt(static_cast<typename PackedInt::value_type>(seed >> 11)), PackedInt(0));
+
+        ASSERT_EQ(pint::mul_wrap(value, multipliers), pint::mul_wrap<Multipliers...>(value));
+        ASSERT_EQ(pint::mul_unsigned_saturate(value, multipliers),
+            pint::mul_unsigned_saturate<Multipliers...>(value));
+    }
+}
+
+TEST(TestMulConstant, PerPackMultiplier) {
+    using PackedInt = pint::packed_int<uint32_t,1,2,3,4,5,6,11>;
+
+    CheckMulConstant<1,2,3,4,5,6,7>(PackedInt(1,2,3,4,5,6,7));
+    CheckMulConstant<0,1,7,15,31,33,2047>(PackedInt(0,1,7,15,31,33,2047));
+    CheckMulConstant<1,3,0,1,2,60,1000>(PackedInt(1,3,0,1,2,60,1000));
+}
+
+TEST(TestMulConstant, SameLength) {
+    using PackedInt = pint::packed_int<uint64_t,8,8,8,8,8,8,8,8>;
+
+    CheckMulConstant<3>(PackedInt(3,3,3,3,3,3,3,3));
+    CheckMulConstant<255>(PackedInt(255,255,255,255,255,255,255,255));
+    CheckMulConstant<0,1,2,3,4,5,6,7>(PackedInt(0,1,2,3,4,5,6,7));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(TestCompare, Unsigned) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto a = PackedInt(5,100,33);
+    constexpr auto b = PackedInt(5,101,32);
+
+    ASSERT_EQ(PackedInt(0,127,0), pint::cmp_lt_unsigned(a, b));
+    ASSERT_EQ(PackedInt(7,127,0), pint::cmp_le_unsigned(a, b));
+    ASSERT_EQ(PackedInt(0,0,63), pint::cmp_gt_unsigned(a, b));
+    ASSERT_EQ(PackedInt(7,0,63), pint::cmp_ge_unsigned(a, b));
+    ASSERT_EQ(PackedInt(7,0,0), pint::cmp_eq(a, b));
+    ASSERT_EQ(PackedInt(0,127,63), pint::cmp_ne(a, b));
+}
+
+TEST(TestCompare, Signed) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto a = PackedInt(-1,-20,5);
+    constexpr auto b = PackedInt(2,-20,-5);
+
+    ASSERT_EQ(PackedInt(7,0,0), pint::cmp_lt_signed(a, b));
+    ASSERT_EQ(PackedInt(7,127,0), pint::cmp_le_signed(a, b));
+    ASSERT_EQ(PackedInt(0,0,63), pint::cmp_gt_signed(a, b));
+    ASSERT_EQ(PackedInt(0,127,63), pint::cmp_ge_signed(a, b));
+}
+
+template<class PackedInt, size_t ...Indexes>
+void CheckCompareHelper(PackedInt a, PackedInt b, IndexSeq<Indexes...>) {
+    const auto lt_unsigned = ToArray(pint::cmp_lt_unsigned(a, b));
+    const auto le_unsigned = ToArray(pint::cmp_le_unsigned(a, b));
+    const auto lt_signed = ToArray(pint::cmp_lt_signed(a, b));
+    const auto ge_signed = ToArray(pint::cmp_ge_signed(a, b));
+    const auto eq = ToArray(pint::cmp_eq(a, b));
+    const auto ones = ToArray(PackedInt(~typename PackedInt::value_type(0)));
+
+    const bool expected_lt_unsigned[] = { (pint::get<Indexes>(a) < pint::get<Indexes>(b))... };
+    const bool expected_lt_signed[] = { (pint::get_signed<Indexes>(a) < pint::get_signed<Indexes>(b))... };
+
+    for (size_t i = 0; i < sizeof...(Indexes); ++i) {
+        const bool expected_eq = ToArray(a)[i] == ToArray(b)[i];
+        ASSERT_EQ(expected_lt_unsigned[i] ? ones[i] : 0, lt_unsigned[i]) << "pack " << i;
+        ASSERT_EQ(expected_lt_unsigned[i] || expected_eq ? ones[i] : 0, le_unsigned[i]) << "pack " << i;
+        ASSERT_EQ(expected_lt_signed[i] ? ones[i] : 0, lt_signed[i]) << "pack " << i;
+        ASSERT_EQ(expected_lt_signed[i] ? 0 : ones[i], ge_signed[i]) << "pack " << i;
+        ASSERT_EQ(expected_eq ? ones[i] : 0, eq[i]) << "pack " << i;
+    }
+}
+
+// Packs are taken from small range, so equal packs are common
+template<size_t Bits0, size_t ...Bits, class Integer>
+void CheckCompare(pint::packed_int<Integer, Bits0, Bits...>) {
+    using PackedInt = pint::packed_int<Integer, Bits0, Bits...>;
+
+    uint64_t seed = 1;
+    for (size_t i = 0; i < 1000; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const auto value = static_cast<Integer>(seed >> 11);
+        const auto a = pint::add_wrap(PackedInt(value), PackedInt(0));
+        const auto b = pint::sub_wrap(a, PackedInt(static_cast<Integer>((seed >> 3) & (seed >> 7)))
+            & PackedInt(pint::detail::mask_loorder<Integer, Bits0, Bits...>::value * 3));
+
+        CheckCompareHelper(a, b, MakeIndexSeq<sizeof...(Bits) + 1>());
+    }
+}
+
+TEST(TestCompare, Random) {
+    CheckCompare(pint::packed_int<uint32_t,1,2,3,4,5,6,11>(0));
+    CheckCompare(pint::packed_int<uint64_t,8,8,8,8,8,8,8,8>(0));
+    CheckCompare(pint::packed_int<uint64_t,3,13,17,31>(0));
+    CheckCompare(pint::packed_int<uint16_t,16>(0));
+}
+
+TEST(TestSelect, Select) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    constexpr auto a = PackedInt(5,100,33);
+    constexpr auto b = PackedInt(2,10,40);
+
+    // Clamp packs of a to b
+    ASSERT_EQ(PackedInt(2,10,33), pint::select(pint::cmp_gt_unsigned(a, b), b, a));
+}
+
+TEST(TestSelect, AnyAll) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    ASSERT_TRUE(pint::any(PackedInt(0,0,32)));
+    ASSERT_FALSE(pint::any(PackedInt(0,0,0)));
+    ASSERT_TRUE(pint::all(PackedInt(1,64,1)));
+    ASSERT_FALSE(pint::all(PackedInt(1,0,1)));
+}
+
+TEST(TestSelect, Movemask) {
+    using PackedInt = pint::packed_int<uint32_t,1,2,3,4,5,6,11>;
+
+    ASSERT_EQ(0x55u, pint::movemask(PackedInt(1,3,7,15,31,63,2047) & PackedInt(1,0,7,0,31,0,2047)));
+    ASSERT_EQ(0x7fu, pint::movemask(PackedInt(~0u)));
+    ASSERT_EQ(0x22u, pint::movemask(pint::cmp_lt_unsigned(PackedInt(0,1,5,8,16,32,1024), PackedInt(0,2,4,8,15,33,1000))));
+}
+
+TEST(TestReduce, SameLength) {
+    using PackedInt = pint::packed_int<uint32_t,8,8,8,8>;
+    constexpr auto value = PackedInt(200,100,3,250);
+
+    static_assert(pint::reduce_add_wide(value) == 553, "Sum must be exact");
+    ASSERT_EQ(553u % 256, pint::reduce_add(value));
+    ASSERT_EQ(3u, pint::reduce_min_unsigned(value));
+    ASSERT_EQ(250u, pint::reduce_max_unsigned(value));
+    ASSERT_EQ(-56, pint::reduce_min_signed(value));
+    ASSERT_EQ(100, pint::reduce_max_signed(value));
+    ASSERT_EQ(0xffu, pint::reduce_or(value));
+}
+
+TEST(TestReduce, VarLength) {
+    using PackedInt = pint::packed_int<uint16_t,3,7,6>;
+    constexpr auto value = PackedInt(7,100,33);
+
+    static_assert(pint::reduce_add_wide(value) == 140, "Sum must be exact");
+    ASSERT_EQ(12u, pint::reduce_add(value));
+    ASSERT_EQ(7u, pint::reduce_min_unsigned(value));
+    ASSERT_EQ(100u, pint::reduce_max_unsigned(value));
+    ASSERT_EQ(-31, pint::reduce_min_signed(value));
+    ASSERT_EQ(-1, pint::reduce_max_signed(value));
+    ASSERT_EQ(103u, pint::reduce_or(value));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer, size_t ...Indexes>
+void CheckReduceHelper(pint::packed_int<Integer, Bits0, Bits...> value, IndexSeq<Indexes...>) {
+    const Integer unsigned_values[] = { pint::get<Indexes>(value)... };
+    const int64_t signed_values[] = { pint::get_signed<Indexes>(value)... };
+    const Integer max_pack = pint::detail::all_ones<Integer,
+        pint::detail::find_max<Bits0, Bits...>::value>::value;
+
+    uint64_t sum = 0;
+    Integer bits = 0;
+    for (size_t i = 0; i < sizeof...(Indexes); ++i) {
+        sum += unsigned_values[i];
+        bits |= unsigned_values[i];
+    }
+
+    const auto minmax_unsigned = std::minmax_element(std::begin(unsigned_values), std::end(unsigned_values));
+    const auto minmax_signed = std::minmax_element(std::begin(signed_values), std::end(signed_values));
+
+    ASSERT_EQ(sum, pint::reduce_add_wide(value));
+    ASSERT_EQ(static_cast<Integer>(sum & max_pack), pint::reduce_add(value));
+    ASSERT_EQ(bits, pint::reduce_or(value));
+    ASSERT_EQ(*minmax_unsigned.first, pint::reduce_min_unsigned(value));
+    ASSERT_EQ(*minmax_unsigned.second, pint::reduce_max_unsigned(value));
+    ASSERT_EQ(*minmax_signed.first, pint::reduce_min_signed(value));
+    ASSERT_EQ(*minmax_signed.second, pint::reduce_max_signed(value));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void CheckReduce(pint::packed_int<Integer, Bits0, Bits...>) {
+    using PackedInt = pint::packed_int<Integer, Bits0, Bits...>;
+
+    uint64_t seed = 1;
+    for (size_t i = 0; i < 1000; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        const auto value = pint::add_wrap(PackedInt(static_cast<Integer>(seed >> 3)), PackedInt(0));
+        CheckReduceHelper(value, MakeIndexSeq<sizeof...(Bits) + 1>());
+    }
+}
+
+TEST(TestReduce, Random) {
+    CheckReduce(pint::packed_int<uint32_t,1,2,3,4,5,6,11>(0));
+    CheckReduce(pint::packed_int<uint64_t,8,8,8,8,8,8,8,8>(0));
+    CheckReduce(pint::packed_int<uint64_t,5,5,5,5,5,5,5,5,5,5,5>(0));
+    CheckReduce(pint::packed_int<uint64_t,7,7,7,7,7,7,7>(0));
+    CheckReduce(pint::packed_int<uint64_t,3,13,17,31>(0));
+    CheckReduce(pint::packed_int<uint16_t,5,5,5>(0));
+    CheckReduce(pint::packed_int<uint16_t,16>(0));
+    CheckReduce(pint::packed_int<uint8_t,1,1,1,1,1,1,1,1>(0));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(TestBitCount, SameLength) {
+    using PackedInt = pint::packed_int<uint64_t,8,8,8,8,8,8,8,8>;
+    constexpr auto value = PackedInt(0, 1, 0x80, 0xff, 0x10, 0x0f, 0xf0, 0x55);
+
+    static_assert(pint::popcount_lanes(value) == PackedInt(0, 1, 1, 8, 1, 4, 4, 4), "Counts of packs");
+    ASSERT_EQ(PackedInt(8, 7, 0, 0, 3, 4, 0, 1), pint::clz_lanes(value));
+    ASSERT_EQ(PackedInt(8, 0, 7, 0, 4, 0, 4, 0), pint::ctz_lanes(value));
+}
+
+TEST(TestBitCount, VarLength) {
+    using PackedInt = pint::packed_int<uint16_t,1,3,5,7>;
+    constexpr auto value = PackedInt(1, 0, 0x14, 0x7f);
+
+    ASSERT_EQ(PackedInt(1, 0, 2, 7), pint::popcount_lanes(value));
+    ASSERT_EQ(PackedInt(0, 3, 0, 0), pint::clz_lanes(value));
+    ASSERT_EQ(PackedInt(0, 3, 2, 0), pint::ctz_lanes(value));
+
+    // Full packs and zero packs
+    ASSERT_EQ(PackedInt(1, 3, 5, 7), pint::popcount_lanes(PackedInt(0xffff)));
+    ASSERT_EQ(PackedInt(1, 3, 5, 7), pint::clz_lanes(PackedInt(0)));
+    ASSERT_EQ(PackedInt(1, 3, 5, 7), pint::ctz_lanes(PackedInt(0)));
+}
+
+template<class Integer>
+Integer PopcountOf(Integer value) {
+    Integer result = 0;
+    for (; value != 0; value &= static_cast<Integer>(value - 1))
+        ++result;
+    return result;
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer, size_t ...Indexes>
+void CheckBitCountHelper(pint::packed_int<Integer, Bits0, Bits...> value, IndexSeq<Indexes...>) {
+    using PackedInt = pint::packed_int<Integer, Bits0, Bits...>;
+    const Integer values[] = { pint::get<Indexes>(value)... };
+    const size_t lengths[] = { Bits0, Bits... };
+
+    Integer popcount[sizeof...(Indexes)], clz[sizeof...(Indexes)], ctz[sizeof...(Indexes)];
+    for (size_t i = 0; i < sizeof...(Indexes); ++i) {
+        popcount[i] = PopcountOf(values[i]);
+        clz[i] = ctz[i] = static_cast<Integer>(lengths[i]);
+        for (size_t bit = 0; bit < lengths[i]; ++bit) {
+            if ((values[i] >> bit) & 1) {
+                clz[i] = static_cast<Integer>(lengths[i] - bit - 1);
+                ctz[i] = std::min(ctz[i], static_cast<Integer>(bit));
+            }
+        }
+    }
+
+    ASSERT_EQ(PackedInt(popcount[Indexes]...), pint::popcount_lanes(value));
+    ASSERT_EQ(PackedInt(clz[Indexes]...), pint::clz_lanes(value));
+    ASSERT_EQ(PackedInt(ctz[Indexes]...), pint::ctz_lanes(value));
+}
+
+template<size_t Bits0, size_t ...Bits, class Integer>
+void CheckBitCount(pint::packed_int<Integer, Bits0, Bits...>) {
+    using PackedInt = pint::packed_int<Integer, Bits0, Bits...>;
+
+    uint64_t seed = 1;
+    for (size_t i = 0; i < 1000; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        // Sparse values have longer runs of zeros
+        const auto bits = static_cast<Integer>(i % 2 ? seed >> 3 : (seed >> 3) & (seed >> 17) & (seed >> 29));
+        CheckBitCountHelper(pint::add_wrap(PackedInt(bits), PackedInt(0)), MakeIndexSeq<sizeof...(Bits) + 1>());
+    }
+}
+
+TEST(TestBitCount, Random) {
+    CheckBitCount(pint::packed_int<uint32_t,1,2,3,4,5,6,11>(0));
+    CheckBitCount(pint::packed_int<uint64_t,8,8,8,8,8,8,8,8>(0));
+    CheckBitCount(pint::packed_int<uint64_t,5,5,5,5,5,5,5,5,5,5,5>(0));
+    CheckBitCount(pint::packed_int<uint64_t,3,13,17,31>(0));
+    CheckBitCount(pint::packed_int<uint64_t,64>(0));
+    CheckBitCount(pint::packed_int<uint16_t,5,6,5>(0));
+    CheckBitCount(pint::packed_int<uint8_t,1,1,1,1,1,1,1,1>(0));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+TEST(TestOverflow, Unsigned) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    pint::overflow_flags<PackedInt> overflow;
+    ASSERT_EQ(PackedInt(1,127,4), pint::add_overflow_unsigned(PackedInt(5,100,30), PackedInt(4,27,38), overflow));
+    ASSERT_EQ(0x5u, overflow.movemask());
+    ASSERT_EQ(PackedInt(7,0,63), overflow.mask());
+
+    overflow.clear();
+    ASSERT_FALSE(overflow.any());
+    ASSERT_EQ(PackedInt(7,0,62), pint::sub_overflow_unsigned(PackedInt(5,100,30), PackedInt(6,100,32), overflow));
+    ASSERT_EQ(PackedInt(4,0,32), overflow.bits());
+}
+
+// Carry out of the pack doesn't mark the next pack, even if its sum is all ones
+TEST(TestOverflow, CarryDoesNotLeak) {
+    using PackedInt = pint::make_packed_int<4,4>;
+
+    pint::overflow_flags<PackedInt> overflow;
+    ASSERT_EQ(PackedInt(0,15), pint::add_overflow_unsigned(PackedInt(15,15), PackedInt(1,0), overflow));
+    ASSERT_EQ(0x1u, overflow.movemask());
+
+    overflow.clear();
+    ASSERT_EQ(PackedInt(15,0), pint::sub_overflow_unsigned(PackedInt(0,0), PackedInt(1,0), overflow));
+    ASSERT_EQ(0x1u, overflow.movemask());
+}
+
+TEST(TestOverflow, Signed) {
+    using PackedInt = pint::make_packed_int<3,7,6>;
+
+    // 3 + 1, -64 + (-1), 31 + (-32)
+    pint::overflow_flags<PackedInt> overflow;
+    ASSERT_EQ(PackedInt(4,63,63), pint::add_overflow_signed(PackedInt(3,64,31), PackedInt(1,127,32), overflow));
+    ASSERT_EQ(0x3u, overflow.movemask());
+
+    // -4 - 1, 63 - (-1), -32 - 31
+    overflow.clear();
+    ASSERT_EQ(PackedInt(3,64,1), pint::sub_overflow_signed(PackedInt(4,63,32), PackedInt(1,127,31), overflow));
+    ASSERT_EQ(0x7u, overflow.movemask());
+}
+
+// Flags are sticky, they are reset only by clear
+TEST(TestOverflow, Sticky) {
+    using PackedInt = pint::make_packed_int<8,8,8,8>;
+
+    pint::overflow_flags<PackedInt> overflow;
+    auto sum = PackedInt(0);
+    for (unsigned i = 0; i < 100; ++i)
+        sum = pint::add_overflow_unsigned(sum, PackedInt(1,2,3,4), overflow);
+
+    ASSERT_EQ(PackedInt(100,200,44,144), sum);
+    ASSERT_EQ(0xcu, overflow.movemask());
+
+    pint::overflow_flags<PackedInt> other;
+    pint::add_overflow_unsigned(PackedInt(255,0,0,0), PackedInt(1,0,0,0), other);
+    overflow.merge(other);
+    ASSERT_EQ(0xdu, overflow.movemask());
+}
+
+// Flags match the reference computed for each pack
+TEST(TestOverflow, Exhaustive) {
+    using PackedInt = pint::packed_int<uint8_t,3,5>;
+
+    for (unsigned a = 0; a < 256; ++a) {
+        for (unsigned b = 0; b < 256; ++b) {
+            const auto pa = PackedInt(static_cast<uint8_t>(a));
+            const auto pb = PackedInt(static_cast<uint8_t>(b));
+            const int a0 = pint::get<0>(pa), a1 = pint::get<1>(pa);
+            const int b0 = pint::get<0>(pb), b1 = pint::get<1>(pb);
+            const int sa0 = pint::get_signed<0>(pa), sa1 = pint::get_signed<1>(pa);
+            const int sb0 = pint::get_signed<0>(pb), sb1 = pint::get_signed<1>(pb);
+
+            pint::overflow_flags<PackedInt> overflow;
+            ASSERT_EQ(pint::add_wrap(pa, pb), pint::add_overflow_unsigned(pa, pb, overflow));
+            ASSERT_EQ((a0 + b0 > 7 ? 1u : 0u) | (a1 + b1 > 31 ? 2u : 0u), overflow.movemask()) << a << " " << b;
+
+            overflow.clear();
+            ASSERT_EQ(pint::add_wrap(pa, pb), pint::add_overflow_signed(pa, pb, overflow));
+            ASSERT_EQ((sa0 + sb0 > 3 || sa0 + sb0 < -4 ? 1u : 0u) | (sa1 + sb1 > 15 || sa1 + sb1 < -16 ? 2u : 0u),
+                overflow.movemask()) << a << " " << b;
+
+            overflow.clear();
+            ASSERT_EQ(pint::sub_wrap(pa, pb), pint::sub_overflow_unsigned(pa, pb, overflow));
+            ASSERT_EQ((a0 < b0 ? 1u : 0u) | (a1 < b1 ? 2u : 0u), overflow.movemask()) << a << " " << b;
+
+            overflow.clear();
+            ASSERT_EQ(pint::sub_wrap(pa, pb), pint::sub_overflow_signed(pa, pb, overflow));
+            ASSERT_EQ((sa0 - sb0 > 3 || sa0 - sb0 < -4 ? 1u : 0u) | (sa1 - sb1 > 15 || sa1 - sb1 < -16 ? 2u : 0u),
+                overflow.movemask()) << a << " " << b;
+        }
+    }
+}
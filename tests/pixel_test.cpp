@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/pixel.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+using pint_test::ForEachLevel;
+using pint_test::RandomPackedInts;
+
+// Lengths of channels, from the first pack
+template<class PackedInt> struct Channels;
+template<class Integer, size_t ...Bits>
+struct Channels<pint::packed_int<Integer, Bits...>> {
+    static std::vector<size_t> Bits_() { return { Bits... }; }
+
+    static std::vector<uint64_t> Get(pint::packed_int<Integer, Bits...> pixel) {
+        std::vector<uint64_t> result;
+        uint64_t value = pixel.value();
+        for (size_t bits : Bits_()) {
+            result.push_back(value & ((uint64_t(1) << bits) - 1));
+            value >>= bits;
+        }
+        return result;
+    }
+};
+
+// Channel blended with weight / 2^rounds is less than exact value by less than 1
+void CheckBlended(uint64_t result, uint64_t src, uint64_t dst, uint64_t weight, size_t rounds) {
+    const uint64_t scaled = src * weight + dst * ((uint64_t(1) << rounds) - weight);
+    ASSERT_LE(result << rounds, scaled);
+    ASSERT_GT((result + 1) << rounds, scaled);
+}
+
+template<class PackedInt>
+void CheckBlend() {
+    const size_t count = 1001;
+    const auto src = RandomPackedInts<PackedInt>(count, 1);
+    const auto dst = RandomPackedInts<PackedInt>(count, 2);
+    std::vector<PackedInt> out(count, PackedInt(0));
+
+    const auto bits = Channels<PackedInt>::Bits_();
+    const size_t rounds = *std::max_element(bits.begin(), bits.end());
+
+    for (unsigned alpha : { 0, 1, 77, 128, 200, 254, 255 }) {
+        SCOPED_TRACE(alpha);
+        pint::blend(src.data(), dst.data(), out.data(), count, static_cast<uint8_t>(alpha));
+
+        const uint64_t weight = (uint64_t(alpha) * (uint64_t(1) << rounds) + 127) / 255;
+        for (size_t i = 0; i < count; ++i) {
+            if (alpha == 0) {
+                ASSERT_EQ(dst[i], out[i]);
+            }
+            if (alpha == 255) {
+                ASSERT_EQ(src[i], out[i]);
+            }
+
+            const auto s = Channels<PackedInt>::Get(src[i]);
+            const auto d = Channels<PackedInt>::Get(dst[i]);
+            const auto r = Channels<PackedInt>::Get(out[i]);
+            for (size_t c = 0; c < bits.size(); ++c)
+                ASSERT_NO_FATAL_FAILURE(CheckBlended(r[c], s[c], d[c], weight, rounds)) << "index " << i;
+        }
+    }
+}
+
+// Alpha of source weights the channels, alpha of the result is blended
+// between destination alpha and opaque
+template<class PackedInt>
+void CheckBlendOver() {
+    const size_t count = 1001;
+    const auto src = RandomPackedInts<PackedInt>(count, 3);
+    const auto dst = RandomPackedInts<PackedInt>(count, 4);
+    std::vector<PackedInt> out(count, PackedInt(0));
+
+    pint::blend_over(src.data(), dst.data(), out.data(), count);
+
+    const auto bits = Channels<PackedInt>::Bits_();
+    const size_t rounds = bits[0];
+    const uint64_t max_alpha = (uint64_t(1) << rounds) - 1;
+
+    for (size_t i = 0; i < count; ++i) {
+        auto s = Channels<PackedInt>::Get(src[i]);
+        const auto d = Channels<PackedInt>::Get(dst[i]);
+        const auto r = Channels<PackedInt>::Get(out[i]);
+
+        const uint64_t weight = s[0] + (s[0] >> (rounds - 1));
+        s[0] = max_alpha;
+        for (size_t c = 0; c < bits.size(); ++c) {
+            if (weight == 0)
+                ASSERT_EQ(d[c], r[c]);
+            else if (weight == (uint64_t(1) << rounds))
+                ASSERT_EQ(s[c], r[c]);
+            else
+                ASSERT_NO_FATAL_FAILURE(CheckBlended(r[c], s[c], d[c], weight, rounds)) << "index " << i;
+        }
+    }
+}
+
+template<class PackedInt>
+void CheckAverage() {
+    const size_t count = 1001;
+    const auto a = RandomPackedInts<PackedInt>(count, 5);
+    const auto b = RandomPackedInts<PackedInt>(count, 6);
+    std::vector<PackedInt> out(count, PackedInt(0));
+
+    pint::average(a.data(), b.data(), out.data(), count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const auto x = Channels<PackedInt>::Get(a[i]);
+        const auto y = Channels<PackedInt>::Get(b[i]);
+        const auto r = Channels<PackedInt>::Get(out[i]);
+        for (size_t c = 0; c < x.size(); ++c)
+            ASSERT_EQ((x[c] + y[c]) / 2, r[c]) << "index " << i;
+    }
+}
+
+// Channels of From are rescaled to the channels of To, which are matched
+// from the high order packs. Extra alpha of To is opaque
+template<class From, class To>
+void CheckConversion() {
+    const size_t count = 1001;
+    const auto pixels = RandomPackedInts<From>(count, 7);
+    std::vector<To> out(count, To(0));
+
+    pint::convert_pixels(pixels.data(), out.data(), count);
+
+    const auto from_bits = Channels<From>::Bits_();
+    const auto to_bits = Channels<To>::Bits_();
+    const size_t from_first = from_bits.size() > to_bits.size() ? 1 : 0;
+    const size_t to_first = to_bits.size() > from_bits.size() ? 1 : 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(pint::convert_pixel<To>(pixels[i]), out[i]);
+
+        const auto f = Channels<From>::Get(pixels[i]);
+        const auto t = Channels<To>::Get(out[i]);
+        if (to_first) {
+            ASSERT_EQ((uint64_t(1) << to_bits[0]) - 1, t[0]);
+        }
+
+        for (size_t c = 0; c + from_first < f.size(); ++c) {
+            const size_t fb = from_bits[c + from_first], tb = to_bits[c + to_first];
+            const uint64_t max_from = (uint64_t(1) << fb) - 1, max_to = (uint64_t(1) << tb) - 1;
+            const uint64_t value = f[c + from_first], converted = t[c + to_first];
+
+            if (tb <= fb) {
+                ASSERT_EQ(value >> (fb - tb), converted);
+            } else {
+                // Top bits are the source channel, extremes are kept
+                ASSERT_EQ(value, converted >> (tb - fb));
+                ASSERT_EQ(value == 0, converted == 0);
+                ASSERT_EQ(value == max_from, converted == max_to);
+            }
+        }
+    }
+}
+
+// Conversion to wider format and back gives the same pixel
+template<class Narrow, class Wide>
+void CheckRoundTrip() {
+    std::vector<Narrow> pixels;
+    for (uint32_t value = 0; value < 0x10000; ++value)
+        pixels.push_back(Narrow(static_cast<typename Narrow::value_type>(value)));
+
+    std::vector<Wide> wide(pixels.size(), Wide(0));
+    std::vector<Narrow> back(pixels.size(), Narrow(0));
+    pint::convert_pixels(pixels.data(), wide.data(), pixels.size());
+    pint::convert_pixels(wide.data(), back.data(), pixels.size());
+
+    ASSERT_EQ(pixels, back);
+}
+
+} // namespace
+
+TEST(TestPixel, Formats) {
+    ASSERT_EQ(31u, pint::get<2>(pint::rgb565(0xf800)));
+    ASSERT_EQ(1u, pint::get<0>(pint::rgba5551(0x0001)));
+    ASSERT_EQ(0xfu, pint::get<3>(pint::rgba4444(0xf000)));
+
+    ASSERT_EQ(pint::rgba8888(0xff0000ff), pint::convert_pixel<pint::rgba8888>(pint::rgb565(0xf800)));
+    ASSERT_EQ(pint::rgb888(0x00ff00), pint::convert_pixel<pint::rgb888>(pint::rgb565(0x07e0)));
+    ASSERT_EQ(pint::rgb565(0x001f), pint::convert_pixel<pint::rgb565>(pint::rgba8888(0x0000ff80)));
+    ASSERT_EQ(pint::rgba8888(0x8888aaff), pint::convert_pixel<pint::rgba8888>(pint::rgba4444(0x88af)));
+}
+
+TEST(TestPixel, Blend) {
+    CheckBlend<pint::rgb565>();
+    CheckBlend<pint::rgba4444>();
+    CheckBlend<pint::rgba5551>();
+    CheckBlend<pint::rgba8888>();
+}
+
+TEST(TestPixel, BlendOver) {
+    CheckBlendOver<pint::rgba5551>();
+    CheckBlendOver<pint::rgba4444>();
+    CheckBlendOver<pint::rgba8888>();
+}
+
+TEST(TestPixel, Average) {
+    CheckAverage<pint::rgb565>();
+    CheckAverage<pint::rgba4444>();
+    CheckAverage<pint::rgba8888>();
+}
+
+TEST(TestPixel, Brightness) {
+    const auto pixels = RandomPackedInts<pint::rgb565>(1001, 8);
+    const pint::rgb565 amount(3, 10, 0);
+    std::vector<pint::rgb565> out(pixels.size(), pint::rgb565(0));
+
+    pint::brighten(pixels.data(), amount, out.data(), pixels.size());
+    for (size_t i = 0; i < pixels.size(); ++i)
+        ASSERT_EQ(pint::add_unsigned_saturate(pixels[i], amount), out[i]);
+
+    pint::darken(pixels.data(), amount, out.data(), pixels.size());
+    for (size_t i = 0; i < pixels.size(); ++i)
+        ASSERT_EQ(pint::sub_unsigned_saturate(pixels[i], amount), out[i]);
+}
+
+TEST(TestPixel, Conversion) {
+    CheckConversion<pint::rgb565, pint::rgba8888>();
+    CheckConversion<pint::rgb565, pint::rgb888>();
+    CheckConversion<pint::rgba8888, pint::rgb565>();
+    CheckConversion<pint::rgb888, pint::rgb565>();
+    CheckConversion<pint::rgba4444, pint::rgba8888>();
+    CheckConversion<pint::rgba8888, pint::rgba4444>();
+    CheckConversion<pint::rgba5551, pint::rgba8888>();
+    CheckConversion<pint::rgba8888, pint::rgba5551>();
+}
+
+TEST(TestPixel, RoundTrip) {
+    CheckRoundTrip<pint::rgb565, pint::rgba8888>();
+    CheckRoundTrip<pint::rgb565, pint::rgb888>();
+    CheckRoundTrip<pint::rgba4444, pint::rgba8888>();
+    CheckRoundTrip<pint::rgba5551, pint::rgba8888>();
+}
+
+TEST(TestPixel, AllLevels) {
+    ForEachLevel([] {
+        CheckBlend<pint::rgb565>();
+        CheckBlendOver<pint::rgba4444>();
+        CheckAverage<pint::rgba8888>();
+        CheckConversion<pint::rgb565, pint::rgba8888>();
+        CheckConversion<pint::rgba8888, pint::rgb565>();
+    });
+}
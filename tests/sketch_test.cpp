@@ -0,0 +1,137 @@
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/sketch.hpp"
+
+namespace {
+
+std::vector<uint64_t> RandomHashes(size_t count, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::vector<uint64_t> result(count);
+    for (auto &hash : result)
+        hash = gen();
+    return result;
+}
+
+// Batch query returns the same values as queries of single keys
+template<class Sketch, class Query>
+void CheckBatch(const Sketch &sketch, const std::vector<uint64_t> &hashes, Query query) {
+    for (size_t count : { size_t(0), size_t(1), size_t(17), size_t(1000), hashes.size() }) {
+        std::vector<uint32_t> result(count, 12345);
+        query(sketch, hashes.data(), result.data(), count);
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(sketch.query_single(hashes[i]), result[i]) << "index " << i;
+    }
+}
+
+template<size_t Bits>
+struct CountMin : pint::count_min_sketch<Bits> {
+    using pint::count_min_sketch<Bits>::count_min_sketch;
+    uint64_t query_single(uint64_t hash) const { return this->query(hash); }
+};
+
+template<size_t Bits>
+struct Bloom : pint::counting_bloom<Bits> {
+    using pint::counting_bloom<Bits>::counting_bloom;
+    uint64_t query_single(uint64_t hash) const { return this->count(hash); }
+};
+
+} // namespace
+
+TEST(TestCountMinSketch, Estimates) {
+    pint::count_min_sketch<8> sketch(1000, 4);
+    ASSERT_EQ(1024u, sketch.width());
+    ASSERT_EQ(4u, sketch.depth());
+    ASSERT_EQ(4096u, sketch.size_bytes());
+
+    const auto hashes = RandomHashes(300, 1);
+    std::unordered_map<uint64_t, uint64_t> counts;
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        sketch.insert(hashes[i], i % 7 + 1);
+        counts[hashes[i]] += i % 7 + 1;
+    }
+
+    // Estimate is never less than the real count
+    for (const auto &count : counts)
+        ASSERT_LE(count.second, sketch.query(count.first));
+    ASSERT_EQ(0u, sketch.query(RandomHashes(1, 2)[0]));
+}
+
+TEST(TestCountMinSketch, Saturation) {
+    pint::count_min_sketch<4> sketch(64, 3);
+    ASSERT_EQ(96u, sketch.size_bytes());
+
+    for (int i = 0; i < 20; ++i)
+        sketch.insert(42);
+    ASSERT_EQ(15u, sketch.query(42));
+
+    sketch.insert(43, 100);
+    ASSERT_EQ(15u, sketch.query(43));
+
+    sketch.clear();
+    ASSERT_EQ(0u, sketch.query(42));
+}
+
+TEST(TestCountMinSketch, Batch) {
+    const auto hashes = RandomHashes(5000, 3);
+
+    CountMin<4> sketch4(512, 4);
+    sketch4.insert(hashes.data(), hashes.size());
+    CheckBatch(sketch4, hashes, [](const CountMin<4> &s, const uint64_t *h, uint32_t *out, size_t n) { s.query(h, out, n); });
+
+    CountMin<8> sketch8(512, 3);
+    sketch8.insert(hashes.data(), hashes.size() / 2);
+    CheckBatch(sketch8, hashes, [](const CountMin<8> &s, const uint64_t *h, uint32_t *out, size_t n) { s.query(h, out, n); });
+
+    CountMin<16> sketch16(4096, 2);
+    sketch16.insert(hashes.data(), hashes.size());
+    CheckBatch(sketch16, hashes, [](const CountMin<16> &s, const uint64_t *h, uint32_t *out, size_t n) { s.query(h, out, n); });
+}
+
+TEST(TestCountingBloom, InsertErase) {
+    pint::counting_bloom<4> filter(1000, 3);
+    ASSERT_EQ(1024u, filter.size());
+    ASSERT_EQ(512u, filter.size_bytes());
+
+    const auto hashes = RandomHashes(100, 4);
+    filter.insert(hashes.data(), hashes.size());
+    for (auto hash : hashes)
+        ASSERT_TRUE(filter.contains(hash));
+
+    for (size_t i = 0; i < 50; ++i)
+        filter.erase(hashes[i]);
+    for (size_t i = 50; i < hashes.size(); ++i)
+        ASSERT_TRUE(filter.contains(hashes[i]));
+}
+
+// Saturated counters are not decremented, so key stays in the filter
+TEST(TestCountingBloom, Saturation) {
+    pint::counting_bloom<4> filter(64, 2);
+
+    for (int i = 0; i < 20; ++i)
+        filter.insert(7);
+    ASSERT_EQ(15u, filter.count(7));
+
+    for (int i = 0; i < 20; ++i)
+        filter.erase(7);
+    ASSERT_EQ(15u, filter.count(7));
+
+    const auto before = filter.count(9);
+    filter.insert(9);
+    filter.erase(9);
+    ASSERT_EQ(before, filter.count(9));
+}
+
+TEST(TestCountingBloom, Batch) {
+    const auto hashes = RandomHashes(3000, 5);
+
+    Bloom<4> filter(2048, 4);
+    filter.insert(hashes.data(), hashes.size() / 3);
+    CheckBatch(filter, hashes, [](const Bloom<4> &f, const uint64_t *h, uint32_t *out, size_t n) { f.count(h, out, n); });
+
+    Bloom<8> filter8(1 << 14, 3);
+    filter8.insert(hashes.data(), hashes.size());
+    CheckBatch(filter8, hashes, [](const Bloom<8> &f, const uint64_t *h, uint32_t *out, size_t n) { f.count(h, out, n); });
+}
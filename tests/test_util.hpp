@@ -0,0 +1,63 @@
+// Helpers shared by unit tests
+
+#pragma once
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/pint.hpp"
+#include "pint/simd.hpp"
+
+namespace pint_test {
+
+// Random packed integers, bits not used by packs are cleared
+template<class PackedInt>
+std::vector<PackedInt> RandomPackedInts(size_t count, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::vector<PackedInt> result;
+    result.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        using value_type = typename PackedInt::value_type;
+        result.push_back(pint::add_wrap(
+            PackedInt(static_cast<value_type>(gen())), PackedInt(0)));
+    }
+
+    return result;
+}
+
+// Restores SIMD level and use of VPOPCNT on scope exit, so a test which
+// fails half way doesn't leave the following tests at another level
+class ScopedLevel {
+public:
+    ScopedLevel()
+        : m_level(pint::simd::current_level())
+        , m_popcnt(pint::simd::current_avx512_popcnt())
+    {}
+    ScopedLevel(const ScopedLevel &) = delete;
+    ScopedLevel &operator=(const ScopedLevel &) = delete;
+    ~ScopedLevel() {
+        pint::simd::set_level(m_level);
+        pint::simd::set_avx512_popcnt(m_popcnt);
+    }
+
+private:
+    pint::simd::level m_level;
+    bool m_popcnt;
+};
+
+// Run function at each instruction set supported by CPU
+template<class Function>
+void ForEachLevel(Function function) {
+    ScopedLevel restore;
+
+    for (int i = 0; i <= static_cast<int>(pint::simd::detected_level()); ++i) {
+        pint::simd::set_level(static_cast<pint::simd::level>(i));
+        SCOPED_TRACE(pint::simd::level_name(pint::simd::current_level()));
+        function();
+    }
+}
+
+} // namespace pint_test
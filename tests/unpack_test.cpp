@@ -0,0 +1,161 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/unpack.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+using pint_test::ForEachLevel;
+using pint_test::RandomPackedInts;
+
+// Unpacked values are the same as returned by get<>, packing them
+// gives the original packed integers
+template<class T, class PackedInt, size_t ...Indices>
+void CheckUnpack() {
+    const size_t packs = sizeof...(Indices);
+    const size_t count = 101;
+    const auto values = RandomPackedInts<PackedInt>(count, 1);
+
+    std::vector<T> unpacked(count * packs, T(0));
+    pint::unpack(values.data(), unpacked.data(), count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const T expected[] = { static_cast<T>(pint::get<Indices>(values[i]))... };
+        for (size_t j = 0; j < packs; ++j)
+            ASSERT_EQ(expected[j], unpacked[i * packs + j]) << "index " << i << ", pack " << j;
+
+        T single[packs];
+        pint::unpack(values[i], single);
+        ASSERT_TRUE(std::equal(single, single + packs, expected)) << "index " << i;
+
+        ASSERT_EQ(values[i], pint::pack<PackedInt>(expected)) << "index " << i;
+    }
+
+    std::vector<PackedInt> packed(count, PackedInt(0));
+    pint::pack(unpacked.data(), packed.data(), count);
+    ASSERT_EQ(values, packed);
+}
+
+void CheckAll() {
+    CheckUnpack<uint8_t, pint::packed_int<uint16_t, 3, 7, 6>, 0, 1, 2>();
+    CheckUnpack<uint16_t, pint::packed_int<uint32_t, 1, 2, 3, 4, 5, 6, 11>, 0, 1, 2, 3, 4, 5, 6>();
+    CheckUnpack<uint32_t, pint::packed_int<uint32_t, 1, 2, 3, 4, 5, 6, 11>, 0, 1, 2, 3, 4, 5, 6>();
+    CheckUnpack<uint8_t, pint::packed_int<uint64_t, 8, 8, 8, 8, 8, 8, 8, 8>, 0, 1, 2, 3, 4, 5, 6, 7>();
+    CheckUnpack<uint8_t, pint::packed_int<uint64_t, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5>,
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11>();
+    CheckUnpack<uint32_t, pint::packed_int<uint64_t, 20, 31, 13>, 0, 1, 2>();
+    CheckUnpack<uint64_t, pint::packed_int<uint64_t, 64>, 0>();
+    CheckUnpack<uint64_t, pint::packed_int<uint64_t, 3, 61>, 0, 1>();
+}
+
+} // namespace
+
+TEST(TestUnpack, Default) {
+    CheckAll();
+}
+
+// Results don't depend on pdep / pext
+TEST(TestUnpack, WithoutBmi2) {
+    const bool initial = pint::simd::current_bmi2();
+
+    pint::simd::set_bmi2(false);
+    EXPECT_FALSE(pint::simd::current_bmi2());
+    CheckAll();
+
+    pint::simd::set_bmi2(true);
+    EXPECT_EQ(pint::simd::detected_bmi2(), pint::simd::current_bmi2());
+    CheckAll();
+
+    pint::simd::set_bmi2(initial);
+}
+
+#ifdef __SIZEOF_INT128__
+TEST(TestUnpack, Int128) {
+    CheckUnpack<uint64_t, pint::packed_int<unsigned __int128, 3, 60, 5, 33, 11, 1>, 0, 1, 2, 3, 4, 5>();
+}
+#endif
+
+// Struct of fields of the same type is unpacked as array
+TEST(TestUnpack, Struct) {
+    struct Rgb565 { uint8_t b, g, r; };
+    using Pixel = pint::make_packed_int<5, 6, 5>;
+
+    Rgb565 rgb;
+    pint::unpack(Pixel(31, 40, 7), &rgb.b);
+    EXPECT_EQ(31, rgb.b);
+    EXPECT_EQ(40, rgb.g);
+    EXPECT_EQ(7, rgb.r);
+
+    rgb.g = 255;
+    EXPECT_EQ(Pixel(31, 63, 7), pint::pack<Pixel>(&rgb.b));
+}
+
+namespace {
+
+// Columns hold packs of records, records packed from columns are the same
+void CheckLanes() {
+    using Record = pint::packed_int<uint32_t, 1, 2, 3, 4, 5, 6, 11>;
+    for (size_t count : {0, 1, 100, 1024, 3001}) {
+        SCOPED_TRACE(count);
+        const auto records = RandomPackedInts<Record>(count, 2);
+
+        std::vector<uint8_t> c0(count), c1(count), c2(count), c3(count), c4(count), c5(count);
+        std::vector<uint16_t> c6(count);
+        pint::unpack_lanes(records.data(), count,
+            c0.data(), c1.data(), c2.data(), c3.data(), c4.data(), c5.data(), c6.data());
+
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(Record(c0[i], c1[i], c2[i], c3[i], c4[i], c5[i], c6[i]), records[i]) << "index " << i;
+            ASSERT_EQ(pint::get<6>(records[i]), c6[i]) << "index " << i;
+        }
+
+        std::vector<uint32_t> lane(count);
+        pint::unpack_lane<3>(records.data(), count, lane.data());
+        ASSERT_TRUE(std::equal(lane.begin(), lane.end(), c3.begin()));
+
+        std::vector<Record> packed(count, Record(~0u));
+        pint::pack_lanes(packed.data(), count,
+            c0.data(), c1.data(), c2.data(), c3.data(), c4.data(), c5.data(), c6.data());
+        ASSERT_EQ(records, packed);
+    }
+
+    using Wide = pint::packed_int<uint64_t, 20, 31, 13>;
+    const auto wide = RandomPackedInts<Wide>(2000, 3);
+    std::vector<uint32_t> w0(wide.size()), w1(wide.size());
+    std::vector<uint16_t> w2(wide.size());
+    pint::unpack_lanes(wide.data(), wide.size(), w0.data(), w1.data(), w2.data());
+
+    // Values are truncated to packs
+    w2[5] = 0xffff;
+    std::vector<Wide> packed(wide.size(), Wide(0));
+    pint::pack_lanes(packed.data(), packed.size(), w0.data(), w1.data(), w2.data());
+    ASSERT_EQ(0x1fffu, pint::get<2>(packed[5]));
+    packed[5] = wide[5];
+    ASSERT_EQ(wide, packed);
+}
+
+} // namespace
+
+TEST(TestUnpack, Lanes) {
+    CheckLanes();
+
+#ifdef __SIZEOF_INT128__
+    using Record = pint::packed_int<unsigned __int128, 3, 60, 65>;
+    const std::vector<Record> records = { Record(5, 1ull << 59, 3), Record(0, 7, 0) };
+    std::vector<uint8_t> c0(2);
+    std::vector<uint64_t> c1(2);
+    std::vector<unsigned __int128> c2(2);
+    pint::unpack_lanes(records.data(), records.size(), c0.data(), c1.data(), c2.data());
+    EXPECT_EQ(5, c0[0]);
+    EXPECT_EQ(1ull << 59, c1[0]);
+    EXPECT_TRUE(c2[0] == 3);
+    EXPECT_EQ(7u, c1[1]);
+#endif
+}
+
+TEST(TestUnpack, LanesAllLevels) {
+    ForEachLevel([] {
+        CheckLanes();
+    });
+}
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/vector.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+using pint_test::ForEachLevel;
+
+std::vector<uint32_t> RandomValues(size_t count, size_t bits, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::vector<uint32_t> result(count);
+    for (auto &value : result)
+        value = static_cast<uint32_t>(gen() & ((uint64_t(1) << bits) - 1));
+    return result;
+}
+
+// Values set one by one are unpacked in bulk from any position,
+// and values packed in bulk are read one by one
+template<size_t Bits>
+void CheckBits() {
+    SCOPED_TRACE(Bits);
+    const size_t count = 1000;
+    const auto values = RandomValues(count, Bits, Bits);
+
+    pint::packed_vector<Bits> vector(count);
+    for (size_t i = 0; i < count; ++i)
+        vector.set(i, values[i]);
+
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(values[i], vector.get(i)) << "index " << i;
+
+    for (size_t first : {0, 1, 7, 8, 63, 64, 65, 333}) {
+        std::vector<uint32_t> out(count - first, ~0u);
+        vector.unpack(first, out.data(), out.size());
+        ASSERT_TRUE(std::equal(out.begin(), out.end(), values.begin() + first)) << "first " << first;
+    }
+
+    for (size_t first : {0, 1, 64, 100}) {
+        pint::packed_vector<Bits> packed(count, 1);
+        packed.pack(first, values.data(), count - first);
+
+        for (size_t i = 0; i < first; ++i)
+            ASSERT_EQ(1u, packed.get(i)) << "index " << i;
+        for (size_t i = first; i < count; ++i)
+            ASSERT_EQ(values[i - first], packed.get(i)) << "index " << i << " first " << first;
+    }
+}
+
+template<size_t ...Bits>
+void CheckAllBits(pint::detail::integer_seq<Bits...>) {
+    const int expand[] = { (CheckBits<Bits>(), 0)... };
+    (void)expand;
+}
+
+} // namespace
+
+TEST(TestPackedVector, GetSet) {
+    pint::packed_vector<11> vector(10);
+    vector.set(5, 2047);
+    vector.set(6, 4096 + 3);
+    vector[7] = 100;
+
+    EXPECT_EQ(0u, vector.get(4));
+    EXPECT_EQ(2047u, vector.get(5));
+    EXPECT_EQ(3u, vector.get(6));
+    EXPECT_EQ(100u, vector[7]);
+    EXPECT_EQ(0u, vector.get(8));
+    EXPECT_EQ(10u, vector.size());
+}
+
+TEST(TestPackedVector, Bits64) {
+    pint::packed_vector<64> vector(3);
+    vector[1] = ~uint64_t(0) - 1;
+    EXPECT_EQ(0u, vector.get(0));
+    EXPECT_EQ(~uint64_t(0) - 1, vector.get(1));
+    EXPECT_EQ(0u, vector.get(2));
+
+    pint::packed_vector<63> vector63(5, ~uint64_t(0));
+    vector63[3] = 0;
+    EXPECT_EQ(~uint64_t(0) >> 1, vector63.get(2));
+    EXPECT_EQ(0u, vector63.get(3));
+    EXPECT_EQ(~uint64_t(0) >> 1, vector63.get(4));
+}
+
+TEST(TestPackedVector, Resize) {
+    pint::packed_vector<5> vector;
+    EXPECT_TRUE(vector.empty());
+
+    for (uint8_t i = 0; i < 100; ++i)
+        vector.push_back(i);
+    EXPECT_EQ(100u, vector.size());
+    EXPECT_EQ(31u, vector.get(63));
+
+    // Removed values don't appear again
+    vector.resize(13);
+    vector.resize(30);
+    EXPECT_EQ(12u, vector.get(12));
+    EXPECT_EQ(0u, vector.get(13));
+    EXPECT_EQ(0u, vector.get(29));
+
+    vector.resize(40, 7);
+    EXPECT_EQ(0u, vector.get(29));
+    EXPECT_EQ(7u, vector.get(30));
+    EXPECT_EQ(7u, vector.get(39));
+
+    vector.clear();
+    vector.resize(40);
+    EXPECT_EQ(0u, vector.get(39));
+}
+
+TEST(TestPackedVector, Iterators) {
+    pint::packed_vector<3> vector(20);
+    std::iota(vector.begin(), vector.end(), 0);
+
+    const auto &const_vector = vector;
+    EXPECT_EQ(20, const_vector.end() - const_vector.begin());
+    EXPECT_EQ(3u, const_vector.begin()[11]);
+    EXPECT_EQ(7u, *std::max_element(const_vector.begin(), const_vector.end()));
+
+    std::sort(vector.begin(), vector.end());
+    EXPECT_TRUE(std::is_sorted(const_vector.cbegin(), const_vector.cend()));
+    EXPECT_EQ(0u, vector[0]);
+    EXPECT_EQ(7u, vector[19]);
+}
+
+TEST(TestPackedVector, Bulk) {
+    CheckAllBits(pint::detail::integer_seq<
+        1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+        17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32>());
+}
+
+// Each instruction set supported by CPU gives the same results
+TEST(TestPackedVector, AllLevels) {
+    ForEachLevel([] {
+        CheckAllBits(pint::detail::integer_seq<1, 7, 11, 25, 26, 32>());
+    });
+}
+
+TEST(TestPackedRecordVector, GetSet) {
+    using Record = pint::make_packed_int<3, 7, 6>;
+    pint::packed_record_vector<3, 7, 6> vector(9, Record(1, 2, 3));
+
+    vector[4] = Record(7, 100, 33);
+    vector.push_back(Record(5, 6, 7));
+
+    EXPECT_EQ(Record(1, 2, 3), vector.get(3));
+    EXPECT_EQ(Record(7, 100, 33), vector.get(4));
+    EXPECT_EQ(Record(1, 2, 3), vector.get(5));
+    EXPECT_EQ(100u, vector.get_field<1>(4));
+    EXPECT_EQ(7u, vector.get_field<2>(9));
+
+    // Record takes exactly the sum of lengths of its packs
+    EXPECT_EQ(16u, vector.value_bits);
+}
+
+TEST(TestPackedRecordVector, Bulk) {
+    using Vector = pint::packed_record_vector<1, 2, 3, 4, 5, 6, 11>;
+    using Record = Vector::value_type;
+    const auto values = RandomValues(300, 32, 1);
+
+    std::vector<Record> records;
+    for (auto value : values)
+        records.push_back(pint::add_wrap(Record(value), Record(0)));
+
+    Vector vector(records.size() + 10, Record(0));
+    vector.pack(10, records.data(), records.size());
+
+    std::vector<Record> out(records.size(), Record(0));
+    vector.unpack(10, out.data(), out.size());
+    EXPECT_TRUE(records == out);
+    EXPECT_EQ(Record(0), vector.get(9));
+}
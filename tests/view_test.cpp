@@ -0,0 +1,119 @@
+#include <cstddef>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/view.hpp"
+
+namespace {
+
+using Header = pint::packed_int<uint32_t, 16, 8, 4, 4>;     // length, tos, ihl, version
+using Pixel = pint::packed_int<uint16_t, 5, 6, 5>;
+
+// Record with unaligned fields: 1 byte tag, 4 bytes header, 2 bytes pixel
+const size_t kRecordSize = 7;
+
+} // namespace
+
+TEST(TestView, ByteOrder) {
+    unsigned char bytes[5] = { 0xee, 0x45, 0x00, 0x05, 0xdc };
+
+    const pint::packed_view<const Header, pint::endian::big> big(bytes + 1);
+    ASSERT_EQ(Header(0x450005dc), big.load());
+    ASSERT_EQ(1500u, big.get<0>());
+    ASSERT_EQ(0u, big.get<1>());
+    ASSERT_EQ(5u, big.get<2>());
+    ASSERT_EQ(4u, big.get<3>());
+
+    const pint::packed_view<const Header, pint::endian::little> little(bytes + 1);
+    ASSERT_EQ(Header(0xdc050045), static_cast<Header>(little));
+}
+
+TEST(TestView, Store) {
+    unsigned char bytes[6] = {};
+    const pint::packed_view<Header, pint::endian::big> big(bytes + 1);
+
+    big.store(Header(0x45000028));
+    ASSERT_EQ(0x45, bytes[1]);
+    ASSERT_EQ(0x28, bytes[4]);
+    ASSERT_EQ(0, bytes[0]);
+    ASSERT_EQ(0, bytes[5]);
+
+    big.set<0>(0x12345);            // truncated
+    big.set<3>(6);
+    ASSERT_EQ(Header(0x65002345), big.load());
+    ASSERT_EQ(0x65, bytes[1]);
+    ASSERT_EQ(0x45, bytes[4]);
+
+    const pint::packed_view<Pixel, pint::endian::little> little(bytes + 4);
+    little.store(Pixel(31, 0, 1));
+    ASSERT_EQ(0x1f, bytes[4]);
+    ASSERT_EQ(0x08, bytes[5]);
+    ASSERT_EQ(0x65, bytes[1]);
+}
+
+#ifdef __cpp_lib_byte
+TEST(TestView, StdByte) {
+    std::byte bytes[2] = { std::byte(0x12), std::byte(0x34) };
+    pint::packed_view<Pixel, pint::endian::big> view(bytes);
+    ASSERT_EQ(Pixel(0x1234), view.load());
+
+    const pint::packed_view<const Pixel, pint::endian::big> const_view = view;
+    ASSERT_EQ(Pixel(0x1234), const_view.load());
+}
+#endif
+
+// Fields of records are loaded, transformed and stored in place
+TEST(TestView, Arrays) {
+    const size_t count = 100;
+    std::vector<unsigned char> records(count * kRecordSize);
+    for (size_t i = 0; i < records.size(); ++i)
+        records[i] = static_cast<unsigned char>(i * 37 + 11);
+
+    pint::packed_view_array<Header, pint::endian::big> headers(records.data() + 1, count, kRecordSize);
+    pint::packed_view_array<Pixel, pint::endian::big> pixels(records.data() + 5, count, kRecordSize);
+    ASSERT_EQ(count, headers.size());
+
+    std::vector<Header> loaded(count, Header(0));
+    pint::load(headers, loaded.data());
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned char *record = records.data() + i * kRecordSize;
+        ASSERT_EQ(Header(uint32_t(record[1]) << 24 | uint32_t(record[2]) << 16 | uint32_t(record[3]) << 8 | record[4]),
+            loaded[i]) << "index " << i;
+    }
+
+    const std::vector<unsigned char> initial = records;
+    std::vector<Pixel> expected(count, Pixel(0));
+    for (size_t i = 0; i < count; ++i)
+        expected[i] = pint::add_unsigned_saturate(pixels[i].load(), Pixel(1, 2, 3));
+
+    pint::transform(pixels, pixels, [](Pixel pixel) { return pint::add_unsigned_saturate(pixel, Pixel(1, 2, 3)); });
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(expected[i], pixels[i].load()) << "index " << i;
+        ASSERT_EQ(initial[i * kRecordSize], records[i * kRecordSize]) << "index " << i;
+    }
+
+    // Big endian headers of records to contiguous little endian array
+    std::vector<unsigned char> out(count * sizeof(uint32_t));
+    pint::packed_view_array<Header, pint::endian::little> little(out.data(), count);
+    pint::transform(headers, headers, little, [](Header a, Header b) { return pint::add_wrap(a, b); });
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(pint::add_wrap(loaded[i], loaded[i]), little[i].load()) << "index " << i;
+
+    // Chunks of bulk function, the last one is partial
+    const size_t records_count = pint::view_chunk_size * 2 + 10;
+    std::vector<unsigned char> many(records_count * kRecordSize, 0x55);
+    pint::packed_view_array<Pixel, pint::endian::big> many_pixels(many.data() + 5, records_count, kRecordSize);
+    pint::transform_chunks(many_pixels, many_pixels, [](Pixel *values, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            values[i] = pint::add_unsigned_saturate(values[i], Pixel(31, 0, 1));
+    });
+    for (size_t i = 0; i < records_count; ++i) {
+        ASSERT_EQ(pint::add_unsigned_saturate(Pixel(0x5555), Pixel(31, 0, 1)), many_pixels[i].load()) << "index " << i;
+        ASSERT_EQ(0x55, many[i * kRecordSize + 4]) << "index " << i;
+    }
+
+    std::vector<Header> values(count, Header(0x01020304));
+    pint::store(values.data(), headers);
+    for (size_t i = 0; i < count; ++i)
+        ASSERT_EQ(4, records[i * kRecordSize + 4]) << "index " << i;
+}
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "pint/bulk.hpp"
+
+namespace {
+
+struct AddWrap { template<class P> P operator()(P a, P b) const { return pint::add_wrap(a, b); } };
+struct AddUnsignedSaturate { template<class P> P operator()(P a, P b) const { return pint::add_unsigned_saturate(a, b); } };
+struct AddSignedSaturate { template<class P> P operator()(P a, P b) const { return pint::add_signed_saturate(a, b); } };
+struct SubWrap { template<class P> P operator()(P a, P b) const { return pint::sub_wrap(a, b); } };
+struct SubUnsignedSaturate { template<class P> P operator()(P a, P b) const { return pint::sub_unsigned_saturate(a, b); } };
+struct SubSignedSaturate { template<class P> P operator()(P a, P b) const { return pint::sub_signed_saturate(a, b); } };
+struct MinUnsigned { template<class P> P operator()(P a, P b) const { return pint::min_unsigned(a, b); } };
+struct MaxUnsigned { template<class P> P operator()(P a, P b) const { return pint::max_unsigned(a, b); } };
+struct MinSigned { template<class P> P operator()(P a, P b) const { return pint::min_signed(a, b); } };
+struct MaxSigned { template<class P> P operator()(P a, P b) const { return pint::max_signed(a, b); } };
+struct CmpEq { template<class P> P operator()(P a, P b) const { return pint::cmp_eq(a, b); } };
+struct CmpLtUnsigned { template<class P> P operator()(P a, P b) const { return pint::cmp_lt_unsigned(a, b); } };
+struct CmpLeSigned { template<class P> P operator()(P a, P b) const { return pint::cmp_le_signed(a, b); } };
+
+template<class T> struct Tag {};
+
+#ifdef __SIZEOF_INT128__
+unsigned __int128 RandomScalar(std::mt19937_64 &gen, Tag<unsigned __int128>) {
+    const unsigned __int128 hi = gen();
+    return (hi << 64) | gen();
+}
+#endif
+
+pint::simd::uint128 RandomScalar(std::mt19937_64 &gen, Tag<pint::simd::uint128>) {
+    const uint64_t hi = gen();
+    return pint::simd::uint128(hi, gen());
+}
+
+pint::simd::uint256 RandomScalar(std::mt19937_64 &gen, Tag<pint::simd::uint256>) {
+    const pint::simd::uint128 hi = RandomScalar(gen, Tag<pint::simd::uint128>());
+    return pint::simd::uint256(hi, RandomScalar(gen, Tag<pint::simd::uint128>()));
+}
+
+template<class PackedInt>
+PackedInt RandomPackedInt(std::mt19937_64 &gen) {
+    using value_type = typename PackedInt::value_type;
+    using scalar_type = pint::detail::scalar_of<value_type>;
+
+    // Truncate value to the bits used by packs
+    return pint::add_wrap(
+        PackedInt(static_cast<value_type>(RandomScalar(gen, Tag<scalar_type>()))),
+        PackedInt(static_cast<value_type>(scalar_type(0))));
+}
+
+// Each pack of the result is compared with the result of the same
+// operation on single pack stored in uint64_t. Count is number of all packs
+template<class Op, class PackedInt, size_t Count>
+void CheckPacks(Op, PackedInt, PackedInt, PackedInt, pint::detail::seq<>, pint::detail::size_t_<Count>) {}
+
+template<class Op, class PackedInt, class Bits0, class ...Bits, size_t Count>
+void CheckPacks(Op op, PackedInt a, PackedInt b, PackedInt result,
+    pint::detail::seq<Bits0, Bits...>, pint::detail::size_t_<Count> count)
+{
+    using single = pint::packed_int<uint64_t, Bits0::value>;
+    const size_t index = Count - sizeof...(Bits) - 1;
+
+    const auto expected = op(
+        single(static_cast<uint64_t>(pint::get<index>(a))),
+        single(static_cast<uint64_t>(pint::get<index>(b))));
+    ASSERT_EQ(expected.value(), static_cast<uint64_t>(pint::get<index>(result))) << "pack " << index;
+
+    CheckPacks(op, a, b, result, pint::detail::seq<Bits...>(), count);
+}
+
+template<class PackedInt> struct BitsOf;
+template<class Integer, size_t ...Bits>
+struct BitsOf<pint::packed_int<Integer, Bits...>> {
+    using type = pint::detail::integer_seq<Bits...>;
+    static const size_t count = sizeof...(Bits);
+};
+
+template<class PackedInt, class Op>
+void CheckOp(Op op) {
+    std::mt19937_64 gen(1);
+    using bits = BitsOf<PackedInt>;
+
+    for (size_t i = 0; i < 1000; ++i) {
+        const auto a = RandomPackedInt<PackedInt>(gen);
+        const auto b = RandomPackedInt<PackedInt>(gen);
+        CheckPacks(op, a, b, op(a, b), typename bits::type(), pint::detail::size_t_<bits::count>());
+    }
+}
+
+template<class PackedInt>
+void CheckAllOps() {
+    CheckOp<PackedInt>(AddWrap());
+    CheckOp<PackedInt>(AddUnsignedSaturate());
+    CheckOp<PackedInt>(AddSignedSaturate());
+    CheckOp<PackedInt>(SubWrap());
+    CheckOp<PackedInt>(SubUnsignedSaturate());
+    CheckOp<PackedInt>(SubSignedSaturate());
+    CheckOp<PackedInt>(MinUnsigned());
+    CheckOp<PackedInt>(MaxUnsigned());
+    CheckOp<PackedInt>(MinSigned());
+    CheckOp<PackedInt>(MaxSigned());
+    CheckOp<PackedInt>(CmpEq());
+    CheckOp<PackedInt>(CmpLtUnsigned());
+    CheckOp<PackedInt>(CmpLeSigned());
+}
+
+// Reductions are compared with packs combined one by one
+template<class PackedInt>
+void CheckReducePacks(PackedInt, pint::detail::seq<>, pint::detail::size_t_<0>,
+    uint64_t &, uint64_t &, int64_t &, int64_t &) {}
+
+template<class PackedInt, class Bits0, class ...Bits, size_t Count>
+void CheckReducePacks(PackedInt value, pint::detail::seq<Bits0, Bits...>, pint::detail::size_t_<Count>,
+    uint64_t &min_unsigned, uint64_t &max_unsigned, int64_t &min_signed, int64_t &max_signed)
+{
+    const size_t index = Count - 1;
+    const auto pack = static_cast<uint64_t>(pint::get<index>(value));
+    const auto signed_pack = static_cast<int64_t>(pint::get_signed<index>(value));
+
+    min_unsigned = std::min(min_unsigned, pack);
+    max_unsigned = std::max(max_unsigned, pack);
+    min_signed = std::min(min_signed, signed_pack);
+    max_signed = std::max(max_signed, signed_pack);
+
+    CheckReducePacks(value, pint::detail::seq<Bits...>(), pint::detail::size_t_<Count - 1>(),
+        min_unsigned, max_unsigned, min_signed, max_signed);
+}
+
+template<class PackedInt>
+void CheckReduce() {
+    std::mt19937_64 gen(3);
+    using bits = BitsOf<PackedInt>;
+
+    for (size_t i = 0; i < 1000; ++i) {
+        const auto value = RandomPackedInt<PackedInt>(gen);
+
+        uint64_t min_unsigned = ~uint64_t(0), max_unsigned = 0;
+        int64_t min_signed = std::numeric_limits<int64_t>::max();
+        int64_t max_signed = std::numeric_limits<int64_t>::min();
+        CheckReducePacks(value, typename bits::type(), pint::detail::size_t_<bits::count>(),
+            min_unsigned, max_unsigned, min_signed, max_signed);
+
+        ASSERT_EQ(min_unsigned, static_cast<uint64_t>(pint::reduce_min_unsigned(value)));
+        ASSERT_EQ(max_unsigned, static_cast<uint64_t>(pint::reduce_max_unsigned(value)));
+        ASSERT_EQ(min_signed, static_cast<int64_t>(pint::reduce_min_signed(value)));
+        ASSERT_EQ(max_signed, static_cast<int64_t>(pint::reduce_max_signed(value)));
+    }
+}
+
+} // namespace
+
+#ifdef __SIZEOF_INT128__
+
+static_assert(std::is_same<pint::make_packed_int<7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7>::value_type,
+    unsigned __int128>::value, "Value type must be unsigned __int128");
+
+TEST(TestWide, Int128_SameLength) {
+    CheckAllOps<pint::packed_int<unsigned __int128, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7>>();
+    CheckAllOps<pint::packed_int<unsigned __int128, 64, 64>>();
+}
+
+TEST(TestWide, Int128_VarLength) {
+    // Packs may cross the middle of unsigned __int128
+    CheckAllOps<pint::packed_int<unsigned __int128, 3, 60, 5, 33, 11, 1>>();
+}
+
+TEST(TestWide, Int128_Reduce) {
+    CheckReduce<pint::packed_int<unsigned __int128, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7>>();
+    CheckReduce<pint::packed_int<unsigned __int128, 3, 60, 5, 33, 11, 1>>();
+
+    // Sum of packs is exact in the scalar type
+    using P = pint::packed_int<unsigned __int128, 64, 64>;
+    const P value(~uint64_t(0), ~uint64_t(0));
+    EXPECT_TRUE((static_cast<unsigned __int128>(~uint64_t(0)) << 1) == pint::reduce_add_wide(value));
+    EXPECT_EQ(~uint64_t(1), static_cast<uint64_t>(pint::reduce_add(value)));
+}
+
+TEST(TestWide, Int128_Get) {
+    using P = pint::packed_int<unsigned __int128, 60, 7, 61>;
+    const P value(1, 0x7e, (uint64_t(1) << 60) | 5);
+
+    EXPECT_EQ(1u, static_cast<uint64_t>(pint::get<0>(value)));
+    EXPECT_EQ(0x7eu, static_cast<uint64_t>(pint::get<1>(value)));
+    EXPECT_EQ(-2, static_cast<int64_t>(pint::get_signed<1>(value)));
+    EXPECT_EQ(-(int64_t(1) << 60) + 5, static_cast<int64_t>(pint::get_signed<2>(value)));
+}
+
+#endif
+
+#ifdef PINT_SIMD_X86
+
+// The first lane is filled by padding pack, packs can't cross lanes
+TEST(TestWide, M128) {
+    CheckAllOps<pint::packed_int<pint::simd::m128, 7, 7, 7, 7, 7, 7, 7, 7, 7, 1, 3, 13, 17, 31>>();
+    CheckAllOps<pint::packed_int<pint::simd::m128, 16, 16, 16, 16, 16, 16, 16, 16>>();
+}
+
+TEST(TestWide, M128_Reduce) {
+    CheckReduce<pint::packed_int<pint::simd::m128, 7, 7, 7, 7, 7, 7, 7, 7, 7, 1, 3, 13, 17, 31>>();
+    CheckReduce<pint::packed_int<pint::simd::m128, 16, 16, 16, 16, 16, 16, 16, 16>>();
+
+    using P = pint::packed_int<pint::simd::m128, 16, 16, 16, 16, 16, 16, 16, 16>;
+    const P value(static_cast<pint::simd::m128>(pint::simd::uint128(~uint64_t(0), ~uint64_t(0))));
+    EXPECT_TRUE(pint::simd::uint128(8 * 0xffff) == pint::reduce_add_wide(value));
+}
+
+TEST(TestWide, M128_Get) {
+    using P = pint::packed_int<pint::simd::m128, 60, 4, 5, 59>;
+    const P value(3, 0xf, 0x1e, 7);
+
+    EXPECT_EQ(3u, pint::get<0>(value));
+    EXPECT_EQ(0xfu, pint::get<1>(value));
+    EXPECT_EQ(-1, pint::get_signed<1>(value));
+    EXPECT_EQ(-2, pint::get_signed<2>(value));
+    EXPECT_EQ(7u, pint::get<3>(value));
+    EXPECT_TRUE(pint::simd::uint128((7 << 5) | 0x1e, 0xf000000000000003) ==
+        static_cast<pint::simd::uint128>(value.value()));
+}
+
+TEST(TestWide, M256) {
+    if (pint::simd::detected_level() < pint::simd::level::avx2)
+        return;
+
+    CheckAllOps<pint::packed_int<pint::simd::m256,
+        32, 32, 1, 2, 3, 4, 5, 6, 11, 32, 7, 7, 7, 7, 7, 7, 7, 7, 7, 1, 20, 20, 20>>();
+}
+
+// Bulk functions process registers one by one
+TEST(TestWide, M128_Bulk) {
+    using P = pint::packed_int<pint::simd::m128, 7, 7, 7, 7, 7, 7, 7, 7, 7, 1, 3, 13, 17, 31>;
+    std::mt19937_64 gen(2);
+
+    std::vector<P> a, b;
+    for (size_t i = 0; i < 33; ++i) {
+        a.push_back(RandomPackedInt<P>(gen));
+        b.push_back(RandomPackedInt<P>(gen));
+    }
+
+    std::vector<P> result = a;
+    pint::add_signed_saturate(a.data(), b.data(), result.data(), a.size());
+    for (size_t i = 0; i < a.size(); ++i)
+        ASSERT_TRUE(pint::add_signed_saturate(a[i], b[i]) == result[i]) << "index " << i;
+}
+
+#endif